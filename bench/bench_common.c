@@ -0,0 +1,229 @@
+/*
+ * bench_common.c - helpers shared by the codec benchmarks
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "bench_common.h"
+
+double now_ms()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec * 1e-6;
+}
+
+int file_exists(const char *path)
+{
+  struct stat st;
+
+  return stat(path, &st) == 0 && st.st_size > 0;
+}
+
+// makes a relative path absolute, the tools are run from other directories
+void make_absolute(char *path)
+{
+  char cwd[MAX_DIR_LEN], rel[MAX_DIR_LEN];
+
+  if (path[0] == '/' || getcwd(cwd, sizeof(cwd)) == NULL)
+    return;
+  strcpy(rel, path);
+  if (snprintf(path, MAX_DIR_LEN, "%s/%s", cwd, rel) >= MAX_DIR_LEN)
+    strcpy(path, rel);
+}
+
+// $TMPDIR/jm_bench or /tmp/jm_bench, the streams and sources are too large for the source tree
+void default_work_dir(char *dir)
+{
+  const char *tmp = getenv("TMPDIR");
+
+  if (tmp == NULL || tmp[0] == '\0')
+    tmp = "/tmp";
+  snprintf(dir, MAX_DIR_LEN, "%s/jm_bench", tmp);
+}
+
+int compare_double(const void *a, const void *b)
+{
+  double d = *(const double *) a - *(const double *) b;
+
+  return d < 0 ? -1 : (d > 0 ? 1 : 0);
+}
+
+/*
+ * Source generation
+ *
+ * The first frame of foreman_part_qcif.yuv is scaled up to cover the target
+ * resolution and panned by a few samples per frame, with a little noise so
+ * that the encoder does not code everything as skip.
+ */
+
+typedef struct
+{
+  unsigned char *y, *u, *v;
+} QcifFrame;
+
+static int load_qcif(const char *bin_dir, QcifFrame *f)
+{
+  char path[MAX_PATH_LEN];
+  FILE *in;
+  size_t size = 176 * 144 * 3 / 2;
+
+  snprintf(path, sizeof(path), "%s/foreman_part_qcif.yuv", bin_dir);
+  if ((in = fopen(path, "rb")) == NULL)
+  {
+    fprintf(stderr, "Cannot open %s\n", path);
+    return -1;
+  }
+  f->y = (unsigned char *) malloc(size);
+  if (f->y == NULL || fread(f->y, 1, size, in) != size)
+  {
+    fprintf(stderr, "Cannot read %s\n", path);
+    fclose(in);
+    return -1;
+  }
+  fclose(in);
+  f->u = f->y + 176 * 144;
+  f->v = f->u + 88 * 72;
+  return 0;
+}
+
+// bilinear sample at (x, y) in 1/256 units
+static int sample(const unsigned char *plane, int w, int h, int x, int y)
+{
+  int x0 = x >> 8, y0 = y >> 8, fx = x & 255, fy = y & 255;
+  int x1, y1, top, bottom;
+
+  if (x0 < 0) { x0 = 0; fx = 0; }
+  if (y0 < 0) { y0 = 0; fy = 0; }
+  if (x0 > w - 1) { x0 = w - 1; fx = 0; }
+  if (y0 > h - 1) { y0 = h - 1; fy = 0; }
+  x1 = x0 < w - 1 ? x0 + 1 : x0;
+  y1 = y0 < h - 1 ? y0 + 1 : y0;
+
+  top    = plane[y0 * w + x0] * (256 - fx) + plane[y0 * w + x1] * fx;
+  bottom = plane[y1 * w + x0] * (256 - fx) + plane[y1 * w + x1] * fx;
+  return (top * (256 - fy) + bottom * fy + (1 << 15)) >> 16;
+}
+
+static void make_plane(unsigned char *dst, int w, int h, const unsigned char *src, int sw, int sh,
+                       int step, int off_x, int off_y, unsigned int *seed)
+{
+  int x, y, v;
+
+  for (y = 0; y < h; y++)
+  {
+    for (x = 0; x < w; x++)
+    {
+      v = sample(src, sw, sh, x * step + off_x, y * step + off_y);
+      *seed = *seed * 1103515245u + 12345u;
+      v += (int) ((*seed >> 16) & 3) - 1;
+      dst[y * w + x] = (unsigned char) (v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+  }
+}
+
+// name of the cached synthetic source in the work directory
+void source_path(char *path, const char *work_dir, int width, int height, int frames, int yuv_format)
+{
+  snprintf(path, MAX_PATH_LEN, "%s/src_%dx%d_%d_%d.yuv", work_dir, width, height, yuv_format, frames);
+}
+
+int make_source(const char *bin_dir, const char *path, int width, int height, int frames, int yuv_format)
+{
+  QcifFrame qcif;
+  FILE *out;
+  int cw = yuv_format == 3 ? width : width / 2;
+  int ch = yuv_format == 1 ? height / 2 : height;
+  int frame_size = width * height + 2 * cw * ch;
+  unsigned char *buf;
+  unsigned int seed = 1;
+  int t, step;
+
+  if (load_qcif(bin_dir, &qcif) != 0)
+    return -1;
+
+  // source step per target luma sample in 1/256 units, leaving room for panning
+  step = (176 * 256 * 4 / 5) / width;
+  if ((144 * 256 * 4 / 5) / height < step)
+    step = (144 * 256 * 4 / 5) / height;
+
+  buf = (unsigned char *) malloc(frame_size);
+  if (buf == NULL || (out = fopen(path, "wb")) == NULL)
+  {
+    fprintf(stderr, "Cannot create %s\n", path);
+    free(buf);
+    free(qcif.y);
+    return -1;
+  }
+
+  for (t = 0; t < frames; t++)
+  {
+    int off_x = t * 96, off_y = t * 32;   // pan by 3/8 and 1/8 QCIF samples per frame
+
+    make_plane(buf, width, height, qcif.y, 176, 144, step, off_x, off_y, &seed);
+    make_plane(buf + width * height, cw, ch, qcif.u, 88, 72,
+      step * width / cw / 2, off_x / 2, off_y / 2, &seed);
+    make_plane(buf + width * height + cw * ch, cw, ch, qcif.v, 88, 72,
+      step * width / cw / 2, off_x / 2, off_y / 2, &seed);
+    fwrite(buf, 1, frame_size, out);
+  }
+
+  fclose(out);
+  free(buf);
+  free(qcif.y);
+  return 0;
+}
+
+/*
+ * Process handling
+ */
+
+// runs cmd with /bin/sh in dir, returns the exit status or -1
+int run_command(const char *dir, const char *cmd, const char *log, double *ms, long *peak_rss_kb)
+{
+  struct rusage ru;
+  double start = now_ms();
+  int status;
+  pid_t pid = fork();
+
+  if (pid < 0)
+    return -1;
+
+  if (pid == 0)
+  {
+    int fd = open(log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd >= 0)
+    {
+      dup2(fd, 1);
+      dup2(fd, 2);
+      close(fd);
+    }
+    if (chdir(dir) != 0)
+      _exit(127);
+    execl("/bin/sh", "sh", "-c", cmd, (char *) NULL);
+    _exit(127);
+  }
+
+  if (wait4(pid, &status, 0, &ru) < 0)
+    return -1;
+
+  if (ms)
+    *ms = now_ms() - start;
+  if (peak_rss_kb)
+    *peak_rss_kb = ru.ru_maxrss;
+
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
@@ -0,0 +1,25 @@
+/*
+ * bench_common.h - helpers shared by the codec benchmarks
+ *
+ * Synthetic source generation, running the codecs as child processes with
+ * their time and peak RSS, and small file and path utilities.
+ */
+
+#ifndef _BENCH_COMMON_H_
+#define _BENCH_COMMON_H_
+
+#define MAX_DIR_LEN    512
+#define MAX_PATH_LEN   1024
+#define MAX_CMD_LEN    8192
+
+extern double now_ms        (void);
+extern int    file_exists   (const char *path);
+extern void   make_absolute (char *path);
+extern int    compare_double(const void *a, const void *b);
+extern void   default_work_dir(char *dir);
+
+extern void   source_path   (char *path, const char *work_dir, int width, int height, int frames, int yuv_format);
+extern int    make_source   (const char *bin_dir, const char *path, int width, int height, int frames, int yuv_format);
+extern int    run_command   (const char *dir, const char *cmd, const char *log, double *ms, long *peak_rss_kb);
+
+#endif
@@ -0,0 +1,545 @@
+/*
+ * decbench - decoder benchmark
+ *
+ *   decbench [-bin <dir>] [-work <dir>] [-set quick|full] [-reps <n>]
+ *            [-o <results>.json] [-baseline <baseline>.json] [-threshold <pct>]
+ *            [-only <name>] [-args "<ldecod options>"]
+ *   decbench [-bin <dir>] [-work <dir>] -conceal <loss_pct>
+ *
+ * Encodes a matrix of streams with lencod (entropy coder, frame/field/MBAFF
+ * coding, chroma format and resolution) from a synthetic source, then decodes
+ * each stream -reps times with ldecod and reports frames/s, macroblocks/s and
+ * peak RSS. The timed runs write no inspector files (ldecod -inspect_none).
+ * Streams are cached in the work directory and only encoded once.
+ * The work directory defaults to $TMPDIR/jm_bench (/tmp/jm_bench), the
+ * results to results.json in it.
+ *
+ * If ldecod was built with per-stage profiling (make PROF=1), the stage times
+ * of the fastest run are reported as well.
+ *
+ * The exit code is 1 if a stream cannot be encoded or decoded. With -baseline,
+ * the results are compared against an earlier results file and the exit code
+ * is also 1 if a stream got slower by more than -threshold percent (default 5)
+ * or a baseline stream of the selected set has no result.
+ *
+ * -conceal runs the frame loss concealment check instead: a CIF CAVLC stream
+ * with one slice per picture is sent through rtp_loss and decoded with frame
+ * copy and with motion extrapolation concealment. The synthetic source pans
+ * by fractional samples, so the extrapolated motion uses sub-pel vectors.
+ * The exit code is 1 if a decode fails or extrapolation is worse than copy.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "bench_common.h"
+
+#define MAX_REPS       32
+#define NUM_STAGES     9
+
+typedef struct
+{
+  const char *name;
+  int width;
+  int height;
+  int frames;
+  int yuv_format;       // 1: 4:2:0, 2: 4:2:2, 3: 4:4:4
+  int full_only;        // only part of -set full
+  const char *params;   // lencod parameters of this stream
+} BenchStream;
+
+typedef struct
+{
+  char name[64];
+  double fps;
+  double mbps;
+  double median_ms;
+  double min_ms;
+  long peak_rss_kb;
+  double stage_ms[NUM_STAGES];
+  int has_stages;
+} BenchResult;
+
+static const char *stage_names[NUM_STAGES] =
+{
+  "nal_read", "entropy", "recon", "intra", "mc", "itrans", "deblock", "output", "inspect"
+};
+
+// parameters common to all streams, chosen to keep encoding time reasonable
+static const char *common_params =
+  "-p IntraPeriod=16 -p NumberBFrames=1 -p QPISlice=28 -p QPPSlice=28 -p QPBSlice=30 "
+  "-p RDOptimization=0 -p SearchMode=3 -p SearchRange=16 -p NumberReferenceFrames=2 "
+  "-p LevelIDC=40 -p RateControlEnable=0";
+
+// tools lencod does not support together with MBAFF, its non-RDO mode decision
+// writes undecodable MBAFF streams
+#define MBAFF_PARAMS \
+  "-p RDOptimization=1 -p ReferenceReorder=0 -p PocMemoryManagement=0 -p WeightedPrediction=0 -p WeightedBiprediction=0"
+
+static const BenchStream streams[] =
+{
+  { "qcif_420_cavlc",       176,  144, 30, 1, 0, "-p ProfileIDC=100 -p SymbolMode=0" },
+  { "qcif_420_cabac",       176,  144, 30, 1, 0, "-p ProfileIDC=100 -p SymbolMode=1" },
+  { "qcif_420_cabac_field", 176,  144, 30, 1, 0, "-p ProfileIDC=100 -p SymbolMode=1 -p PicInterlace=1" },
+  { "qcif_420_cabac_mbaff", 176,  144, 30, 1, 0, "-p ProfileIDC=100 -p SymbolMode=1 -p MbInterlace=1 " MBAFF_PARAMS },
+  { "qcif_422_cabac",       176,  144, 30, 2, 0, "-p ProfileIDC=122 -p SymbolMode=1" },
+  { "qcif_444_cabac",       176,  144, 30, 3, 0, "-p ProfileIDC=244 -p SymbolMode=1" },
+  { "cif_420_cavlc",        352,  288, 30, 1, 0, "-p ProfileIDC=100 -p SymbolMode=0" },
+  { "cif_420_cabac",        352,  288, 30, 1, 0, "-p ProfileIDC=100 -p SymbolMode=1" },
+  { "cif_420_cabac_mbaff",  352,  288, 30, 1, 1, "-p ProfileIDC=100 -p SymbolMode=1 -p MbInterlace=1 " MBAFF_PARAMS },
+  { "cif_422_cabac",        352,  288, 30, 2, 1, "-p ProfileIDC=122 -p SymbolMode=1" },
+  { "cif_444_cabac",        352,  288, 30, 3, 1, "-p ProfileIDC=244 -p SymbolMode=1" },
+  { "720p_420_cabac",      1280,  720, 10, 1, 1, "-p ProfileIDC=100 -p SymbolMode=1" },
+  { "1080p_420_cavlc",     1920, 1080, 10, 1, 1, "-p ProfileIDC=100 -p SymbolMode=0" },
+  { "1080p_420_cabac",     1920, 1080, 10, 1, 1, "-p ProfileIDC=100 -p SymbolMode=1" },
+  { "1080p_420_cabac_field",1920, 1080, 10, 1, 1, "-p ProfileIDC=100 -p SymbolMode=1 -p PicInterlace=1" },
+};
+
+#define NUM_STREAMS ((int) (sizeof(streams) / sizeof(streams[0])))
+
+// stream of the concealment check, IPPP so that every lost picture is a reference
+static const BenchStream conceal_stream =
+  { "cif_420_cavlc_rtp",    352,  288, 30, 1, 0,
+    "-p ProfileIDC=100 -p SymbolMode=0 -p NumberBFrames=0 -p IntraPeriod=0 -p SliceMode=0 -p OutFileMode=1" };
+
+static char bin_dir[MAX_DIR_LEN] = "../bin";
+static char work_dir[MAX_DIR_LEN] = "";
+static char dec_args[MAX_DIR_LEN] = "";
+
+static void usage()
+{
+  printf("Usage: decbench [-bin <dir>] [-work <dir>] [-set quick|full] [-reps <n>]\n");
+  printf("                [-o <results>.json] [-baseline <baseline>.json] [-threshold <pct>]\n");
+  printf("                [-only <name>] [-args \"<ldecod options>\"]\n");
+  printf("       decbench [-bin <dir>] [-work <dir>] -conceal <loss_pct>\n");
+  exit(-1);
+}
+
+static int encode_stream(const BenchStream *s, const char *stream_path, const char *recon_path)
+{
+  char source[MAX_PATH_LEN], recon[MAX_PATH_LEN], log[MAX_PATH_LEN], cmd[MAX_CMD_LEN];
+  int ret;
+
+  source_path(source, work_dir, s->width, s->height, s->frames, s->yuv_format);
+  if (!file_exists(source))
+  {
+    printf("  generating %s\n", source);
+    if (make_source(bin_dir, source, s->width, s->height, s->frames, s->yuv_format) != 0)
+      return -1;
+  }
+
+  if (recon_path)
+    snprintf(recon, sizeof(recon), "%s", recon_path);
+  else
+    snprintf(recon, sizeof(recon), "%s/enc_rec.yuv", work_dir);
+  snprintf(log, sizeof(log), "%s/%s_enc.log", work_dir, s->name);
+  // run in the work directory, lencod writes its statistics files to the current directory
+  snprintf(cmd, sizeof(cmd),
+    "exec \"%s/lencod.exe\" -d \"%s/encoder.cfg\" %s %s -p InputFile1=\"%s\" -p SourceWidth=%d -p SourceHeight=%d "
+    "-p OutputWidth=%d -p OutputHeight=%d -p YUVFormat=%d -p FramesToBeEncoded=%d "
+    "-p OutputFile=\"%s\" -p ReconFile=\"%s\"",
+    bin_dir, bin_dir, common_params, s->params, source, s->width, s->height, s->width, s->height,
+    s->yuv_format, s->frames, stream_path, recon);
+
+  printf("  encoding %s\n", s->name);
+  ret = run_command(work_dir, cmd, log, NULL, NULL);
+  if (recon_path == NULL)
+    remove(recon);
+  if (ret != 0 || !file_exists(stream_path))
+  {
+    fprintf(stderr, "Encoding %s failed, see %s\n", s->name, log);
+    remove(stream_path);
+    return -1;
+  }
+  return 0;
+}
+
+// reads the stage times from the JSON summary of ldecod -profile
+static int read_profile(const char *path, double *stage_ms)
+{
+  char buf[4096], key[64];
+  size_t len;
+  FILE *f = fopen(path, "r");
+  char *stages, *p;
+  int i;
+
+  if (f == NULL)
+    return 0;
+  len = fread(buf, 1, sizeof(buf) - 1, f);
+  fclose(f);
+  buf[len] = '\0';
+
+  // only the totals, the per slice type objects follow them
+  if ((stages = strstr(buf, "\"stages\"")) == NULL)
+    return 0;
+  if ((p = strstr(stages, "\"slice_types\"")) != NULL)
+    *p = '\0';
+
+  for (i = 0; i < NUM_STAGES; i++)
+  {
+    snprintf(key, sizeof(key), "\"%s\": {\"ms\": ", stage_names[i]);
+    if ((p = strstr(stages, key)) == NULL)
+      return 0;
+    stage_ms[i] = atof(p + strlen(key));
+  }
+  return 1;
+}
+
+static int decode_stream(const BenchStream *s, const char *stream_path, int reps, BenchResult *res)
+{
+  char run_dir[MAX_PATH_LEN], log[MAX_PATH_LEN], profile[MAX_PATH_LEN], cmd[MAX_CMD_LEN];
+  double times[MAX_REPS], best = -1.0;
+  int r, mbs = ((s->width + 15) / 16) * ((s->height + 15) / 16);
+
+  // ldecod writes its logs to the current directory
+  snprintf(run_dir, sizeof(run_dir), "%s/run", work_dir);
+  mkdir(run_dir, 0755);
+  snprintf(log, sizeof(log), "%s/%s_dec.log", work_dir, s->name);
+  snprintf(profile, sizeof(profile), "%s/run/profile.json", work_dir);
+
+  memset(res, 0, sizeof(BenchResult));
+  strncpy(res->name, s->name, sizeof(res->name) - 1);
+
+  for (r = 0; r < reps; r++)
+  {
+    long rss = 0;
+    double stage_ms[NUM_STAGES];
+
+    remove(profile);
+    snprintf(cmd, sizeof(cmd), "exec \"%s/ldecod.exe\" -i \"%s\" -o /dev/null -inspect_none -profile profile.json %s",
+      bin_dir, stream_path, dec_args);
+    if (run_command(run_dir, cmd, log, &times[r], &rss) != 0)
+    {
+      fprintf(stderr, "Decoding %s failed, see %s\n", s->name, log);
+      return -1;
+    }
+    if (rss > res->peak_rss_kb)
+      res->peak_rss_kb = rss;
+
+    // stage times of the fastest run
+    if ((best < 0 || times[r] < best) && read_profile(profile, stage_ms))
+    {
+      memcpy(res->stage_ms, stage_ms, sizeof(stage_ms));
+      res->has_stages = 1;
+    }
+    if (best < 0 || times[r] < best)
+      best = times[r];
+  }
+
+  qsort(times, reps, sizeof(double), compare_double);
+  res->min_ms = times[0];
+  res->median_ms = (reps & 1) ? times[reps / 2] : 0.5 * (times[reps / 2 - 1] + times[reps / 2]);
+  res->fps = s->frames * 1000.0 / res->median_ms;
+  res->mbps = (double) s->frames * mbs * 1000.0 / res->median_ms;
+  return 0;
+}
+
+/*
+ * Concealment check
+ */
+
+// decodes the lossy stream with one concealment mode, returns the Y PSNR against the lossless recon
+static int decode_conceal(const char *lossy, const char *recon, int mode, double *snr_y)
+{
+  char run_dir[MAX_PATH_LEN], cfg[MAX_PATH_LEN], log[MAX_PATH_LEN], cmd[MAX_CMD_LEN], line[1024];
+  FILE *f;
+  int ret;
+
+  snprintf(run_dir, sizeof(run_dir), "%s/run", work_dir);
+  mkdir(run_dir, 0755);
+  snprintf(cfg, sizeof(cfg), "%s/run/conceal%d.cfg", work_dir, mode);
+  snprintf(log, sizeof(log), "%s/conceal%d_dec.log", work_dir, mode);
+
+  // RTP input and the concealment mode are only available through the configuration file
+  if ((f = fopen(cfg, "w")) == NULL)
+  {
+    fprintf(stderr, "Cannot create %s\n", cfg);
+    return -1;
+  }
+  fprintf(f, "%s\n/dev/null\n%s\n1\n1\n0\n2\n500000\n104000\n73000\nleakybucketparam.cfg\n"
+    "%d\n2\n2\n0\n1\nnone\n0\n", lossy, recon, mode);
+  fclose(f);
+
+  snprintf(cmd, sizeof(cmd), "exec \"%s/ldecod.exe\" \"%s\"", bin_dir, cfg);
+  ret = run_command(run_dir, cmd, log, NULL, NULL);
+  if (ret != 0)
+  {
+    fprintf(stderr, "Decoding with concealment mode %d failed (exit %d), see %s\n", mode, ret, log);
+    return -1;
+  }
+
+  *snr_y = -1.0;
+  if ((f = fopen(log, "r")) == NULL)
+    return -1;
+  while (fgets(line, sizeof(line), f))
+  {
+    char *p = strstr(line, "SNR Y(dB)");
+
+    if (p != NULL && (p = strchr(p, ':')) != NULL)
+      *snr_y = atof(p + 1);
+  }
+  fclose(f);
+  return *snr_y < 0 ? -1 : 0;
+}
+
+static int conceal_check(int loss)
+{
+  const BenchStream *s = &conceal_stream;
+  char stream_path[MAX_PATH_LEN], recon[MAX_PATH_LEN], lossy[MAX_PATH_LEN], log[MAX_PATH_LEN], cmd[MAX_CMD_LEN];
+  double snr_copy, snr_extrapolate;
+
+  snprintf(stream_path, sizeof(stream_path), "%s/%s.rtp", work_dir, s->name);
+  snprintf(recon, sizeof(recon), "%s/%s_rec.yuv", work_dir, s->name);
+  if ((!file_exists(stream_path) || !file_exists(recon)) && encode_stream(s, stream_path, recon) != 0)
+    return 1;
+
+  // keep the parameter sets and the IDR picture
+  snprintf(lossy, sizeof(lossy), "%s/%s_loss%d.rtp", work_dir, s->name, loss);
+  snprintf(log, sizeof(log), "%s/%s_loss.log", work_dir, s->name);
+  snprintf(cmd, sizeof(cmd), "exec \"%s/rtp_loss.exe\" \"%s\" \"%s\" %d 2", bin_dir, stream_path, lossy, loss);
+  if (run_command(work_dir, cmd, log, NULL, NULL) != 0)
+  {
+    fprintf(stderr, "rtp_loss failed, see %s\n", log);
+    return 1;
+  }
+
+  if (decode_conceal(lossy, recon, 1, &snr_copy) != 0 ||
+      decode_conceal(lossy, recon, 3, &snr_extrapolate) != 0)
+    return 1;
+
+  printf(" %s, %d%% packet loss\n", s->name, loss);
+  printf("   frame copy            SNR Y %6.2f dB\n", snr_copy);
+  printf("   motion extrapolation  SNR Y %6.2f dB\n", snr_extrapolate);
+  if (snr_extrapolate < snr_copy)
+  {
+    printf("\n Motion extrapolation is worse than frame copy\n");
+    return 1;
+  }
+  return 0;
+}
+
+/*
+ * Results
+ *
+ * One stream per line, so that baselines can be read back without a JSON parser.
+ */
+
+static void write_results(const char *path, BenchResult *res, int num, int reps)
+{
+  FILE *f = fopen(path, "w");
+  int i, k;
+
+  if (f == NULL)
+  {
+    fprintf(stderr, "Cannot create %s\n", path);
+    return;
+  }
+
+  fprintf(f, "{\n  \"reps\": %d,\n  \"streams\": [\n", reps);
+  for (i = 0; i < num; i++)
+  {
+    fprintf(f, "    {\"name\": \"%s\", \"fps\": %.3f, \"mb_per_s\": %.1f, \"median_ms\": %.3f, \"min_ms\": %.3f, \"peak_rss_kb\": %ld",
+      res[i].name, res[i].fps, res[i].mbps, res[i].median_ms, res[i].min_ms, res[i].peak_rss_kb);
+    if (res[i].has_stages)
+    {
+      fprintf(f, ", \"stages_ms\": {");
+      for (k = 0; k < NUM_STAGES; k++)
+        fprintf(f, "%s\"%s\": %.3f", k ? ", " : "", stage_names[k], res[i].stage_ms[k]);
+      fprintf(f, "}");
+    }
+    fprintf(f, "}%s\n", i < num - 1 ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  fclose(f);
+}
+
+static int read_number(const char *line, const char *key, double *value)
+{
+  const char *p = strstr(line, key);
+
+  if (p == NULL)
+    return 0;
+  *value = atof(p + strlen(key));
+  return 1;
+}
+
+// true if the stream is part of this run
+static int stream_selected(const char *name, int full, const char *only)
+{
+  int i;
+
+  for (i = 0; i < NUM_STREAMS; i++)
+  {
+    if (!strcmp(streams[i].name, name))
+      return (full || !streams[i].full_only) && (only == NULL || !strcmp(only, name));
+  }
+  return 0;
+}
+
+// compares against a baseline, returns the number of regressions and of selected streams without a result
+static int compare_baseline(const char *path, BenchResult *res, int num, double threshold, int full, const char *only)
+{
+  char line[4096];
+  FILE *f = fopen(path, "r");
+  int regressions = 0, i;
+
+  if (f == NULL)
+  {
+    fprintf(stderr, "Cannot open baseline %s\n", path);
+    return -1;
+  }
+
+  printf("\n Stream                    base fps    new fps   change\n");
+  while (fgets(line, sizeof(line), f))
+  {
+    char name[64];
+    const char *p = strstr(line, "\"name\": \"");
+    double base_fps;
+
+    if (p == NULL || !read_number(line, "\"fps\": ", &base_fps) || base_fps <= 0)
+      continue;
+    if (sscanf(p + 9, "%63[^\"]", name) != 1)
+      continue;
+
+    for (i = 0; i < num && strcmp(res[i].name, name) != 0; i++)
+      ;
+    if (i == num)
+    {
+      if (stream_selected(name, full, only))
+      {
+        printf(" %-24s %9.2f  %9s           MISSING\n", name, base_fps, "-");
+        regressions++;
+      }
+      else
+        printf(" %-24s %9.2f  %9s           not run\n", name, base_fps, "-");
+      continue;
+    }
+
+    {
+      double change = 100.0 * (res[i].fps - base_fps) / base_fps;
+      int slower = change < -threshold;
+
+      printf(" %-24s %9.2f  %9.2f  %+6.1f%%%s\n", name, base_fps, res[i].fps, change, slower ? "  REGRESSION" : "");
+      regressions += slower;
+    }
+  }
+  fclose(f);
+  return regressions;
+}
+
+int main(int argc, char **argv)
+{
+  BenchResult results[NUM_STREAMS];
+  const char *out_file = NULL, *baseline = NULL, *only = NULL;
+  char default_out[MAX_PATH_LEN];
+  double threshold = 5.0;
+  int full = 0, reps = 3, num = 0, failed = 0, ret = 0, conceal = -1, i, k;
+
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  for (i = 1; i < argc; i++)
+  {
+    if (i + 1 >= argc)
+      usage();
+    if (!strcmp(argv[i], "-bin"))
+      strncpy(bin_dir, argv[++i], MAX_DIR_LEN - 1);
+    else if (!strcmp(argv[i], "-work"))
+      strncpy(work_dir, argv[++i], MAX_DIR_LEN - 1);
+    else if (!strcmp(argv[i], "-set"))
+      full = !strcmp(argv[++i], "full");
+    else if (!strcmp(argv[i], "-reps"))
+      reps = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-o"))
+      out_file = argv[++i];
+    else if (!strcmp(argv[i], "-baseline"))
+      baseline = argv[++i];
+    else if (!strcmp(argv[i], "-threshold"))
+      threshold = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-only"))
+      only = argv[++i];
+    else if (!strcmp(argv[i], "-args"))
+      strncpy(dec_args, argv[++i], MAX_DIR_LEN - 1);
+    else if (!strcmp(argv[i], "-conceal"))
+      conceal = atoi(argv[++i]);
+    else
+      usage();
+  }
+  if (reps < 1 || reps > MAX_REPS)
+  {
+    fprintf(stderr, "-reps must be between 1 and %d\n", MAX_REPS);
+    return -1;
+  }
+
+  if (work_dir[0] == '\0')
+    default_work_dir(work_dir);
+  make_absolute(bin_dir);
+  make_absolute(work_dir);
+  if (mkdir(work_dir, 0755) != 0 && errno != EEXIST)
+  {
+    fprintf(stderr, "Cannot create %s\n", work_dir);
+    return -1;
+  }
+
+  if (conceal >= 0)
+    return conceal_check(conceal);
+
+  if (out_file == NULL)
+  {
+    snprintf(default_out, sizeof(default_out), "%s/results.json", work_dir);
+    out_file = default_out;
+  }
+
+  printf(" Stream                      fps       MB/s  median(ms)  peak RSS(kB)\n");
+  for (i = 0; i < NUM_STREAMS; i++)
+  {
+    const BenchStream *s = &streams[i];
+    char stream_path[MAX_PATH_LEN];
+
+    if ((s->full_only && !full) || (only && strcmp(only, s->name) != 0))
+      continue;
+
+    snprintf(stream_path, sizeof(stream_path), "%s/%s.264", work_dir, s->name);
+    if ((!file_exists(stream_path) && encode_stream(s, stream_path, NULL) != 0) ||
+        decode_stream(s, stream_path, reps, &results[num]) != 0)
+    {
+      printf(" %-24s   FAILED\n", s->name);
+      failed++;
+      continue;
+    }
+
+    printf(" %-24s %8.2f %10.0f %11.2f %13ld\n", s->name, results[num].fps, results[num].mbps,
+      results[num].median_ms, results[num].peak_rss_kb);
+    if (results[num].has_stages)
+    {
+      printf("   ");
+      for (k = 0; k < NUM_STAGES; k++)
+        printf(" %s %.1f", stage_names[k], results[num].stage_ms[k]);
+      printf(" (ms)\n");
+    }
+    num++;
+  }
+
+  write_results(out_file, results, num, reps);
+  printf("\n Results written to %s\n", out_file);
+
+  if (baseline)
+  {
+    int regressions = compare_baseline(baseline, results, num, threshold, full, only);
+
+    if (regressions > 0)
+      printf("\n %d stream(s) slower than the baseline by more than %.1f%% or missing\n", regressions, threshold);
+    if (regressions != 0)
+      ret = 1;
+  }
+  if (failed)
+  {
+    printf("\n %d stream(s) could not be encoded or decoded\n", failed);
+    ret = 1;
+  }
+  return ret;
+}
@@ -0,0 +1,655 @@
+/*
+ * encbench - encoder benchmark
+ *
+ *   encbench [-bin <dir>] [-work <dir>] [-set quick|full] [-reps <n>] [-qps <qp,qp,...>]
+ *            [-o <results>.json] [-baseline <baseline>.json] [-threshold <pct>]
+ *            [-bd-threshold <pct>] [-only <name>] [-args "<lencod options>"]
+ *
+ * Encodes a fixed matrix of sequences and encoder presets with lencod. The
+ * presets vary the motion search (SearchMode), the mode decision
+ * (RDOptimization), RDOQ (UseRDOQuant), the entropy coder and the B-frame
+ * structure around a reference preset. The sequences are synthetic, generated
+ * like the decbench sources, and long enough for stable rates and BD-rates.
+ *
+ * Every sequence/preset pair is encoded at each QP of -qps (default
+ * 22,27,32,37) -reps times. The median run gives frames/s; the bit rate and
+ * the PSNR of each QP are read from the lencod report and the peak RSS is the
+ * largest of all runs. The BD-rate of every preset against the reference
+ * preset on the same sequence shows the rate-distortion cost of its speed.
+ * The work directory defaults to $TMPDIR/jm_bench (/tmp/jm_bench), the
+ * results to encresults.json in it.
+ *
+ * The exit code is 1 if a pair cannot be encoded. With -baseline, the results
+ * are compared against an earlier results file: the exit code is also 1 if a
+ * pair got slower by more than -threshold percent (default 5), its BD-rate
+ * against the baseline is above -bd-threshold percent (default 0.5) or a
+ * baseline pair of the selected set has no result.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "bench_common.h"
+
+#define MAX_REPS       32
+#define MAX_QPS        8
+
+typedef struct
+{
+  const char *name;
+  int width;
+  int height;
+  int frames;
+  int yuv_format;       // 1: 4:2:0, 2: 4:2:2, 3: 4:4:4
+  int full_only;        // only part of -set full
+  const char *params;   // lencod parameters of this sequence
+} BenchSequence;
+
+typedef struct
+{
+  const char *name;
+  int full_only;        // only part of -set full
+  const char *params;   // lencod parameters changed from the reference preset
+} BenchPreset;
+
+typedef struct
+{
+  char name[128];
+  int num_qps;
+  int qp[MAX_QPS];
+  double fps[MAX_QPS];
+  double kbps[MAX_QPS];
+  double psnr[MAX_QPS][3];
+  double fps_total;     // all frames of all QPs over the sum of the median times
+  long peak_rss_kb;
+  double bd_rate_ref;   // BD-rate against the reference preset in percent
+  int has_bd_rate_ref;
+} BenchResult;
+
+// parameters of the reference preset, the QPs are set per run
+static const char *common_params =
+  "-p IntraPeriod=0 -p NumberBFrames=1 -p HierarchicalCoding=0 -p SearchMode=3 -p SearchRange=16 "
+  "-p NumberReferenceFrames=2 -p RDOptimization=1 -p UseRDOQuant=0 -p SymbolMode=1 "
+  "-p LevelIDC=40 -p RateControlEnable=0";
+
+static const BenchSequence sequences[] =
+{
+  { "synth_qcif_420",  176, 144, 30, 1, 0, "-p ProfileIDC=100" },
+  { "synth_cif_420",   352, 288, 15, 1, 0, "-p ProfileIDC=100" },
+  { "synth_qcif_422",  176, 144, 30, 2, 1, "-p ProfileIDC=122" },
+  { "synth_qcif_444",  176, 144, 30, 3, 1, "-p ProfileIDC=244" },
+  { "synth_720p_420", 1280, 720, 10, 1, 1, "-p ProfileIDC=100" },
+};
+
+// the first preset is the reference of the BD-rates
+static const BenchPreset presets[] =
+{
+  { "ref",         0, "" },
+  { "full_search", 1, "-p SearchMode=-1" },
+  { "fast_full",   0, "-p SearchMode=0" },
+  { "umhex",       0, "-p SearchMode=1" },
+  { "smp_umhex",   1, "-p SearchMode=2" },
+  { "rdo_off",     0, "-p RDOptimization=0" },
+  { "rdoq",        0, "-p UseRDOQuant=1" },
+  { "cavlc",       0, "-p SymbolMode=0" },
+  { "no_b",        0, "-p NumberBFrames=0" },
+  { "hier_b3",     0, "-p NumberBFrames=3 -p HierarchicalCoding=2" },
+  { "fastest",     0, "-p RDOptimization=0 -p SymbolMode=0 -p NumberBFrames=0" },
+  { "best",        1, "-p UseRDOQuant=1 -p NumberBFrames=3 -p HierarchicalCoding=2 -p SearchRange=32 -p NumberReferenceFrames=4" },
+};
+
+#define NUM_SEQUENCES ((int) (sizeof(sequences) / sizeof(sequences[0])))
+#define NUM_PRESETS   ((int) (sizeof(presets) / sizeof(presets[0])))
+
+static char bin_dir[MAX_DIR_LEN] = "../bin";
+static char work_dir[MAX_DIR_LEN] = "";
+static char enc_args[MAX_DIR_LEN] = "";
+
+static void usage()
+{
+  printf("Usage: encbench [-bin <dir>] [-work <dir>] [-set quick|full] [-reps <n>] [-qps <qp,qp,...>]\n");
+  printf("                [-o <results>.json] [-baseline <baseline>.json] [-threshold <pct>]\n");
+  printf("                [-bd-threshold <pct>] [-only <name>] [-args \"<lencod options>\"]\n");
+  exit(-1);
+}
+
+// reads the comma separated numbers after key, returns their count
+static int read_array(const char *line, const char *key, double *values, int max_values)
+{
+  const char *p = strstr(line, key);
+  char *end;
+  int n = 0;
+
+  if (p == NULL)
+    return 0;
+  p += strlen(key);
+  while (n < max_values)
+  {
+    values[n] = strtod(p, &end);
+    if (end == p)
+      break;
+    n++;
+    p = end;
+    while (*p == ' ' || *p == ',')
+      p++;
+  }
+  return n;
+}
+
+/*
+ * BD-rate
+ *
+ * Bjontegaard delta rate: log10 of the rate is fitted as a cubic polynomial
+ * of the PSNR for both curves (of lower degree with fewer than four points),
+ * the average difference over the overlapping PSNR range is the log10 of the
+ * rate ratio.
+ */
+
+// least squares polynomial fit of the given degree, returns 0 if singular
+static int polyfit(const double *x, const double *y, int n, int degree, double *coef)
+{
+  double a[4][5];
+  int i, j, k, m = degree + 1;
+
+  memset(a, 0, sizeof(a));
+  for (k = 0; k < n; k++)
+  {
+    double xi[7];
+
+    xi[0] = 1.0;
+    for (i = 1; i < 2 * m - 1; i++)
+      xi[i] = xi[i - 1] * x[k];
+    for (i = 0; i < m; i++)
+    {
+      for (j = 0; j < m; j++)
+        a[i][j] += xi[i + j];
+      a[i][m] += xi[i] * y[k];
+    }
+  }
+
+  // Gaussian elimination with partial pivoting
+  for (i = 0; i < m; i++)
+  {
+    int pivot = i;
+
+    for (k = i + 1; k < m; k++)
+      if (fabs(a[k][i]) > fabs(a[pivot][i]))
+        pivot = k;
+    if (fabs(a[pivot][i]) < 1e-12)
+      return 0;
+    for (j = 0; j <= m; j++)
+    {
+      double t = a[i][j];
+
+      a[i][j] = a[pivot][j];
+      a[pivot][j] = t;
+    }
+    for (k = 0; k < m; k++)
+    {
+      double f;
+
+      if (k == i)
+        continue;
+      f = a[k][i] / a[i][i];
+      for (j = i; j <= m; j++)
+        a[k][j] -= f * a[i][j];
+    }
+  }
+  for (i = 0; i < m; i++)
+    coef[i] = a[i][m] / a[i][i];
+  return 1;
+}
+
+static double integrate(const double *coef, int degree, double lo, double hi)
+{
+  double sum = 0.0, plo = lo, phi = hi;
+  int k;
+
+  for (k = 0; k <= degree; k++)
+  {
+    sum += coef[k] * (phi - plo) / (k + 1);
+    plo *= lo;
+    phi *= hi;
+  }
+  return sum;
+}
+
+// BD-rate of the test curve against the reference curve in percent, returns 0 if undefined
+static int bd_rate(const double *ref_kbps, const double *ref_psnr, int ref_n,
+                   const double *test_kbps, const double *test_psnr, int test_n, double *bd)
+{
+  double ref_log[MAX_QPS], test_log[MAX_QPS], ref_coef[4], test_coef[4];
+  double lo, hi;
+  int i, ref_degree, test_degree;
+
+  if (ref_n < 2 || test_n < 2)
+    return 0;
+  ref_degree = ref_n - 1 < 3 ? ref_n - 1 : 3;
+  test_degree = test_n - 1 < 3 ? test_n - 1 : 3;
+
+  lo = ref_psnr[0];
+  hi = ref_psnr[0];
+  for (i = 0; i < ref_n; i++)
+  {
+    if (ref_kbps[i] <= 0)
+      return 0;
+    ref_log[i] = log10(ref_kbps[i]);
+    lo = ref_psnr[i] < lo ? ref_psnr[i] : lo;
+    hi = ref_psnr[i] > hi ? ref_psnr[i] : hi;
+  }
+  {
+    double test_lo = test_psnr[0], test_hi = test_psnr[0];
+
+    for (i = 0; i < test_n; i++)
+    {
+      if (test_kbps[i] <= 0)
+        return 0;
+      test_log[i] = log10(test_kbps[i]);
+      test_lo = test_psnr[i] < test_lo ? test_psnr[i] : test_lo;
+      test_hi = test_psnr[i] > test_hi ? test_psnr[i] : test_hi;
+    }
+    lo = test_lo > lo ? test_lo : lo;
+    hi = test_hi < hi ? test_hi : hi;
+  }
+  if (hi - lo < 1e-6)
+    return 0;
+
+  if (!polyfit(ref_psnr, ref_log, ref_n, ref_degree, ref_coef) ||
+      !polyfit(test_psnr, test_log, test_n, test_degree, test_coef))
+    return 0;
+
+  *bd = (pow(10.0, (integrate(test_coef, test_degree, lo, hi) - integrate(ref_coef, ref_degree, lo, hi)) / (hi - lo)) - 1.0) * 100.0;
+  return 1;
+}
+
+/*
+ * Encoding
+ */
+
+// reads the bit rate and the PSNR of Y, U and V from the lencod report
+static int read_report(const char *log, double *kbps, double *psnr)
+{
+  static const char *psnr_keys[3] = { " Y { PSNR (dB)", " U { PSNR (dB)", " V { PSNR (dB)" };
+  char line[1024];
+  FILE *f = fopen(log, "r");
+  int found = 0, k;
+
+  if (f == NULL)
+    return 0;
+  while (fgets(line, sizeof(line), f))
+  {
+    char *p;
+
+    for (k = 0; k < 3; k++)
+    {
+      if (strncmp(line, psnr_keys[k], strlen(psnr_keys[k])) == 0 && (p = strchr(line, '{')) != NULL
+        && (p = strchr(p + 1, '{')) != NULL)
+      {
+        psnr[k] = atof(p + 1);
+        found |= 1 << k;
+      }
+    }
+    if (strncmp(line, " Bit rate (kbit/s)", 18) == 0 && (p = strchr(line, ':')) != NULL)
+    {
+      *kbps = atof(p + 1);
+      found |= 8;
+    }
+  }
+  fclose(f);
+  return found == 15;
+}
+
+static int encode_pair(const BenchSequence *s, const BenchPreset *pr, const int *qps, int num_qps, int reps, BenchResult *res)
+{
+  char source[MAX_PATH_LEN], run_dir[MAX_PATH_LEN], log[MAX_PATH_LEN], cmd[MAX_CMD_LEN];
+  double total_ms = 0.0;
+  int q, r;
+
+  source_path(source, work_dir, s->width, s->height, s->frames, s->yuv_format);
+  if (!file_exists(source))
+  {
+    printf("  generating %s\n", source);
+    if (make_source(bin_dir, source, s->width, s->height, s->frames, s->yuv_format) != 0)
+      return -1;
+  }
+
+  // lencod writes its statistics files to the current directory
+  snprintf(run_dir, sizeof(run_dir), "%s/encrun", work_dir);
+  mkdir(run_dir, 0755);
+  snprintf(log, sizeof(log), "%s/%s_%s_bench.log", work_dir, s->name, pr->name);
+
+  memset(res, 0, sizeof(BenchResult));
+  snprintf(res->name, sizeof(res->name), "%s/%s", s->name, pr->name);
+  res->num_qps = num_qps;
+
+  for (q = 0; q < num_qps; q++)
+  {
+    double times[MAX_REPS];
+    int qp_b = qps[q] + 2 > 51 ? 51 : qps[q] + 2;
+
+    snprintf(cmd, sizeof(cmd),
+      "exec \"%s/lencod.exe\" -d \"%s/encoder.cfg\" %s %s %s -p QPISlice=%d -p QPPSlice=%d -p QPBSlice=%d "
+      "-p InputFile1=\"%s\" -p SourceWidth=%d -p SourceHeight=%d -p OutputWidth=%d -p OutputHeight=%d "
+      "-p YUVFormat=%d -p FramesToBeEncoded=%d -p OutputFile=out.264 -p ReconFile=out_rec.yuv %s",
+      bin_dir, bin_dir, common_params, s->params, pr->params, qps[q], qps[q], qp_b,
+      source, s->width, s->height, s->width, s->height, s->yuv_format, s->frames, enc_args);
+
+    for (r = 0; r < reps; r++)
+    {
+      long rss = 0;
+
+      if (run_command(run_dir, cmd, log, &times[r], &rss) != 0 || !read_report(log, &res->kbps[q], res->psnr[q]))
+      {
+        fprintf(stderr, "Encoding %s at QP %d failed, see %s\n", res->name, qps[q], log);
+        return -1;
+      }
+      if (rss > res->peak_rss_kb)
+        res->peak_rss_kb = rss;
+    }
+
+    qsort(times, reps, sizeof(double), compare_double);
+    res->qp[q] = qps[q];
+    res->fps[q] = s->frames * 1000.0 / times[reps / 2];
+    total_ms += times[reps / 2];
+  }
+  res->fps_total = s->frames * num_qps * 1000.0 / total_ms;
+  return 0;
+}
+
+/*
+ * Results
+ *
+ * One sequence/preset pair per line, so that baselines can be read back
+ * without a JSON parser.
+ */
+
+static void write_array(FILE *f, const char *key, const double *values, int stride, int n, const char *format)
+{
+  int q;
+
+  fprintf(f, ", \"%s\": [", key);
+  for (q = 0; q < n; q++)
+  {
+    fprintf(f, q ? ", " : "");
+    fprintf(f, format, values[q * stride]);
+  }
+  fprintf(f, "]");
+}
+
+static void write_results(const char *path, BenchResult *res, int num, int reps)
+{
+  FILE *f = fopen(path, "w");
+  double qp[MAX_QPS];
+  int i, q;
+
+  if (f == NULL)
+  {
+    fprintf(stderr, "Cannot create %s\n", path);
+    return;
+  }
+
+  fprintf(f, "{\n  \"reps\": %d,\n  \"reference_preset\": \"%s\",\n  \"results\": [\n", reps, presets[0].name);
+  for (i = 0; i < num; i++)
+  {
+    for (q = 0; q < res[i].num_qps; q++)
+      qp[q] = res[i].qp[q];
+
+    fprintf(f, "    {\"name\": \"%s\", \"fps\": %.3f, \"peak_rss_kb\": %ld", res[i].name, res[i].fps_total, res[i].peak_rss_kb);
+    if (res[i].has_bd_rate_ref)
+      fprintf(f, ", \"bd_rate_vs_ref\": %.3f", res[i].bd_rate_ref);
+    write_array(f, "qp", qp, 1, res[i].num_qps, "%.0f");
+    write_array(f, "fps_qp", res[i].fps, 1, res[i].num_qps, "%.3f");
+    write_array(f, "kbps", res[i].kbps, 1, res[i].num_qps, "%.2f");
+    write_array(f, "psnr_y", &res[i].psnr[0][0], 3, res[i].num_qps, "%.3f");
+    write_array(f, "psnr_u", &res[i].psnr[0][1], 3, res[i].num_qps, "%.3f");
+    write_array(f, "psnr_v", &res[i].psnr[0][2], 3, res[i].num_qps, "%.3f");
+    fprintf(f, "}%s\n", i < num - 1 ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  fclose(f);
+}
+
+// true if the sequence/preset pair is part of this run, -only selects a sequence, a preset or a single pair
+static int pair_selected(const BenchSequence *s, const BenchPreset *pr, int full, const char *only)
+{
+  char pair[128];
+
+  if ((s->full_only || pr->full_only) && !full)
+    return 0;
+  snprintf(pair, sizeof(pair), "%s/%s", s->name, pr->name);
+  return only == NULL || !strcmp(only, s->name) || !strcmp(only, pr->name) || !strcmp(only, pair);
+}
+
+// true if the named pair of a results file is part of this run
+static int name_selected(const char *name, int full, const char *only)
+{
+  char pair[128];
+  int i, k;
+
+  for (i = 0; i < NUM_SEQUENCES; i++)
+  {
+    for (k = 0; k < NUM_PRESETS; k++)
+    {
+      snprintf(pair, sizeof(pair), "%s/%s", sequences[i].name, presets[k].name);
+      if (!strcmp(pair, name))
+        return pair_selected(&sequences[i], &presets[k], full, only);
+    }
+  }
+  return 0;
+}
+
+// compares against a baseline, returns the number of regressions and of selected pairs without a result
+static int compare_baseline(const char *path, BenchResult *res, int num, double threshold, double bd_threshold,
+                            int full, const char *only)
+{
+  char line[4096];
+  FILE *f = fopen(path, "r");
+  int regressions = 0, i, q;
+
+  if (f == NULL)
+  {
+    fprintf(stderr, "Cannot open baseline %s\n", path);
+    return -1;
+  }
+
+  printf("\n Sequence/preset                      base fps    new fps   change   BD-rate\n");
+  while (fgets(line, sizeof(line), f))
+  {
+    char name[128];
+    const char *p = strstr(line, "\"name\": \"");
+    double base_fps, base_kbps[MAX_QPS], base_psnr[MAX_QPS], psnr[MAX_QPS], bd = 0.0;
+    int base_n, has_bd, slower, worse;
+    double change;
+
+    if (p == NULL || read_array(line, "\"fps\": ", &base_fps, 1) != 1 || base_fps <= 0)
+      continue;
+    if (sscanf(p + 9, "%127[^\"]", name) != 1)
+      continue;
+
+    for (i = 0; i < num && strcmp(res[i].name, name) != 0; i++)
+      ;
+    if (i == num)
+    {
+      if (name_selected(name, full, only))
+      {
+        printf(" %-36s %9.2f  %9s                     MISSING\n", name, base_fps, "-");
+        regressions++;
+      }
+      else
+        printf(" %-36s %9.2f  %9s                     not run\n", name, base_fps, "-");
+      continue;
+    }
+
+    base_n = read_array(line, "\"kbps\": [", base_kbps, MAX_QPS);
+    if (read_array(line, "\"psnr_y\": [", base_psnr, MAX_QPS) != base_n)
+      base_n = 0;
+    for (q = 0; q < res[i].num_qps; q++)
+      psnr[q] = res[i].psnr[q][0];
+    has_bd = bd_rate(base_kbps, base_psnr, base_n, res[i].kbps, psnr, res[i].num_qps, &bd);
+
+    change = 100.0 * (res[i].fps_total - base_fps) / base_fps;
+    slower = change < -threshold;
+    worse = has_bd && bd > bd_threshold;
+    if (has_bd)
+      printf(" %-36s %9.2f  %9.2f  %+6.1f%%  %+6.2f%%%s\n", name, base_fps, res[i].fps_total, change, bd,
+        slower || worse ? "  REGRESSION" : "");
+    else
+      printf(" %-36s %9.2f  %9.2f  %+6.1f%%       n/a%s\n", name, base_fps, res[i].fps_total, change,
+        slower ? "  REGRESSION" : "");
+    regressions += slower || worse;
+  }
+  fclose(f);
+  return regressions;
+}
+
+static int parse_qps(const char *list, int *qps)
+{
+  double values[MAX_QPS];
+  int n = read_array(list, "", values, MAX_QPS), q;
+
+  for (q = 0; q < n; q++)
+  {
+    qps[q] = (int) values[q];
+    if (qps[q] < 0 || qps[q] > 51)
+      return 0;
+  }
+  return n;
+}
+
+int main(int argc, char **argv)
+{
+  static BenchResult results[NUM_SEQUENCES * NUM_PRESETS];
+  const char *out_file = NULL, *baseline = NULL, *only = NULL;
+  char default_out[MAX_PATH_LEN];
+  double threshold = 5.0, bd_threshold = 0.5;
+  int qps[MAX_QPS] = { 22, 27, 32, 37 };
+  int full = 0, reps = 1, num_qps = 4, num = 0, failed = 0, ret = 0, i, k, q;
+
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  for (i = 1; i < argc; i++)
+  {
+    if (i + 1 >= argc)
+      usage();
+    if (!strcmp(argv[i], "-bin"))
+      strncpy(bin_dir, argv[++i], MAX_DIR_LEN - 1);
+    else if (!strcmp(argv[i], "-work"))
+      strncpy(work_dir, argv[++i], MAX_DIR_LEN - 1);
+    else if (!strcmp(argv[i], "-set"))
+      full = !strcmp(argv[++i], "full");
+    else if (!strcmp(argv[i], "-reps"))
+      reps = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-qps"))
+      num_qps = parse_qps(argv[++i], qps);
+    else if (!strcmp(argv[i], "-o"))
+      out_file = argv[++i];
+    else if (!strcmp(argv[i], "-baseline"))
+      baseline = argv[++i];
+    else if (!strcmp(argv[i], "-threshold"))
+      threshold = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-bd-threshold"))
+      bd_threshold = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-only"))
+      only = argv[++i];
+    else if (!strcmp(argv[i], "-args"))
+      strncpy(enc_args, argv[++i], MAX_DIR_LEN - 1);
+    else
+      usage();
+  }
+  if (reps < 1 || reps > MAX_REPS)
+  {
+    fprintf(stderr, "-reps must be between 1 and %d\n", MAX_REPS);
+    return -1;
+  }
+  if (num_qps < 1)
+  {
+    fprintf(stderr, "-qps must list 1 to %d QPs between 0 and 51\n", MAX_QPS);
+    return -1;
+  }
+
+  if (work_dir[0] == '\0')
+    default_work_dir(work_dir);
+  make_absolute(bin_dir);
+  make_absolute(work_dir);
+  if (mkdir(work_dir, 0755) != 0 && errno != EEXIST)
+  {
+    fprintf(stderr, "Cannot create %s\n", work_dir);
+    return -1;
+  }
+
+  if (out_file == NULL)
+  {
+    snprintf(default_out, sizeof(default_out), "%s/encresults.json", work_dir);
+    out_file = default_out;
+  }
+
+  printf(" Sequence/preset                           fps  peak RSS(kB)  BD-rate(ref)\n");
+  for (i = 0; i < NUM_SEQUENCES; i++)
+  {
+    const BenchSequence *s = &sequences[i];
+    BenchResult *ref = NULL;
+
+    for (k = 0; k < NUM_PRESETS; k++)
+    {
+      const BenchPreset *pr = &presets[k];
+      BenchResult *res = &results[num];
+
+      if (!pair_selected(s, pr, full, only))
+        continue;
+
+      if (encode_pair(s, pr, qps, num_qps, reps, res) != 0)
+      {
+        printf(" %s/%s  FAILED\n", s->name, pr->name);
+        failed++;
+        continue;
+      }
+
+      if (k == 0)
+        ref = res;
+      else if (ref != NULL)
+      {
+        double ref_psnr[MAX_QPS], psnr[MAX_QPS];
+
+        for (q = 0; q < num_qps; q++)
+        {
+          ref_psnr[q] = ref->psnr[q][0];
+          psnr[q] = res->psnr[q][0];
+        }
+        res->has_bd_rate_ref = bd_rate(ref->kbps, ref_psnr, num_qps, res->kbps, psnr, num_qps, &res->bd_rate_ref);
+      }
+
+      if (res->has_bd_rate_ref)
+        printf(" %-36s %9.2f %13ld %+12.2f%%\n", res->name, res->fps_total, res->peak_rss_kb, res->bd_rate_ref);
+      else
+        printf(" %-36s %9.2f %13ld\n", res->name, res->fps_total, res->peak_rss_kb);
+      for (q = 0; q < num_qps; q++)
+        printf("     QP %2d: %9.2f kbit/s  %6.3f dB  %7.2f fps\n", res->qp[q], res->kbps[q], res->psnr[q][0], res->fps[q]);
+      num++;
+    }
+  }
+
+  write_results(out_file, results, num, reps);
+  printf("\n Results written to %s\n", out_file);
+
+  if (baseline)
+  {
+    int regressions = compare_baseline(baseline, results, num, threshold, bd_threshold, full, only);
+
+    if (regressions > 0)
+      printf("\n %d pair(s) slower, with a higher BD-rate than the baseline or missing\n", regressions);
+    if (regressions != 0)
+      ret = 1;
+  }
+  if (failed)
+  {
+    printf("\n %d pair(s) could not be encoded\n", failed);
+    ret = 1;
+  }
+  return ret;
+}
@@ -0,0 +1,594 @@
+/*
+ * kernbench - microbenchmark for the lcommon kernels shared by both codecs
+ *
+ *   kernbench [-k <name>] [-check] [-time <ms>] [-seed <n>]
+ *
+ * Every kernel is run over a set of randomized blocks, first to check all
+ * registered implementations bit-exactly against the reference (the current
+ * C code in lcommon), then to time them: after a warm-up the number of calls
+ * is doubled until a round takes at least -time milliseconds (default 20) and
+ * the fastest of several rounds is reported as ns and cycles per call and
+ * cycles per pixel.
+ *
+ * -k only runs kernels whose name contains <name>, -check skips the timing.
+ * The exit code is 1 if an implementation does not match the reference.
+ *
+ * New implementations of a kernel (e.g. SIMD versions) are added to its
+ * entry in the kernels[] table below, after the reference.
+ *
+ * The kernels are built against the decoder headers, the cycle counts use
+ * the time stamp counter on x86 and are not available elsewhere.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "global.h"
+#include "transform.h"
+#include "blk_prediction.h"
+#include "mv_prediction.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#define HAVE_TICKS 1
+#define read_ticks() ((unsigned long long) __rdtsc())
+#else
+#define HAVE_TICKS 0
+#define read_ticks() 0ULL
+#endif
+
+#define NUM_SAMPLES   64      // randomized blocks per kernel, cycled through while timing
+#define MAX_IMPLS     8
+#define NUM_ROUNDS    5
+#define MB_SIZE       16
+#define MV_SIZE       8       // 4x4 blocks of the motion field around the current macroblock
+
+typedef void (*KernelFunc)(void);
+
+//! inputs and outputs of one kernel call
+typedef struct
+{
+  int       in[MB_SIZE][MB_SIZE];
+  int       out[MB_SIZE][MB_SIZE];
+  int      *in_rows[MB_SIZE];
+  int      *out_rows[MB_SIZE];
+  int       in4[4];
+  int       out4[4];
+  imgpel    cur[MB_SIZE][MB_SIZE];
+  imgpel    pred[MB_SIZE][MB_SIZE];
+  imgpel   *cur_rows[MB_SIZE];
+  imgpel   *pred_rows[MB_SIZE];
+  int       pos_y;
+  int       pos_x;
+
+  // motion vector prediction
+  Macroblock mb;
+  PixelPos  neighbours[4];
+  char      ref[MV_SIZE][MV_SIZE];
+  char     *ref_rows[MV_SIZE];
+  short     mv[MV_SIZE][MV_SIZE][2];
+  short    *mv_cols[MV_SIZE][MV_SIZE];
+  short   **mv_rows[MV_SIZE];
+  short     ref_frame;
+  short     pmv[2];
+  int       mb_x;
+  int       mb_y;
+  int       shape_x;
+  int       shape_y;
+} Sample;
+
+typedef struct
+{
+  const char *name;
+  KernelFunc  fn;
+} KernelImpl;
+
+typedef struct
+{
+  const char *name;
+  int         pixels;                                  //!< pixels per call, 0 if not pixel based
+  void      (*prepare)(Sample *s);                     //!< randomizes the inputs
+  void      (*call)(KernelFunc fn, Sample *s);         //!< calls one implementation
+  KernelImpl  impls[MAX_IMPLS];                        //!< impls[0] is the reference
+} Kernel;
+
+static unsigned int rnd_state = 1;
+static VideoParameters *mv_vid;
+
+static int rnd(int lo, int hi)
+{
+  rnd_state = rnd_state * 1103515245u + 12345u;
+  return lo + (int) ((rnd_state >> 8) % (unsigned int) (hi - lo + 1));
+}
+
+static double now_ns()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * Alternative implementations
+ */
+
+//! forward 4x4 transform as a matrix product, C * X * C^T
+static void forward4x4_matrix(int **block, int **tblock, int pos_y, int pos_x)
+{
+  static const int c[4][4] = { { 1, 1, 1, 1 }, { 2, 1, -1, -2 }, { 1, -1, -1, 1 }, { 1, -2, 2, -1 } };
+  int tmp[4][4];
+  int i, j, k;
+
+  for (i = 0; i < 4; i++)
+  {
+    for (j = 0; j < 4; j++)
+    {
+      tmp[i][j] = 0;
+      for (k = 0; k < 4; k++)
+        tmp[i][j] += block[pos_y + i][pos_x + k] * c[j][k];
+    }
+  }
+  for (i = 0; i < 4; i++)
+  {
+    for (j = 0; j < 4; j++)
+    {
+      int sum = 0;
+      for (k = 0; k < 4; k++)
+        sum += c[i][k] * tmp[k][j];
+      tblock[pos_y + i][pos_x + j] = sum;
+    }
+  }
+}
+
+//! 2x2 Hadamard transforms with 12 additions (the former transform.c versions)
+static void hadamard2x2_direct(int **block, int tblock[4])
+{
+  tblock[0] = (block[0][0] + block[0][4] + block[4][0] + block[4][4]);
+  tblock[1] = (block[0][0] - block[0][4] + block[4][0] - block[4][4]);
+  tblock[2] = (block[0][0] + block[0][4] - block[4][0] - block[4][4]);
+  tblock[3] = (block[0][0] - block[0][4] - block[4][0] + block[4][4]);
+}
+
+static void ihadamard2x2_direct(int tblock[4], int block[4])
+{
+  block[0] = (tblock[0] + tblock[1] + tblock[2] + tblock[3]);
+  block[1] = (tblock[0] - tblock[1] + tblock[2] - tblock[3]);
+  block[2] = (tblock[0] + tblock[1] - tblock[2] - tblock[3]);
+  block[3] = (tblock[0] - tblock[1] - tblock[2] + tblock[3]);
+}
+
+//! inverse transforms with reconstruction as itrans4x4()/itrans8x8() do them block by block
+static void inverse_recon_blocks(int size, int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride,
+                                 int width, int height, int max_imgpel_value)
+{
+  int *t_rows[MB_SIZE], *r_rows[MB_SIZE];
+  imgpel *p_rows[MB_SIZE], *c_rows[MB_SIZE];
+  int x, y, j;
+
+  for (j = 0; j < height; j++)
+  {
+    t_rows[j] = tblock + j * coef_stride;
+    r_rows[j] = rres + j * coef_stride;
+    p_rows[j] = pred + j * pel_stride;
+    c_rows[j] = rec + j * pel_stride;
+  }
+  for (y = 0; y < height; y += size)
+  {
+    for (x = 0; x < width; x += size)
+    {
+      if (size == 4)
+        inverse4x4(t_rows, r_rows, y, x);
+      else
+        inverse8x8(t_rows, r_rows, y, x);
+      sample_reconstruct(&c_rows[y], &p_rows[y], &r_rows[y], x, x, size, size, max_imgpel_value, DQ_BITS);
+    }
+  }
+}
+
+static void itrans4x4_blocks(int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride,
+                             int width, int height, int max_imgpel_value)
+{
+  inverse_recon_blocks(4, tblock, rres, coef_stride, pred, rec, pel_stride, width, height, max_imgpel_value);
+}
+
+static void itrans8x8_blocks(int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride,
+                             int width, int height, int max_imgpel_value)
+{
+  inverse_recon_blocks(8, tblock, rres, coef_stride, pred, rec, pel_stride, width, height, max_imgpel_value);
+}
+
+/*
+ * Input generation
+ */
+
+static void fill_ints(Sample *s, int lo, int hi)
+{
+  int i, j;
+
+  for (j = 0; j < MB_SIZE; j++)
+    for (i = 0; i < MB_SIZE; i++)
+      s->in[j][i] = rnd(lo, hi);
+  for (i = 0; i < 4; i++)
+    s->in4[i] = rnd(lo, hi);
+}
+
+static void prepare_residual(Sample *s)
+{
+  fill_ints(s, -255, 255);
+  s->pos_y = rnd(0, 3) * 4;
+  s->pos_x = rnd(0, 3) * 4;
+}
+
+static void prepare_coeffs(Sample *s)
+{
+  fill_ints(s, -2048, 2047);
+  s->pos_y = rnd(0, 3) * 4;
+  s->pos_x = rnd(0, 3) * 4;
+}
+
+static void prepare_residual8x8(Sample *s)
+{
+  prepare_residual(s);
+  s->pos_y &= 8;
+  s->pos_x &= 8;
+}
+
+static void prepare_coeffs8x8(Sample *s)
+{
+  prepare_coeffs(s);
+  s->pos_y &= 8;
+  s->pos_x &= 8;
+}
+
+static void prepare_pixels(Sample *s)
+{
+  int i, j;
+
+  fill_ints(s, -(1 << 12), 1 << 12);
+  for (j = 0; j < MB_SIZE; j++)
+  {
+    for (i = 0; i < MB_SIZE; i++)
+    {
+      s->cur[j][i] = (imgpel) rnd(0, 255);
+      s->pred[j][i] = (imgpel) rnd(0, 255);
+    }
+  }
+}
+
+static void prepare_mvpred(Sample *s, int mbaff)
+{
+  static const int shapes[5][2] = { { 16, 16 }, { 16, 8 }, { 8, 16 }, { 8, 8 }, { 4, 4 } };
+  int i, j, k = rnd(0, 4);
+
+  for (j = 0; j < MV_SIZE; j++)
+  {
+    for (i = 0; i < MV_SIZE; i++)
+    {
+      s->ref[j][i] = (char) rnd(-1, 2);
+      s->mv[j][i][0] = (short) rnd(-512, 511);
+      s->mv[j][i][1] = (short) rnd(-512, 511);
+    }
+  }
+  for (i = 0; i < 4; i++)
+  {
+    s->neighbours[i].available = rnd(0, 3) != 0;
+    s->neighbours[i].mb_addr = rnd(0, 3);
+    s->neighbours[i].pos_x = (short) rnd(0, MV_SIZE - 1);
+    s->neighbours[i].pos_y = (short) rnd(0, MV_SIZE - 1);
+  }
+  s->ref_frame = (short) rnd(0, 1);
+  s->shape_x = shapes[k][0];
+  s->shape_y = shapes[k][1];
+  s->mb_x = rnd(0, (16 - s->shape_x) / 4) * 4;
+  s->mb_y = rnd(0, (16 - s->shape_y) / 4) * 4;
+
+  s->mb.p_Vid = mv_vid;
+  s->mb.mb_field = mbaff ? rnd(0, 1) : 0;
+  init_motion_vector_prediction(&s->mb, mbaff);
+}
+
+static void prepare_mvpred_normal(Sample *s)
+{
+  prepare_mvpred(s, 0);
+}
+
+static void prepare_mvpred_mbaff(Sample *s)
+{
+  prepare_mvpred(s, 1);
+}
+
+/*
+ * Calls
+ */
+
+typedef void (*BlockTransformFunc)(int **src, int **dst, int pos_y, int pos_x);
+typedef void (*HadamardFunc)(int **src, int **dst);
+typedef void (*Hadamard2x2Func)(int **src, int dst[4]);
+typedef void (*IHadamard2x2Func)(int src[4], int dst[4]);
+typedef void (*ResidueFunc)(imgpel **cur, imgpel **pred, int **rres, int mb_x, int opix_x, int width, int height);
+typedef void (*InverseReconFunc)(int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride, int width, int height, int max_value);
+typedef void (*ReconstructFunc)(imgpel **cur, imgpel **pred, int **rres, int mb_x, int opix_x, int width, int height, int max_value, int dq_bits);
+
+static void call_block_transform(KernelFunc fn, Sample *s)
+{
+  ((BlockTransformFunc) fn)(s->in_rows, s->out_rows, s->pos_y, s->pos_x);
+}
+
+static void call_hadamard(KernelFunc fn, Sample *s)
+{
+  ((HadamardFunc) fn)(s->in_rows, s->out_rows);
+}
+
+static void call_hadamard2x2(KernelFunc fn, Sample *s)
+{
+  ((Hadamard2x2Func) fn)(s->in_rows, s->out4);
+}
+
+static void call_ihadamard2x2(KernelFunc fn, Sample *s)
+{
+  ((IHadamard2x2Func) fn)(s->in4, s->out4);
+}
+
+static void call_compute_residue(KernelFunc fn, Sample *s)
+{
+  ((ResidueFunc) fn)(s->cur_rows, s->pred_rows, s->out_rows, 0, 0, MB_SIZE, MB_SIZE);
+}
+
+static void call_sample_reconstruct(KernelFunc fn, Sample *s)
+{
+  ((ReconstructFunc) fn)(s->cur_rows, s->pred_rows, s->in_rows, 0, 0, MB_SIZE, MB_SIZE, 255, DQ_BITS);
+}
+
+static void call_inverse_recon(KernelFunc fn, Sample *s)
+{
+  ((InverseReconFunc) fn)(&s->in[0][0], &s->out[0][0], MB_SIZE, &s->pred[0][0], &s->cur[0][0], MB_SIZE, MB_SIZE, MB_SIZE, 255);
+}
+
+static void call_mvpred(KernelFunc fn, Sample *s)
+{
+  (void) fn;
+  s->mb.GetMVPredictor(&s->mb, s->neighbours, s->pmv, s->ref_frame, s->ref_rows, s->mv_rows,
+    s->mb_x, s->mb_y, s->shape_x, s->shape_y);
+}
+
+#define IMPL(fn) { #fn, (KernelFunc) fn }
+
+// the motion vector predictors are static, they are selected by init_motion_vector_prediction()
+static Kernel kernels[] =
+{
+  { "forward4x4",         16, prepare_residual,     call_block_transform,
+    { IMPL(forward4x4), IMPL(forward4x4_matrix) } },
+  { "inverse4x4",         16, prepare_coeffs,       call_block_transform,
+    { IMPL(inverse4x4) } },
+  { "forward8x8",         64, prepare_residual8x8,  call_block_transform,
+    { IMPL(forward8x8) } },
+  { "inverse8x8",         64, prepare_coeffs8x8,    call_block_transform,
+    { IMPL(inverse8x8) } },
+  { "hadamard4x4",        16, prepare_coeffs,       call_hadamard,
+    { IMPL(hadamard4x4) } },
+  { "ihadamard4x4",       16, prepare_coeffs,       call_hadamard,
+    { IMPL(ihadamard4x4) } },
+  { "hadamard4x2",         8, prepare_coeffs,       call_hadamard,
+    { IMPL(hadamard4x2) } },
+  { "ihadamard4x2",        8, prepare_coeffs,       call_hadamard,
+    { IMPL(ihadamard4x2) } },
+  { "hadamard2x2",         4, prepare_coeffs,       call_hadamard2x2,
+    { IMPL(hadamard2x2), IMPL(hadamard2x2_direct) } },
+  { "ihadamard2x2",        4, prepare_coeffs,       call_ihadamard2x2,
+    { IMPL(ihadamard2x2), IMPL(ihadamard2x2_direct) } },
+  { "compute_residue",   256, prepare_pixels,       call_compute_residue,
+    { IMPL(compute_residue) } },
+  { "sample_reconstruct",256, prepare_pixels,       call_sample_reconstruct,
+    { IMPL(sample_reconstruct) } },
+  { "inverse4x4_recon",  256, prepare_pixels,       call_inverse_recon,
+    { IMPL(itrans4x4_blocks), IMPL(inverse4x4_recon) } },
+  { "inverse8x8_recon",  256, prepare_pixels,       call_inverse_recon,
+    { IMPL(itrans8x8_blocks), IMPL(inverse8x8_recon) } },
+  { "mvpred_normal",       0, prepare_mvpred_normal, call_mvpred,
+    { { "GetMotionVectorPredictorNormal", NULL } } },
+  { "mvpred_mbaff",        0, prepare_mvpred_mbaff, call_mvpred,
+    { { "GetMotionVectorPredictorMBAFF", NULL } } },
+};
+
+#define NUM_KERNELS ((int) (sizeof(kernels) / sizeof(kernels[0])))
+
+/*
+ * Harness
+ */
+
+//! row tables of a sample, needed again after copying it
+static void set_rows(Sample *s)
+{
+  int i, j;
+
+  for (j = 0; j < MB_SIZE; j++)
+  {
+    s->in_rows[j] = s->in[j];
+    s->out_rows[j] = s->out[j];
+    s->cur_rows[j] = s->cur[j];
+    s->pred_rows[j] = s->pred[j];
+  }
+  for (j = 0; j < MV_SIZE; j++)
+  {
+    s->ref_rows[j] = s->ref[j];
+    for (i = 0; i < MV_SIZE; i++)
+      s->mv_cols[j][i] = s->mv[j][i];
+    s->mv_rows[j] = s->mv_cols[j];
+  }
+}
+
+//! fresh copy of the inputs, also restores them for kernels working in place
+static void copy_samples(Sample *dst, const Sample *src)
+{
+  int k;
+
+  memcpy(dst, src, NUM_SAMPLES * sizeof(Sample));
+  for (k = 0; k < NUM_SAMPLES; k++)
+    set_rows(&dst[k]);
+}
+
+static int same_outputs(const Sample *a, const Sample *b)
+{
+  return memcmp(a->out, b->out, sizeof(a->out)) == 0 && memcmp(a->out4, b->out4, sizeof(a->out4)) == 0 &&
+    memcmp(a->cur, b->cur, sizeof(a->cur)) == 0 && memcmp(a->pmv, b->pmv, sizeof(a->pmv)) == 0;
+}
+
+static int check_kernel(Kernel *kern, Sample *input, Sample *ref, Sample *test)
+{
+  int m, k, errors = 0;
+
+  copy_samples(ref, input);
+  for (k = 0; k < NUM_SAMPLES; k++)
+    kern->call(kern->impls[0].fn, &ref[k]);
+
+  for (m = 1; m < MAX_IMPLS && kern->impls[m].name; m++)
+  {
+    copy_samples(test, input);
+    for (k = 0; k < NUM_SAMPLES; k++)
+    {
+      kern->call(kern->impls[m].fn, &test[k]);
+      if (!same_outputs(&ref[k], &test[k]))
+      {
+        printf(" %-20s %-32s MISMATCH in sample %d\n", kern->name, kern->impls[m].name, k);
+        errors++;
+        break;
+      }
+    }
+  }
+  return errors;
+}
+
+//! fastest round of calls, in ns and ticks per call
+static void time_impl(Kernel *kern, KernelFunc fn, Sample *samples, double min_ms, double *ns, double *ticks)
+{
+  long calls = NUM_SAMPLES, c;
+  int r;
+
+  // warm-up and calibration
+  for (;;)
+  {
+    double start = now_ns();
+
+    for (c = 0; c < calls; c++)
+      kern->call(fn, &samples[c % NUM_SAMPLES]);
+    if (now_ns() - start >= min_ms * 1e6 || calls >= (1L << 30))
+      break;
+    calls *= 2;
+  }
+
+  *ns = -1.0;
+  for (r = 0; r < NUM_ROUNDS; r++)
+  {
+    unsigned long long t0 = read_ticks();
+    double start = now_ns(), elapsed;
+
+    for (c = 0; c < calls; c++)
+      kern->call(fn, &samples[c % NUM_SAMPLES]);
+    elapsed = now_ns() - start;
+    if (*ns < 0 || elapsed / calls < *ns)
+    {
+      *ns = elapsed / calls;
+      *ticks = (double) (read_ticks() - t0) / calls;
+    }
+  }
+}
+
+static void usage()
+{
+  printf("Usage: kernbench [-k <name>] [-check] [-time <ms>] [-seed <n>]\n");
+  exit(-1);
+}
+
+int main(int argc, char **argv)
+{
+  Sample *input, *ref, *test;
+  const char *filter = NULL;
+  double min_ms = 20.0;
+  int check_only = 0, errors = 0, i, k, m;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "-check"))
+      check_only = 1;
+    else if (i + 1 >= argc)
+      usage();
+    else if (!strcmp(argv[i], "-k"))
+      filter = argv[++i];
+    else if (!strcmp(argv[i], "-time"))
+      min_ms = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-seed"))
+      rnd_state = (unsigned int) atoi(argv[++i]);
+    else
+      usage();
+  }
+
+  input = (Sample *) calloc(NUM_SAMPLES, sizeof(Sample));
+  ref = (Sample *) calloc(NUM_SAMPLES, sizeof(Sample));
+  test = (Sample *) calloc(NUM_SAMPLES, sizeof(Sample));
+  mv_vid = (VideoParameters *) calloc(1, sizeof(VideoParameters));
+  if (input == NULL || ref == NULL || test == NULL || mv_vid == NULL ||
+    (mv_vid->mb_data = (Macroblock *) calloc(4, sizeof(Macroblock))) == NULL)
+  {
+    fprintf(stderr, "Out of memory\n");
+    return -1;
+  }
+  for (k = 0; k < 4; k++)
+    mv_vid->mb_data[k].mb_field = k & 1;
+
+  if (!check_only)
+    printf(" Kernel               Implementation                    ns/call  cycles/call  cycles/pixel  speedup\n");
+  for (i = 0; i < NUM_KERNELS; i++)
+  {
+    Kernel *kern = &kernels[i];
+    double ref_ns = 0.0;
+
+    if (filter && strstr(kern->name, filter) == NULL)
+      continue;
+
+    for (k = 0; k < NUM_SAMPLES; k++)
+    {
+      memset(&input[k], 0, sizeof(Sample));
+      set_rows(&input[k]);
+      kern->prepare(&input[k]);
+    }
+    errors += check_kernel(kern, input, ref, test);
+    if (check_only)
+      continue;
+
+    for (m = 0; m < MAX_IMPLS && kern->impls[m].name; m++)
+    {
+      double ns, ticks = 0.0;
+
+      copy_samples(test, input);
+      time_impl(kern, kern->impls[m].fn, test, min_ms, &ns, &ticks);
+      if (m == 0)
+        ref_ns = ns;
+
+      printf(" %-20s %-32s %8.2f", kern->name, kern->impls[m].name, ns);
+      if (HAVE_TICKS)
+        printf("  %11.1f", ticks);
+      else
+        printf("  %11s", "-");
+      if (HAVE_TICKS && kern->pixels > 0)
+        printf("  %12.3f", ticks / kern->pixels);
+      else
+        printf("  %12s", "-");
+      printf("  %6.2fx\n", ref_ns / ns);
+    }
+  }
+
+  if (errors)
+    printf("\n %d implementation(s) do not match the reference\n", errors);
+  else
+    printf("\n All implementations match the reference\n");
+
+  free(mv_vid->mb_data);
+  free(mv_vid);
+  free(input);
+  free(ref);
+  free(test);
+  return errors ? 1 : 0;
+}
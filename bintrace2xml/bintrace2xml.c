@@ -0,0 +1,175 @@
+/*
+ * bintrace2xml - converts a binary AVCTrace (ldecod -xmltrace <file>.jmbt)
+ * into the XML trace the decoder would have written.
+ *
+ *   bintrace2xml <trace>.jmbt <trace>.xml [-range first[:last]]
+ *   bintrace2xml -list <trace>.jmbt
+ *
+ * -range only converts the given pictures in decoding order (see -list),
+ * using the index of the binary trace to seek to them directly.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xmltracefile.h"
+#include "bintrace.h"
+
+static void usage()
+{
+	printf("Usage: bintrace2xml <trace>.jmbt <trace>.xml [-range first[:last]]\n");
+	printf("       bintrace2xml -list <trace>.jmbt\n");
+	exit(-1);
+}
+
+//Replays one record through the XML writer, returns 0 on success
+static int convert_record(BinTraceRecord* rec)
+{
+	switch(rec->type)
+	{
+		case BT_NAME:
+			break;
+		case BT_START:
+			xml_write_start_element(rec->name);
+			break;
+		case BT_END:
+			xml_write_end_element();
+			break;
+		case BT_ATTR_STR:
+			xml_write_string_attribute(rec->name, rec->text);
+			break;
+		case BT_ATTR_INT:
+			xml_write_int_attribute(rec->name, rec->value);
+			break;
+		case BT_TEXT:
+			xml_write_text(rec->text);
+			break;
+		case BT_INT:
+			xml_write_int(rec->value);
+			break;
+		case BT_INT_ELEM:
+			xml_write_int_element(rec->name, rec->value);
+			break;
+		case BT_INT_LIST:
+			if(rec->count > 0)
+				xml_write_int_list_element(rec->name, rec->values, rec->count);
+			break;
+		case BT_COMMENT:
+			xml_write_comment(rec->text);
+			break;
+		case BT_FRAME_ORDER:
+			xml_output_frame_order(rec->value);
+			break;
+		default:
+			return -1;
+	}
+	return 0;
+}
+
+static int convert_all(BinTraceReader* reader)
+{
+	BinTraceRecord rec;
+	int ret;
+
+	while((ret = bintrace_next(reader, &rec)) == 1)
+	{
+		if(convert_record(&rec) != 0) return -1;
+	}
+	return ret < 0 ? -1 : 0;
+}
+
+//Prints entry, file offset and frame id of the indexed pictures
+static void list_index(BinTraceReader* reader)
+{
+	int i;
+
+	for(i = 0; i < bintrace_num_index(reader); i++)
+		printf("%6d %12lld %6d\n", i, bintrace_index_offset(reader, i), bintrace_index_frame(reader, i));
+}
+
+int main(int argc, char** argv)
+{
+	BinTraceReader* reader;
+	BinTraceRecord rec;
+	int first = -1, last = -1;
+	int ret = 0;
+
+	if(argc == 3 && strcmp(argv[1], "-list") == 0)
+	{
+		if((reader = bintrace_open(argv[2])) == NULL)
+		{
+			fprintf(stderr, "Cannot read binary trace '%s'\n", argv[2]);
+			return -1;
+		}
+		list_index(reader);
+		bintrace_close(reader);
+		return 0;
+	}
+
+	if(argc != 3 && argc != 5) usage();
+	if(argc == 5)
+	{
+		if(strcmp(argv[3], "-range") != 0) usage();
+		if(sscanf(argv[4], "%d:%d", &first, &last) < 1) usage();
+		if(last < first) last = first;
+	}
+
+	if((reader = bintrace_open(argv[1])) == NULL)
+	{
+		fprintf(stderr, "Cannot read binary trace '%s'\n", argv[1]);
+		return -1;
+	}
+	if(first >= 0 && (first >= bintrace_num_index(reader) || last >= bintrace_num_index(reader)))
+	{
+		fprintf(stderr, "Range %d:%d is outside the index (%d entries)\n", first, last, bintrace_num_index(reader));
+		bintrace_close(reader);
+		return -1;
+	}
+
+	xml_set_trace_filename(argv[2]);
+	if(strcmp(xml_get_trace_filename(), argv[2]) != 0 || xml_open_trace_file() != 0)
+	{
+		fprintf(stderr, "Cannot create XML trace '%s'\n", argv[2]);
+		bintrace_close(reader);
+		return -1;
+	}
+
+	if(first < 0)
+	{
+		ret = convert_all(reader);
+	}
+	else
+	{
+		long long end = -1;
+		int depth = 0;
+
+		//Root element with its attributes
+		while(bintrace_next(reader, &rec) == 1 && rec.type != BT_START);
+		if(rec.type == BT_START)
+		{
+			convert_record(&rec);
+			depth = 1;
+		}
+		while(bintrace_next(reader, &rec) == 1 && (rec.type == BT_ATTR_STR || rec.type == BT_ATTR_INT || rec.type == BT_NAME))
+			convert_record(&rec);
+
+		//Pictures first..last, up to the next entry or the end of the root element
+		if(last + 1 < bintrace_num_index(reader)) end = bintrace_index_offset(reader, last + 1);
+		bintrace_seek_index(reader, first);
+		while(ret == 0 && bintrace_next(reader, &rec) == 1 && (end < 0 || rec.offset < end))
+		{
+			if(rec.type == BT_END && depth == 1) break;
+			ret = convert_record(&rec);
+			if(rec.type == BT_START) depth++;
+			if(rec.type == BT_END) depth--;
+		}
+		while(depth-- > 0) xml_write_end_element();
+	}
+
+	if(ret != 0) fprintf(stderr, "Binary trace '%s' is corrupt\n", argv[1]);
+
+	xml_close_trace_file();
+	bintrace_close(reader);
+	return ret;
+}
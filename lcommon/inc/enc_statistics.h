@@ -49,6 +49,8 @@ struct stat_parameters
   int64  bit_use_delta_quant [NUM_SLICE_TYPES];
   int64  bit_use_stuffingBits[NUM_SLICE_TYPES];
 
+  int64  cs_bytes_copied;             //!< bytes copied to store and restore the coding state during mode decision
+
   int    bit_ctr_parametersets;
   int    bit_ctr_parametersets_n;
   int64  bit_ctr_filler_data;
@@ -12,6 +12,8 @@
 #ifndef _FRAME_H_
 #define _FRAME_H_
 
+#include "typedefs.h"
+
 typedef enum {
   CM_UNKNOWN = -1,
   CM_YUV     =  0,
@@ -53,4 +55,14 @@ typedef struct frame_format
   int         pic_unit_size_shift3;          //!< pic_unit_size_on_disk >> 3
 } FrameFormat;
 
+//! picture plane in one aligned block with an aligned row stride
+typedef struct pic_plane
+{
+  imgpel     *base;                          //!< aligned start of the allocation (first row)
+  imgpel    **img;                           //!< row table, img[0][0] is the top left sample
+  int         width;                         //!< visible width in samples
+  int         height;                        //!< visible height in samples
+  int         stride;                        //!< distance between two rows in samples
+} PicPlane;
+
 #endif
@@ -15,6 +15,16 @@
 #ifndef _IO_RAW_H_
 #define _IO_RAW_H_
 
+//! reading of concatenated raw input files (InputPrefetch)
+typedef enum
+{
+  PREFETCH_OFF    = 0,   //!< synchronous reads
+  PREFETCH_THREAD = 1,   //!< reader thread with a ring of frame buffers
+  PREFETCH_MMAP   = 2    //!< copies from a memory mapped file
+} PrefetchMode;
+
+extern void OpenFramePrefetch      (InputParameters *p_Inp, VideoDataFile *input_file, int HeaderSize, FrameFormat *source, int frame_step, int num_frames, int mode);
+extern void CloseFramePrefetch     (VideoDataFile *input_file);
 extern int ReadFrameConcatenated  (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, int HeaderSize, FrameFormat *source, unsigned char *buf);
 extern int ReadFrameSeparate      (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, int HeaderSize, FrameFormat *source, unsigned char *buf);
 
@@ -28,9 +28,13 @@ typedef enum {
   VIDEO_RGB     =  1,
   VIDEO_XYZ     =  2,
   VIDEO_TIFF    =  3,
-  VIDEO_AVI     =  4
+  VIDEO_AVI     =  4,
+  VIDEO_Y4M     =  5
 } VideoFileType;
 
+typedef struct frame_prefetch FramePrefetch;
+typedef struct y4m_cache      Y4MCache;
+
 typedef struct video_data_file
 {
   //char*         fname;          //!< video file name
@@ -52,6 +56,15 @@ typedef struct video_data_file
   int           crop_x_offset;         //!< crop offset (x component);
   int           crop_y_offset;         //!< crop offset (y component);
 
+  FramePrefetch *prefetch;              //!< prefetcher of concatenated raw input (NULL: synchronous reads)
+
+  // Y4M related information
+  int           is_pipe;               //!< Y4M stream read from stdin ("-")
+  int           y4m_header;            //!< length of the Y4M stream header
+  int           y4m_frame_header;      //!< length of the Y4M frame headers (files only)
+  int           pipe_frame;            //!< number of frames read from the pipe
+  Y4MCache     *y4m_cache;             //!< frames read ahead from the pipe
+
   // AVI related information to be added here
   int* avi;
   //avi_t* avi;
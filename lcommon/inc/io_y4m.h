@@ -0,0 +1,22 @@
+/*!
+ ************************************************************************
+ * \file io_y4m.h
+ *
+ * \brief
+ *    I/O functions related to YUV4MPEG2 (Y4M) streams
+ *
+ ************************************************************************
+ */
+
+#ifndef _IO_Y4M_H_
+#define _IO_Y4M_H_
+
+extern int  ParseY4MHeader      (VideoDataFile *input_file, FrameFormat *format);
+extern int  ReadFrameY4M        (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, FrameFormat *source, unsigned char *buf);
+extern void FreeY4MCache        (VideoDataFile *input_file);
+
+extern int  OpenOutputFile      (char *fname);
+extern void CloseOutputFile     (int p_out);
+extern void WriteY4MFrameHeader (int p_out, FrameFormat *format);
+
+#endif
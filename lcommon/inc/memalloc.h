@@ -30,6 +30,14 @@
 # endif
 #endif
 
+#define MEM_ALIGNMENT  64   //!< alignment of aligned allocations and plane rows (one cache line)
+
+extern void *mem_calloc_aligned(size_t size);
+extern void  mem_free_aligned  (void *ptr);
+
+extern int  get_plane (PicPlane *plane, int height, int width);
+extern void free_plane(PicPlane *plane);
+
 extern int  get_mem2Ddist(DistortionData ***array2D, int dim0, int dim1);
 
 extern int  get_mem2Dlm  (LambdaParams ***array2D, int dim0, int dim1);
@@ -82,6 +90,8 @@ extern int  get_mem2Dpel(imgpel ***array2D, int rows, int columns);
 extern int  get_mem3Dpel(imgpel ****array3D, int frames, int rows, int columns);
 extern int  get_mem4Dpel(imgpel *****array4D, int sub_x, int sub_y, int rows, int columns);
 extern int  get_mem5Dpel(imgpel ******array5D, int dims, int sub_x, int sub_y, int rows, int columns);
+extern int  get_mem3Dpel_aligned(imgpel ****array3D, int frames, int rows, int columns);
+extern int  get_mem3Dint_aligned(int    ****array3D, int frames, int rows, int columns);
 
 extern int  get_mem2Ddouble (double ***array2D, int rows, int columns);
 extern int  get_mem2Dodouble(double ***array2D, int rows, int columns, int offset);
@@ -145,6 +155,8 @@ extern void free_mem2Dpel  (imgpel    **array2D);
 extern void free_mem3Dpel  (imgpel   ***array3D);
 extern void free_mem4Dpel  (imgpel  ****array4D);
 extern void free_mem5Dpel  (imgpel *****array5D);
+extern void free_mem3Dpel_aligned(imgpel ***array3D);
+extern void free_mem3Dint_aligned(int    ***array3D);
 extern void free_mem2Ddouble(double **array2D);
 extern void free_mem3Ddouble(double ***array3D);
 
@@ -61,6 +61,7 @@ struct inp_par_enc
   int UseConstrainedIntraPred;          //!< 0: Inter MB pixels are allowed for intra prediction 1: Not allowed
   int  SetFirstAsLongTerm;              //!< Support for temporal considerations for CB plus encoding
   int  infile_header;                   //!< If input file has a header set this to the length of the header
+  int  input_prefetch;                  //!< Reading of concatenated raw input (0: synchronous, 1: reader thread, 2: memory mapped)
   int  MultiSourceData;
   VideoDataFile   input_file2;          //!< Input video file2
   VideoDataFile   input_file3;          //!< Input video file3
@@ -122,6 +123,7 @@ struct inp_par_enc
   int WeightedBiprediction;             //!< Weighted prediction for B frames (0: not used, 1: explicit, 2: implicit)
   int WPMethod;                         //!< WP method (0: DC, 1: LMS)
   int WPIterMC;                         //!< Iterative WP method
+  int WPThreads;                        //!< Number of threads computing the iterative WP offsets
   int WPMCPrecision;
   int WPMCPrecFullRef;
   int WPMCPrecBSlice;
@@ -178,9 +180,12 @@ struct inp_par_enc
   int rdopt;
   int I16rdo; 
   int subMBCodingState;
+  int CABACRateEstimation;
   int Distortion[TOTAL_DIST_TYPES];
   double VisualResWavPSNR;
   int SSIMOverlapSize;
+  int SSIMThreads;                      //!< Number of threads computing the SSIM and MS-SSIM windows
+  int DistortionThread;                 //!< Compute the frame distortion metrics on a background thread
   int DistortionYUVtoRGB;
   int CtxAdptLagrangeMult;    //!< context adaptive lagrangian multiplier
   int FastCrIntraDecision;
@@ -248,6 +253,7 @@ struct inp_par_enc
   int model_number;
   int Transform8x8Mode;
   int ReportFrameStats;
+  char ProfileFile[FILE_NAME_SIZE];      //!< JSON summary of the per-module profile (encoder built with ENC_PROFILE=1)
   int DisplayEncParams;
   int Verbose;
 
@@ -29,4 +29,9 @@ extern void ihadamard4x2 (int **tblock, int **block);
 extern void hadamard2x2  (int **block , int tblock[4]);
 extern void ihadamard2x2 (int block[4], int tblock[4]);
 
+extern void inverse4x4_recon(int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride,
+                             int width, int height, int max_imgpel_value);
+extern void inverse8x8_recon(int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride,
+                             int width, int height, int max_imgpel_value);
+
 #endif //_TRANSFORM_H_
@@ -252,7 +252,11 @@ void OpenFrameFile( VideoDataFile *input_file, int FrameNumberInFile)
  */
 void OpenFiles( VideoDataFile *input_file)
 {
-  if (input_file->is_concatenated == 1)
+  if (input_file->is_pipe)
+  {
+    input_file->f_num = fileno(stdin);
+  }
+  else if (input_file->is_concatenated == 1)
   {
     if (strlen(input_file->fname) == 0)
     {
@@ -276,7 +280,8 @@ void OpenFiles( VideoDataFile *input_file)
  */
 void CloseFiles(VideoDataFile *input_file)
 {
-  if (input_file->f_num != -1)
+  FreeY4MCache(input_file);
+  if (input_file->f_num != -1 && !input_file->is_pipe)
     close(input_file->f_num);
   input_file->f_num = -1;
 }
@@ -291,7 +296,15 @@ VideoFileType ParseVideoType (VideoDataFile *input_file)
 {
   char *format;
 
-  format = input_file->fname + strlen(input_file->fname) - 3;
+  if (strcmp (input_file->fname, "-") == 0)
+  {
+    input_file->vdtype = VIDEO_Y4M;
+    input_file->is_pipe = 1;
+    input_file->avi = NULL;
+    return input_file->vdtype;
+  }
+
+  format = input_file->fname + imax(0, (int) strlen(input_file->fname) - 3);
 
   if (strcasecmp (format, "yuv") == 0)
   {
@@ -305,6 +318,11 @@ VideoFileType ParseVideoType (VideoDataFile *input_file)
     input_file->format.yuv_format = YUV444;
     input_file->avi = NULL;
   }
+  else if (strcasecmp (format, "y4m") == 0)
+  {
+    input_file->vdtype = VIDEO_Y4M;
+    input_file->avi = NULL;
+  }
   else if (strcasecmp (format, "tif") == 0)
   {
     input_file->vdtype = VIDEO_TIFF;
@@ -216,6 +216,129 @@ static void deinterleave ( unsigned char** input,       //!< input buffer
   }
 }
 
+#if defined(__SSE2__) && (IMGTYPE == 1)
+#include <emmintrin.h>
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Widens n 8 bit samples to imgpel (SSE2)
+ ************************************************************************
+ */
+static void bytes2pels (imgpel *dst, const unsigned char *src, int n)
+{
+  __m128i zero = _mm_setzero_si128();
+  int i;
+
+  for (i = 0; i + 16 <= n; i += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+    _mm_storeu_si128((__m128i *) (dst + i    ), _mm_unpacklo_epi8(v, zero));
+    _mm_storeu_si128((__m128i *) (dst + i + 8), _mm_unpackhi_epi8(v, zero));
+  }
+  for (; i < n; ++i)
+    dst[i] = (imgpel) src[i];
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Converts n little endian samples of symbol_size_in_bytes (1 or 2)
+ *    bytes to imgpel with rshift_rnd(sample, bitshift) (SSE2)
+ ************************************************************************
+ */
+static void shift2pels (imgpel *dst, const unsigned char *src, int n, int symbol_size_in_bytes, int bitshift)
+{
+  __m128i zero = _mm_setzero_si128();
+  __m128i one  = _mm_set1_epi16(1);
+  __m128i sh   = _mm_cvtsi32_si128(iabs(bitshift));
+  __m128i sh1  = _mm_cvtsi32_si128(bitshift - 1);
+  uint16 ui16;
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    __m128i v = (symbol_size_in_bytes == 1)
+      ? _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (src + i)), zero)
+      : _mm_loadu_si128((const __m128i *) (src + 2 * i));
+
+    // (x + (1 << (a - 1))) >> a == (x >> a) + ((x >> (a - 1)) & 1) without overflowing 16 bits
+    if (bitshift > 0)
+      v = _mm_add_epi16(_mm_srl_epi16(v, sh), _mm_and_si128(_mm_srl_epi16(v, sh1), one));
+    else
+      v = _mm_sll_epi16(v, sh);
+    _mm_storeu_si128((__m128i *) (dst + i), v);
+  }
+  for (; i < n; ++i)
+  {
+    ui16 = 0;
+    memcpy(&ui16, src + i * symbol_size_in_bytes, symbol_size_in_bytes);
+    dst[i] = (imgpel) rshift_rnd(ui16, bitshift);
+  }
+}
+#else
+/*!
+ ************************************************************************
+ * \brief
+ *    Widens n 8 bit samples to imgpel
+ ************************************************************************
+ */
+static void bytes2pels (imgpel *dst, const unsigned char *src, int n)
+{
+  int i;
+
+  for (i = 0; i < n; ++i)
+    dst[i] = (imgpel) src[i];
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Converts n little endian samples of symbol_size_in_bytes bytes to
+ *    imgpel with rshift_rnd(sample, bitshift)
+ ************************************************************************
+ */
+static void shift2pels (imgpel *dst, const unsigned char *src, int n, int symbol_size_in_bytes, int bitshift)
+{
+  uint16 ui16;
+  int i;
+
+  for (i = 0; i < n; ++i)
+  {
+    ui16 = 0;
+    memcpy(&ui16, src + i * symbol_size_in_bytes, symbol_size_in_bytes);
+    dst[i] = (imgpel) rshift_rnd(ui16, bitshift);
+  }
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Converts n little endian samples of symbol_size_in_bytes bytes to
+ *    imgpel
+ ************************************************************************
+ */
+static void buf2pels (imgpel *dst, const unsigned char *src, int n, int symbol_size_in_bytes)
+{
+  uint16 ui16;
+  int i;
+
+  if (symbol_size_in_bytes == 1)
+  {
+    bytes2pels(dst, src, n);
+  }
+  else
+  {
+    for (i = 0; i < n; ++i)
+    {
+      ui16 = 0;
+      memcpy(&ui16, src + i * symbol_size_in_bytes, symbol_size_in_bytes);
+      dst[i] = (imgpel) ui16;
+    }
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -297,13 +420,7 @@ void buf2img_bitshift ( imgpel** imgX,           //!< Pointer to image plane
       {
         for (j = 0; j < o_size_y; j++)
         {
-          j_pos = j*size_x;
-          for (i = 0; i < o_size_x; i++)
-          {
-            ui16=0;
-            memcpy(&(ui16), buf + ((i + j_pos) * symbol_size_in_bytes), symbol_size_in_bytes);
-            imgX[j][i] = (imgpel) rshift_rnd(ui16,bitshift);
-          }
+          shift2pels(imgX[j], buf + j * size_x * symbol_size_in_bytes, o_size_x, symbol_size_in_bytes, bitshift);
         }  
       }
       else
@@ -331,12 +448,7 @@ void buf2img_bitshift ( imgpel** imgX,           //!< Pointer to image plane
         for (j=0; j < iminheight; j++)
         {        
           j_pos = (j + offset_y) * size_x + offset_x;
-          for (i=0; i < iminwidth; i++)
-          {
-            ui16=0;
-            memcpy(&(ui16), buf + ((i + j_pos) * symbol_size_in_bytes), symbol_size_in_bytes);
-            imgX[j + dst_offset_y][i + dst_offset_x] = (imgpel) rshift_rnd(ui16,bitshift);
-          }
+          shift2pels(&imgX[j + dst_offset_y][dst_offset_x], buf + j_pos * symbol_size_in_bytes, iminwidth, symbol_size_in_bytes, bitshift);
         }    
       }
   }
@@ -402,18 +514,11 @@ void buf2img_basic (imgpel** imgX,            //!< Pointer to image plane
   else
   {
     int j_pos;
-    uint16 ui16;
     if (size_x == o_size_x && size_y == o_size_y)
     {
       for (j=0; j < o_size_y; j++)
       {
-        j_pos = j * size_x;
-        for (i=0; i < o_size_x; i++)
-        {
-          ui16=0;          
-          memcpy(&(ui16), buf + ((i + j_pos) * symbol_size_in_bytes), symbol_size_in_bytes);
-          imgX[j][i]= (imgpel) ui16;
-        }
+        buf2pels(imgX[j], buf + j * size_x * symbol_size_in_bytes, o_size_x, symbol_size_in_bytes);
       }    
     }
     else
@@ -438,18 +543,10 @@ void buf2img_basic (imgpel** imgX,            //!< Pointer to image plane
       iminwidth  =  ( (dst_offset_x + iminwidth ) > o_size_x  ) ? (o_size_x  - dst_offset_x) : iminwidth;
       iminheight =  ( (dst_offset_y + iminheight) > o_size_y )  ? (o_size_y - dst_offset_y) : iminheight;
 
-      for (j = 0; j < iminheight; j++) {
-        memcpy(&imgX[j + dst_offset_y][dst_offset_x], &(temp_buf[(j + offset_y) * size_x + offset_x]), iminwidth * sizeof(imgpel));
-      }
       for (j=0; j < iminheight; j++)
       {        
         j_pos = (j + offset_y) * size_x + offset_x;
-        for (i=0; i < iminwidth; i++)
-        {
-          ui16 = 0;
-          memcpy(&(ui16), buf + ((i + j_pos) * symbol_size_in_bytes), symbol_size_in_bytes);
-          imgX[j + dst_offset_y][i + dst_offset_x]= (imgpel) ui16;
-        }
+        buf2pels(&imgX[j + dst_offset_y][dst_offset_x], buf + j_pos * symbol_size_in_bytes, iminwidth, symbol_size_in_bytes);
       }    
     }
   }
@@ -602,7 +699,11 @@ int ReadOneFrame (VideoParameters *p_Vid, VideoDataFile *input_file, int FrameNo
 
 	Boolean rgb_input = (Boolean) (source->color_model == CM_RGB && source->yuv_format == YUV444);
 
-	if (input_file->is_concatenated == 0)
+	if (input_file->vdtype == VIDEO_Y4M)
+	{
+		file_read = ReadFrameY4M (p_Inp, input_file, FrameNoInFile, source, p_Vid->buf);
+	}
+	else if (input_file->is_concatenated == 0)
 	{    
 		if (input_file->vdtype == VIDEO_TIFF)
     {
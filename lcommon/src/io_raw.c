@@ -16,6 +16,7 @@
 
 #include "global.h"
 #include "img_io.h"
+#include "memalloc.h"
 
 #define FAST_READ 1
 
@@ -68,6 +69,359 @@ static inline int ReadData (int vfile, int framesize_in_bytes, unsigned char *bu
 }
 #endif
 
+#if !defined(WIN32)
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define PREFETCH_SLOTS 8      //!< number of frame buffers of the prefetch ring
+
+typedef enum
+{
+  SLOT_FREE    = 0,
+  SLOT_LOADING = 1,
+  SLOT_READY   = 2,
+  SLOT_FAILED  = 3
+} SlotState;
+
+//! prefetching reader or memory mapping of a concatenated raw input file
+struct frame_prefetch
+{
+  int             mode;                          //!< PREFETCH_THREAD or PREFETCH_MMAP
+  int             vfile;                         //!< input file
+  int64           offset;                        //!< file position of the first frame to be coded
+  int64           frame_size;                    //!< distance of consecutive frames in the file
+  int             read_size;                     //!< bytes read per frame
+  int             frame_step;                    //!< distance of consecutive coded frames (FrameNoInFile)
+  int             num_frames;                    //!< number of frames to be coded
+
+  // PREFETCH_MMAP
+  unsigned char  *map;                           //!< mapped input file
+  int64           map_size;                      //!< size of the mapping
+  int64           page_size;
+
+  // PREFETCH_THREAD
+  unsigned char  *slot_buf  [PREFETCH_SLOTS];    //!< frame buffers of the ring
+  int             slot_frame[PREFETCH_SLOTS];    //!< coded frame index held by a slot
+  int             slot_state[PREFETCH_SLOTS];    //!< SlotState of a slot
+  byte           *consumed;                      //!< coded frames already requested by the encoder
+  int             low;                           //!< lowest coded frame index not requested yet
+  int             stop;
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+};
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads size bytes at file position pos without moving the file
+ *    pointer of vfile
+ ************************************************************************
+ */
+static int read_at (int vfile, unsigned char *buf, int size, int64 pos)
+{
+  while (size > 0)
+  {
+    ssize_t n = pread(vfile, buf, size, (off_t) pos);
+    if (n <= 0)
+      return 0;
+    buf  += n;
+    pos  += n;
+    size -= (int) n;
+  }
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Selects the next frame to be loaded by the reader thread: the
+ *    lowest frame within PREFETCH_SLOTS frames of the oldest outstanding
+ *    one that is neither requested nor held by a slot. Returns -1 if
+ *    there is no such frame or no free slot.
+ ************************************************************************
+ */
+static int next_prefetch_frame (FramePrefetch *pf, int *free_slot)
+{
+  int k, s, last = imin(pf->low + PREFETCH_SLOTS, pf->num_frames);
+
+  for (s = 0; s < PREFETCH_SLOTS && pf->slot_state[s] != SLOT_FREE; ++s)
+    ;
+  if (s == PREFETCH_SLOTS)
+    return -1;
+  *free_slot = s;
+
+  for (k = pf->low; k < last; ++k)
+  {
+    if (!pf->consumed[k])
+    {
+      for (s = 0; s < PREFETCH_SLOTS; ++s)
+      {
+        if (pf->slot_state[s] != SLOT_FREE && pf->slot_frame[s] == k)
+          break;
+      }
+      if (s == PREFETCH_SLOTS)
+        return k;
+    }
+  }
+  return -1;
+}
+
+static void *prefetch_thread (void *arg)
+{
+  FramePrefetch *pf = (FramePrefetch *) arg;
+  int k, slot, ok;
+
+  pthread_mutex_lock(&pf->mutex);
+  while (!pf->stop)
+  {
+    if ((k = next_prefetch_frame(pf, &slot)) < 0)
+    {
+      pthread_cond_wait(&pf->cond, &pf->mutex);
+      continue;
+    }
+
+    pf->slot_frame[slot] = k;
+    pf->slot_state[slot] = SLOT_LOADING;
+    pthread_mutex_unlock(&pf->mutex);
+
+    ok = read_at(pf->vfile, pf->slot_buf[slot], pf->read_size, pf->offset + pf->frame_size * k * pf->frame_step);
+
+    pthread_mutex_lock(&pf->mutex);
+    pf->slot_state[slot] = ok ? SLOT_READY : SLOT_FAILED;
+    pthread_cond_broadcast(&pf->cond);
+  }
+  pthread_mutex_unlock(&pf->mutex);
+
+  return NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Hands out a frame loaded by the reader thread. Returns 0 if the
+ *    frame was not prefetched; it then has to be read synchronously.
+ ************************************************************************
+ */
+static int read_prefetched (FramePrefetch *pf, int k, unsigned char *buf)
+{
+  int s, hit = 0;
+
+  pthread_mutex_lock(&pf->mutex);
+  pf->consumed[k] = 1;
+  while (pf->low < pf->num_frames && pf->consumed[pf->low])
+    pf->low++;
+
+  for (s = 0; s < PREFETCH_SLOTS; ++s)
+  {
+    if (pf->slot_state[s] != SLOT_FREE && pf->slot_frame[s] == k)
+    {
+      while (pf->slot_state[s] == SLOT_LOADING)
+        pthread_cond_wait(&pf->cond, &pf->mutex);
+      if (pf->slot_state[s] == SLOT_READY)
+      {
+        memcpy(buf, pf->slot_buf[s], pf->read_size);
+        hit = 1;
+      }
+      pf->slot_state[s] = SLOT_FREE;
+      break;
+    }
+  }
+  pthread_cond_broadcast(&pf->cond);
+  pthread_mutex_unlock(&pf->mutex);
+
+  return hit;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Copies a frame from the mapped input file and asks the kernel to
+ *    page in the following one. Returns 0 if the frame lies beyond the
+ *    end of the file.
+ ************************************************************************
+ */
+static int read_mapped (FramePrefetch *pf, int k, unsigned char *buf)
+{
+  int64 pos = pf->offset + pf->frame_size * k * pf->frame_step;
+  int64 next;
+
+  if (pos + pf->read_size > pf->map_size)
+    return 0;
+
+  memcpy(buf, pf->map + pos, pf->read_size);
+
+  next = (pos + pf->frame_size * pf->frame_step) & ~(pf->page_size - 1);
+  if (next < pf->map_size)
+    madvise(pf->map + next, (size_t) i64min(pf->frame_size + pf->page_size, pf->map_size - next), MADV_WILLNEED);
+
+  return 1;
+}
+
+static void free_ring (FramePrefetch *pf)
+{
+  int s;
+
+  pthread_cond_destroy(&pf->cond);
+  pthread_mutex_destroy(&pf->mutex);
+  for (s = 0; s < PREFETCH_SLOTS; ++s)
+    free(pf->slot_buf[s]);
+  free(pf->consumed);
+  free(pf);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sets up prefetching of a concatenated raw input file
+ *
+ * \param p_Inp
+ *    Input configuration parameters
+ * \param input_file
+ *    Input file, already opened
+ * \param HeaderSize
+ *    Number of bytes in the source file to be skipped
+ * \param source
+ *    source file (on disk) information
+ * \param frame_step
+ *    distance of consecutive coded frames in the file
+ * \param num_frames
+ *    number of frames to be coded
+ * \param mode
+ *    PREFETCH_THREAD: a reader thread loads the next frames into a ring
+ *    of frame buffers; PREFETCH_MMAP: frames are copied from a memory
+ *    mapping of the file. Frames that were not prefetched are read
+ *    synchronously as before.
+ ************************************************************************
+ */
+void OpenFramePrefetch (InputParameters *p_Inp, VideoDataFile *input_file, int HeaderSize, FrameFormat *source, int frame_step, int num_frames, int mode)
+{
+  FramePrefetch *pf;
+  unsigned int symbol_size_in_bytes = source->pic_unit_size_shift3;
+  int s;
+
+  if (mode == PREFETCH_OFF || input_file->is_concatenated == 0 || input_file->vdtype == VIDEO_TIFF || input_file->vdtype == VIDEO_Y4M || input_file->f_num == -1)
+    return;
+  if ((source->pic_unit_size_on_disk & 0x07) != 0 || num_frames < 1)
+    return;
+
+  if ((pf = (FramePrefetch *) calloc(1, sizeof(FramePrefetch))) == NULL)
+    no_mem_exit("OpenFramePrefetch: pf");
+
+  pf->mode       = mode;
+  pf->vfile      = input_file->f_num;
+  pf->frame_size = (int64) (source->size_cmp[0] + 2 * source->size_cmp[1]) * symbol_size_in_bytes;
+  pf->offset     = HeaderSize + pf->frame_size * p_Inp->start_frame;
+  pf->read_size  = source->width * source->height * symbol_size_in_bytes;
+  if (source->yuv_format != YUV400)
+    pf->read_size += 2 * source->width_cr * source->height_cr * symbol_size_in_bytes;
+  pf->frame_step = frame_step;
+  pf->num_frames = num_frames;
+
+  if (mode == PREFETCH_MMAP)
+  {
+    struct stat st;
+
+    if (fstat(pf->vfile, &st) == 0 && st.st_size > 0)
+    {
+      pf->map_size  = (int64) st.st_size;
+      pf->page_size = (int64) sysconf(_SC_PAGESIZE);
+      pf->map = (unsigned char *) mmap(NULL, (size_t) pf->map_size, PROT_READ, MAP_SHARED, pf->vfile, 0);
+    }
+    if (pf->map == NULL || pf->map == (unsigned char *) MAP_FAILED)
+    {
+      printf("OpenFramePrefetch: cannot map %s, reading frames synchronously\n", input_file->fname);
+      free(pf);
+      return;
+    }
+    madvise(pf->map, (size_t) pf->map_size, MADV_SEQUENTIAL);
+  }
+  else
+  {
+    if ((pf->consumed = (byte *) calloc(pf->num_frames, sizeof(byte))) == NULL)
+      no_mem_exit("OpenFramePrefetch: pf->consumed");
+    for (s = 0; s < PREFETCH_SLOTS; ++s)
+    {
+      if ((pf->slot_buf[s] = (unsigned char *) malloc(pf->read_size)) == NULL)
+        no_mem_exit("OpenFramePrefetch: pf->slot_buf");
+    }
+    pthread_mutex_init(&pf->mutex, NULL);
+    pthread_cond_init(&pf->cond, NULL);
+    if (pthread_create(&pf->thread, NULL, prefetch_thread, pf) != 0)
+    {
+      printf("OpenFramePrefetch: cannot start reader thread, reading frames synchronously\n");
+      free_ring(pf);
+      return;
+    }
+  }
+
+  input_file->prefetch = pf;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stops prefetching of an input file and frees its buffers
+ ************************************************************************
+ */
+void CloseFramePrefetch (VideoDataFile *input_file)
+{
+  FramePrefetch *pf = input_file->prefetch;
+
+  if (pf == NULL)
+    return;
+
+  if (pf->mode == PREFETCH_MMAP)
+  {
+    munmap(pf->map, (size_t) pf->map_size);
+    free(pf);
+  }
+  else
+  {
+    pthread_mutex_lock(&pf->mutex);
+    pf->stop = 1;
+    pthread_cond_broadcast(&pf->cond);
+    pthread_mutex_unlock(&pf->mutex);
+    pthread_join(pf->thread, NULL);
+    free_ring(pf);
+  }
+
+  input_file->prefetch = NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Serves frame FrameNoInFile from the prefetcher. Returns 0 if the
+ *    frame has to be read synchronously.
+ ************************************************************************
+ */
+static int ReadFramePrefetched (FramePrefetch *pf, int FrameNoInFile, unsigned char *buf)
+{
+  int k = FrameNoInFile / pf->frame_step;
+
+  if (FrameNoInFile < 0 || (FrameNoInFile % pf->frame_step) != 0 || k >= pf->num_frames)
+    return 0;
+
+  return (pf->mode == PREFETCH_MMAP) ? read_mapped(pf, k, buf) : read_prefetched(pf, k, buf);
+}
+#else
+void OpenFramePrefetch (InputParameters *p_Inp, VideoDataFile *input_file, int HeaderSize, FrameFormat *source, int frame_step, int num_frames, int mode)
+{
+  if (mode != PREFETCH_OFF)
+    printf("OpenFramePrefetch: input prefetching is not supported on this platform, reading frames synchronously\n");
+}
+
+void CloseFramePrefetch (VideoDataFile *input_file)
+{
+}
+
+static int ReadFramePrefetched (FramePrefetch *pf, int FrameNoInFile, unsigned char *buf)
+{
+  return 0;
+}
+#endif
+
 
 /*!
  ************************************************************************
@@ -99,6 +453,9 @@ int ReadFrameConcatenated (InputParameters *p_Inp, VideoDataFile *input_file, in
   const int bytes_uv = source->size_cmp[1] * symbol_size_in_bytes;
 
   const int64 framesize_in_bytes = bytes_y + 2*bytes_uv;
+
+  if (input_file->prefetch != NULL && ReadFramePrefetched(input_file->prefetch, FrameNoInFile, buf))
+    return 1;
   
 #if 0
   // skip Header
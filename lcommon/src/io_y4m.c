@@ -0,0 +1,494 @@
+/*!
+ *************************************************************************************
+ * \file io_y4m.c
+ *
+ * \brief
+ *    I/O functions related to YUV4MPEG2 (Y4M) streams
+ *
+ *    The stream header is parsed once when the input is set up. Frames of
+ *    a Y4M file are then read at their file position like raw frames.
+ *    A pipe ("-" reads from stdin) can only be read in order, so frames
+ *    that are read before they are requested (e.g. the frames following
+ *    an anchor in coding order) are kept in a cache that grows with the
+ *    reordering depth; the requested frame itself is read directly into
+ *    the frame buffer.
+ *
+ *    Output files with the extension .y4m, and "-" for stdout, get the
+ *    stream header before the first frame and a frame header before each
+ *    frame. Console output is moved to stderr when writing to stdout.
+ *
+ *************************************************************************************
+ */
+#include "contributors.h"
+
+#include <math.h>
+
+#include "global.h"
+#include "img_io.h"
+#include "memalloc.h"
+
+#define Y4M_MAX_HEADER    1024     //!< maximum length of a stream or frame header
+#define Y4M_PIPE_FRAMES   16       //!< initial number of frames kept when reading ahead from a pipe
+#define Y4M_MAX_OUTPUTS   4        //!< number of Y4M output files open at a time
+
+//! frames read ahead from a pipe
+struct y4m_cache
+{
+  int             no_slots;
+  int            *frame_no;                    //!< frame held by a slot (-1: free)
+  unsigned char **buf;
+};
+
+//! Y4M output files
+static struct
+{
+  int fd;
+  int header_written;
+} y4m_out[Y4M_MAX_OUTPUTS] = { {-1, 0}, {-1, 0}, {-1, 0}, {-1, 0} };
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads size bytes; pipes may return less than requested per read
+ ************************************************************************
+ */
+static int read_full (int vfile, unsigned char *buf, int size)
+{
+  while (size > 0)
+  {
+    int n = read(vfile, buf, size);
+    if (n <= 0)
+      return 0;
+    buf  += n;
+    size -= n;
+  }
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads one header line including the terminating '\n'.
+ *    Returns its length or 0 on EOF or if it is too long.
+ ************************************************************************
+ */
+static int read_line (int vfile, char *line)
+{
+  int len = 0;
+
+  while (len < Y4M_MAX_HEADER - 1)
+  {
+    if (read(vfile, &line[len], 1) != 1)
+      return 0;
+    if (line[len++] == '\n')
+    {
+      line[len] = '\0';
+      return len;
+    }
+  }
+  return 0;
+}
+
+static int frame_bytes (FrameFormat *source)
+{
+  int size = source->width * source->height;
+
+  if (source->yuv_format != YUV400)
+    size += 2 * source->width_cr * source->height_cr;
+
+  return size * source->pic_unit_size_shift3;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Parses the stream header of a Y4M input and sets the frame size,
+ *    frame rate, color format and bit depth of format accordingly.
+ *    Files are opened for the parsing only; from a pipe the header is
+ *    consumed. Returns 0 if the header is not valid.
+ ************************************************************************
+ */
+int ParseY4MHeader (VideoDataFile *input_file, FrameFormat *format)
+{
+  char line[Y4M_MAX_HEADER], *tag;
+  int vfile, len, ok = 1;
+  int num = 0, den = 0, depth = 8;
+  ColorFormat yuv_format = YUV420;
+
+  vfile = input_file->is_pipe ? fileno(stdin) : open(input_file->fname, OPENFLAGS_READ);
+  if (vfile == -1)
+    return 0;
+#if defined(WIN32)
+  if (input_file->is_pipe)
+    _setmode(vfile, _O_BINARY);
+#endif
+
+  if ((len = read_line(vfile, line)) == 0 || strncmp(line, "YUV4MPEG2 ", 10) != 0)
+    ok = 0;
+  input_file->y4m_header = len;
+
+  for (tag = strtok(line + 9, " \n"); ok && tag != NULL; tag = strtok(NULL, " \n"))
+  {
+    switch (tag[0])
+    {
+    case 'W':
+      format->width  = atoi(tag + 1);
+      break;
+    case 'H':
+      format->height = atoi(tag + 1);
+      break;
+    case 'F':
+      if (sscanf(tag + 1, "%d:%d", &num, &den) == 2 && num > 0 && den > 0)
+        format->frame_rate = (double) num / den;
+      break;
+    case 'C':
+      if (strncmp(tag + 1, "mono", 4) == 0)
+      {
+        yuv_format = YUV400;
+        depth = (tag[5] != '\0') ? atoi(tag + 5) : 8;
+      }
+      else
+      {
+        if (strncmp(tag + 1, "420", 3) == 0)
+          yuv_format = YUV420;
+        else if (strncmp(tag + 1, "422", 3) == 0)
+          yuv_format = YUV422;
+        else if (strncmp(tag + 1, "444", 3) == 0 && strcmp(tag + 4, "alpha") != 0)
+          yuv_format = YUV444;
+        else
+          ok = 0;
+        // C420jpeg, C420mpeg2, C420paldv are 8 bit, C420p10 etc. have 16 bit samples
+        depth = (tag[4] == 'p' && tag[5] >= '0' && tag[5] <= '9') ? atoi(tag + 5) : 8;
+      }
+      break;
+    default:
+      // interlacing, aspect ratio and comments are not used
+      break;
+    }
+  }
+
+  if (ok && (format->width <= 0 || format->height <= 0 || depth < 8 || depth > 16))
+    ok = 0;
+
+  if (ok)
+  {
+    format->yuv_format   = yuv_format;
+    format->bit_depth[0] = format->bit_depth[1] = format->bit_depth[2] = depth;
+  }
+
+  // the frame headers of a file are all expected to be as long as the first one
+  input_file->y4m_frame_header = 0;
+  if (ok && !input_file->is_pipe)
+  {
+    if ((len = read_line(vfile, line)) == 0 || strncmp(line, "FRAME", 5) != 0)
+      ok = 0;
+    input_file->y4m_frame_header = len;
+  }
+
+  if (!input_file->is_pipe)
+    close(vfile);
+
+  return ok;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads frame FrameNoInFile from a Y4M file
+ ************************************************************************
+ */
+static int read_y4m_file (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, int size, unsigned char *buf)
+{
+  char header[Y4M_MAX_HEADER];
+  int vfile = input_file->f_num;
+  int64 pos = input_file->y4m_header + (int64) (FrameNoInFile + p_Inp->start_frame) * (input_file->y4m_frame_header + size);
+
+  if (lseek(vfile, pos, SEEK_SET) == -1)
+  {
+    snprintf(errortext, ET_SIZE, "ReadFrameY4M: cannot advance file pointer in input file beyond frame %d\n", p_Inp->start_frame + FrameNoInFile);
+    error (errortext, -1);
+  }
+
+  if (!read_full(vfile, (unsigned char *) header, input_file->y4m_frame_header))
+  {
+    printf ("ReadFrameY4M: cannot read frame %d from input file, unexpected EOF!\n", p_Inp->start_frame + FrameNoInFile);
+    return 0;
+  }
+  if (strncmp(header, "FRAME", 5) != 0 || header[input_file->y4m_frame_header - 1] != '\n')
+  {
+    error ("ReadFrameY4M: Y4M frame headers of different length are not supported", 500);
+  }
+
+  if (!read_full(vfile, buf, size))
+  {
+    printf ("ReadFrameY4M: cannot read %d bytes from input file, unexpected EOF!\n", size);
+    return 0;
+  }
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads the next frame of a Y4M pipe
+ ************************************************************************
+ */
+static int read_y4m_pipe_frame (VideoDataFile *input_file, int size, unsigned char *buf)
+{
+  char header[Y4M_MAX_HEADER];
+
+  if (read_line(input_file->f_num, header) == 0 || strncmp(header, "FRAME", 5) != 0)
+    return 0;
+  if (!read_full(input_file->f_num, buf, size))
+    return 0;
+
+  input_file->pipe_frame++;
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns a free slot of the pipe cache, doubling the number of
+ *    slots if all of them hold frames that were not requested yet
+ ************************************************************************
+ */
+static int get_y4m_cache_slot (Y4MCache *cache, int size)
+{
+  int s, old_slots = cache->no_slots;
+
+  for (s = 0; s < old_slots; ++s)
+  {
+    if (cache->frame_no[s] < 0)
+      return s;
+  }
+
+  cache->no_slots = imax(2 * old_slots, Y4M_PIPE_FRAMES);
+  if ((cache->frame_no = (int *) realloc(cache->frame_no, cache->no_slots * sizeof(int))) == NULL)
+    no_mem_exit("get_y4m_cache_slot: cache->frame_no");
+  if ((cache->buf = (unsigned char **) realloc(cache->buf, cache->no_slots * sizeof(unsigned char *))) == NULL)
+    no_mem_exit("get_y4m_cache_slot: cache->buf");
+  for (s = old_slots; s < cache->no_slots; ++s)
+  {
+    cache->frame_no[s] = -1;
+    if ((cache->buf[s] = (unsigned char *) malloc(size)) == NULL)
+      no_mem_exit("get_y4m_cache_slot: cache->buf");
+  }
+
+  return old_slots;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads frame FrameNoInFile from a Y4M pipe. Frames before it are
+ *    read into the cache. Each frame can be read once; asking for a
+ *    frame that was already handed out is an error.
+ ************************************************************************
+ */
+static int read_y4m_pipe (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, int size, unsigned char *buf)
+{
+  Y4MCache *cache = input_file->y4m_cache;
+  int frame = FrameNoInFile + p_Inp->start_frame;
+  int s, slot;
+
+  if (cache == NULL)
+  {
+    if ((cache = input_file->y4m_cache = (Y4MCache *) calloc(1, sizeof(Y4MCache))) == NULL)
+      no_mem_exit("read_y4m_pipe: cache");
+  }
+
+  for (s = 0; s < cache->no_slots; ++s)
+  {
+    if (cache->frame_no[s] == frame)
+    {
+      memcpy(buf, cache->buf[s], size);
+      cache->frame_no[s] = -1;
+      return 1;
+    }
+  }
+
+  if (frame < input_file->pipe_frame)
+  {
+    snprintf(errortext, ET_SIZE, "ReadFrameY4M: frame %d is no longer available from the input pipe", frame);
+    error (errortext, 500);
+  }
+
+  while (input_file->pipe_frame < frame)
+  {
+    // frames before the start frame are skipped
+    int keep = input_file->pipe_frame >= p_Inp->start_frame;
+
+    slot = get_y4m_cache_slot(cache, size);
+    cache->frame_no[slot] = keep ? input_file->pipe_frame : -1;
+    if (!read_y4m_pipe_frame(input_file, size, cache->buf[slot]))
+    {
+      cache->frame_no[slot] = -1;
+      printf ("ReadFrameY4M: cannot read frame %d from input pipe, unexpected EOF!\n", input_file->pipe_frame);
+      return 0;
+    }
+  }
+
+  if (!read_y4m_pipe_frame(input_file, size, buf))
+  {
+    printf ("ReadFrameY4M: cannot read frame %d from input pipe, unexpected EOF!\n", frame);
+    return 0;
+  }
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reads one frame from a Y4M file or pipe
+ *
+ * \param p_Inp
+ *    Input configuration parameters
+ * \param input_file
+ *    Input file to read from
+ * \param FrameNoInFile
+ *    Frame number in the source file
+ * \param source
+ *    source file (on disk) information
+ * \param buf
+ *    target buffer
+ ************************************************************************
+ */
+int ReadFrameY4M (InputParameters *p_Inp, VideoDataFile *input_file, int FrameNoInFile, FrameFormat *source, unsigned char *buf)
+{
+  int size = frame_bytes(source);
+
+  return input_file->is_pipe ? read_y4m_pipe(p_Inp, input_file, FrameNoInFile, size, buf)
+                             : read_y4m_file(p_Inp, input_file, FrameNoInFile, size, buf);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees the frames read ahead from a pipe
+ ************************************************************************
+ */
+void FreeY4MCache (VideoDataFile *input_file)
+{
+  Y4MCache *cache = input_file->y4m_cache;
+  int s;
+
+  if (cache == NULL)
+    return;
+
+  for (s = 0; s < cache->no_slots; ++s)
+    free(cache->buf[s]);
+  free(cache->frame_no);
+  free(cache->buf);
+  free(cache);
+  input_file->y4m_cache = NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Opens an output video file. "-" writes to stdout, console output
+ *    then goes to stderr. Files with the extension .y4m and stdout are
+ *    written as Y4M streams. Returns -1 if the file cannot be opened.
+ ************************************************************************
+ */
+int OpenOutputFile (char *fname)
+{
+  int p_out, i, y4m;
+  size_t len = strlen(fname);
+
+  if (strcmp(fname, "-") == 0)
+  {
+    // stdout is not flushed, so console output still buffered goes to stderr as well
+    if ((p_out = dup(fileno(stdout))) != -1)
+      dup2(fileno(stderr), fileno(stdout));
+#if defined(WIN32)
+    _setmode(p_out, _O_BINARY);
+#endif
+    y4m = 1;
+  }
+  else
+  {
+    p_out = open(fname, OPENFLAGS_WRITE, OPEN_PERMISSIONS);
+    y4m = (len > 4 && strcasecmp(fname + len - 4, ".y4m") == 0);
+  }
+
+  if (p_out != -1 && y4m)
+  {
+    for (i = 0; i < Y4M_MAX_OUTPUTS && y4m_out[i].fd != -1; ++i)
+      ;
+    if (i == Y4M_MAX_OUTPUTS)
+      error ("OpenOutputFile: too many Y4M output files", 500);
+    y4m_out[i].fd = p_out;
+    y4m_out[i].header_written = 0;
+  }
+
+  return p_out;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Closes an output video file
+ ************************************************************************
+ */
+void CloseOutputFile (int p_out)
+{
+  int i;
+
+  for (i = 0; i < Y4M_MAX_OUTPUTS; ++i)
+  {
+    if (y4m_out[i].fd == p_out)
+      y4m_out[i].fd = -1;
+  }
+  close(p_out);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Writes the frame header of a Y4M output, preceded by the stream
+ *    header for the first frame. Does nothing for other outputs.
+ *
+ * \param p_out
+ *    Output file
+ * \param format
+ *    width, height, yuv_format, frame_rate, bit_depth[0] and
+ *    pic_unit_size_shift3 of the written frames
+ ************************************************************************
+ */
+void WriteY4MFrameHeader (int p_out, FrameFormat *format)
+{
+  static const char *chroma[4] = { "mono", "420", "422", "444" };
+  char header[Y4M_MAX_HEADER], cspace[16];
+  double frame_rate = (format->frame_rate > 0.0) ? format->frame_rate : 30.0;
+  int i, len;
+
+  for (i = 0; i < Y4M_MAX_OUTPUTS && y4m_out[i].fd != p_out; ++i)
+    ;
+  if (i == Y4M_MAX_OUTPUTS)
+    return;
+
+  if (!y4m_out[i].header_written)
+  {
+    if (format->pic_unit_size_shift3 == 1)
+      snprintf(cspace, 16, "%s", chroma[format->yuv_format]);
+    else if (format->yuv_format == YUV400)
+      snprintf(cspace, 16, "mono16");
+    else
+      snprintf(cspace, 16, "%sp%d", chroma[format->yuv_format], imax(format->bit_depth[0], 9));
+
+    // integer and NTSC style frame rates are written exactly
+    if (fabs(frame_rate - floor(frame_rate + 0.5)) < 1e-6)
+      len = snprintf(header, Y4M_MAX_HEADER, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C%s\n", format->width, format->height, (int) floor(frame_rate + 0.5), cspace);
+    else
+      len = snprintf(header, Y4M_MAX_HEADER, "YUV4MPEG2 W%d H%d F%d:1001 Ip A1:1 C%s\n", format->width, format->height, (int) floor(frame_rate * 1001.0 + 0.5), cspace);
+
+    if (write(p_out, header, len) != len)
+      error ("WriteY4MFrameHeader: error writing to Y4M output file", 500);
+    y4m_out[i].header_written = 1;
+  }
+
+  if (write(p_out, "FRAME\n", 6) != 6)
+    error ("WriteY4MFrameHeader: error writing to Y4M output file", 500);
+}
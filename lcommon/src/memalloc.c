@@ -822,6 +822,198 @@ void free_mem5Dpel(imgpel *****array5D)
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate zeroed memory starting on a MEM_ALIGNMENT byte boundary.
+ *    The start of the underlying block is stored in front of the
+ *    returned pointer; release with mem_free_aligned()
+ *
+ * \return
+ *    aligned pointer or NULL if out of memory
+ ************************************************************************
+ */
+void *mem_calloc_aligned(size_t size)
+{
+  byte *block = (byte *) calloc(size + MEM_ALIGNMENT + sizeof(void *), 1);
+  byte *ptr;
+
+  if (block == NULL)
+    return NULL;
+
+  ptr = (byte *) (((size_t) (block + sizeof(void *)) + MEM_ALIGNMENT - 1) & ~((size_t) MEM_ALIGNMENT - 1));
+  ((void **) ptr)[-1] = block;
+
+  return ptr;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    free memory allocated with mem_calloc_aligned()
+ ************************************************************************
+ */
+void mem_free_aligned(void *ptr)
+{
+  if (ptr)
+    free(((void **) ptr)[-1]);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate a picture plane of height x width samples in one block.
+ *    The stride is rounded up to MEM_ALIGNMENT bytes so that every row
+ *    starts on a cache line. plane->img is the row table for the usual
+ *    [y][x] access.
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************
+ */
+int get_plane(PicPlane *plane, int height, int width)
+{
+  int i;
+  int align = MEM_ALIGNMENT / sizeof(imgpel);
+
+  plane->width  = width;
+  plane->height = height;
+  plane->stride = (width + align - 1) & ~(align - 1);
+
+  if ((plane->img = (imgpel**) malloc(height * sizeof(imgpel*))) == NULL)
+    no_mem_exit("get_plane: img");
+  if ((plane->base = (imgpel*) mem_calloc_aligned((size_t) height * plane->stride * sizeof(imgpel))) == NULL)
+    no_mem_exit("get_plane: base");
+
+  for (i = 0; i < height; i++)
+    plane->img[i] = plane->base + i * plane->stride;
+
+  return height * (sizeof(imgpel*) + plane->stride * sizeof(imgpel));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    free a picture plane which was allocated with get_plane()
+ ************************************************************************
+ */
+void free_plane(PicPlane *plane)
+{
+  if (plane->img)
+  {
+    mem_free_aligned(plane->base);
+    free (plane->img);
+    plane->img  = NULL;
+    plane->base = NULL;
+  }
+  else
+  {
+    error ("free_plane: trying to free unused memory",100);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 3D memory array -> imgpel array3D[dim0][dim1][dim2]
+ *    with the samples in one MEM_ALIGNMENT aligned block. Rows are not
+ *    padded, so every dim1 x dim2 plane stays contiguous.
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************
+ */
+int get_mem3Dpel_aligned(imgpel ****array3D, int dim0, int dim1, int dim2)
+{
+  int i;
+
+  if(((*array3D) = (imgpel***)malloc(dim0 * sizeof(imgpel**))) == NULL)
+    no_mem_exit("get_mem3Dpel_aligned: array3D");
+  if(((**array3D) = (imgpel**)malloc(dim0 * dim1 * sizeof(imgpel*))) == NULL)
+    no_mem_exit("get_mem3Dpel_aligned: array3D");
+  if((***array3D = (imgpel*)mem_calloc_aligned(dim0 * dim1 * dim2 * sizeof(imgpel))) == NULL)
+    no_mem_exit("get_mem3Dpel_aligned: array3D");
+
+  for(i = 1; i < dim0 * dim1; i++)
+    (**array3D)[i] = (**array3D)[i - 1] + dim2;
+  for(i = 1; i < dim0; i++)
+    (*array3D)[i] = (*array3D)[i - 1] + dim1;
+
+  return dim0 * (sizeof(imgpel**) + dim1 * (sizeof(imgpel*) + dim2 * sizeof(imgpel)));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate 3D memory array -> int array3D[dim0][dim1][dim2]
+ *    with the samples in one MEM_ALIGNMENT aligned block. Rows are not
+ *    padded, so every dim1 x dim2 plane stays contiguous.
+ *
+ * \par Output:
+ *    memory size in bytes
+ ************************************************************************
+ */
+int get_mem3Dint_aligned(int ****array3D, int dim0, int dim1, int dim2)
+{
+  int i;
+
+  if(((*array3D) = (int***)malloc(dim0 * sizeof(int**))) == NULL)
+    no_mem_exit("get_mem3Dint_aligned: array3D");
+  if(((**array3D) = (int**)malloc(dim0 * dim1 * sizeof(int*))) == NULL)
+    no_mem_exit("get_mem3Dint_aligned: array3D");
+  if((***array3D = (int*)mem_calloc_aligned(dim0 * dim1 * dim2 * sizeof(int))) == NULL)
+    no_mem_exit("get_mem3Dint_aligned: array3D");
+
+  for(i = 1; i < dim0 * dim1; i++)
+    (**array3D)[i] = (**array3D)[i - 1] + dim2;
+  for(i = 1; i < dim0; i++)
+    (*array3D)[i] = (*array3D)[i - 1] + dim1;
+
+  return dim0 * (sizeof(int**) + dim1 * (sizeof(int*) + dim2 * sizeof(int)));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    free 3D memory array
+ *    which was allocated with get_mem3Dpel_aligned()
+ ************************************************************************
+ */
+void free_mem3Dpel_aligned(imgpel ***array3D)
+{
+  if (array3D && *array3D)
+  {
+    mem_free_aligned(**array3D);
+    free (*array3D);
+    free (array3D);
+  }
+  else
+  {
+    error ("free_mem3Dpel_aligned: trying to free unused memory",100);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    free 3D memory array
+ *    which was allocated with get_mem3Dint_aligned()
+ ************************************************************************
+ */
+void free_mem3Dint_aligned(int ***array3D)
+{
+  if (array3D && *array3D)
+  {
+    mem_free_aligned(**array3D);
+    free (*array3D);
+    free (array3D);
+  }
+  else
+  {
+    error ("free_mem3Dint_aligned: trying to free unused memory",100);
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -549,3 +549,277 @@ void inverse8x8(int **tblock, int **block, int pos_y, int pos_x)
 }
 
 #endif
+
+
+/*
+ * Inverse transforms with reconstruction
+ *
+ * These work on contiguous blocks (rows of stride elements, as allocated by
+ * get_mem2Dint()/get_mem2Dpel()) instead of row pointer tables and fuse the
+ * inverse transform, rounding, adding the prediction and clipping. The
+ * transformed residual is still written to rres, the decoder inspector reads it.
+ * The results are bit-exact to inverse4x4()/inverse8x8() followed by
+ * sample_reconstruct().
+ */
+
+#if defined(__SSE2__) && (IMGTYPE < 2)
+#include <emmintrin.h>
+
+#define TRANSPOSE4x4_EPI32(r0, r1, r2, r3)    \
+{                                             \
+  __m128i t0 = _mm_unpacklo_epi32(r0, r1);    \
+  __m128i t1 = _mm_unpacklo_epi32(r2, r3);    \
+  __m128i t2 = _mm_unpackhi_epi32(r0, r1);    \
+  __m128i t3 = _mm_unpackhi_epi32(r2, r3);    \
+  r0 = _mm_unpacklo_epi64(t0, t1);            \
+  r1 = _mm_unpackhi_epi64(t0, t1);            \
+  r2 = _mm_unpacklo_epi64(t2, t3);            \
+  r3 = _mm_unpackhi_epi64(t2, t3);            \
+}
+
+//! 4 point inverse transform of 4 columns at once
+static inline void inverse4_sse2(__m128i v[4])
+{
+  __m128i p0 = _mm_add_epi32(v[0], v[2]);
+  __m128i p1 = _mm_sub_epi32(v[0], v[2]);
+  __m128i p2 = _mm_sub_epi32(_mm_srai_epi32(v[1], 1), v[3]);
+  __m128i p3 = _mm_add_epi32(v[1], _mm_srai_epi32(v[3], 1));
+
+  v[0] = _mm_add_epi32(p0, p3);
+  v[1] = _mm_add_epi32(p1, p2);
+  v[2] = _mm_sub_epi32(p1, p2);
+  v[3] = _mm_sub_epi32(p0, p3);
+}
+
+//! 8 point inverse transform of 4 columns at once
+static inline void inverse8_sse2(__m128i v[8])
+{
+  __m128i a0, a1, a2, a3;
+  __m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+  a0 = _mm_add_epi32(v[0], v[4]);
+  a1 = _mm_sub_epi32(v[0], v[4]);
+  a2 = _mm_sub_epi32(v[6], _mm_srai_epi32(v[2], 1));
+  a3 = _mm_add_epi32(v[2], _mm_srai_epi32(v[6], 1));
+
+  b0 = _mm_add_epi32(a0, a3);
+  b2 = _mm_sub_epi32(a1, a2);
+  b4 = _mm_add_epi32(a1, a2);
+  b6 = _mm_sub_epi32(a0, a3);
+
+  // a0 = -p3 + p5 - p7 - (p7 >> 1), a1 = p1 + p7 - p3 - (p3 >> 1)
+  // a2 = -p1 + p7 + p5 + (p5 >> 1), a3 = p3 + p5 + p1 + (p1 >> 1)
+  a0 = _mm_sub_epi32(_mm_sub_epi32(_mm_sub_epi32(v[5], v[3]), v[7]), _mm_srai_epi32(v[7], 1));
+  a1 = _mm_sub_epi32(_mm_sub_epi32(_mm_add_epi32(v[1], v[7]), v[3]), _mm_srai_epi32(v[3], 1));
+  a2 = _mm_add_epi32(_mm_add_epi32(_mm_sub_epi32(v[7], v[1]), v[5]), _mm_srai_epi32(v[5], 1));
+  a3 = _mm_add_epi32(_mm_add_epi32(_mm_add_epi32(v[3], v[5]), v[1]), _mm_srai_epi32(v[1], 1));
+
+  b1 = _mm_add_epi32(a0, _mm_srai_epi32(a3, 2));
+  b3 = _mm_add_epi32(a1, _mm_srai_epi32(a2, 2));
+  b5 = _mm_sub_epi32(a2, _mm_srai_epi32(a1, 2));
+  b7 = _mm_sub_epi32(a3, _mm_srai_epi32(a0, 2));
+
+  v[0] = _mm_add_epi32(b0, b7);
+  v[1] = _mm_sub_epi32(b2, b5);
+  v[2] = _mm_add_epi32(b4, b3);
+  v[3] = _mm_add_epi32(b6, b1);
+  v[4] = _mm_sub_epi32(b6, b1);
+  v[5] = _mm_sub_epi32(b4, b3);
+  v[6] = _mm_add_epi32(b2, b5);
+  v[7] = _mm_sub_epi32(b0, b7);
+}
+
+//! stores 4 residual samples and the reconstruction of 4 pixels
+static inline void recon4_sse2(__m128i res, int *rres, imgpel *pred, imgpel *rec, __m128i max_value)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(1 << (DQ_BITS - 1));
+  __m128i pix;
+
+  _mm_storeu_si128((__m128i *) rres, res);
+  res = _mm_srai_epi32(_mm_add_epi32(res, round), DQ_BITS);
+
+#if (IMGTYPE == 0)
+  {
+    int p;
+    memcpy(&p, pred, sizeof(int));
+    pix = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(p), zero), zero);
+  }
+#else
+  pix = _mm_unpacklo_epi16(_mm_loadl_epi64((__m128i *) pred), zero);
+#endif
+
+  // saturating to 16 bits first does not change the clipping to [0, max_value]
+  pix = _mm_packs_epi32(_mm_add_epi32(res, pix), zero);
+  pix = _mm_min_epi16(_mm_max_epi16(pix, zero), max_value);
+
+#if (IMGTYPE == 0)
+  {
+    int p = _mm_cvtsi128_si32(_mm_packus_epi16(pix, zero));
+    memcpy(rec, &p, sizeof(int));
+  }
+#else
+  _mm_storel_epi64((__m128i *) rec, pix);
+#endif
+}
+
+void inverse4x4_recon(int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride,
+                      int width, int height, int max_imgpel_value)
+{
+  const __m128i max_value = _mm_set1_epi16((short) max_imgpel_value);
+  __m128i v[4];
+  int x, y, j;
+
+  for (y = 0; y < height; y += BLOCK_SIZE)
+  {
+    for (x = 0; x < width; x += BLOCK_SIZE)
+    {
+      int *src = tblock + y * coef_stride + x;
+
+      for (j = 0; j < BLOCK_SIZE; j++)
+        v[j] = _mm_loadu_si128((__m128i *) (src + j * coef_stride));
+
+      // horizontal pass on the columns of the transposed block, vertical pass on the rows
+      TRANSPOSE4x4_EPI32(v[0], v[1], v[2], v[3]);
+      inverse4_sse2(v);
+      TRANSPOSE4x4_EPI32(v[0], v[1], v[2], v[3]);
+      inverse4_sse2(v);
+
+      for (j = 0; j < BLOCK_SIZE; j++)
+        recon4_sse2(v[j], rres + (y + j) * coef_stride + x, pred + (y + j) * pel_stride + x,
+          rec + (y + j) * pel_stride + x, max_value);
+    }
+  }
+}
+
+void inverse8x8_recon(int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride,
+                      int width, int height, int max_imgpel_value)
+{
+  const __m128i max_value = _mm_set1_epi16((short) max_imgpel_value);
+  __m128i lo[8], hi[8];   // columns 0-3 and 4-7
+  int x, y, j;
+
+  for (y = 0; y < height; y += BLOCK_SIZE_8x8)
+  {
+    for (x = 0; x < width; x += BLOCK_SIZE_8x8)
+    {
+      int *src = tblock + y * coef_stride + x;
+
+      for (j = 0; j < BLOCK_SIZE_8x8; j++)
+      {
+        lo[j] = _mm_loadu_si128((__m128i *) (src + j * coef_stride));
+        hi[j] = _mm_loadu_si128((__m128i *) (src + j * coef_stride + 4));
+      }
+
+      // transpose, lo[] then holds the columns of rows 0-3 and hi[] those of rows 4-7
+      TRANSPOSE4x4_EPI32(lo[0], lo[1], lo[2], lo[3]);
+      TRANSPOSE4x4_EPI32(hi[0], hi[1], hi[2], hi[3]);
+      TRANSPOSE4x4_EPI32(lo[4], lo[5], lo[6], lo[7]);
+      TRANSPOSE4x4_EPI32(hi[4], hi[5], hi[6], hi[7]);
+      {
+        __m128i t[4];
+
+        for (j = 0; j < 4; j++)
+        {
+          t[j] = lo[j + 4];
+          lo[j + 4] = hi[j];
+          hi[j] = t[j];
+        }
+      }
+
+      inverse8_sse2(lo);
+      inverse8_sse2(hi);
+
+      // transpose back to rows
+      TRANSPOSE4x4_EPI32(lo[0], lo[1], lo[2], lo[3]);
+      TRANSPOSE4x4_EPI32(hi[0], hi[1], hi[2], hi[3]);
+      TRANSPOSE4x4_EPI32(lo[4], lo[5], lo[6], lo[7]);
+      TRANSPOSE4x4_EPI32(hi[4], hi[5], hi[6], hi[7]);
+      {
+        __m128i t[4];
+
+        for (j = 0; j < 4; j++)
+        {
+          t[j] = lo[j + 4];
+          lo[j + 4] = hi[j];
+          hi[j] = t[j];
+        }
+      }
+
+      inverse8_sse2(lo);
+      inverse8_sse2(hi);
+
+      for (j = 0; j < BLOCK_SIZE_8x8; j++)
+      {
+        int    *res_row  = rres + (y + j) * coef_stride + x;
+        imgpel *pred_row = pred + (y + j) * pel_stride + x;
+        imgpel *rec_row  = rec  + (y + j) * pel_stride + x;
+
+        recon4_sse2(lo[j], res_row,     pred_row,     rec_row,     max_value);
+        recon4_sse2(hi[j], res_row + 4, pred_row + 4, rec_row + 4, max_value);
+      }
+    }
+  }
+}
+
+#else
+
+static void recon_block(int *tmp, int size, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride, int max_imgpel_value)
+{
+  int i, j;
+
+  for (j = 0; j < size; j++)
+  {
+    for (i = 0; i < size; i++)
+    {
+      rres[j * coef_stride + i] = tmp[j * size + i];
+      rec[j * pel_stride + i] = (imgpel) iClip1(max_imgpel_value, pred[j * pel_stride + i] + rshift_rnd_sf(tmp[j * size + i], DQ_BITS));
+    }
+  }
+}
+
+void inverse4x4_recon(int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride,
+                      int width, int height, int max_imgpel_value)
+{
+  int tmp[16], *rows[BLOCK_SIZE], *out_rows[BLOCK_SIZE];
+  int x, y, j;
+
+  for (y = 0; y < height; y += BLOCK_SIZE)
+  {
+    for (x = 0; x < width; x += BLOCK_SIZE)
+    {
+      for (j = 0; j < BLOCK_SIZE; j++)
+      {
+        rows[j] = tblock + (y + j) * coef_stride + x;
+        out_rows[j] = tmp + j * BLOCK_SIZE;
+      }
+      inverse4x4(rows, out_rows, 0, 0);
+      recon_block(tmp, BLOCK_SIZE, rres + y * coef_stride + x, coef_stride, pred + y * pel_stride + x,
+        rec + y * pel_stride + x, pel_stride, max_imgpel_value);
+    }
+  }
+}
+
+void inverse8x8_recon(int *tblock, int *rres, int coef_stride, imgpel *pred, imgpel *rec, int pel_stride,
+                      int width, int height, int max_imgpel_value)
+{
+  int tmp[64], *rows[BLOCK_SIZE_8x8], *out_rows[BLOCK_SIZE_8x8];
+  int x, y, j;
+
+  for (y = 0; y < height; y += BLOCK_SIZE_8x8)
+  {
+    for (x = 0; x < width; x += BLOCK_SIZE_8x8)
+    {
+      for (j = 0; j < BLOCK_SIZE_8x8; j++)
+      {
+        rows[j] = tblock + (y + j) * coef_stride + x;
+        out_rows[j] = tmp + j * BLOCK_SIZE_8x8;
+      }
+      inverse8x8(rows, out_rows, 0, 0);
+      recon_block(tmp, BLOCK_SIZE_8x8, rres + y * coef_stride + x, coef_stride, pred + y * pel_stride + x,
+        rec + y * pel_stride + x, pel_stride, max_imgpel_value);
+    }
+  }
+}
+
+#endif
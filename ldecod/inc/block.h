@@ -113,6 +113,7 @@ extern void Inv_Residual_trans_4x4(Macroblock *currMB, ColorPlane pl, int ioff,
 extern void Inv_Residual_trans_8x8(Macroblock *currMB, ColorPlane pl, int ioff,int joff);
 
 extern void itrans4x4   (Macroblock *currMB, ColorPlane pl, int ioff, int joff);
+extern void itrans4x4_mb(Macroblock *currMB, ColorPlane pl, int width, int height);
 extern void itrans4x4_ls(Macroblock *currMB, ColorPlane pl, int ioff, int joff);
 extern void itrans_sp   (Macroblock *currMB, ColorPlane pl, int ioff, int joff);
 extern int  intrapred   (Macroblock *currMB, ColorPlane pl, int ioff,int joff,int i4,int j4);
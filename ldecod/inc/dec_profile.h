@@ -0,0 +1,69 @@
+
+/*!
+ ************************************************************************
+ * \file
+ *    dec_profile.h
+ *
+ * \brief
+ *    Per-stage decoder profiling counters
+ *
+ *    Build with DEC_PROFILE=1 (make PROF=1) to enable. When disabled all
+ *    DEC_PROF_* macros expand to empty statements. Stages may nest, the
+ *    time of a nested stage is not counted again in the enclosing one.
+ ************************************************************************
+ */
+
+#ifndef _DEC_PROFILE_H_
+#define _DEC_PROFILE_H_
+
+#ifndef DEC_PROFILE
+#define DEC_PROFILE 0
+#endif
+
+//! decoder stages with their own counters
+typedef enum
+{
+  PROF_NAL_READ = 0,  //!< read_new_slice(): NAL unit reading and slice header parsing
+  PROF_ENTROPY,       //!< read_one_macroblock(): entropy decoding
+  PROF_RECON,         //!< decode_one_macroblock(): reconstruction, the next three are nested in it
+  PROF_INTRA,         //!< intra prediction
+  PROF_MC,            //!< motion compensated prediction
+  PROF_ITRANS,        //!< inverse transform and reconstruction
+  PROF_DEBLOCK,       //!< DeblockPicture()
+  PROF_OUTPUT,        //!< write_stored_frame()
+  PROF_INSPECT,       //!< inspector hooks
+  PROF_NUM_STAGES
+} DecProfileStage;
+
+#if (DEC_PROFILE)
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define dec_prof_ticks() ((unsigned long long) __rdtsc())
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#define dec_prof_ticks() ((unsigned long long) __rdtsc())
+#else
+extern unsigned long long dec_prof_ticks(void);
+#endif
+
+extern void dec_profile_init        (void);
+extern void dec_profile_set_slice_type(int slice_type);
+extern void dec_profile_start       (int stage);
+extern void dec_profile_stop        (int stage);
+extern void dec_profile_set_filename(char *filename);
+extern void dec_profile_report      (int num_frames);
+
+#define DEC_PROF_START(stage)            dec_profile_start(stage)
+#define DEC_PROF_STOP(stage)             dec_profile_stop(stage)
+#define DEC_PROF_SET_SLICE_TYPE(type)    dec_profile_set_slice_type(type)
+
+#else
+
+#define DEC_PROF_START(stage)            ((void) 0)
+#define DEC_PROF_STOP(stage)             ((void) 0)
+#define DEC_PROF_SET_SLICE_TYPE(type)    ((void) 0)
+
+#endif
+
+#endif
@@ -36,6 +36,8 @@ typedef struct frame_s
   imgpel *yptr;
   imgpel *uptr;
   imgpel *vptr;
+  int     ystride;    //!< row stride of yptr in samples
+  int     uvstride;   //!< row stride of uptr and vptr in samples
 } frame;
 
 //! region structure stores information about a region that is needed for concealment
@@ -61,6 +61,14 @@ typedef enum
   CbComp = 2
 } Color_Component;
 
+//! selective decoding mode of a picture (inspection workflow)
+typedef enum
+{
+  DEC_FULL       = 0,  //!< parse and reconstruct
+  DEC_PARSE_ONLY = 1,  //!< parse macroblocks only, no reconstruction, deblocking or output
+  DEC_SKIP       = 2   //!< do not decode the slice data at all
+} SelectiveDecMode;
+
 /***********************************************************************
  * D a t a    t y p e s   f o r  C A B A C
  ***********************************************************************
@@ -325,6 +333,17 @@ typedef struct datapartition
                entropy coding method  */
 } DataPartition;
 
+//! Samples around the current intra macroblock, gathered once per macroblock and colour plane
+typedef struct intra_neighbours
+{
+  imgpel up[2 * MB_BLOCK_SIZE + 1];   //!< p(-1..31,-1)
+  imgpel left[MB_BLOCK_SIZE];         //!< p(-1,0..15)
+  byte   left_avail[MB_BLOCK_SIZE];   //!< availability of each left sample (constrained intra included)
+  byte   up_avail;                    //!< availability of p(0..15,-1)
+  byte   up_left_avail;               //!< availability of p(-1,-1)
+  byte   up_right_avail;              //!< availability of p(16..31,-1)
+} IntraNeighbours;
+
 //! Slice
 typedef struct slice
 {
@@ -391,7 +410,9 @@ typedef struct slice
 
   imgpel **tmp_block_l0;
   imgpel **tmp_block_l1;  
+  imgpel **tmp_block_cr[2][2];  //!< chroma prediction blocks [list][uv]
   int    **tmp_res;
+  IntraNeighbours intra_nb;     //!< neighbours of the current intra macroblock
 
   // Scaling matrix info
   int  InvLevelScale4x4_Intra[3][6][4][4];
@@ -610,6 +631,10 @@ typedef struct video_par
   unsigned int frame_to_conceal;
   int IDR_concealment_flag;
   int conceal_slice_type;
+  struct storable_picture *picture_pool;  //!< freed frame kept for the next lost frame, see alloc_pooled_picture()
+
+  // selective decoding
+  int dec_mode;                    //!< SelectiveDecMode of the current picture
 
   // random access point decoding
   int recovery_point;
@@ -684,6 +709,7 @@ typedef struct video_par
 
   struct annex_b_struct *annex_b;
   struct sBitsFile *bitsfile;
+  struct nalu_t *nalu;                 //!< NAL unit buffer, reused for every NAL unit of the stream
 
 
   struct frame_store *out_buffer;
@@ -765,6 +791,12 @@ typedef struct inp_par
   int ref_poc_gap;
   int poc_gap;
 
+  // selective decoding (inspection workflow)
+  int parse_only;                         //!< skip reconstruction of non-reference pictures
+  int select_slice_types;                 //!< bit mask (1 << slice type) of pictures to inspect, 0: all
+  int select_first_frame;                 //!< first frame (display order) to inspect
+  int select_last_frame;                  //!< last frame (display order) to inspect, -1: no limit
+
   // dummy for encoder
   int start_frame;
   int bEncoderLog;
@@ -0,0 +1,30 @@
+/*!
+ *************************************************************************************
+ * \file intra_pred_common.h
+ *
+ * \brief
+ *    definitions for the neighbour handling shared by the intra prediction modes
+ *
+ *************************************************************************************
+ */
+
+#ifndef _INTRA_PRED_COMMON_H_
+#define _INTRA_PRED_COMMON_H_
+
+#include "global.h"
+
+//! availability of the predictor pels of one intra block
+typedef struct intra_block_avail
+{
+  int left;
+  int up;
+  int up_left;
+  int up_right;
+} IntraBlockAvail;
+
+extern void get_intra_neighbours(Macroblock *currMB, ColorPlane pl);
+extern void get_intra_pred_pels (Macroblock *currMB, ColorPlane pl, int ioff, int joff, int bsize, imgpel *PredPel, IntraBlockAvail *avail);
+extern void filter_pels_121     (imgpel *dst, const imgpel *src, int n);
+
+#endif
+
@@ -49,10 +49,12 @@ typedef struct storable_picture
   int         top_poc;
   int         bottom_poc;
   int         frame_poc;
-  int64       ref_pic_num        [MAX_NUM_SLICES][6][MAX_LIST_SIZE];
-  int64       frm_ref_pic_num    [MAX_NUM_SLICES][6][MAX_LIST_SIZE];
-  int64       top_ref_pic_num    [MAX_NUM_SLICES][6][MAX_LIST_SIZE];
-  int64       bottom_ref_pic_num [MAX_NUM_SLICES][6][MAX_LIST_SIZE];
+  // [MAX_NUM_SLICES][6][MAX_LIST_SIZE] each, one allocation cleared on demand, see clear_ref_pic_num()
+  int64     (*ref_pic_num)       [6][MAX_LIST_SIZE];
+  int64     (*frm_ref_pic_num)   [6][MAX_LIST_SIZE];
+  int64     (*top_ref_pic_num)   [6][MAX_LIST_SIZE];
+  int64     (*bottom_ref_pic_num)[6][MAX_LIST_SIZE];
+  short       ref_pic_num_rows;  //!< number of slice rows of the ref_pic_num tables cleared so far
   unsigned    frame_num;
   unsigned    recovery_frame;
 
@@ -64,6 +66,7 @@ typedef struct storable_picture
   int         used_for_reference;
   int         is_output;
   int         non_existing;
+  int         recon_skipped;   //!< samples were not reconstructed (selective decoding)
 
   short       max_slice_id;
 
@@ -78,6 +81,8 @@ typedef struct storable_picture
   imgpel **     imgY;         //!< Y picture component
   imgpel ***    imgUV;        //!< U and V picture components
   imgpel ***    img_comp;     //!< Y,U, and V components
+  PicPlane      planeY;       //!< aligned storage of imgY
+  PicPlane      planeUV[2];   //!< aligned storage of imgUV
 
   struct pic_motion_params motion;              //!< Motion info
   struct pic_motion_params JVmotion[MAX_PLANE]; //!< Motion info for 4:4:4 independent mode decoding
@@ -185,6 +190,9 @@ extern FrameStore*      alloc_frame_store(void);
 extern void             free_frame_store(VideoParameters *p_Vid, FrameStore* f);
 extern StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure type, int size_x, int size_y, int size_x_cr, int size_y_cr);
 extern void             free_storable_picture (VideoParameters *p_Vid, StorablePicture* p);
+extern void             clear_ref_pic_num(StorablePicture* p, int max_slice_id);
+extern StorablePicture* alloc_pooled_picture(VideoParameters *p_Vid);
+extern void             free_pooled_picture(VideoParameters *p_Vid);
 extern void             store_picture_in_dpb(VideoParameters *p_Vid, StorablePicture* p);
 extern void             flush_dpb(VideoParameters *p_Vid);
 
@@ -17,6 +17,24 @@ enum {
 } MB_TYPE;
 
 
+//! one non-zero coefficient of the sparse coefficient list
+typedef struct inspect_coeff
+{
+  int  mb;     //!< macroblock address (mb_y * PicWidthInMbs + mb_x)
+  byte pl;     //!< colour plane
+  byte block;  //!< transform block index inside the macroblock (raster order)
+  byte pos;    //!< coefficient position inside the transform block (raster order)
+  int  level;  //!< coefficient value
+} InspectCoeff;
+
+typedef struct inspect_coeff_list
+{
+  InspectCoeff* coeffs;
+  int num;
+  int size;
+} InspectCoeffList;
+
+
 typedef struct inspector
 {
   float*** coeffs; // of size (H, W, 3)
@@ -24,6 +42,22 @@ typedef struct inspector
   uint8** img_type; // of size (H, W)
   uint8*** img_mv; // of size (H, W, 2)
 
+  // compact storage at macroblock granularity, of size (H/16, W/16)
+  uint8** mb_type;
+  int** mb_qp;
+  uint8** mb_skip;
+  uint8** mb_transform_8x8;
+  int** mb_cbp;
+  InspectCoeffList coeff_list; // non-zero coefficients only
+
+  int mb_height;
+  int mb_width;
+  int mb_cr_size_x; // chroma macroblock size, 8x8 (4:2:0), 8x16 (4:2:2) or 16x16 (4:4:4)
+  int mb_cr_size_y;
+  int yuv_format;
+  int qp_offset; // QpBdOffsetY, makes the exported QP non-negative
+  uint8 compact;
+
   int height;
   int width;
   int channel;
@@ -34,6 +68,8 @@ typedef struct inspector
   int poc_offset;
 
   uint8 is_exported;
+  uint8 is_selected; // passes the selective decoding filters
+  uint8 has_residual; // the picture is reconstructed, -parse_only leaves residual empty
 
 } Inspector;
 
@@ -41,9 +77,13 @@ typedef struct inspector
 void extract_coeffs(Macroblock* currMB, Slice* currSlice, float*** out_coeffs);
 void extract_residual(Macroblock* currMB, Slice* currSlice, float*** out_residual);
 void extract_mb_type(Macroblock* currMB, Slice* currSlice, int mb_type, uint8** img_type);
+void extract_mb_info(Macroblock* currMB, Slice* currSlice, int mb_type, Inspector* inspector);
+void extract_coeffs_sparse(Macroblock* currMB, Slice* currSlice, Inspector* inspector);
 
 
 void inspect_pic_type(Inspector* inspector, int type);
+void inspect_set_selected(Inspector* inspector, int selected);
+void inspect_set_residual(Inspector* inspector, int has_residual);
 void init_inspector(Inspector** inspector, VideoParameters* p_Vid, int num_display);
 void free_inspector(Inspector** inspector);
 int export_from_inspector(Inspector* inspector);
@@ -52,5 +92,7 @@ void inspect_poc_offset(Inspector* inspector, int offset);
 
 void save_mb_type(int mb_type);
 void inspect_set_savedir(char* location);
+void inspect_set_compact(int compact);
+void inspect_set_export(int enable); // 0: write no files, e.g. to time the decoding alone
 
 #endif
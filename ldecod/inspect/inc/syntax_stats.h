@@ -0,0 +1,37 @@
+#ifndef _SYNTAX_STATS_H_
+#define _SYNTAX_STATS_H_
+
+/*
+ * Parse-only syntax statistics (-syntax_stats <file>)
+ *
+ * Per macroblock syntax records are written to a columnar binary file
+ * (host byte order):
+ *
+ *   header   : "JMSS", uint32 version, uint32 num_columns,
+ *              num_columns x { char name[16], uint32 elem_size, uint32 elems_per_mb }
+ *   picture  : uint32 frame_id, int32 display_nr, uint8 slice_type, uint8 structure,
+ *              uint16 reserved, uint32 num_mb,
+ *              then for every column num_mb * elems_per_mb elements of elem_size bytes
+ *   index    : num_pictures x { int64 offset, uint32 frame_id, int32 display_nr, uint32 num_mb }
+ *   trailer  : int64 index_offset, uint32 num_pictures, "JMSI"
+ *
+ * The trailer has a fixed size, so readers can seek to the end of the file,
+ * load the index and access any picture directly.
+ */
+
+#include "global.h"
+
+#define SYNTAX_STATS_VERSION 1
+
+void syntax_stats_set_filename(char* filename);
+char* syntax_stats_get_filename();
+int syntax_stats_enabled();
+
+int syntax_stats_open();
+void syntax_stats_close();
+
+void syntax_stats_start_picture(int frame_id, int display_nr, int slice_type, int structure, int selected);
+int syntax_stats_bits_read(Slice* currSlice);
+void syntax_stats_add_mb(Macroblock* currMB, Slice* currSlice, int mb_type, int bits);
+
+#endif
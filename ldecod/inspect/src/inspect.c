@@ -2,6 +2,20 @@
 
 #include "iio.h"
 #include "memalloc.h"
+#include "syntax_stats.h"
+
+/**
+ * \param currMB
+ * \param currSlice
+ * \param pl the colour plane
+ * \return the coefficient plane of the current macroblock, 8x8 transform blocks are dequantized into mb_rres
+ */
+static int** get_coeff_plane(Macroblock* currMB, Slice* currSlice, int pl) {
+  if (currMB->luma_transform_size_8x8_flag && (pl == 0 || currSlice->p_Vid->yuv_format == YUV444)) {
+    return currSlice->mb_rres[pl];
+  }
+  return currSlice->cof[pl];
+}
 
 /**
  * \param currMB
@@ -11,36 +25,23 @@
 void extract_coeffs(Macroblock* currMB, Slice* currSlice, float*** out_coeffs) {
   int pos_x = currMB->mb_x * MB_BLOCK_SIZE;
   int pos_y = currMB->mb_y * MB_BLOCK_SIZE;
+  int cr_size_x = currSlice->p_Vid->mb_cr_size_x;
+  int cr_size_y = currSlice->p_Vid->mb_cr_size_y;
 
   int pl, i, j;
-  if (currMB->luma_transform_size_8x8_flag) {
-    // Luma
-    for (i = 0; i < 16; i++) {
-      for (j = 0; j < 16; j++) {
-        out_coeffs[0][pos_y + i][pos_x + j] = (&currSlice->mb_rres[0][0])[i][j];
-      }
-    }
-    // Chroma
-    for (pl = 1; pl <= 2; pl++) {
-      for (i = 0; i < 8; i++) {
-        for (j = 0; j < 8; j++) {
-          out_coeffs[pl][pos_y + i][pos_x + j] = currSlice->cof[pl][i][j];
-        }
-      }
+  // Luma
+  int** cof = get_coeff_plane(currMB, currSlice, 0);
+  for (i = 0; i < 16; i++) {
+    for (j = 0; j < 16; j++) {
+      out_coeffs[0][pos_y + i][pos_x + j] = cof[i][j];
     }
-  } else {
-    // Luma
-    for (i = 0; i < 16; i++) {
-      for (j = 0; j < 16; j++) {
-        out_coeffs[0][pos_y + i][pos_x + j] = currSlice->cof[0][i][j];
-      }
-    }
-    // Chroma
-    for (pl = 1; pl <= 2; pl++) {
-      for (i = 0; i < 8; i++) {
-        for (j = 0; j < 8; j++) {
-          out_coeffs[pl][pos_y + i][pos_x + j] = currSlice->cof[pl][i][j];
-        }
+  }
+  // Chroma
+  for (pl = 1; pl <= 2; pl++) {
+    cof = get_coeff_plane(currMB, currSlice, pl);
+    for (i = 0; i < cr_size_y; i++) {
+      for (j = 0; j < cr_size_x; j++) {
+        out_coeffs[pl][pos_y + i][pos_x + j] = cof[i][j];
       }
     }
   }
@@ -66,15 +67,31 @@ void extract_residual(Macroblock* currMB, Slice* currSlice, float*** out_residua
   }
 }
 
+static uint8 g_compact = 0;
+static uint8 g_export = 1;
+
 /**
- * \param currMB
- * \param img_type the macroblock type (0 for undefined, 1 for I, 2 for P, and 3 for skip block)
- *  of size (H, W)
+ * \param inspector a compact inspector
+ * \param pl the colour plane
+ * \param transform_8x8 the transform size flag of the macroblock
+ * \param size_x returns the width of the plane inside a macroblock
+ * \param size_y returns the height of the plane inside a macroblock
+ * \return the transform block size of the plane
  */
-void extract_mb_type(Macroblock* currMB, Slice* currSlice, int mb_type, uint8** img_type) {
-  const int pos_x = currMB->mb_x * MB_BLOCK_SIZE;
-  const int pos_y = currMB->mb_y * MB_BLOCK_SIZE;
+static int get_block_layout(Inspector* inspector, int pl, int transform_8x8, int* size_x, int* size_y) {
+  *size_x = (pl == 0) ? MB_BLOCK_SIZE : inspector->mb_cr_size_x;
+  *size_y = (pl == 0) ? MB_BLOCK_SIZE : inspector->mb_cr_size_y;
+  // 4:4:4 chroma is coded like luma
+  return (transform_8x8 && (pl == 0 || inspector->yuv_format == YUV444)) ? 8 : 4;
+}
 
+/**
+ * \param currMB
+ * \param currSlice
+ * \param mb_type the syntax element mb_type
+ * \return the macroblock type class (0 for undefined, 1 for I, 2 for P, and 3 for skip block)
+ */
+static int classify_mb_type(Macroblock* currMB, Slice* currSlice, int mb_type) {
   int value = UNDEFINED_MB;
   switch (currSlice->slice_type) {
     case SP_SLICE:
@@ -106,6 +123,19 @@ void extract_mb_type(Macroblock* currMB, Slice* currSlice, int mb_type, uint8**
       value = UNDEFINED_MB;
       break;
   }
+  return value;
+}
+
+/**
+ * \param currMB
+ * \param img_type the macroblock type (0 for undefined, 1 for I, 2 for P, and 3 for skip block)
+ *  of size (H, W)
+ */
+void extract_mb_type(Macroblock* currMB, Slice* currSlice, int mb_type, uint8** img_type) {
+  const int pos_x = currMB->mb_x * MB_BLOCK_SIZE;
+  const int pos_y = currMB->mb_y * MB_BLOCK_SIZE;
+
+  int value = classify_mb_type(currMB, currSlice, mb_type);
 
   for (int i = 0; i < 16; i++) {
     for (int j = 0; j < 16; j++) {
@@ -114,6 +144,67 @@ void extract_mb_type(Macroblock* currMB, Slice* currSlice, int mb_type, uint8**
   }
 }
 
+/**
+ * \param currMB
+ * \param currSlice
+ * \param mb_type the syntax element mb_type
+ * \param inspector stores type, QP, skip, transform size and CBP once per macroblock,
+ *  in arrays of size (H/16, W/16)
+ */
+void extract_mb_info(Macroblock* currMB, Slice* currSlice, int mb_type, Inspector* inspector) {
+  const int mb_x = currMB->mb_x;
+  const int mb_y = currMB->mb_y;
+
+  inspector->mb_type[mb_y][mb_x] = (uint8)classify_mb_type(currMB, currSlice, mb_type);
+  inspector->mb_qp[mb_y][mb_x] = currMB->qp;
+  inspector->mb_skip[mb_y][mb_x] = (uint8)(currMB->skip_flag == 1);
+  inspector->mb_transform_8x8[mb_y][mb_x] = (uint8)currMB->luma_transform_size_8x8_flag;
+  inspector->mb_cbp[mb_y][mb_x] = currMB->cbp;
+}
+
+static void append_coeff(InspectCoeffList* list, int mb, int pl, int block, int pos, int level) {
+  if (list->num == list->size) {
+    list->size = list->size ? 2 * list->size : 4096;
+    list->coeffs = (InspectCoeff*)realloc(list->coeffs, list->size * sizeof(InspectCoeff));
+    if (list->coeffs == NULL) no_mem_exit("append_coeff: coeffs");
+  }
+  list->coeffs[list->num].mb = mb;
+  list->coeffs[list->num].pl = (byte)pl;
+  list->coeffs[list->num].block = (byte)block;
+  list->coeffs[list->num].pos = (byte)pos;
+  list->coeffs[list->num].level = level;
+  list->num++;
+}
+
+/**
+ * \param currMB
+ * \param currSlice
+ * \param inspector appends the non-zero coefficients of the macroblock to its sparse list.
+ *  Luma uses 8x8 blocks when the 8x8 transform is selected, 4x4 blocks otherwise. Chroma uses
+ *  4x4 blocks over the 8x8 (4:2:0) or 8x16 (4:2:2) chroma macroblock; 4:4:4 chroma is laid out like luma.
+ */
+void extract_coeffs_sparse(Macroblock* currMB, Slice* currSlice, Inspector* inspector) {
+  const int mb = currMB->mb_y * inspector->mb_width + currMB->mb_x;
+  int pl, i, j, level;
+
+  for (pl = 0; pl < inspector->channel; pl++) {
+    int** cof = get_coeff_plane(currMB, currSlice, pl);
+    int size_x, size_y;
+    int bsize = get_block_layout(inspector, pl, currMB->luma_transform_size_8x8_flag, &size_x, &size_y);
+    int bshift = (bsize == 8) ? 3 : 2;
+    int bstride = size_x >> bshift;
+
+    for (i = 0; i < size_y; i++) {
+      for (j = 0; j < size_x; j++) {
+        if ((level = cof[i][j]) != 0) {
+          append_coeff(&inspector->coeff_list, mb, pl, (i >> bshift) * bstride + (j >> bshift),
+                       (i & (bsize - 1)) * bsize + (j & (bsize - 1)), level);
+        }
+      }
+    }
+  }
+}
+
 // /**
 //  * \param currMB
 //  * \param img_mv the motion vectors, of size (H, W). Each pixel is asigned with a mv.
@@ -157,57 +248,165 @@ void init_inspector(Inspector** inspector, VideoParameters* p_Vid, int num_displ
   (*inspector)->num_pic_stream = p_Vid->dec_picture->frame_id;
   (*inspector)->num_display = num_display + (*inspector)->poc_offset;
 
-  if (!(*inspector)->residual) {
-    get_mem3Dfloat(&((*inspector)->residual), 3, p_Vid->height, p_Vid->width);
-  }
-  float* data = &((*inspector)->residual[0][0][0]);
-  for (size_t i = 0; i < 3 * p_Vid->height * p_Vid->width; i++) {
-    data[i] = 0.0f;
+  (*inspector)->compact = g_compact;
+  (*inspector)->mb_height = p_Vid->height / MB_BLOCK_SIZE;
+  (*inspector)->mb_width = p_Vid->width / MB_BLOCK_SIZE;
+  (*inspector)->yuv_format = p_Vid->yuv_format;
+  (*inspector)->mb_cr_size_x = p_Vid->mb_cr_size_x;
+  (*inspector)->mb_cr_size_y = p_Vid->mb_cr_size_y;
+  (*inspector)->qp_offset = p_Vid->bitdepth_luma_qp_scale;
+
+  // syntax statistics only use the picture numbers, nothing is extracted or exported
+  if (syntax_stats_enabled()) {
+    (*inspector)->is_exported = 0;
+    (*inspector)->is_selected = 0;
+    return;
   }
 
-  if (!(*inspector)->coeffs) {
-    get_mem3Dfloat(&((*inspector)->coeffs), 3, p_Vid->height, p_Vid->width);
-  }
-  data = &((*inspector)->coeffs[0][0][0]);
-  for (size_t i = 0; i < 3 * p_Vid->height * p_Vid->width; i++) {
-    data[i] = 0.0f;
+  if ((*inspector)->compact) {
+    if (p_Vid->separate_colour_plane_flag) {
+      error("-inspect_compact does not support separate colour planes", 500);
+    }
+    if (p_Vid->yuv_format == YUV400) {
+      (*inspector)->channel = 1;
+    }
   }
 
-  if (!(*inspector)->img_type) {
-    get_mem2D(&((*inspector)->img_type), p_Vid->height, p_Vid->width);
-  }
-  uint8* data_uint8 = &((*inspector)->img_type[0][0]);
-  for (size_t i = 0; i < p_Vid->height * p_Vid->width; i++) {
-    data_uint8[i] = 0;
-  }
+  if ((*inspector)->compact) {
+    // macroblock level fields and sparse coefficients only
+    const int mb_height = (*inspector)->mb_height;
+    const int mb_width = (*inspector)->mb_width;
+
+    if (!(*inspector)->mb_type) {
+      get_mem2D(&((*inspector)->mb_type), mb_height, mb_width);
+      get_mem2Dint(&((*inspector)->mb_qp), mb_height, mb_width);
+      get_mem2D(&((*inspector)->mb_skip), mb_height, mb_width);
+      get_mem2D(&((*inspector)->mb_transform_8x8), mb_height, mb_width);
+      get_mem2Dint(&((*inspector)->mb_cbp), mb_height, mb_width);
+    }
+    memset(&((*inspector)->mb_type[0][0]), 0, mb_height * mb_width * sizeof(uint8));
+    memset(&((*inspector)->mb_qp[0][0]), 0, mb_height * mb_width * sizeof(int));
+    memset(&((*inspector)->mb_skip[0][0]), 0, mb_height * mb_width * sizeof(uint8));
+    memset(&((*inspector)->mb_transform_8x8[0][0]), 0, mb_height * mb_width * sizeof(uint8));
+    memset(&((*inspector)->mb_cbp[0][0]), 0, mb_height * mb_width * sizeof(int));
 
-  if (!(*inspector)->img_mv) {
-    get_mem3D(&((*inspector)->img_mv), p_Vid->height, p_Vid->width, 2);
-  }
-  data_uint8 = &((*inspector)->img_mv[0][0][0]);
-  for (size_t i = 0; i < p_Vid->height * p_Vid->width * 2; i++) {
-    data_uint8[i] = 0;
+    (*inspector)->coeff_list.num = 0;
+  } else {
+    if (!(*inspector)->residual) {
+      get_mem3Dfloat(&((*inspector)->residual), 3, p_Vid->height, p_Vid->width);
+    }
+    float* data = &((*inspector)->residual[0][0][0]);
+    for (size_t i = 0; i < 3 * p_Vid->height * p_Vid->width; i++) {
+      data[i] = 0.0f;
+    }
+
+    if (!(*inspector)->coeffs) {
+      get_mem3Dfloat(&((*inspector)->coeffs), 3, p_Vid->height, p_Vid->width);
+    }
+    data = &((*inspector)->coeffs[0][0][0]);
+    for (size_t i = 0; i < 3 * p_Vid->height * p_Vid->width; i++) {
+      data[i] = 0.0f;
+    }
+
+    if (!(*inspector)->img_type) {
+      get_mem2D(&((*inspector)->img_type), p_Vid->height, p_Vid->width);
+    }
+    uint8* data_uint8 = &((*inspector)->img_type[0][0]);
+    for (size_t i = 0; i < p_Vid->height * p_Vid->width; i++) {
+      data_uint8[i] = 0;
+    }
+
+    if (!(*inspector)->img_mv) {
+      get_mem3D(&((*inspector)->img_mv), p_Vid->height, p_Vid->width, 2);
+    }
+    data_uint8 = &((*inspector)->img_mv[0][0][0]);
+    for (size_t i = 0; i < p_Vid->height * p_Vid->width * 2; i++) {
+      data_uint8[i] = 0;
+    }
   }
 
   (*inspector)->is_exported = 0;
+  (*inspector)->is_selected = 1;
 }
 
 void free_inspector(Inspector** inspector) {
+  // nothing is allocated in syntax statistics mode
   if (*inspector) {
-    free_mem3Dfloat((*inspector)->coeffs);
-    free_mem3Dfloat((*inspector)->residual);
-    free_mem2D((*inspector)->img_type);
-    free_mem3D((*inspector)->img_mv);
+    if ((*inspector)->mb_type) {
+      free_mem2D((*inspector)->mb_type);
+      free_mem2Dint((*inspector)->mb_qp);
+      free_mem2D((*inspector)->mb_skip);
+      free_mem2D((*inspector)->mb_transform_8x8);
+      free_mem2Dint((*inspector)->mb_cbp);
+    }
+    free((*inspector)->coeff_list.coeffs);
+    if ((*inspector)->residual) {
+      free_mem3Dfloat((*inspector)->residual);
+      free_mem3Dfloat((*inspector)->coeffs);
+      free_mem2D((*inspector)->img_type);
+      free_mem3D((*inspector)->img_mv);
+    }
     free(*inspector);
   }
 }
 
 void inspect_pic_type(Inspector* inspector, int type) { inspector->pic_type = type; }
 
+void inspect_set_selected(Inspector* inspector, int selected) { inspector->is_selected = (uint8)selected; }
+
+void inspect_set_residual(Inspector* inspector, int has_residual) { inspector->has_residual = (uint8)has_residual; }
+
+/**
+ * \param inspector a compact inspector
+ * \param pic_type the picture type letter used in the file names
+ *
+ * Writes the macroblock fields as one (H/16, W/16, 5) uint8 array of (type, QP + QpBdOffsetY, skip,
+ * transform 8x8, CBP) and the coefficients as an (N, 5) int array of (mb, pl, block, pos, level) rows.
+ * No dense planes are written.
+ */
+static void export_compact(Inspector* inspector, char pic_type) {
+  const int num_mbs = inspector->mb_height * inspector->mb_width;
+  char fname[100];
+  uint8* fields;
+  int* rows;
+  int k;
+
+  fields = (uint8*)malloc(5 * num_mbs * sizeof(uint8));
+  if (fields == NULL) no_mem_exit("export_compact: fields");
+  for (k = 0; k < num_mbs; k++) {
+    fields[5 * k + 0] = (&inspector->mb_type[0][0])[k];
+    fields[5 * k + 1] = (uint8)((&inspector->mb_qp[0][0])[k] + inspector->qp_offset);
+    fields[5 * k + 2] = (&inspector->mb_skip[0][0])[k];
+    fields[5 * k + 3] = (&inspector->mb_transform_8x8[0][0])[k];
+    fields[5 * k + 4] = (uint8)(&inspector->mb_cbp[0][0])[k];
+  }
+  sprintf(fname, "%s/mbInfo_d%04d_s%04d_%c.npy", g_save_dir, inspector->num_display, inspector->num_pic_stream,
+          pic_type);
+  iio_write_image_uint8_vec(fname, fields, inspector->mb_width, inspector->mb_height, 5);
+  free(fields);
+
+  if (inspector->coeff_list.num > 0) {
+    rows = (int*)malloc(5 * inspector->coeff_list.num * sizeof(int));
+    if (rows == NULL) no_mem_exit("export_compact: rows");
+    for (k = 0; k < inspector->coeff_list.num; k++) {
+      InspectCoeff* c = &inspector->coeff_list.coeffs[k];
+      rows[5 * k + 0] = c->mb;
+      rows[5 * k + 1] = c->pl;
+      rows[5 * k + 2] = c->block;
+      rows[5 * k + 3] = c->pos;
+      rows[5 * k + 4] = c->level;
+    }
+    sprintf(fname, "%s/coeffs_d%04d_s%04d_%c.npy", g_save_dir, inspector->num_display, inspector->num_pic_stream,
+            pic_type);
+    iio_write_image_int(fname, rows, 5, inspector->coeff_list.num);
+    free(rows);
+  }
+}
+
 int export_from_inspector(Inspector* inspector) {
   printf("export_from_inspector(): \n");
 
-  if (inspector && inspector->is_exported == 0) {
+  if (inspector && inspector->is_exported == 0 && inspector->is_selected && g_export) {
     printf("num_stream=%d, num_display=%d \n", inspector->num_pic_stream, inspector->num_display);
     
     // float* data = &(inspector->residual[0][0][0]);
@@ -238,21 +437,28 @@ int export_from_inspector(Inspector* inspector) {
     if (strcmp(g_save_dir, "\0") == 0) {
       strcpy(g_save_dir, ".");
     }
-    sprintf(fname, "%s/imgY_d%04d_s%04d_%c.npy", g_save_dir, inspector->num_display, inspector->num_pic_stream,
-            pic_type);
-    iio_write_image_float(fname, &(inspector->residual[0][0][0]), inspector->width, inspector->height);
-
-    sprintf(fname, "%s/imgU_d%04d_s%04d_%c.npy", g_save_dir, inspector->num_display, inspector->num_pic_stream, 
-            pic_type);
-    iio_write_image_float(fname, &(inspector->residual[1][0][0]), inspector->width, inspector->height);
-
-    sprintf(fname, "%s/imgV_d%04d_s%04d_%c.npy", g_save_dir, inspector->num_display, inspector->num_pic_stream, 
-            pic_type);
-    iio_write_image_float(fname, &(inspector->residual[2][0][0]), inspector->width, inspector->height);
+    if (inspector->compact) {
+      export_compact(inspector, pic_type);
+    } else {
+      // pictures that are only parsed have no residual to write
+      if (inspector->has_residual) {
+        sprintf(fname, "%s/imgY_d%04d_s%04d_%c.npy", g_save_dir, inspector->num_display, inspector->num_pic_stream,
+                pic_type);
+        iio_write_image_float(fname, &(inspector->residual[0][0][0]), inspector->width, inspector->height);
+
+        sprintf(fname, "%s/imgU_d%04d_s%04d_%c.npy", g_save_dir, inspector->num_display, inspector->num_pic_stream, 
+                pic_type);
+        iio_write_image_float(fname, &(inspector->residual[1][0][0]), inspector->width, inspector->height);
+
+        sprintf(fname, "%s/imgV_d%04d_s%04d_%c.npy", g_save_dir, inspector->num_display, inspector->num_pic_stream, 
+                pic_type);
+        iio_write_image_float(fname, &(inspector->residual[2][0][0]), inspector->width, inspector->height);
+      }
 
-    sprintf(fname, "%s/imgMBtype_d%04d_s%04d_%c.png", g_save_dir, inspector->num_display, inspector->num_pic_stream, 
-            pic_type);
-    iio_write_image_uint8_matrix(fname, inspector->img_type, inspector->width, inspector->height);
+      sprintf(fname, "%s/imgMBtype_d%04d_s%04d_%c.png", g_save_dir, inspector->num_display, inspector->num_pic_stream, 
+              pic_type);
+      iio_write_image_uint8_matrix(fname, inspector->img_type, inspector->width, inspector->height);
+    }
     printf("img_*.npy is created. \n");
 
     inspector->is_exported = 1;
@@ -268,3 +474,7 @@ void inspect_poc_offset(Inspector* inspector, int offset) { inspector->poc_offse
 void save_mb_type(int mb_type) { g_mb_type = mb_type; }
 
 void inspect_set_savedir(char* location) { strcpy(g_save_dir, location); }
+
+void inspect_set_compact(int compact) { g_compact = (uint8)compact; }
+
+void inspect_set_export(int enable) { g_export = (uint8)enable; }
@@ -0,0 +1,242 @@
+#include "syntax_stats.h"
+
+#include "biaridecod.h"
+#include "memalloc.h"
+
+typedef struct syntax_stats_column
+{
+  char name[16];
+  int elem_size;  // bytes per element
+  int elems;      // elements per macroblock
+} SyntaxStatsColumn;
+
+enum {
+  COL_MB_ADDR = 0,
+  COL_SLICE_TYPE,
+  COL_MB_TYPE,
+  COL_SKIP,
+  COL_QP,
+  COL_CBP,
+  COL_TRANSFORM_8x8,
+  COL_MVD,
+  COL_BITS,
+  NUM_COLUMNS
+};
+
+static const SyntaxStatsColumn columns[NUM_COLUMNS] = {
+  {"mb_addr",       4, 1},
+  {"slice_type",    1, 1},
+  {"mb_type",       2, 1},   // mb_type syntax element
+  {"skip",          1, 1},
+  {"qp",            1, 1},
+  {"cbp",           4, 1},
+  {"transform_8x8", 1, 1},
+  {"mvd",           2, 2 * BLOCK_MULTIPLE * BLOCK_MULTIPLE * 2},  // [list][block_y][block_x][x,y]
+  {"bits",          4, 1}
+};
+
+typedef struct syntax_stats_index
+{
+  int64 offset;
+  int frame_id;
+  int display_nr;
+  int num_mb;
+} SyntaxStatsIndex;
+
+static char stats_filename[255];
+static FILE* stats_file = NULL;
+static int64 file_pos = 0;
+
+// current picture
+static byte* data[NUM_COLUMNS];
+static int capacity = 0;  // in macroblocks
+static int num_mb = 0;
+static int pic_open = 0;
+static int pic_selected = 0;
+static int pic_frame_id, pic_display_nr, pic_slice_type, pic_structure;
+
+static SyntaxStatsIndex* pic_index = NULL;
+static int num_pictures = 0;
+static int index_size = 0;
+
+static void write_data(const void* ptr, size_t size) {
+  if (size && fwrite(ptr, 1, size, stats_file) != size) {
+    snprintf(errortext, ET_SIZE, "syntax_stats: error writing to %s", stats_filename);
+    error(errortext, 500);
+  }
+  file_pos += size;
+}
+
+static void write_uint32(unsigned int value) { write_data(&value, sizeof(unsigned int)); }
+
+static void write_int64(int64 value) { write_data(&value, sizeof(int64)); }
+
+void syntax_stats_set_filename(char* filename) { strncpy(stats_filename, filename, sizeof(stats_filename) - 1); }
+
+char* syntax_stats_get_filename() { return stats_filename; }
+
+int syntax_stats_enabled() { return stats_filename[0] != '\0'; }
+
+/**
+ * \return 0 on success, -1 if the file cannot be created
+ */
+int syntax_stats_open() {
+  int i;
+
+  if ((stats_file = fopen(stats_filename, "wb")) == NULL) return -1;
+
+  file_pos = 0;
+  write_data("JMSS", 4);
+  write_uint32(SYNTAX_STATS_VERSION);
+  write_uint32(NUM_COLUMNS);
+  for (i = 0; i < NUM_COLUMNS; i++) {
+    write_data(columns[i].name, sizeof(columns[i].name));
+    write_uint32(columns[i].elem_size);
+    write_uint32(columns[i].elems);
+  }
+  return 0;
+}
+
+/**
+ * Writes the buffered columns of the current picture as one chunk and adds it to the index.
+ */
+static void flush_picture() {
+  int i;
+  unsigned short reserved = 0;
+  byte type, structure;
+
+  if (!pic_open) return;
+  pic_open = 0;
+  if (!pic_selected) return;
+
+  if (num_pictures == index_size) {
+    index_size = index_size ? 2 * index_size : 256;
+    pic_index = (SyntaxStatsIndex*)realloc(pic_index, index_size * sizeof(SyntaxStatsIndex));
+    if (pic_index == NULL) no_mem_exit("flush_picture: pic_index");
+  }
+  pic_index[num_pictures].offset = file_pos;
+  pic_index[num_pictures].frame_id = pic_frame_id;
+  pic_index[num_pictures].display_nr = pic_display_nr;
+  pic_index[num_pictures].num_mb = num_mb;
+  num_pictures++;
+
+  type = (byte)pic_slice_type;
+  structure = (byte)pic_structure;
+  write_uint32(pic_frame_id);
+  write_uint32(pic_display_nr);
+  write_data(&type, 1);
+  write_data(&structure, 1);
+  write_data(&reserved, sizeof(reserved));
+  write_uint32(num_mb);
+  for (i = 0; i < NUM_COLUMNS; i++) {
+    write_data(data[i], (size_t)num_mb * columns[i].elem_size * columns[i].elems);
+  }
+}
+
+void syntax_stats_close() {
+  int i;
+  int64 index_offset;
+
+  if (stats_file == NULL) return;
+
+  flush_picture();
+
+  index_offset = file_pos;
+  for (i = 0; i < num_pictures; i++) {
+    write_int64(pic_index[i].offset);
+    write_uint32(pic_index[i].frame_id);
+    write_uint32(pic_index[i].display_nr);
+    write_uint32(pic_index[i].num_mb);
+  }
+  write_int64(index_offset);
+  write_uint32(num_pictures);
+  write_data("JMSI", 4);
+
+  fclose(stats_file);
+  stats_file = NULL;
+
+  for (i = 0; i < NUM_COLUMNS; i++) {
+    free(data[i]);
+    data[i] = NULL;
+  }
+  capacity = 0;
+  free(pic_index);
+  pic_index = NULL;
+  num_pictures = index_size = 0;
+}
+
+/**
+ * \param frame_id decoding order number of the picture
+ * \param display_nr display order number of the picture
+ * \param selected records of unselected pictures are dropped
+ */
+void syntax_stats_start_picture(int frame_id, int display_nr, int slice_type, int structure, int selected) {
+  flush_picture();
+
+  pic_open = 1;
+  pic_selected = selected;
+  pic_frame_id = frame_id;
+  pic_display_nr = display_nr;
+  pic_slice_type = slice_type;
+  pic_structure = structure;
+  num_mb = 0;
+}
+
+/**
+ * \return the number of bits consumed so far in all partitions of the slice
+ */
+int syntax_stats_bits_read(Slice* currSlice) {
+  int i, bits = 0;
+  int num_part = (currSlice->dp_mode == PAR_DP_1) ? 1 : 3;
+
+  for (i = 0; i < num_part; i++) {
+    if ((int) currSlice->p_Vid->active_pps->entropy_coding_mode_flag == CABAC)
+      bits += arideco_bits_read(&currSlice->partArr[i].de_cabac);
+    else
+      bits += currSlice->partArr[i].bitstream->frame_bitoffset;
+  }
+  return bits;
+}
+
+/**
+ * \param currMB a parsed macroblock
+ * \param mb_type the syntax element mb_type
+ * \param bits number of bits used by the macroblock
+ */
+void syntax_stats_add_mb(Macroblock* currMB, Slice* currSlice, int mb_type, int bits) {
+  int i;
+  int mb_addr = currMB->mbAddrX;
+  short type = (short)mb_type;
+  byte slice_type = (byte)currSlice->slice_type;
+  byte skip = (byte)(currMB->skip_flag == 1);
+  signed char qp = (signed char)currMB->qp;
+  byte transform_8x8 = (byte)currMB->luma_transform_size_8x8_flag;
+
+  if (!pic_open || !pic_selected) return;
+
+  if (num_mb == capacity) {
+    capacity = capacity ? 2 * capacity : 8192;
+    for (i = 0; i < NUM_COLUMNS; i++) {
+      data[i] = (byte*)realloc(data[i], (size_t)capacity * columns[i].elem_size * columns[i].elems);
+      if (data[i] == NULL) no_mem_exit("syntax_stats_add_mb: data");
+    }
+  }
+
+#define STORE(col, ptr) \
+  memcpy(data[col] + (size_t)num_mb * columns[col].elem_size * columns[col].elems, ptr, \
+         columns[col].elem_size * columns[col].elems)
+
+  STORE(COL_MB_ADDR, &mb_addr);
+  STORE(COL_SLICE_TYPE, &slice_type);
+  STORE(COL_MB_TYPE, &type);
+  STORE(COL_SKIP, &skip);
+  STORE(COL_QP, &qp);
+  STORE(COL_CBP, &currMB->cbp);
+  STORE(COL_TRANSFORM_8x8, &transform_8x8);
+  STORE(COL_MVD, &currMB->mvd[0][0][0][0]);
+  STORE(COL_BITS, &bits);
+
+#undef STORE
+
+  num_mb++;
+}
@@ -144,12 +144,7 @@ int GetAnnexbNALU (VideoParameters *p_Vid, NALU_t *nalu)
   int info2 = 0, info3 = 0, pos = 0;
   int StartCodeFound = 0;
   int LeadingZero8BitsCount = 0;
-  byte *pBuf; 
-
-  if ((annex_b->Buf = (byte*) calloc (nalu->max_size , sizeof(char))) == NULL) 
-    no_mem_exit("GetAnnexbNALU: Buf");
-
-  pBuf = annex_b->Buf;
+  byte *pBuf = annex_b->Buf;
 
   if (annex_b->nextstartcodebytes != 0)
   {
@@ -172,7 +167,6 @@ int GetAnnexbNALU (VideoParameters *p_Vid, NALU_t *nalu)
   }
   if(annex_b->is_eof == TRUE)
   {
-    free (annex_b->Buf);
     if(pos==0)
     {
       return 0;
@@ -187,7 +181,6 @@ int GetAnnexbNALU (VideoParameters *p_Vid, NALU_t *nalu)
   if(*(pBuf - 1) != 1 || pos < 3)
   {
     printf ("GetAnnexbNALU: no Start Code at the beginning of the NALU, return -1\n");
-    free (annex_b->Buf);
     return -1;
   }
 
@@ -207,7 +200,6 @@ int GetAnnexbNALU (VideoParameters *p_Vid, NALU_t *nalu)
   if(!annex_b->IsFirstByteStreamNALU && LeadingZero8BitsCount > 0)
   {
     printf ("GetAnnexbNALU: The leading_zero_8bits syntax can only be present in the first byte stream NAL unit, return -1\n");
-    free (annex_b->Buf);
     return -1;
   }
 
@@ -238,7 +230,6 @@ int GetAnnexbNALU (VideoParameters *p_Vid, NALU_t *nalu)
       fflush (p_Dec->p_trace);
 #endif
 
-      free (annex_b->Buf);
       return (pos - 1);
     }
 
@@ -268,7 +259,6 @@ int GetAnnexbNALU (VideoParameters *p_Vid, NALU_t *nalu)
   else
   {
     printf(" Panic: Error in next start code search \n");
-    free (annex_b->Buf);
     return -1;
   }
 
@@ -297,7 +287,6 @@ int GetAnnexbNALU (VideoParameters *p_Vid, NALU_t *nalu)
 
   abs_pos+=pos;
   //printf("%d\n", abs_pos);
-  free (annex_b->Buf);
   return (pos);
 }
 
@@ -327,6 +316,9 @@ void OpenAnnexBFile (VideoParameters *p_Vid, char *fn)
   {
     error ("OpenAnnexBFile: cannot allocate IO buffer",500);
   }
+  // one NAL unit buffer for the whole stream instead of one per NAL unit
+  if ((annex_b->Buf = (byte*) calloc (MAX_CODED_FRAME_SIZE, sizeof(char))) == NULL) 
+    no_mem_exit("OpenAnnexBFile: Buf");
   annex_b->is_eof = FALSE;
   getChunk(annex_b);
 }
@@ -348,5 +340,7 @@ void CloseAnnexBFile(VideoParameters *p_Vid)
   }
   free (annex_b->iobuffer);
   annex_b->iobuffer = NULL;
+  free (annex_b->Buf);
+  annex_b->Buf = NULL;
 }
 
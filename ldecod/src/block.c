@@ -24,6 +24,7 @@
 #include "transform.h"
 #include "quant.h"
 #include "memalloc.h"
+#include "dec_profile.h"
 
 /*!
  ***********************************************************************
@@ -44,6 +45,25 @@ void itrans4x4(Macroblock *currMB,   //!< current macroblock
   sample_reconstruct (&currSlice->mb_rec[pl][joff], &currSlice->mb_pred[pl][joff], &mb_rres[joff], ioff, ioff, BLOCK_SIZE, BLOCK_SIZE, currMB->p_Vid->max_pel_value_comp[pl], DQ_BITS);
 }
 
+/*!
+ ***********************************************************************
+ * \brief
+ *    Inverse 4x4 transformation of all blocks of a macroblock (plane),
+ *    same result as itrans4x4() for each block
+ ***********************************************************************
+ */
+void itrans4x4_mb(Macroblock *currMB,   //!< current macroblock
+                  ColorPlane pl,        //!< used color plane
+                  int width,            //!< macroblock width in this plane
+                  int height)           //!< macroblock height in this plane
+{
+  Slice *currSlice = currMB->p_Slice;
+
+  inverse4x4_recon(&currSlice->cof[pl][0][0], &currSlice->mb_rres[pl][0][0], (int) (currSlice->cof[pl][1] - currSlice->cof[pl][0]),
+    &currSlice->mb_pred[pl][0][0], &currSlice->mb_rec[pl][0][0], (int) (currSlice->mb_pred[pl][1] - currSlice->mb_pred[pl][0]),
+    width, height, currMB->p_Vid->max_pel_value_comp[pl]);
+}
+
 /*!
  ****************************************************************************
  * \brief
@@ -508,14 +528,22 @@ void iMBtrans4x4(Macroblock *currMB, ColorPlane pl, int smb)
 
   currMB->itrans_4x4 = (smb) ? itrans_sp : ((currMB->is_lossless == FALSE) ? itrans4x4 : Inv_Residual_trans_4x4);
 
-  for (block8x8=0; block8x8 < MB_BLOCK_SIZE; block8x8 += 4)
-  { 
-    for (k = block8x8; k < block8x8 + 4; ++k )
-    {
-      jj = ((decode_block_scan[k] >> 2) & 3) << BLOCK_SHIFT;
-      ii = (decode_block_scan[k] & 3) << BLOCK_SHIFT;
+  if (currMB->itrans_4x4 == itrans4x4)
+  {
+    // all 16 blocks at once, blocks without coefficients just copy the prediction
+    itrans4x4_mb(currMB, pl, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  }
+  else
+  {
+    for (block8x8=0; block8x8 < MB_BLOCK_SIZE; block8x8 += 4)
+    { 
+      for (k = block8x8; k < block8x8 + 4; ++k )
+      {
+        jj = ((decode_block_scan[k] >> 2) & 3) << BLOCK_SHIFT;
+        ii = (decode_block_scan[k] & 3) << BLOCK_SHIFT;
 
-      currMB->itrans_4x4(currMB, pl, ii, jj);   // use DCT transform and make 4x4 block mb_rres from prediction block mb_pred
+        currMB->itrans_4x4(currMB, pl, ii, jj);   // use DCT transform and make 4x4 block mb_rres from prediction block mb_pred
+      }
     }
   }
 
@@ -533,14 +561,24 @@ void iMBtrans8x8(Macroblock *currMB, ColorPlane pl)
   int block8x8;
   int ioff, joff;
 
-  for (block8x8=0; block8x8<4; ++block8x8)
+  if (currMB->is_lossless == FALSE)
   {
-    // =============== 8x8 itrans ================
-    // -------------------------------------------
-    ioff = 8 * (block8x8 & 0x01);
-    joff = 8 * (block8x8 >> 1);
+    // coefficients are in mb_rres, transformed in place
+    inverse8x8_recon(&currSlice->mb_rres[pl][0][0], &currSlice->mb_rres[pl][0][0], (int) (currSlice->mb_rres[pl][1] - currSlice->mb_rres[pl][0]),
+      &currSlice->mb_pred[pl][0][0], &currSlice->mb_rec[pl][0][0], (int) (currSlice->mb_pred[pl][1] - currSlice->mb_pred[pl][0]),
+      MB_BLOCK_SIZE, MB_BLOCK_SIZE, p_Vid->max_pel_value_comp[pl]);
+  }
+  else
+  {
+    for (block8x8=0; block8x8<4; ++block8x8)
+    {
+      // =============== 8x8 itrans ================
+      // -------------------------------------------
+      ioff = 8 * (block8x8 & 0x01);
+      joff = 8 * (block8x8 >> 1);
 
-    itrans8x8(currMB, pl, ioff, joff);      // use DCT transform and make 8x8 block mb_rres from prediction block mb_pred
+      itrans8x8(currMB, pl, ioff, joff);      // use DCT transform and make 8x8 block mb_rres from prediction block mb_pred
+    }
   }
 
   copy_image_data_16x16(&curr_img[currMB->pix_y], currSlice->mb_rec[pl], currMB->pix_x, 0);
@@ -553,6 +591,7 @@ void iTransform(Macroblock *currMB, ColorPlane pl, int smb)
   StorablePicture *dec_picture = p_Vid->dec_picture;
   imgpel **curr_img;
   int uv = pl-1; 
+  DEC_PROF_START(PROF_ITRANS);
 
   if ((currMB->cbp & 15) != 0 || smb)
   {
@@ -589,14 +628,21 @@ void iTransform(Macroblock *currMB, ColorPlane pl, int smb)
 
       if (!smb && (currMB->cbp>>4))
       {
-        for (b8 = 0; b8 < (p_Vid->num_uv_blocks); ++b8)
+        if (currMB->itrans_4x4 == itrans4x4)
+        {
+          itrans4x4_mb(currMB, (ColorPlane) (uv + 1), p_Vid->mb_cr_size_x, p_Vid->mb_cr_size_y);
+        }
+        else
         {
-          for(b4 = 0; b4 < 4; ++b4)
+          for (b8 = 0; b8 < (p_Vid->num_uv_blocks); ++b8)
           {
-            joff = subblk_offset_y[1][b8][b4];
-            ioff = subblk_offset_x[1][b8][b4];
+            for(b4 = 0; b4 < 4; ++b4)
+            {
+              joff = subblk_offset_y[1][b8][b4];
+              ioff = subblk_offset_x[1][b8][b4];
 
-            currMB->itrans_4x4(currMB, (ColorPlane) (uv + 1), ioff, joff);
+              currMB->itrans_4x4(currMB, (ColorPlane) (uv + 1), ioff, joff);
+            }
           }
         }
 
@@ -622,6 +668,8 @@ void iTransform(Macroblock *currMB, ColorPlane pl, int smb)
       }
     }
   }
+
+  DEC_PROF_STOP(PROF_ITRANS);
 }
 
 /*!
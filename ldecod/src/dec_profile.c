@@ -0,0 +1,243 @@
+
+/*!
+ ************************************************************************
+ * \file
+ *    dec_profile.c
+ *
+ * \brief
+ *    Per-stage decoder profiling counters.
+ *
+ *    The time of each stage is accumulated in CPU ticks per slice type.
+ *    Started stages are kept on a stack, so that the time of a nested
+ *    stage (e.g. intra inside recon) is only counted as the self time of
+ *    the nested one. The self times add up to at most the total.
+ *    The tick rate is calibrated against gettime() over the whole run.
+ *    The summary is printed after decoding and, with -profile <file>,
+ *    written as JSON.
+ ************************************************************************
+ */
+
+#include "global.h"
+#include "dec_profile.h"
+
+#if (DEC_PROFILE)
+
+#if !defined(_WIN32) && !(defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)))
+#include <time.h>
+
+unsigned long long dec_prof_ticks(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+#define PROF_NUM_SLICE_TYPES 5
+#define PROF_MAX_DEPTH       16
+
+static const char *stage_names[PROF_NUM_STAGES] =
+{
+  "nal_read", "entropy", "recon", "intra", "mc", "itrans", "deblock", "output", "inspect"
+};
+
+static const char *slice_type_names[PROF_NUM_SLICE_TYPES] = { "P", "B", "I", "SP", "SI" };
+
+//! a started stage
+typedef struct
+{
+  int stage;
+  unsigned long long start;
+  unsigned long long nested;  //!< ticks of the stages started inside this one
+} ProfileFrame;
+
+static unsigned long long prof_ticks[PROF_NUM_SLICE_TYPES][PROF_NUM_STAGES];  //!< self time
+static unsigned long long prof_total[PROF_NUM_SLICE_TYPES][PROF_NUM_STAGES];  //!< including nested stages
+static unsigned long long prof_calls[PROF_NUM_SLICE_TYPES][PROF_NUM_STAGES];
+static int prof_slice_type = P_SLICE;
+
+static ProfileFrame prof_stack[PROF_MAX_DEPTH];
+static int prof_depth = 0;
+
+static TIME_T prof_start_time;
+static unsigned long long prof_start_ticks;
+static char prof_filename[FILE_NAME_SIZE] = "";
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Resets the counters and starts the tick calibration
+ ************************************************************************
+ */
+void dec_profile_init(void)
+{
+  memset(prof_ticks, 0, sizeof(prof_ticks));
+  memset(prof_total, 0, sizeof(prof_total));
+  memset(prof_calls, 0, sizeof(prof_calls));
+  prof_depth = 0;
+  gettime(&prof_start_time);
+  prof_start_ticks = dec_prof_ticks();
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sets the slice type the following stages are counted for
+ ************************************************************************
+ */
+void dec_profile_set_slice_type(int slice_type)
+{
+  prof_slice_type = (slice_type >= 0 && slice_type < PROF_NUM_SLICE_TYPES) ? slice_type : P_SLICE;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Starts a stage, nested in the stage that is running
+ ************************************************************************
+ */
+void dec_profile_start(int stage)
+{
+  ProfileFrame *frame;
+
+  if (prof_depth == PROF_MAX_DEPTH)
+    error("dec_profile_start: stages nested too deep", 500);
+  frame = &prof_stack[prof_depth++];
+  frame->stage  = stage;
+  frame->nested = 0;
+  frame->start  = dec_prof_ticks();
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stops the stage started last and adds its time to the stage that
+ *    encloses it
+ ************************************************************************
+ */
+void dec_profile_stop(int stage)
+{
+  unsigned long long ticks = dec_prof_ticks();
+  ProfileFrame *frame;
+
+  if (prof_depth == 0 || prof_stack[prof_depth - 1].stage != stage)
+    error("dec_profile_stop: stage was not started last", 500);
+  frame = &prof_stack[--prof_depth];
+  ticks -= frame->start;
+
+  prof_ticks[prof_slice_type][stage] += ticks - frame->nested;
+  prof_total[prof_slice_type][stage] += ticks;
+  prof_calls[prof_slice_type][stage]++;
+  if (prof_depth > 0)
+    prof_stack[prof_depth - 1].nested += ticks;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sets the file the JSON summary is written to
+ ************************************************************************
+ */
+void dec_profile_set_filename(char *filename)
+{
+  strncpy(prof_filename, filename, FILE_NAME_SIZE - 1);
+  prof_filename[FILE_NAME_SIZE - 1] = '\0';
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Writes the counters of one slice type (or all of them if slice_type
+ *    is negative) as JSON object members
+ ************************************************************************
+ */
+static void write_json_stages(FILE *f, int slice_type, double ms_per_tick, const char *indent)
+{
+  int stage, type;
+
+  for (stage = 0; stage < PROF_NUM_STAGES; stage++)
+  {
+    unsigned long long ticks = 0, total = 0, calls = 0;
+
+    for (type = 0; type < PROF_NUM_SLICE_TYPES; type++)
+    {
+      if (slice_type < 0 || slice_type == type)
+      {
+        ticks += prof_ticks[type][stage];
+        total += prof_total[type][stage];
+        calls += prof_calls[type][stage];
+      }
+    }
+    fprintf(f, "%s\"%s\": {\"ms\": %.3f, \"total_ms\": %.3f, \"calls\": %llu}%s\n", indent, stage_names[stage],
+      ticks * ms_per_tick, total * ms_per_tick, calls, stage < PROF_NUM_STAGES - 1 ? "," : "");
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Prints the per-stage times and writes the JSON summary
+ ************************************************************************
+ */
+void dec_profile_report(int num_frames)
+{
+  TIME_T end_time;
+  unsigned long long total_ticks = dec_prof_ticks() - prof_start_ticks;
+  double total_ms, ms_per_tick;
+  int stage, type, first = 1;
+  FILE *f;
+
+  gettime(&end_time);
+  total_ms = (double) timenorm(timediff(&prof_start_time, &end_time) * 1000) * 0.001;
+  ms_per_tick = total_ticks ? total_ms / (double) total_ticks : 0.0;
+
+  fprintf(stdout,"-------------------- Decoder stage profile -------------------------------\n");
+  fprintf(stdout," Stage      Self time(ms)   Share  Incl. nested(ms)       Calls\n");
+  for (stage = 0; stage < PROF_NUM_STAGES; stage++)
+  {
+    unsigned long long ticks = 0, total = 0, calls = 0;
+
+    for (type = 0; type < PROF_NUM_SLICE_TYPES; type++)
+    {
+      ticks += prof_ticks[type][stage];
+      total += prof_total[type][stage];
+      calls += prof_calls[type][stage];
+    }
+    fprintf(stdout," %-10s %13.3f %6.1f%% %17.3f %11llu\n", stage_names[stage], ticks * ms_per_tick,
+      total_ticks ? 100.0 * ticks / total_ticks : 0.0, total * ms_per_tick, calls);
+  }
+  fprintf(stdout," %-10s %13.3f\n", "total", total_ms);
+
+  if (prof_filename[0] == '\0')
+    return;
+
+  if ((f = fopen(prof_filename, "w")) == NULL)
+  {
+    fprintf(stderr, "Error open file %s\n", prof_filename);
+    return;
+  }
+
+  fprintf(f, "{\n");
+  fprintf(f, "  \"frames\": %d,\n", num_frames);
+  fprintf(f, "  \"total_ms\": %.3f,\n", total_ms);
+  fprintf(f, "  \"stages\": {\n");
+  write_json_stages(f, -1, ms_per_tick, "    ");
+  fprintf(f, "  },\n");
+  fprintf(f, "  \"slice_types\": {");
+  for (type = 0; type < PROF_NUM_SLICE_TYPES; type++)
+  {
+    for (stage = 0; stage < PROF_NUM_STAGES && prof_calls[type][stage] == 0; stage++)
+      ;
+    if (stage == PROF_NUM_STAGES)
+      continue;
+    fprintf(f, "%s\n    \"%s\": {\n", first ? "" : ",", slice_type_names[type]);
+    write_json_stages(f, type, ms_per_tick, "      ");
+    fprintf(f, "    }");
+    first = 0;
+  }
+  fprintf(f, "\n  }\n}\n");
+  fclose(f);
+}
+
+#endif
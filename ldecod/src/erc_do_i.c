@@ -18,8 +18,8 @@
 #include "global.h"
 #include "erc_do.h"
 
-static void concealBlocks          ( VideoParameters *p_Vid, int lastColumn, int lastRow, int comp, frame *recfr, int picSizeX, int *condition );
-static void pixMeanInterpolateBlock( VideoParameters *p_Vid, imgpel *src[], imgpel *block, int blockSize, int frameWidth );
+static void concealBlocks          ( VideoParameters *p_Vid, int lastColumn, int lastRow, int comp, frame *recfr, int *condition );
+static void pixMeanInterpolateBlock( VideoParameters *p_Vid, imgpel *src[], imgpel *block, int blockSize, int frameStride );
 
 /*!
  ************************************************************************
@@ -54,15 +54,15 @@ int ercConcealIntraFrame( VideoParameters *p_Vid, frame *recfr, int picSizeX, in
       // Y
       lastRow = (int) (picSizeY>>3);
       lastColumn = (int) (picSizeX>>3);
-      concealBlocks( p_Vid, lastColumn, lastRow, 0, recfr, picSizeX, errorVar->yCondition );
+      concealBlocks( p_Vid, lastColumn, lastRow, 0, recfr, errorVar->yCondition );
 
       // U (dimensions halved compared to Y)
       lastRow = (int) (picSizeY>>4);
       lastColumn = (int) (picSizeX>>4);
-      concealBlocks( p_Vid, lastColumn, lastRow, 1, recfr, picSizeX, errorVar->uCondition );
+      concealBlocks( p_Vid, lastColumn, lastRow, 1, recfr, errorVar->uCondition );
 
       // V ( dimensions equal to U )
-      concealBlocks( p_Vid, lastColumn, lastRow, 2, recfr, picSizeX, errorVar->vCondition );
+      concealBlocks( p_Vid, lastColumn, lastRow, 2, recfr, errorVar->vCondition );
     }
     return 1;
   }
@@ -85,37 +85,37 @@ int ercConcealIntraFrame( VideoParameters *p_Vid, frame *recfr, int picSizeX, in
  *      x coordinate in blocks
  * \param predBlocks[]
  *      list of neighboring source blocks (numbering 0 to 7, 1 means: use the neighbor)
- * \param frameWidth
- *      width of frame in pixels
+ * \param frameStride
+ *      row stride of the frame in pixels
  * \param mbWidthInBlocks
  *      2 for Y, 1 for U/V components
  ************************************************************************
  */
-void ercPixConcealIMB(VideoParameters *p_Vid, imgpel *currFrame, int row, int column, int predBlocks[], int frameWidth, int mbWidthInBlocks)
+void ercPixConcealIMB(VideoParameters *p_Vid, imgpel *currFrame, int row, int column, int predBlocks[], int frameStride, int mbWidthInBlocks)
 {
    imgpel *src[8]={NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL};
    imgpel *currBlock = NULL;
 
    // collect the reliable neighboring blocks
    if (predBlocks[0])
-      src[0] = currFrame + (row-mbWidthInBlocks)*frameWidth*8 + (column+mbWidthInBlocks)*8;
+      src[0] = currFrame + (row-mbWidthInBlocks)*frameStride*8 + (column+mbWidthInBlocks)*8;
    if (predBlocks[1])
-      src[1] = currFrame + (row-mbWidthInBlocks)*frameWidth*8 + (column-mbWidthInBlocks)*8;
+      src[1] = currFrame + (row-mbWidthInBlocks)*frameStride*8 + (column-mbWidthInBlocks)*8;
    if (predBlocks[2])
-      src[2] = currFrame + (row+mbWidthInBlocks)*frameWidth*8 + (column-mbWidthInBlocks)*8;
+      src[2] = currFrame + (row+mbWidthInBlocks)*frameStride*8 + (column-mbWidthInBlocks)*8;
    if (predBlocks[3])
-      src[3] = currFrame + (row+mbWidthInBlocks)*frameWidth*8 + (column+mbWidthInBlocks)*8;
+      src[3] = currFrame + (row+mbWidthInBlocks)*frameStride*8 + (column+mbWidthInBlocks)*8;
    if (predBlocks[4])
-      src[4] = currFrame + (row-mbWidthInBlocks)*frameWidth*8 + column*8;
+      src[4] = currFrame + (row-mbWidthInBlocks)*frameStride*8 + column*8;
    if (predBlocks[5])
-      src[5] = currFrame + row*frameWidth*8 + (column-mbWidthInBlocks)*8;
+      src[5] = currFrame + row*frameStride*8 + (column-mbWidthInBlocks)*8;
    if (predBlocks[6])
-      src[6] = currFrame + (row+mbWidthInBlocks)*frameWidth*8 + column*8;
+      src[6] = currFrame + (row+mbWidthInBlocks)*frameStride*8 + column*8;
    if (predBlocks[7])
-      src[7] = currFrame + row*frameWidth*8 + (column+mbWidthInBlocks)*8;
+      src[7] = currFrame + row*frameStride*8 + (column+mbWidthInBlocks)*8;
 
-   currBlock = currFrame + row*frameWidth*8 + column*8;
-   pixMeanInterpolateBlock( p_Vid, src, currBlock, mbWidthInBlocks*8, frameWidth );
+   currBlock = currFrame + row*frameStride*8 + column*8;
+   pixMeanInterpolateBlock( p_Vid, src, currBlock, mbWidthInBlocks*8, frameStride );
 }
 
 /*!
@@ -300,13 +300,11 @@ int ercCollectColumnBlocks( int predBlocks[], int currRow, int currColumn, int *
  *      color component
  * \param recfr
  *      Reconstructed frame buffer
- * \param picSizeX
- *      Width of the frame in pixels
  * \param condition
  *      The block condition (ok, lost) table
  ************************************************************************
  */
-static void concealBlocks( VideoParameters *p_Vid, int lastColumn, int lastRow, int comp, frame *recfr, int picSizeX, int *condition )
+static void concealBlocks( VideoParameters *p_Vid, int lastColumn, int lastRow, int comp, frame *recfr, int *condition )
 {
   int row, column, srcCounter = 0,  thr = ERC_BLOCK_CORRUPTED,
       lastCorruptedRow = -1, firstCorruptedRow = -1, currRow = 0,
@@ -349,13 +347,13 @@ static void concealBlocks( VideoParameters *p_Vid, int lastColumn, int lastRow,
             switch( comp )
             {
             case 0 :
-              ercPixConcealIMB( p_Vid, recfr->yptr, currRow, column, predBlocks, picSizeX, 2 );
+              ercPixConcealIMB( p_Vid, recfr->yptr, currRow, column, predBlocks, recfr->ystride, 2 );
               break;
             case 1 :
-              ercPixConcealIMB( p_Vid, recfr->uptr, currRow, column, predBlocks, (picSizeX>>1), 1 );
+              ercPixConcealIMB( p_Vid, recfr->uptr, currRow, column, predBlocks, recfr->uvstride, 1 );
               break;
             case 2 :
-              ercPixConcealIMB( p_Vid, recfr->vptr, currRow, column, predBlocks, (picSizeX>>1), 1 );
+              ercPixConcealIMB( p_Vid, recfr->vptr, currRow, column, predBlocks, recfr->uvstride, 1 );
               break;
             }
 
@@ -384,13 +382,13 @@ static void concealBlocks( VideoParameters *p_Vid, int lastColumn, int lastRow,
             switch( comp )
             {
             case 0 :
-              ercPixConcealIMB( p_Vid, recfr->yptr, currRow, column, predBlocks, picSizeX, 2 );
+              ercPixConcealIMB( p_Vid, recfr->yptr, currRow, column, predBlocks, recfr->ystride, 2 );
               break;
             case 1 :
-              ercPixConcealIMB( p_Vid, recfr->uptr, currRow, column, predBlocks, (picSizeX>>1), 1 );
+              ercPixConcealIMB( p_Vid, recfr->uptr, currRow, column, predBlocks, recfr->uvstride, 1 );
               break;
             case 2 :
-              ercPixConcealIMB( p_Vid, recfr->vptr, currRow, column, predBlocks, (picSizeX>>1), 1 );
+              ercPixConcealIMB( p_Vid, recfr->vptr, currRow, column, predBlocks, recfr->uvstride, 1 );
               break;
             }
 
@@ -443,15 +441,15 @@ static void concealBlocks( VideoParameters *p_Vid, int lastColumn, int lastRow,
             switch( comp )
             {
             case 0 :
-              ercPixConcealIMB( p_Vid, recfr->yptr, currRow, column, predBlocks, picSizeX, 2 );
+              ercPixConcealIMB( p_Vid, recfr->yptr, currRow, column, predBlocks, recfr->ystride, 2 );
               break;
 
             case 1 :
-              ercPixConcealIMB( p_Vid, recfr->uptr, currRow, column, predBlocks, (picSizeX>>1), 1 );
+              ercPixConcealIMB( p_Vid, recfr->uptr, currRow, column, predBlocks, recfr->uvstride, 1 );
               break;
 
             case 2 :
-              ercPixConcealIMB( p_Vid, recfr->vptr, currRow, column, predBlocks, (picSizeX>>1), 1 );
+              ercPixConcealIMB( p_Vid, recfr->vptr, currRow, column, predBlocks, recfr->uvstride, 1 );
               break;
             }
 
@@ -490,11 +488,11 @@ static void concealBlocks( VideoParameters *p_Vid, int lastColumn, int lastRow,
  *      destination block
  * \param blockSize
  *      16 for Y, 8 for U/V components
- * \param frameWidth
- *      Width of the frame in pixels
+ * \param frameStride
+ *      Row stride of the frame in pixels
  ************************************************************************
  */
-static void pixMeanInterpolateBlock( VideoParameters *p_Vid, imgpel *src[], imgpel *block, int blockSize, int frameWidth )
+static void pixMeanInterpolateBlock( VideoParameters *p_Vid, imgpel *src[], imgpel *block, int blockSize, int frameStride )
 {
   int row, column, k, tmp, srcCounter = 0, weight = 0, bmax = blockSize - 1;
 
@@ -509,14 +507,14 @@ static void pixMeanInterpolateBlock( VideoParameters *p_Vid, imgpel *src[], imgp
       if ( src[4] != NULL )
       {
         weight = blockSize-row;
-        tmp += weight * (*(src[4]+bmax*frameWidth+column));
+        tmp += weight * (*(src[4]+bmax*frameStride+column));
         srcCounter += weight;
       }
       // left
       if ( src[5] != NULL )
       {
         weight = blockSize-column;
-        tmp += weight * (*(src[5]+row*frameWidth+bmax));
+        tmp += weight * (*(src[5]+row*frameStride+bmax));
         srcCounter += weight;
       }
       // below
@@ -530,7 +528,7 @@ static void pixMeanInterpolateBlock( VideoParameters *p_Vid, imgpel *src[], imgp
       if ( src[7] != NULL )
       {
         weight = column+1;
-        tmp += weight * (*(src[7]+row*frameWidth));
+        tmp += weight * (*(src[7]+row*frameStride));
         srcCounter += weight;
       }
 
@@ -539,6 +537,6 @@ static void pixMeanInterpolateBlock( VideoParameters *p_Vid, imgpel *src[], imgp
       else
         block[ k + column ] = blockSize == 8 ? p_Vid->dc_pred_value_comp[1] : p_Vid->dc_pred_value_comp[0];
     }
-    k += frameWidth;
+    k += frameStride;
   }
 }
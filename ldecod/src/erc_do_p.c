@@ -28,21 +28,33 @@
 #include "macroblock.h"
 
 
+//! luma edge distortions of the motion vectors already tried for the current region
+typedef struct
+{
+  int num;
+  int mv[9][3];
+  int dist[9];
+} TrialCache;
+
 // static function declarations
 static int concealByCopy(frame *recfr, int currMBNum, objectBuffer_t *object_list, int picSizeX);
 static int concealByTrial(frame *recfr, imgpel *predMB,
                           int currMBNum, objectBuffer_t *object_list, int predBlocks[],
                           int picSizeX, int picSizeY, int *yCondition);
 static int edgeDistortion (int predBlocks[], int currYBlockNum, imgpel *predMB,
-                           imgpel *recY, int picSizeX, int regionSize);
+                           imgpel *recY, int picSizeX, int stride, int regionSize);
 static void copyBetweenFrames (frame *recfr, int currYBlockNum, int picSizeX, int regionSize);
 static void buildPredRegionYUV(VideoParameters *p_Vid, int *mv, int x, int y, imgpel *predMB);
+static void buildPredRegionY(VideoParameters *p_Vid, int *mv, int x, int y, imgpel *predMB);
+static int  trialDistortion(frame *recfr, int *mv, int x, int y, imgpel *predMB, int predBlocks[],
+                            int currYBlockNum, int picSizeX, int regionSize, TrialCache *cache);
 
 // picture error concealment
 static void buildPredblockRegionYUV(VideoParameters *p_Vid, int *mv,
                                     int x, int y, imgpel *predMB, int list);
 static void CopyImgData(imgpel **inputY, imgpel ***inputUV, imgpel **outputY, imgpel ***outputUV,
                         int img_width, int img_height, int img_width_cr, int img_height_cr);
+static void extrapolate_to_conceal(StorablePicture *src, StorablePicture *dst, VideoParameters *p_Vid);
 
 static void copyPredMB (int currYBlockNum, imgpel *predMB, frame *recfr,
                         int picSizeX, int regionSize);
@@ -284,7 +296,7 @@ static void copyBetweenFrames (frame *recfr, int currYBlockNum, int picSizeX, in
   for (j = ymin; j < ymin + regionSize; j++)
     for (k = xmin; k < xmin + regionSize; k++)
     {
-      location = j * picSizeX + k;
+      location = j * recfr->ystride + k;
 //th      recfr->yptr[location] = dec_picture->imgY[j][k];
       recfr->yptr[location] = refPic->imgY[j][k];
     }
@@ -293,7 +305,7 @@ static void copyBetweenFrames (frame *recfr, int currYBlockNum, int picSizeX, in
       for (k = xmin >> uv_div[0][dec_picture->chroma_format_idc]; k < (xmin + regionSize) >> uv_div[0][dec_picture->chroma_format_idc]; k++)
       {
 //        location = j * picSizeX / 2 + k;
-        location = ((j * picSizeX) >> uv_div[0][dec_picture->chroma_format_idc]) + k;
+        location = j * recfr->uvstride + k;
 
 //th        recfr->uptr[location] = dec_picture->imgUV[0][j][k];
 //th        recfr->vptr[location] = dec_picture->imgUV[1][j][k];
@@ -343,6 +355,7 @@ static int concealByTrial(frame *recfr, imgpel *predMB,
   int regionSize;
   objectBuffer_t *currRegion;
   int mvBest[3] = {0, 0, 0}, mvPred[3] = {0, 0, 0}, *mvptr;
+  TrialCache cache;
 
   numMBPerLine = (int) (picSizeX>>4);
 
@@ -361,6 +374,8 @@ static int concealByTrial(frame *recfr, imgpel *predMB,
     currRegion->xMin = (xPosYBlock(MBNum2YBlock(currMBNum,comp,picSizeX),picSizeX)<<3);
     currRegion->yMin = (yPosYBlock(MBNum2YBlock(currMBNum,comp,picSizeX),picSizeX)<<3);
 
+    cache.num = 0;
+
     do
     { /* reliability loop */
 
@@ -434,8 +449,6 @@ static int concealByTrial(frame *recfr, imgpel *predMB,
 
                   mvPred[0] = mvPred[1] = 0;
                   mvPred[2] = 0;
-
-                  buildPredRegionYUV(p_Vid->erc_img, mvPred, currRegion->xMin, currRegion->yMin, predMB);
                 }
               }
               /* build motion using the neighbour's Motion Parameters */
@@ -450,16 +463,13 @@ static int concealByTrial(frame *recfr, imgpel *predMB,
                 mvPred[0] = mvptr[0];
                 mvPred[1] = mvptr[1];
                 mvPred[2] = mvptr[2];
-
-                buildPredRegionYUV(p_Vid->erc_img, mvPred, currRegion->xMin, currRegion->yMin, predMB);
               }
 
               /* measure absolute boundary pixel difference */
-              currDist = edgeDistortion(predBlocks,
-                MBNum2YBlock(currMBNum,comp,picSizeX),
-                predMB, recfr->yptr, picSizeX, regionSize);
+              currDist = trialDistortion(recfr, mvPred, currRegion->xMin, currRegion->yMin, predMB, predBlocks,
+                MBNum2YBlock(currMBNum,comp,picSizeX), picSizeX, regionSize, &cache);
 
-              /* if so far best -> store the pixels as the best concealment */
+              /* if so far best -> remember the motion, the pixels are built once the best is known */
               if (currDist < minDist || !fInterNeighborExists)
               {
 
@@ -473,9 +483,6 @@ static int concealByTrial(frame *recfr, imgpel *predMB,
                   (isBlock(object_list, predMBNum, compPred, INTER_COPY)) ?
                   ((regionSize == 16) ? REGMODE_INTER_COPY : REGMODE_INTER_COPY_8x8) :
                   ((regionSize == 16) ? REGMODE_INTER_PRED : REGMODE_INTER_PRED_8x8);
-
-                copyPredMB(MBNum2YBlock(currMBNum,comp,picSizeX), predMB, recfr,
-                  picSizeX, regionSize);
               }
 
               fInterNeighborExists = 1;
@@ -494,11 +501,8 @@ static int concealByTrial(frame *recfr, imgpel *predMB,
       mvPred[0] = mvPred[1] = 0;
       mvPred[2] = 0;
 
-      buildPredRegionYUV(p_Vid->erc_img, mvPred, currRegion->xMin, currRegion->yMin, predMB);
-
-      currDist = edgeDistortion(predBlocks,
-        MBNum2YBlock(currMBNum,comp,picSizeX),
-        predMB, recfr->yptr, picSizeX, regionSize);
+      currDist = trialDistortion(recfr, mvPred, currRegion->xMin, currRegion->yMin, predMB, predBlocks,
+        MBNum2YBlock(currMBNum,comp,picSizeX), picSizeX, regionSize, &cache);
 
       if (currDist < minDist || !fInterNeighborExists)
       {
@@ -509,12 +513,13 @@ static int concealByTrial(frame *recfr, imgpel *predMB,
 
         currRegion->regionMode =
           ((regionSize == 16) ? REGMODE_INTER_COPY : REGMODE_INTER_COPY_8x8);
-
-        copyPredMB(MBNum2YBlock(currMBNum,comp,picSizeX), predMB, recfr,
-          picSizeX, regionSize);
       }
     }
 
+    buildPredRegionYUV(p_Vid->erc_img, mvBest, currRegion->xMin, currRegion->yMin, predMB);
+    copyPredMB(MBNum2YBlock(currMBNum,comp,picSizeX), predMB, recfr,
+      picSizeX, regionSize);
+
     for (i=0; i<3; i++)
       currRegion->mv[i] = mvBest[i];
 
@@ -549,17 +554,14 @@ static int concealByTrial(frame *recfr, imgpel *predMB,
 */
 static void buildPredRegionYUV(VideoParameters *p_Vid, int *mv, int x, int y, imgpel *predMB)
 {
-  imgpel **tmp_block;
   int i=0, j=0, ii=0, jj=0,i1=0,j1=0,j4=0,i4=0;
   int jf=0;
   int uv;
-  int vec1_x=0,vec1_y=0;
   int ioff,joff;
   imgpel *pMB = predMB;
 
   StorablePicture *dec_picture = p_Vid->dec_picture;
   int ii0,jj0,ii1,jj1,if1,jf1,if0,jf0;
-  int mv_mul;
 
   //FRExt
   int f1_x, f1_y, f2_x, f2_y, f3, f4, ifx;
@@ -572,49 +574,9 @@ static void buildPredRegionYUV(VideoParameters *p_Vid, int *mv, int x, int y, im
   Macroblock *currMB = &p_Vid->mb_data[mb_nr];   // intialization code deleted, see below, StW
   Slice *currSlice = currMB->p_Slice;
 
-  // This should be allocated only once.
-  get_mem2Dpel(&tmp_block, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-
-  /* Update coordinates of the current concealed macroblock */
-  p_Vid->mb_x = x/MB_BLOCK_SIZE;
-  p_Vid->mb_y = y/MB_BLOCK_SIZE;
-  p_Vid->block_y = p_Vid->mb_y * BLOCK_SIZE;
-  p_Vid->pix_c_y = p_Vid->mb_y * p_Vid->mb_cr_size_y;
-  p_Vid->block_x = p_Vid->mb_x * BLOCK_SIZE;
-  p_Vid->pix_c_x = p_Vid->mb_x * p_Vid->mb_cr_size_x;
-
-  mv_mul=4;
-
   // luma *******************************************************
 
-  for(j=0;j<MB_BLOCK_SIZE/BLOCK_SIZE;j++)
-  {
-    joff=j*4;
-    j4=p_Vid->block_y+j;
-    for(i=0;i<MB_BLOCK_SIZE/BLOCK_SIZE;i++)
-    {
-      ioff=i*4;
-      i4=p_Vid->block_x+i;
-
-      vec1_x = i4*4*mv_mul + mv[0];
-      vec1_y = j4*4*mv_mul + mv[1];
-
-      get_block_luma(currMB, PLANE_Y, p_Vid->listX[0][ref_frame], vec1_x, vec1_y, BLOCK_SIZE, BLOCK_SIZE, tmp_block);
-
-      for(ii=0;ii<BLOCK_SIZE;ii++)
-        for(jj=0;jj<MB_BLOCK_SIZE/BLOCK_SIZE;jj++)
-          currSlice->mb_pred[LumaComp][jj+joff][ii+ioff]=tmp_block[jj][ii];
-    }
-  }
-
-
-  for (j = 0; j < 16; j++)
-  {
-    for (i = 0; i < 16; i++)
-    {
-      pMB[j*16+i] = currSlice->mb_pred[LumaComp][j][i];
-    }
-  }
+  buildPredRegionY(p_Vid, mv, x, y, pMB);
   pMB += 256;
 
   if (dec_picture->chroma_format_idc != YUV400)
@@ -680,8 +642,79 @@ static void buildPredRegionYUV(VideoParameters *p_Vid, int *mv, int x, int y, im
 
     }
   }
-  // We should allocate this memory only once.
-  free_mem2Dpel(tmp_block);
+}
+
+/*!
+************************************************************************
+* \brief
+*      Builds only the luma part of the motion prediction of buildPredRegionYUV
+*      with a single 16x16 call of the decoder's luma interpolation.
+* \param p_Vid
+*      The pointer of video_par structure of current frame
+* \param mv
+*      The pointer of the predicted MV of the current (being concealed) MB
+* \param x
+*      The x-coordinate of the above-left corner pixel of the current MB
+* \param y
+*      The y-coordinate of the above-left corner pixel of the current MB
+* \param predMB
+*      memory area for the 16x16 luma pixels
+************************************************************************
+*/
+static void buildPredRegionY(VideoParameters *p_Vid, int *mv, int x, int y, imgpel *predMB)
+{
+  imgpel *tmp_block[MB_BLOCK_SIZE];
+  int j;
+  int ref_frame = imax (mv[2], 0);
+  Macroblock *currMB = &p_Vid->mb_data[p_Vid->current_mb_nr];
+
+  /* Update coordinates of the current concealed macroblock */
+  p_Vid->mb_x = x/MB_BLOCK_SIZE;
+  p_Vid->mb_y = y/MB_BLOCK_SIZE;
+  p_Vid->block_y = p_Vid->mb_y * BLOCK_SIZE;
+  p_Vid->pix_c_y = p_Vid->mb_y * p_Vid->mb_cr_size_y;
+  p_Vid->block_x = p_Vid->mb_x * BLOCK_SIZE;
+  p_Vid->pix_c_x = p_Vid->mb_x * p_Vid->mb_cr_size_x;
+
+  // the prediction is written directly into predMB
+  for (j = 0; j < MB_BLOCK_SIZE; j++)
+    tmp_block[j] = predMB + j * MB_BLOCK_SIZE;
+
+  get_block_luma(currMB, PLANE_Y, p_Vid->listX[0][ref_frame], (x << 2) + mv[0], (y << 2) + mv[1],
+    MB_BLOCK_SIZE, MB_BLOCK_SIZE, tmp_block);
+}
+
+/*!
+************************************************************************
+* \brief
+*      Returns the edge distortion of the luma prediction with motion vector mv.
+*      Motion vectors already tried for the current region are taken from cache,
+*      they would give the same distortion again.
+************************************************************************
+*/
+static int trialDistortion(frame *recfr, int *mv, int x, int y, imgpel *predMB, int predBlocks[],
+                           int currYBlockNum, int picSizeX, int regionSize, TrialCache *cache)
+{
+  int i, dist;
+
+  for (i = 0; i < cache->num; i++)
+  {
+    if (cache->mv[i][0] == mv[0] && cache->mv[i][1] == mv[1] && imax(cache->mv[i][2], 0) == imax(mv[2], 0))
+      return cache->dist[i];
+  }
+
+  buildPredRegionY(recfr->p_Vid->erc_img, mv, x, y, predMB);
+  dist = edgeDistortion(predBlocks, currYBlockNum, predMB, recfr->yptr, picSizeX, recfr->ystride, regionSize);
+
+  if (cache->num < 9)
+  {
+    cache->mv[cache->num][0] = mv[0];
+    cache->mv[cache->num][1] = mv[1];
+    cache->mv[cache->num][2] = mv[2];
+    cache->dist[cache->num] = dist;
+    cache->num++;
+  }
+  return dist;
 }
 /*!
  ************************************************************************
@@ -768,18 +801,20 @@ static void copyPredMB (int currYBlockNum, imgpel *predMB, frame *recfr,
  *      pointer to a Y plane of a YUV frame
  * \param picSizeX
  *      picture width in pixels
+ * \param stride
+ *      row stride of recY in pixels
  * \param regionSize
  *      can be 16 or 8 to tell the dimension of the region to copy
  ************************************************************************
  */
 static int edgeDistortion (int predBlocks[], int currYBlockNum, imgpel *predMB,
-                           imgpel *recY, int picSizeX, int regionSize)
+                           imgpel *recY, int picSizeX, int stride, int regionSize)
 {
   int i, j, distortion, numOfPredBlocks, threshold = ERC_BLOCK_OK;
   imgpel *currBlock = NULL, *neighbor = NULL;
   int currBlockOffset = 0;
 
-  currBlock = recY + (yPosYBlock(currYBlockNum,picSizeX)<<3)*picSizeX + (xPosYBlock(currYBlockNum,picSizeX)<<3);
+  currBlock = recY + (yPosYBlock(currYBlockNum,picSizeX)<<3)*stride + (xPosYBlock(currYBlockNum,picSizeX)<<3);
 
   do
   {
@@ -796,7 +831,7 @@ static int edgeDistortion (int predBlocks[], int currYBlockNum, imgpel *predMB,
         switch (j)
         {
         case 4:
-          neighbor = currBlock - picSizeX;
+          neighbor = currBlock - stride;
           for ( i = 0; i < regionSize; i++ )
           {
             distortion += iabs((int)(predMB[i] - neighbor[i]));
@@ -806,11 +841,11 @@ static int edgeDistortion (int predBlocks[], int currYBlockNum, imgpel *predMB,
           neighbor = currBlock - 1;
           for ( i = 0; i < regionSize; i++ )
           {
-            distortion += iabs((int)(predMB[i*16] - neighbor[i*picSizeX]));
+            distortion += iabs((int)(predMB[i*16] - neighbor[i*stride]));
           }
           break;
         case 6:
-          neighbor = currBlock + regionSize*picSizeX;
+          neighbor = currBlock + regionSize*stride;
           currBlockOffset = (regionSize-1)*16;
           for ( i = 0; i < regionSize; i++ )
           {
@@ -822,7 +857,7 @@ static int edgeDistortion (int predBlocks[], int currYBlockNum, imgpel *predMB,
           currBlockOffset = regionSize-1;
           for ( i = 0; i < regionSize; i++ )
           {
-            distortion += iabs((int)(predMB[i*16+currBlockOffset] - neighbor[i*picSizeX]));
+            distortion += iabs((int)(predMB[i*16+currBlockOffset] - neighbor[i*stride]));
           }
           break;
         }
@@ -1110,8 +1145,288 @@ static StorablePicture* get_last_ref_pic_from_dpb(DecodedPictureBuffer *p_Dpb)
 /*!
 ************************************************************************
 * \brief
-* Conceals the lost reference or non reference frame by either frame copy
-* or motion vector copy concealment.
+*    Returns the short term reference frame in the dpb that precedes pic
+*    in output order, NULL if there is none.
+************************************************************************
+*/
+
+static StorablePicture* get_prev_ref_pic_from_dpb(DecodedPictureBuffer *p_Dpb, StorablePicture *pic)
+{
+  StorablePicture *prev = NULL;
+  unsigned int i;
+
+  for(i = 0; i < p_Dpb->used_size; i++)
+  {
+    StorablePicture *frame = p_Dpb->fs[i]->frame;
+
+    if (p_Dpb->fs[i]->is_used==3 && frame != pic && frame->used_for_reference && !frame->is_long_term &&
+      frame->poc < pic->poc && (prev == NULL || frame->poc > prev->poc))
+    {
+      prev = frame;
+    }
+  }
+
+  return prev;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Scales a motion vector component from a POC distance of den to num,
+*    rounded to the nearest quarter sample.
+************************************************************************
+*/
+static inline int scale_conceal_mv(int mv, int num, int den)
+{
+  int v = mv * num;
+
+  v = (v >= 0) ? (v + (den >> 1)) / den : -((-v + (den >> 1)) / den);
+
+  return iClip3(-2048, 2047, v);
+}
+
+/*!
+************************************************************************
+* \brief
+*    Returns the LIST_0 motion of 4x4 block (i, j) of pic, scaled from the
+*    POC distance to its reference to dist. Returns 0 for intra blocks and
+*    blocks without a usable reference POC.
+************************************************************************
+*/
+static int get_extrapolated_mv(StorablePicture *pic, int j, int i, int dist, int *mv)
+{
+  PicMotionParams *motion = &pic->motion;
+  int ref_dist;
+
+  if (motion->ref_idx[LIST_0][j][i] < 0 || motion->ref_pic_id[LIST_0][j][i] == INT64_MIN)
+    return 0;
+
+  // ref_pic_id holds twice the POC of the reference frame
+  ref_dist = pic->poc - (int) (motion->ref_pic_id[LIST_0][j][i] >> 1);
+  if (ref_dist <= 0)
+    return 0;
+
+  if (ref_dist == dist)
+  {
+    mv[0] = motion->mv[LIST_0][j][i][0];
+    mv[1] = motion->mv[LIST_0][j][i][1];
+  }
+  else
+  {
+    mv[0] = scale_conceal_mv(motion->mv[LIST_0][j][i][0], dist, ref_dist);
+    mv[1] = scale_conceal_mv(motion->mv[LIST_0][j][i][1], dist, ref_dist);
+  }
+
+  return 1;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Bilinear motion compensation of a size_x x size_y block of one plane.
+*    (pos_x, pos_y) is the position of the block in ref in units of
+*    1/(1 << shift_x) and 1/(1 << shift_y) samples. Positions outside
+*    the reference are clipped to its border. The prediction is written
+*    directly into img at (x, y).
+************************************************************************
+*/
+static void conceal_plane_mc(imgpel **ref, imgpel **img, int x, int y, int size_x, int size_y,
+                             int pos_x, int pos_y, int shift_x, int shift_y, int max_x, int max_y)
+{
+  int fx = pos_x & ((1 << shift_x) - 1);
+  int fy = pos_y & ((1 << shift_y) - 1);
+  int x0 = pos_x >> shift_x;
+  int y0 = pos_y >> shift_y;
+  int w00 = ((1 << shift_x) - fx) * ((1 << shift_y) - fy);
+  int w01 = fx * ((1 << shift_y) - fy);
+  int w10 = ((1 << shift_x) - fx) * fy;
+  int w11 = fx * fy;
+  int shift = shift_x + shift_y;
+  int round = (1 << shift) >> 1;
+  int i, j;
+
+  // the second column and row are only read at fractional positions
+  if (x0 >= 0 && y0 >= 0 && x0 + size_x - (fx == 0) <= max_x && y0 + size_y - (fy == 0) <= max_y)
+  {
+    for (j = 0; j < size_y; j++)
+    {
+      imgpel *r0 = &ref[y0 + j][x0];
+      imgpel *out = &img[y + j][x];
+
+      if (fy == 0)
+      {
+        if (fx == 0)
+        {
+          memcpy(out, r0, size_x * sizeof(imgpel));
+        }
+        else
+        {
+          int wa = (1 << shift_x) - fx;
+          int rx = (1 << shift_x) >> 1;
+
+          for (i = 0; i < size_x; i++)
+            out[i] = (imgpel) ((wa * r0[i] + fx * r0[i + 1] + rx) >> shift_x);
+        }
+      }
+      else
+      {
+        imgpel *r1 = &ref[y0 + j + 1][x0];
+
+        if (fx == 0)
+        {
+          int wa = (1 << shift_y) - fy;
+          int ry = (1 << shift_y) >> 1;
+
+          for (i = 0; i < size_x; i++)
+            out[i] = (imgpel) ((wa * r0[i] + fy * r1[i] + ry) >> shift_y);
+        }
+        else
+        {
+          for (i = 0; i < size_x; i++)
+            out[i] = (imgpel) ((w00 * r0[i] + w01 * r0[i + 1] + w10 * r1[i] + w11 * r1[i + 1] + round) >> shift);
+        }
+      }
+    }
+  }
+  else
+  {
+    for (j = 0; j < size_y; j++)
+    {
+      imgpel *r0 = ref[iClip3(0, max_y, y0 + j)];
+      imgpel *r1 = ref[iClip3(0, max_y, y0 + j + 1)];
+      imgpel *out = &img[y + j][x];
+
+      for (i = 0; i < size_x; i++)
+      {
+        int xa = iClip3(0, max_x, x0 + i);
+        int xb = iClip3(0, max_x, x0 + i + 1);
+
+        out[i] = (imgpel) ((w00 * r0[xa] + w01 * r0[xb] + w10 * r1[xa] + w11 * r1[xb] + round) >> shift);
+      }
+    }
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Motion compensates a block of dst from src with a quarter sample
+*    motion vector. Luma and 4:4:4 chroma are interpolated in quarter
+*    samples, subsampled chroma in eighth samples.
+************************************************************************
+*/
+static void conceal_block_mc(StorablePicture *src, StorablePicture *dst, short *mv, int x, int y, int block_size)
+{
+  int pos_x = (x << 2) + mv[0];
+  int pos_y = (y << 2) + mv[1];
+  int uv;
+
+  conceal_plane_mc(src->imgY, dst->imgY, x, y, block_size, block_size,
+    pos_x, pos_y, 2, 2, dst->size_x_m1, dst->size_y_m1);
+
+  if (dst->chroma_format_idc != YUV400)
+  {
+    int sub_x = (dst->chroma_format_idc == YUV444) ? 0 : 1;
+    int sub_y = (dst->chroma_format_idc == YUV420) ? 1 : 0;
+
+    for (uv = 0; uv < 2; uv++)
+    {
+      conceal_plane_mc(src->imgUV[uv], dst->imgUV[uv], x >> sub_x, y >> sub_y, block_size >> sub_x, block_size >> sub_y,
+        pos_x, pos_y, 2 + sub_x, 2 + sub_y, dst->size_x_cr_m1, dst->size_y_cr_m1);
+    }
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Motion compensates the square region of size x size 4x4 blocks at
+*    (block_x, block_y) of dst from src. A region whose blocks share one
+*    motion vector is predicted as one block, other regions are split
+*    into quarters.
+************************************************************************
+*/
+static void conceal_region_mc(StorablePicture *src, StorablePicture *dst, int block_x, int block_y, int size)
+{
+  short ***mv = dst->motion.mv[LIST_0];
+  short *mv0 = mv[block_y][block_x];
+  int i, j;
+
+  for (j = block_y; j < block_y + size; j++)
+  {
+    for (i = block_x; i < block_x + size; i++)
+    {
+      if (mv[j][i][0] != mv0[0] || mv[j][i][1] != mv0[1])
+      {
+        size >>= 1;
+        conceal_region_mc(src, dst, block_x,        block_y,        size);
+        conceal_region_mc(src, dst, block_x + size, block_y,        size);
+        conceal_region_mc(src, dst, block_x,        block_y + size, size);
+        conceal_region_mc(src, dst, block_x + size, block_y + size, size);
+        return;
+      }
+    }
+  }
+
+  conceal_block_mc(src, dst, mv0, block_x * BLOCK_SIZE, block_y * BLOCK_SIZE, size * BLOCK_SIZE);
+}
+
+/*!
+************************************************************************
+* \brief
+*    Conceals a lost frame by extrapolating the motion field of the last
+*    references to the POC of the lost frame.
+*
+*    The LIST_0 motion of every 4x4 block of src is scaled from the POC
+*    distance to its reference to the distance between src and dst and
+*    applied to src. Intra blocks of src take the co-located motion of the
+*    reference preceding src instead. The extrapolated field is stored in
+*    dst, so that a following loss continues the motion.
+*    Macroblocks and 8x8 blocks with uniform motion are predicted as one
+*    block, with a bilinear filter instead of the 6-tap luma filter.
+************************************************************************
+*/
+static void extrapolate_to_conceal(StorablePicture *src, StorablePicture *dst, VideoParameters *p_Vid)
+{
+  StorablePicture *prev = get_prev_ref_pic_from_dpb(p_Vid->p_Dpb, src);
+  PicMotionParams *motion = &dst->motion;
+  int mb_width = dst->PicWidthInMbs;
+  int mb_height = dst->PicSizeInMbs / dst->PicWidthInMbs;
+  int dist = dst->poc - src->poc;
+  int mb_x, mb_y, i, j;
+  int mv[2];
+
+  for (j = 0; j < mb_height * BLOCK_SIZE; j++)
+  {
+    for (i = 0; i < mb_width * BLOCK_SIZE; i++)
+    {
+      if (!get_extrapolated_mv(src, j, i, dist, mv) &&
+        (prev == NULL || !get_extrapolated_mv(prev, j, i, dist, mv)))
+      {
+        mv[0] = mv[1] = 0;
+      }
+
+      motion->mv[LIST_0][j][i][0] = (short) mv[0];
+      motion->mv[LIST_0][j][i][1] = (short) mv[1];
+      motion->ref_idx[LIST_0][j][i] = 0;
+      motion->ref_pic_id[LIST_0][j][i] = 2 * (int64) src->poc;
+    }
+  }
+
+  for (mb_y = 0; mb_y < mb_height; mb_y++)
+  {
+    for (mb_x = 0; mb_x < mb_width; mb_x++)
+    {
+      conceal_region_mc(src, dst, mb_x * BLOCK_SIZE, mb_y * BLOCK_SIZE, BLOCK_SIZE);
+    }
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+* Conceals the lost reference or non reference frame by either frame copy,
+* motion vector copy or motion extrapolation concealment.
 *
 ************************************************************************
 */
@@ -1247,6 +1562,15 @@ static void copy_to_conceal(StorablePicture *src, StorablePicture *dst, VideoPar
     }
     free(storeYUV);
   }
+
+  // Conceals the missing frame by motion extrapolation
+  if (p_Vid->conceal_mode==3)
+  {
+    dst->PicWidthInMbs = src->PicWidthInMbs;
+    dst->PicSizeInMbs = src->PicSizeInMbs;
+
+    extrapolate_to_conceal(src, dst, p_Vid);
+  }
 }
 
 /*!
@@ -1312,7 +1636,7 @@ void conceal_lost_frames(VideoParameters *p_Vid)
 
   while (CurrFrameNum != UnusedShortTermFrameNum)
   {
-    picture = alloc_storable_picture (p_Vid, FRAME, p_Vid->width, p_Vid->height, p_Vid->width_cr, p_Vid->height_cr);
+    picture = alloc_pooled_picture (p_Vid);
 
     picture->coded_frame = 1;
     picture->pic_num = UnusedShortTermFrameNum;
@@ -1763,7 +2087,7 @@ StorablePicture *get_pic_from_dpb(VideoParameters *p_Vid, int missingpoc, unsign
 
   if(p_Vid->conceal_mode == 1)
     concealfrom = missingpoc - p_Vid->poc_gap;
-  else if (p_Vid->conceal_mode == 2)
+  else if (p_Vid->conceal_mode == 2 || p_Vid->conceal_mode == 3)
     concealfrom = missingpoc + p_Vid->poc_gap;
 
   for(i = used_size; i >= 0; i--)
@@ -2071,9 +2395,9 @@ void write_lost_ref_after_idr(VideoParameters *p_Vid, int pos)
     p_Vid->last_out_fs->is_used = 3;
   }
 
-  if(p_Vid->conceal_mode == 2)
+  if(p_Vid->conceal_mode == 2 || p_Vid->conceal_mode == 3)
   {
-    temp = 2;
+    temp = p_Vid->conceal_mode;
     p_Vid->conceal_mode = 1;
   }
   copy_to_conceal(p_Dpb->fs[pos]->frame, p_Vid->last_out_fs->frame, p_Vid);
@@ -55,6 +55,7 @@
 
 #include "errorconcealment.h"
 #include "erc_api.h"
+#include "dec_profile.h"
 
 /***** XML_TRACE_BEGIN *****/
 #include "xmltracefile.h"
@@ -63,6 +64,7 @@
 
 /****** INSPECT_BEGIN ******/
 #include "inspect.h"
+#include "syntax_stats.h"
 /****** INSPECT_END ******/
 
 extern int testEndian(void);
@@ -596,6 +598,53 @@ static void Error_tracking(VideoParameters *p_Vid)
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Apply the selective decoding filters (-slice_type, -frames,
+ *    -parse_only) to the picture that starts with the current slice
+ *    and set p_Vid->dec_mode accordingly.
+ *
+ * \param p_Vid
+ *    video parameters of the current picture
+ * \param display_nr
+ *    display order number of the picture
+ * \return
+ *    1 if the picture should be inspected, 0 otherwise
+ ************************************************************************
+ */
+static int select_picture(VideoParameters *p_Vid, int display_nr)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  int intra_types = (1 << I_SLICE) | (1 << SI_SLICE);
+  int selected = 1;
+
+  if (p_Inp->select_slice_types && !(p_Inp->select_slice_types & (1 << p_Vid->type)))
+    selected = 0;
+  if (display_nr < p_Inp->select_first_frame || (p_Inp->select_last_frame >= 0 && display_nr > p_Inp->select_last_frame))
+    selected = 0;
+
+  if (syntax_stats_enabled())
+  {
+    // syntax statistics never need reconstructed samples
+    p_Vid->dec_mode = selected ? DEC_PARSE_ONLY : DEC_SKIP;
+  }
+  else if (selected)
+  {
+    p_Vid->dec_mode = (p_Inp->parse_only && p_Vid->nal_reference_idc == 0) ? DEC_PARSE_ONLY : DEC_FULL;
+  }
+  else
+  {
+    // references are still needed by later pictures, unless only intra pictures are inspected
+    if (p_Vid->nal_reference_idc == 0 || (p_Inp->select_slice_types && !(p_Inp->select_slice_types & ~intra_types)))
+      p_Vid->dec_mode = DEC_SKIP;
+    else
+      p_Vid->dec_mode = DEC_FULL;
+  }
+
+  return selected;
+}
+
 /*!
  ***********************************************************************
  * \brief
@@ -613,6 +662,7 @@ int decode_one_frame(VideoParameters *p_Vid)
   int current_header;
   Slice *currSlice = p_Vid->currentSlice;
   int i;
+  int selected;
 
   currSlice->p_Vid = p_Vid;
   currSlice->p_Inp = p_Inp;
@@ -631,7 +681,10 @@ int decode_one_frame(VideoParameters *p_Vid)
 
   while ((currSlice->next_header != EOS && currSlice->next_header != SOP))
   {
+    DEC_PROF_START(PROF_NAL_READ);
     current_header = read_new_slice(p_Vid->currentSlice);
+    DEC_PROF_SET_SLICE_TYPE(p_Vid->type);
+    DEC_PROF_STOP(PROF_NAL_READ);
 
     // error tracking of primary and redundant slices.
     Error_tracking(p_Vid);
@@ -708,6 +761,7 @@ int decode_one_frame(VideoParameters *p_Vid)
         //   printf("p_Vid->dec_picture->frame_id = %d \n", p_Vid->dec_picture->frame_id);
         // }
 
+        DEC_PROF_START(PROF_INSPECT);
         export_from_inspector(inspector);
         p_Vid->dec_picture->frame_id = getNewFrameID();
 
@@ -727,11 +781,24 @@ int decode_one_frame(VideoParameters *p_Vid)
 
         init_inspector(&inspector, p_Vid, picture_order(p_Vid)/p_Inp->poc_scale);
         inspect_pic_type(inspector, p_Vid->type);
-
+        selected = select_picture(p_Vid, inspector->num_display);
+        inspect_set_selected(inspector, selected && !syntax_stats_enabled());
+        inspect_set_residual(inspector, p_Vid->dec_mode == DEC_FULL);
+        if (syntax_stats_enabled())
+          syntax_stats_start_picture(p_Vid->dec_picture->frame_id, inspector->num_display, p_Vid->type, p_Vid->structure, selected);
+        DEC_PROF_STOP(PROF_INSPECT);
+
+        /***** XML_TRACE_BEGIN *****/
+        if(xml_trace_enabled(0))
+          xml_start_picture(p_Vid->dec_picture->frame_id);
+        /*****  XML_TRACE_END  *****/
       }
     }
     /****** INSPECT_BEGIN ******/
 
+    if (p_Vid->dec_picture)
+      p_Vid->dec_picture->recon_skipped = (p_Vid->dec_mode != DEC_FULL);
+
     // If primary and redundant are received and primary is correct, discard the redundant
     // else, primary slice will be replaced with redundant slice.
     if(p_Vid->frame_num == p_Vid->previous_frame_num && p_Vid->redundant_pic_cnt !=0
@@ -762,7 +829,7 @@ int decode_one_frame(VideoParameters *p_Vid)
       exit_picture(p_Vid, &p_Vid->dec_picture);
 
       /***** XML_TRACE_BEGIN *****/
-      if(xml_gen_trace_file())
+      if(xml_trace_enabled(0))
       {
         xml_check_and_write_end_element("SubPicture");
         xml_check_and_write_end_element("Picture");
@@ -785,7 +852,8 @@ int decode_one_frame(VideoParameters *p_Vid)
       currSlice->linfo_cbp_inter = linfo_cbp_inter_normal;
     }
 
-    decode_slice(currSlice, current_header, inspector);
+    if (p_Vid->dec_mode != DEC_SKIP)
+      decode_slice(currSlice, current_header, inspector);
 
     p_Vid->newframe = 0;
     ++(p_Vid->current_slice_nr);
@@ -794,7 +862,7 @@ int decode_one_frame(VideoParameters *p_Vid)
   exit_picture(p_Vid, &p_Vid->dec_picture);
 
 	/***** XML_TRACE_BEGIN *****/
-	if(xml_gen_trace_file())
+	if(xml_trace_enabled(0))
 	{
 		xml_check_and_write_end_element("SubPicture");
 		xml_check_and_write_end_element("Picture");
@@ -1000,6 +1068,10 @@ void find_snr(VideoParameters *p_Vid,
   // picture error concealment
   char yuv_types[4][6]= {"4:0:0","4:2:0","4:2:2","4:4:4"};
 
+  // pictures skipped by selective decoding have no samples to compare
+  if (p->recon_skipped)
+    return;
+
   comp_size_x[0] = p_Inp->source.width;
   comp_size_y[0] = p_Inp->source.height;
   comp_size_x[1] = comp_size_x[2] = p_Inp->source.width_cr;
@@ -1137,6 +1209,8 @@ void set_ref_pic_num(VideoParameters *p_Vid)
   StorablePicture *dec_picture = p_Vid->dec_picture;
   int slice_id=p_Vid->current_slice_nr;
 
+  clear_ref_pic_num(dec_picture, slice_id);
+
   for (i=0;i<p_Vid->listXsize[LIST_0];++i)
   {
     dec_picture->ref_pic_num        [slice_id][LIST_0][i] = p_Vid->listX[LIST_0][i]->poc * 2 + ((p_Vid->listX[LIST_0][i]->structure==BOTTOM_FIELD)?1:0) ;
@@ -1185,7 +1259,7 @@ int read_new_slice(Slice *currSlice)
   VideoParameters *p_Vid = currSlice->p_Vid;
   InputParameters *p_Inp = currSlice->p_Inp;
 
-  NALU_t *nalu = AllocNALU(MAX_CODED_FRAME_SIZE);
+  NALU_t *nalu = p_Vid->nalu;
   int current_header = 0;
   int BitsUsedByHeader;
   Bitstream *currStream;
@@ -1352,7 +1426,6 @@ process_nalu:
           arideco_start_decoding (&currSlice->partArr[0].de_cabac, currStream->streamBuffer, ByteStartPosition, &currStream->read_len);
         }
         // printf ("read_new_slice: returning %s\n", current_header == SOP?"SOP":"SOS");
-        FreeNALU(nalu);
         p_Vid->recovery_point = 0;
         return current_header;
         break;
@@ -1530,7 +1603,6 @@ process_nalu:
           // (which should be taken care of anyway)
         }
 
-        FreeNALU(nalu);
         return current_header;
 
         break;
@@ -1599,7 +1671,7 @@ process_nalu:
     }
 
 	/***** XML_TRACE_BEGIN *****/
-	if(xml_gen_trace_file())
+	if(xml_trace_enabled(0))
 	{
 		if(nalu->nal_unit_type > 5)
 			writeNALInfo(currSlice);
@@ -1607,8 +1679,6 @@ process_nalu:
 	/*****  XML_TRACE_END  *****/
   }
 
-  FreeNALU(nalu);
-
   return  current_header;
 }
 
@@ -1644,10 +1714,13 @@ void exit_picture(VideoParameters *p_Vid, StorablePicture **dec_picture)
 
   recfr.p_Vid = p_Vid;
   recfr.yptr = &(*dec_picture)->imgY[0][0];
+  recfr.ystride = (*dec_picture)->planeY.stride;
+  recfr.uvstride = 0;
   if ((*dec_picture)->chroma_format_idc != YUV400)
   {
     recfr.uptr = &(*dec_picture)->imgUV[0][0][0];
     recfr.vptr = &(*dec_picture)->imgUV[1][0][0];
+    recfr.uvstride = (*dec_picture)->planeUV[0].stride;
   }
 
   //! this is always true at the beginning of a picture
@@ -1655,7 +1728,7 @@ void exit_picture(VideoParameters *p_Vid, StorablePicture **dec_picture)
   ercSegment = 0;
 
   //! mark the start of the first segment
-  if (!(*dec_picture)->mb_aff_frame_flag)
+  if (!(*dec_picture)->mb_aff_frame_flag && !(*dec_picture)->recon_skipped)
   {
     ercStartSegment(0, ercSegment, 0 , p_Vid->erc_errorVar);
     //! generate the segments according to the macroblock map
@@ -1694,23 +1767,31 @@ void exit_picture(VideoParameters *p_Vid, StorablePicture **dec_picture)
   }
 
   //deblocking for frame or field
+  DEC_PROF_SET_SLICE_TYPE((*dec_picture)->slice_type);
   if( IS_INDEPENDENT(p_Vid) )
   {
     int colour_plane_id = p_Vid->colour_plane_id;
     for( nplane=0; nplane<MAX_PLANE; ++nplane )
     {
       change_plane_JV( p_Vid, nplane );
-      DeblockPicture( p_Vid, *dec_picture );
+      if (!(*dec_picture)->recon_skipped)
+      {
+        DEC_PROF_START(PROF_DEBLOCK);
+        DeblockPicture( p_Vid, *dec_picture );
+        DEC_PROF_STOP(PROF_DEBLOCK);
+      }
     }
     p_Vid->colour_plane_id = colour_plane_id;
     make_frame_picture_JV(p_Vid);
   }
-  else
+  else if (!(*dec_picture)->recon_skipped)
   {
+    DEC_PROF_START(PROF_DEBLOCK);
     DeblockPicture( p_Vid, *dec_picture );
+    DEC_PROF_STOP(PROF_DEBLOCK);
   }
 
-  if ((*dec_picture)->mb_aff_frame_flag)
+  if ((*dec_picture)->mb_aff_frame_flag && !(*dec_picture)->recon_skipped)
     MbAffPostProc(p_Vid);
 
   if (p_Vid->structure == FRAME)         // buffer mgt. for frame mode
@@ -2149,16 +2230,16 @@ void decode_one_slice(Slice *currSlice, Inspector* inspector)
   VideoParameters *p_Vid = currSlice->p_Vid;
   Boolean end_of_slice = FALSE;
   Macroblock *currMB = NULL;
+  int gen_syntax_stats = syntax_stats_enabled();
+  int mb_start_bits = 0;
   p_Vid->cod_counter=-1;
 
 	/***** XML_TRACE_BEGIN *****/
-	if(xml_gen_trace_file())
+	if(xml_trace_enabled(0))
 	{
 		xml_write_start_element("Slice");
 			xml_write_int_attribute("num", p_Vid->current_slice_nr);
-			xml_write_start_element("Type");
-				xml_write_int(p_Vid->type);
-			xml_write_end_element();
+			xml_write_int_element("Type", p_Vid->type);
 			xml_write_start_element("TypeString");
 			switch(p_Vid->type)
 			{
@@ -2174,6 +2255,7 @@ void decode_one_slice(Slice *currSlice, Inspector* inspector)
 	/****** XML_TRACE_END ******/
 
   setup_slice_methods(currSlice);
+  DEC_PROF_SET_SLICE_TYPE(currSlice->slice_type);
 
   if( IS_INDEPENDENT(p_Vid) )
   {
@@ -2197,7 +2279,7 @@ void decode_one_slice(Slice *currSlice, Inspector* inspector)
 #endif
 
 		/***** XML_TRACE_BEGIN *****/
-		if(xml_gen_trace_file() && xml_get_log_level() >= 1)
+		if(xml_trace_enabled(1))
 		{
 			xml_write_start_element("MacroBlock");
 				xml_write_int_attribute("num", p_Vid->current_mb_nr);
@@ -2206,40 +2288,66 @@ void decode_one_slice(Slice *currSlice, Inspector* inspector)
 
     // Initializes the current macroblock
     start_macroblock(currSlice, &currMB);
+    if (gen_syntax_stats)
+      mb_start_bits = syntax_stats_bits_read(currSlice);
     // Get the syntax elements from the NAL
-    currSlice->read_one_macroblock(currMB);
+    {
+      DEC_PROF_START(PROF_ENTROPY);
+      currSlice->read_one_macroblock(currMB);
+      DEC_PROF_STOP(PROF_ENTROPY);
+    }
+    if (gen_syntax_stats)
+      syntax_stats_add_mb(currMB, currSlice, g_mb_type, syntax_stats_bits_read(currSlice) - mb_start_bits);
 
     /***** XML_TRACE_BEGIN *****/
-    if(xml_gen_trace_file() && xml_get_log_level() >= 1)
+    if(xml_trace_enabled(1))
     {
       xml_write_start_element("Position");
-        xml_write_start_element("X");
-          xml_write_int(currMB->mb_x * MB_BLOCK_SIZE);
-        xml_write_end_element();
-        xml_write_start_element("Y");
-          xml_write_int(currMB->mb_y * MB_BLOCK_SIZE);
-        xml_write_end_element();
-      xml_write_end_element();
-      xml_write_start_element("QP_Y");
-        xml_write_int(currMB->qp);
+        xml_write_int_element("X", currMB->mb_x * MB_BLOCK_SIZE);
+        xml_write_int_element("Y", currMB->mb_y * MB_BLOCK_SIZE);
       xml_write_end_element();
+      xml_write_int_element("QP_Y", currMB->qp);
 
       writeMBInfo(currMB, currSlice);
 
-      if(xml_get_log_level() >= 4) addCoeffsToTrace(currMB, currSlice);
+      if(xml_trace_enabled(4)) addCoeffsToTrace(currMB, currSlice);
     }
     /****** XML_TRACE_END ******/
 
     /****** INSPECT_BEGIN ******/
-    extract_mb_type(currMB, currSlice, g_mb_type, inspector->img_type);
-    extract_coeffs(currMB, currSlice, inspector->coeffs);
+    if (inspector->is_selected)
+    {
+      DEC_PROF_START(PROF_INSPECT);
+      if (inspector->compact)
+      {
+        extract_mb_info(currMB, currSlice, g_mb_type, inspector);
+        extract_coeffs_sparse(currMB, currSlice, inspector);
+      }
+      else
+      {
+        extract_mb_type(currMB, currSlice, g_mb_type, inspector->img_type);
+        extract_coeffs(currMB, currSlice, inspector->coeffs);
+      }
+      DEC_PROF_STOP(PROF_INSPECT);
+    }
     /****** INSPECT_END ******/
 
-    decode_one_macroblock(currMB, p_Vid->dec_picture);
+    // in parse-only mode the motion of direct predicted blocks is not derived either
+    if (p_Vid->dec_mode == DEC_FULL)
+    {
+      DEC_PROF_START(PROF_RECON);
+      decode_one_macroblock(currMB, p_Vid->dec_picture);
+      DEC_PROF_STOP(PROF_RECON);
 
-    /****** INSPECT_BEGIN ******/
-    extract_residual(currMB, currSlice, inspector->residual);
-    /****** INSPECT_END ******/
+      /****** INSPECT_BEGIN ******/
+      if (inspector->is_selected && !inspector->compact)
+      {
+        DEC_PROF_START(PROF_INSPECT);
+        extract_residual(currMB, currSlice, inspector->residual);
+        DEC_PROF_STOP(PROF_INSPECT);
+      }
+      /****** INSPECT_END ******/
+    }
 
     if(currSlice->mb_aff_frame_flag && p_Vid->dec_picture->motion.mb_field[p_Vid->current_mb_nr])
     {
@@ -2252,7 +2360,7 @@ void decode_one_slice(Slice *currSlice, Inspector* inspector)
     end_of_slice = exit_macroblock(currSlice, (!currSlice->mb_aff_frame_flag||p_Vid->current_mb_nr%2));
 
 		/***** XML_TRACE_BEGIN *****/
-		if(xml_gen_trace_file()  && xml_get_log_level() >= 1)
+		if(xml_trace_enabled(1))
 		{
 			xml_write_end_element();
 		}
@@ -2263,7 +2371,7 @@ void decode_one_slice(Slice *currSlice, Inspector* inspector)
   //reset_ec_flags(p_Vid);
 
 	/***** XML_TRACE_BEGIN *****/
-	if(xml_gen_trace_file())
+	if(xml_trace_enabled(0))
 	{
 		xml_write_end_element();
 	}
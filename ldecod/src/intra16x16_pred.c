@@ -16,6 +16,7 @@
  */
 #include "global.h"
 #include "intra16x16_pred.h"
+#include "intra_pred_common.h"
 #include "mb_access.h"
 #include "image.h"
 
@@ -39,48 +40,23 @@ static inline int intra16x16_dc_pred(Macroblock *currMB,
 
   int i,j;
 
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
+  imgpel PredPel[3 * MB_BLOCK_SIZE + 1];  // array of predictor pels
+  imgpel *up_pels = &PredPel[1], *left_pels = &PredPel[2 * MB_BLOCK_SIZE + 1];
   imgpel **mb_pred = &(currSlice->mb_pred[pl][0]); 
+  IntraBlockAvail avail;
 
-  PixelPos up;          //!< pixel position p(0,-1)
-  PixelPos left[17];    //!< pixel positions p(-1, -1..15)
-
-  int up_avail, left_avail, left_up_avail;
-
-  s1=s2=0;
-
-  for (i=0;i<17;++i)
-  {
-    p_Vid->getNeighbour(currMB, -1,  i-1, p_Vid->mb_size[IS_LUMA], &left[i]);
-  }
-  p_Vid->getNeighbour(currMB,    0,   -1, p_Vid->mb_size[IS_LUMA], &up);
-
-  if (!p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    up_avail      = up.available;
-    left_avail    = left[1].available;
-    left_up_avail = left[0].available;
-  }
-  else
-  {
-    up_avail      = up.available ? p_Vid->intra_block[up.mb_addr] : 0;
-    for (i = 1, left_avail = 1; i < 17; ++i)
-      left_avail  &= left[i].available ? p_Vid->intra_block[left[i].mb_addr]: 0;
-    left_up_avail = left[0].available ? p_Vid->intra_block[left[0].mb_addr]: 0;
-  }
+  get_intra_pred_pels(currMB, pl, 0, 0, MB_BLOCK_SIZE, PredPel, &avail);
 
   for (i = 0; i < MB_BLOCK_SIZE; ++i)
   {
-    if (up_avail)
-      s1 += imgY[up.pos_y][up.pos_x+i];    // sum hor pix
-    if (left_avail)
-      s2 += imgY[left[i + 1].pos_y][left[i + 1].pos_x];    // sum vert pix
+    s1 += up_pels[i];      // sum hor pix
+    s2 += left_pels[i];    // sum vert pix
   }
-  if (up_avail && left_avail)
+  if (avail.up && avail.left)
     s0 = (s1 + s2 + 16)>>5;       // no edge
-  else if (!up_avail && left_avail)
+  else if (!avail.up && avail.left)
     s0 = (s2 + 8)>>4;              // upper edge
-  else if (up_avail && !left_avail)
+  else if (avail.up && !avail.left)
     s0 = (s1 + 8)>>4;              // left edge
   else
     s0 = p_Vid->dc_pred_value_comp[pl];                            // top left corner, nothing to predict from
@@ -111,32 +87,15 @@ static inline int intra16x16_vert_pred(Macroblock *currMB,
                                        ColorPlane pl)
 {
   Slice *currSlice = currMB->p_Slice;
-  VideoParameters *p_Vid = currMB->p_Vid;
+  IntraNeighbours *nb = &currSlice->intra_nb;
   
   int j;
 
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-
-  PixelPos up;          //!< pixel position p(0,-1)
-
-  int up_avail;
-
-  p_Vid->getNeighbour(currMB,    0,   -1, p_Vid->mb_size[IS_LUMA], &up);
-
-  if (!p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    up_avail = up.available;
-  }
-  else
-  {
-    up_avail = up.available ? p_Vid->intra_block[up.mb_addr] : 0;
-  }
-
-  if (!up_avail)
+  if (!nb->up_avail)
     error ("invalid 16x16 intra pred Mode VERT_PRED_16",500);
 
   for(j=0;j<MB_BLOCK_SIZE;++j)
-    memcpy(&currSlice->mb_pred[pl][j][0], &(imgY[up.pos_y][up.pos_x]), MB_BLOCK_SIZE * sizeof(imgpel));
+    memcpy(&currSlice->mb_pred[pl][j][0], &nb->up[1], MB_BLOCK_SIZE * sizeof(imgpel));
 
   return DECODING_OK;
 }
@@ -156,40 +115,22 @@ static inline int intra16x16_hor_pred(Macroblock *currMB,
                                       ColorPlane pl)
 {
   Slice *currSlice = currMB->p_Slice;
-  VideoParameters *p_Vid = currMB->p_Vid;
   int i,j;
 
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
+  imgpel PredPel[3 * MB_BLOCK_SIZE + 1];  // array of predictor pels
+  imgpel *left_pels = &PredPel[2 * MB_BLOCK_SIZE + 1];
   imgpel **mb_pred = &(currSlice->mb_pred[pl][0]); 
   imgpel prediction;
+  IntraBlockAvail avail;
 
-  PixelPos left[17];    //!< pixel positions p(-1, -1..15)
-
-  int left_avail, left_up_avail;
-
-  for (i=0;i<17;++i)
-  {
-    p_Vid->getNeighbour(currMB, -1,  i-1, p_Vid->mb_size[IS_LUMA], &left[i]);
-  }
-
-  if (!p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    left_avail    = left[1].available;
-    left_up_avail = left[0].available;
-  }
-  else
-  {
-    for (i = 1, left_avail = 1; i < 17; ++i)
-      left_avail  &= left[i].available ? p_Vid->intra_block[left[i].mb_addr]: 0;
-    left_up_avail = left[0].available ? p_Vid->intra_block[left[0].mb_addr]: 0;
-  }
+  get_intra_pred_pels(currMB, pl, 0, 0, MB_BLOCK_SIZE, PredPel, &avail);
 
-  if (!left_avail)
+  if (!avail.left)
     error ("invalid 16x16 intra pred Mode HOR_PRED_16",500);
 
   for(j = 0; j < MB_BLOCK_SIZE; ++j)
   {
-    prediction = imgY[left[j+1].pos_y][left[j+1].pos_x];
+    prediction = left_pels[j];
     for(i = 0; i < MB_BLOCK_SIZE; ++i)
       mb_pred[j][i]= prediction; // store predicted 16x16 block
   }
@@ -197,6 +138,32 @@ static inline int intra16x16_hor_pred(Macroblock *currMB,
   return DECODING_OK;
 }
 
+#if defined(__SSE2__) && (IMGTYPE < 2)
+#include <emmintrin.h>
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    stores the 16 plane prediction values of one row (SSE2)
+ *    (base + i * ib + 16) >> 5, i = -7..8, clipped to [0, max_imgpel_value]
+ ***********************************************************************
+ */
+static inline void plane_pred_row(imgpel *mpr_line, __m128i base[4], __m128i max_value)
+{
+  __m128i lo = _mm_packs_epi32(_mm_srai_epi32(base[0], 5), _mm_srai_epi32(base[1], 5));
+  __m128i hi = _mm_packs_epi32(_mm_srai_epi32(base[2], 5), _mm_srai_epi32(base[3], 5));
+
+  lo = _mm_min_epi16(_mm_max_epi16(lo, _mm_setzero_si128()), max_value);
+  hi = _mm_min_epi16(_mm_max_epi16(hi, _mm_setzero_si128()), max_value);
+#if (IMGTYPE == 0)
+  _mm_storeu_si128((__m128i *) mpr_line, _mm_packus_epi16(lo, hi));
+#else
+  _mm_storeu_si128((__m128i *) mpr_line, lo);
+  _mm_storeu_si128((__m128i *) (mpr_line + 8), hi);
+#endif
+}
+#endif
+
 /*!
  ***********************************************************************
  * \brief
@@ -218,53 +185,56 @@ static inline int intra16x16_plane_pred(Macroblock *currMB,
   int ih = 0, iv = 0;
   int ib,ic,iaa;
 
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
+  imgpel PredPel[3 * MB_BLOCK_SIZE + 1];  // array of predictor pels
   imgpel **mb_pred = &(currSlice->mb_pred[pl][0]); 
-  imgpel *mpr_line;
+  imgpel *mpr_line, *left_line;
   int max_imgpel_value = p_Vid->max_pel_value_comp[pl];
+  IntraBlockAvail avail;
 
-  PixelPos up;          //!< pixel position p(0,-1)
-  PixelPos left[17];    //!< pixel positions p(-1, -1..15)
-
-  int up_avail, left_avail, left_up_avail;
-
-  for (i=0;i<17; ++i)
-  {
-    p_Vid->getNeighbour(currMB, -1,  i-1, p_Vid->mb_size[IS_LUMA], &left[i]);
-  }
-  p_Vid->getNeighbour(currMB,    0,   -1, p_Vid->mb_size[IS_LUMA], &up);
-
-  if (!p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    up_avail      = up.available;
-    left_avail    = left[1].available;
-    left_up_avail = left[0].available;
-  }
-  else
-  {
-    up_avail      = up.available ? p_Vid->intra_block[up.mb_addr] : 0;
-    for (i = 1, left_avail = 1; i < 17; ++i)
-      left_avail  &= left[i].available ? p_Vid->intra_block[left[i].mb_addr]: 0;
-    left_up_avail = left[0].available ? p_Vid->intra_block[left[0].mb_addr]: 0;
-  }
+  get_intra_pred_pels(currMB, pl, 0, 0, MB_BLOCK_SIZE, PredPel, &avail);
 
-  if (!up_avail || !left_up_avail  || !left_avail)
+  if (!avail.up || !avail.up_left  || !avail.left)
     error ("invalid 16x16 intra pred Mode PLANE_16",500);
 
-  mpr_line = &imgY[up.pos_y][up.pos_x+7];
+  // PredPel[0] is p(-1,-1), so that p(-1,-1..15) and p(-1..15,-1) are both contiguous
+  mpr_line  = &PredPel[8];
+  left_line = &PredPel[2 * MB_BLOCK_SIZE];
+  left_line[0] = PredPel[0];
   for (i = 1; i < 8; ++i)
   {
     ih += i*(mpr_line[i] - mpr_line[-i]);
-    iv += i*(imgY[left[8+i].pos_y][left[8+i].pos_x] - imgY[left[8-i].pos_y][left[8-i].pos_x]);
+    iv += i*(left_line[8 + i] - left_line[8 - i]);
   }
 
-  ih += 8*(mpr_line[8] - imgY[left[0].pos_y][left[0].pos_x]);
-  iv += 8*(imgY[left[16].pos_y][left[16].pos_x] - imgY[left[0].pos_y][left[0].pos_x]);
+  ih += 8*(mpr_line[8] - PredPel[0]);
+  iv += 8*(left_line[16] - PredPel[0]);
 
   ib=(5 * ih + 32)>>6;
   ic=(5 * iv + 32)>>6;
 
-  iaa=16 * (mpr_line[8] + imgY[left[16].pos_y][left[16].pos_x]);
+  iaa=16 * (mpr_line[8] + left_line[16]);
+#if defined(__SSE2__) && (IMGTYPE < 2)
+  {
+    __m128i max_value = _mm_set1_epi16((short) max_imgpel_value);
+    __m128i step  = _mm_set1_epi32(ic);
+    __m128i base[4];
+
+    // iaa + (i - 7) * ib + (j - 7) * ic + 16 for j = 0
+    for (i = 0; i < 4; ++i)
+    {
+      int x = 4 * i - 7;
+      base[i] = _mm_setr_epi32(x * ib, (x + 1) * ib, (x + 2) * ib, (x + 3) * ib);
+      base[i] = _mm_add_epi32(base[i], _mm_set1_epi32(iaa - 7 * ic + 16));
+    }
+
+    for (j = 0;j < MB_BLOCK_SIZE; ++j)
+    {
+      plane_pred_row(mb_pred[j], base, max_value);
+      for (i = 0; i < 4; ++i)
+        base[i] = _mm_add_epi32(base[i], step);
+    }
+  }
+#else
   for (j = 0;j < MB_BLOCK_SIZE; ++j)
   {
     for (i = 0;i < MB_BLOCK_SIZE; ++i)
@@ -272,6 +242,7 @@ static inline int intra16x16_plane_pred(Macroblock *currMB,
       mb_pred[j][i] = (imgpel) iClip1(max_imgpel_value, ((iaa + (i - 7) * ib + (j - 7) * ic + 16) >> 5));
     }
   }// store plane prediction
+#endif
 
   return DECODING_OK;
 }
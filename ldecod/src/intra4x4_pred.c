@@ -14,6 +14,7 @@
  */
 #include "global.h"
 #include "intra4x4_pred.h"
+#include "intra_pred_common.h"
 #include "mb_access.h"
 #include "image.h"
 
@@ -68,70 +69,33 @@ static inline int intra4x4_dc_pred(Macroblock *currMB,
                                    int joff)
 {
   Slice *currSlice = currMB->p_Slice;
-  VideoParameters *p_Vid = currMB->p_Vid;  
-
+  VideoParameters *p_Vid = currMB->p_Vid;
+  
   int i,j;
   int s0 = 0;  
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-
-  PixelPos pix_a[4], pix_b;
-
-  int block_available_up;
-  int block_available_left;  
+  imgpel PredPel[13];  // array of predictor pels
+  IntraBlockAvail avail;
 
   imgpel **mb_pred = currSlice->mb_pred[pl];    
 
-  for (i=0;i<4;++i)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, p_Vid->mb_size[IS_LUMA], &pix_a[i]);
-  }
-  p_Vid->getNeighbour(currMB, ioff    , joff -1 , p_Vid->mb_size[IS_LUMA], &pix_b);
-
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<4;++i)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-  }
-
-  // form predictor pels
-  if (block_available_up)
-  {
-    s0 += imgY[pix_b.pos_y][pix_b.pos_x + 0];
-    s0 += imgY[pix_b.pos_y][pix_b.pos_x + 1];
-    s0 += imgY[pix_b.pos_y][pix_b.pos_x + 2];
-    s0 += imgY[pix_b.pos_y][pix_b.pos_x + 3];
-  }
-
-  if (block_available_left)
-  {
-    s0 += imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-    s0 += imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-    s0 += imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-    s0 += imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE, PredPel, &avail);
 
-  if (block_available_up && block_available_left)
+  if (avail.up && avail.left)
   {
     // no edge
-    s0 = (s0 + 4)>>3;
+    s0 = (P_A + P_B + P_C + P_D + P_I + P_J + P_K + P_L + 4) >> 3;
   }
-  else if (!block_available_up && block_available_left)
+  else if (!avail.up && avail.left)
   {
     // upper edge
-    s0 = (s0 + 2)>>2;
+    s0 = (P_I + P_J + P_K + P_L + 2) >> 2;
   }
-  else if (block_available_up && !block_available_left)
+  else if (avail.up && !avail.left)
   {
     // left edge
-    s0 = (s0 + 2)>>2;
+    s0 = (P_A + P_B + P_C + P_D + 2) >> 2;
   }
-  else //if (!block_available_up && !block_available_left)
+  else //if (!avail.up && !avail.left)
   {
     // top left corner, nothing to predict from
     s0 = p_Vid->dc_pred_value_comp[pl];
@@ -167,30 +131,18 @@ static inline int intra4x4_vert_pred(Macroblock *currMB,    //!< current macrobl
   VideoParameters *p_Vid = currMB->p_Vid;
   
   int j;
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-  
-  int block_available_up;
-
-  PixelPos pix_b;
+  imgpel PredPel[13];  // array of predictor pels
+  IntraBlockAvail avail;
 
   imgpel **mb_pred = currSlice->mb_pred[pl];
 
-  p_Vid->getNeighbour(currMB, ioff, joff - 1 , p_Vid->mb_size[IS_LUMA], &pix_b);
-
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    block_available_up = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_up = pix_b.available;
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE, PredPel, &avail);
 
-  if (!block_available_up)
+  if (!avail.up)
     printf ("warning: Intra_4x4_Vertical prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
   for(j = joff; j < joff + BLOCK_SIZE; ++j) /* store predicted 4x4 block */
-    memcpy(&(mb_pred[j][ioff]), &(imgY[pix_b.pos_y][pix_b.pos_x]), BLOCK_SIZE * sizeof(imgpel));
+    memcpy(&(mb_pred[j][ioff]), &P_A, BLOCK_SIZE * sizeof(imgpel));
 
   return DECODING_OK;
 }
@@ -219,40 +171,24 @@ static inline int intra4x4_hor_pred(Macroblock *currMB,
                                     int ioff,
                                     int joff)
 {
-  VideoParameters *p_Vid = currMB->p_Vid;
   Slice *currSlice = currMB->p_Slice;
-
+  VideoParameters *p_Vid = currMB->p_Vid;
+  
   int i,j;
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-
-  PixelPos pix_a[4];
-
-  int block_available_left;
+  imgpel PredPel[13];  // array of predictor pels
+  IntraBlockAvail avail;
 
   imgpel *predrow, prediction, **mb_pred = currSlice->mb_pred[pl];    
 
-  for (i=0;i<4;++i)
-  {
-    p_Vid->getNeighbour(currMB, ioff -1 , joff +i , p_Vid->mb_size[IS_LUMA], &pix_a[i]);
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE, PredPel, &avail);
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<4;++i)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-  }
-
-  if (!block_available_left)
+  if (!avail.left)
     printf ("warning: Intra_4x4_Horizontal prediction mode not allowed at mb %d\n",(int) p_Vid->current_mb_nr);
 
   for(j=0;j<BLOCK_SIZE;++j)
   {
     predrow = mb_pred[j+joff];
-    prediction = imgY[pix_a[j].pos_y][pix_a[j].pos_x];
+    prediction = (&P_I)[j];
     for(i = ioff;i < ioff + BLOCK_SIZE;++i)
       predrow[i]= prediction; /* store predicted 4x4 block */
   }
@@ -278,75 +214,29 @@ static inline int intra4x4_diag_down_right_pred(Macroblock *currMB,    //!< curr
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-  int i;
+  int j;
   imgpel PredPel[13];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-
-  PixelPos pix_a[4];
-  PixelPos pix_b, pix_d;
+  imgpel Edge[9];      // predictor pels L, K, J, I, X, A, B, C, D
+  imgpel PredVal[7];   // filtered pels, one per diagonal
+  IntraBlockAvail avail;
 
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-
-  int jpos0 = joff, jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
-  int ipos0 = ioff, ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   imgpel **mb_pred = currSlice->mb_pred[pl];    
 
-  for (i=0;i<4;++i)
-  {
-    p_Vid->getNeighbour(currMB, ioff -1 , joff +i , p_Vid->mb_size[IS_LUMA], &pix_a[i]);
-  }
-
-  p_Vid->getNeighbour(currMB, ioff    , joff -1 , p_Vid->mb_size[IS_LUMA], &pix_b);
-  p_Vid->getNeighbour(currMB, ioff -1 , joff -1 , p_Vid->mb_size[IS_LUMA], &pix_d);
-
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<4;++i)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_left  = pix_d.available;
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE, PredPel, &avail);
 
-  if ((!block_available_up)||(!block_available_left)||(!block_available_up_left))
+  if ((!avail.up)||(!avail.left)||(!avail.up_left))
     printf ("warning: Intra_4x4_Diagonal_Down_Right prediction mode not allowed at mb %d\n",(int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  P_A = imgY[pix_b.pos_y][pix_b.pos_x + 0];
-  P_B = imgY[pix_b.pos_y][pix_b.pos_x + 1];
-  P_C = imgY[pix_b.pos_y][pix_b.pos_x + 2];
-  P_D = imgY[pix_b.pos_y][pix_b.pos_x + 3];
+  // every down right diagonal holds one filtered pel of L..I, X, A..D
+  Edge[0] = P_L;
+  Edge[1] = P_K;
+  Edge[2] = P_J;
+  Edge[3] = P_I;
+  memcpy(&Edge[4], &P_X, 5 * sizeof(imgpel));
+  filter_pels_121(PredVal, &Edge[1], 7);
 
-  P_I = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-  P_J = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-  P_K = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-  P_L = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-
-  P_X = imgY[pix_d.pos_y][pix_d.pos_x];
-
-  mb_pred[jpos3][ipos0] = (imgpel) ((P_L + 2*P_K + P_J + 2) >> 2);
-  mb_pred[jpos2][ipos0] =
-  mb_pred[jpos3][ipos1] = (imgpel) ((P_K + 2*P_J + P_I + 2) >> 2);
-  mb_pred[jpos1][ipos0] =
-  mb_pred[jpos2][ipos1] =
-  mb_pred[jpos3][ipos2] = (imgpel) ((P_J + 2*P_I + P_X + 2) >> 2);
-  mb_pred[jpos0][ipos0] =
-  mb_pred[jpos1][ipos1] =
-  mb_pred[jpos2][ipos2] =
-  mb_pred[jpos3][ipos3] = (imgpel) ((P_I + 2*P_X + P_A + 2) >> 2);
-  mb_pred[jpos0][ipos1] =
-  mb_pred[jpos1][ipos2] =
-  mb_pred[jpos2][ipos3] = (imgpel) ((P_X + 2*P_A + P_B + 2) >> 2);
-  mb_pred[jpos0][ipos2] =
-  mb_pred[jpos1][ipos3] = (imgpel) ((P_A + 2*P_B + P_C + 2) >> 2);
-  mb_pred[jpos0][ipos3] = (imgpel) ((P_B + 2*P_C + P_D + 2) >> 2);
+  for (j = 0; j < BLOCK_SIZE; ++j)
+    memcpy(&mb_pred[joff + j][ioff], &PredVal[3 - j], BLOCK_SIZE * sizeof(imgpel));
 
   return DECODING_OK;
 }
@@ -369,71 +259,25 @@ static inline int intra4x4_diag_down_left_pred(Macroblock *currMB,    //!< curre
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
+  int j;
   imgpel PredPel[13];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-
-  PixelPos pix_b, pix_c;
+  imgpel PredVal[7];   // filtered pels, one per diagonal
+  IntraBlockAvail avail;
 
-  int block_available_up;
-  int block_available_up_right;
-
-  int jpos0 = joff, jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
-  int ipos0 = ioff, ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   imgpel **mb_pred = currSlice->mb_pred[pl];    
 
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, p_Vid->mb_size[IS_LUMA], &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 4, joff - 1, p_Vid->mb_size[IS_LUMA], &pix_c);
-
-  pix_c.available = pix_c.available && !((ioff==4) && ((joff==4)||(joff==12)));
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE, PredPel, &avail);
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-  }
-
-  if (!block_available_up)
+  if (!avail.up)
     printf ("warning: Intra_4x4_Diagonal_Down_Left prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  P_A = imgY[pix_b.pos_y][pix_b.pos_x + 0];
-  P_B = imgY[pix_b.pos_y][pix_b.pos_x + 1];
-  P_C = imgY[pix_b.pos_y][pix_b.pos_x + 2];
-  P_D = imgY[pix_b.pos_y][pix_b.pos_x + 3];
-
-  if (block_available_up_right)
-  {
-    P_E = imgY[pix_c.pos_y][pix_c.pos_x + 0];
-    P_F = imgY[pix_c.pos_y][pix_c.pos_x + 1];
-    P_G = imgY[pix_c.pos_y][pix_c.pos_x + 2];
-    P_H = imgY[pix_c.pos_y][pix_c.pos_x + 3];
-  }
-  else
-  {
-    P_E = P_F = P_G = P_H = P_D;
-  }
+  // every down left diagonal holds one filtered pel of A..H, the last one
+  // repeats P_H, (P_G + 3*P_H + 2) >> 2
+  P_I = P_H;
+  filter_pels_121(PredVal, &P_B, 7);
 
-  mb_pred[jpos0][ipos0] = (imgpel) ((P_A + P_C + 2*(P_B) + 2) >> 2);
-  mb_pred[jpos0][ipos1] =
-  mb_pred[jpos1][ipos0] = (imgpel) ((P_B + P_D + 2*(P_C) + 2) >> 2);
-  mb_pred[jpos0][ipos2] =
-  mb_pred[jpos1][ipos1] =
-  mb_pred[jpos2][ipos0] = (imgpel) ((P_C + P_E + 2*(P_D) + 2) >> 2);
-  mb_pred[jpos0][ipos3] =
-  mb_pred[jpos1][ipos2] =
-  mb_pred[jpos2][ipos1] =
-  mb_pred[jpos3][ipos0] = (imgpel) ((P_D + P_F + 2*(P_E) + 2) >> 2);
-  mb_pred[jpos1][ipos3] =
-  mb_pred[jpos2][ipos2] =
-  mb_pred[jpos3][ipos1] = (imgpel) ((P_E + P_G + 2*(P_F) + 2) >> 2);
-  mb_pred[jpos2][ipos3] =
-  mb_pred[jpos3][ipos2] = (imgpel) ((P_F + P_H + 2*(P_G) + 2) >> 2);
-  mb_pred[jpos3][ipos3] = (imgpel) ((P_G + 3*(P_H) + 2) >> 2);
+  for (j = 0; j < BLOCK_SIZE; ++j)
+    memcpy(&mb_pred[joff + j][ioff], &PredVal[j], BLOCK_SIZE * sizeof(imgpel));
 
   return DECODING_OK;
 }
@@ -456,59 +300,18 @@ static inline int intra4x4_vert_right_pred(Macroblock *currMB,    //!< current m
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-  int i;
   imgpel PredPel[13];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-
-  PixelPos pix_a[4];
-  PixelPos pix_b, pix_d;
-
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
+  IntraBlockAvail avail;
 
   int jpos0 = joff, jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
   int ipos0 = ioff, ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   imgpel **mb_pred = currSlice->mb_pred[pl];    
 
-  for (i=0;i<4;++i)
-  {
-    p_Vid->getNeighbour(currMB, ioff -1 , joff +i , p_Vid->mb_size[IS_LUMA], &pix_a[i]);
-  }
-
-  p_Vid->getNeighbour(currMB, ioff    , joff -1 , p_Vid->mb_size[IS_LUMA], &pix_b);
-  p_Vid->getNeighbour(currMB, ioff -1 , joff -1 , p_Vid->mb_size[IS_LUMA], &pix_d);
-
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<4;++i)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_left  = pix_d.available;
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE, PredPel, &avail);
 
-  if ((!block_available_up)||(!block_available_left)||(!block_available_up_left))
+  if ((!avail.up)||(!avail.left)||(!avail.up_left))
     printf ("warning: Intra_4x4_Vertical_Right prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  P_A = imgY[pix_b.pos_y][pix_b.pos_x + 0];
-  P_B = imgY[pix_b.pos_y][pix_b.pos_x + 1];
-  P_C = imgY[pix_b.pos_y][pix_b.pos_x + 2];
-  P_D = imgY[pix_b.pos_y][pix_b.pos_x + 3];
-
-  P_I = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-  P_J = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-  P_K = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-  P_L = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-
-  P_X = imgY[pix_d.pos_y][pix_d.pos_x];
-
   mb_pred[jpos0][ipos0] =
   mb_pred[jpos2][ipos1] = (imgpel) ((P_X + P_A + 1) >> 1);
   mb_pred[jpos0][ipos1] =
@@ -548,56 +351,18 @@ static inline int intra4x4_vert_left_pred(Macroblock *currMB,    //!< current ma
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-  imgpel PredPel[13];  // array of predictor pels  
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-
-  PixelPos pix_b, pix_c;
-
-  int block_available_up;
-  int block_available_up_right;
+  imgpel PredPel[13];  // array of predictor pels
+  IntraBlockAvail avail;
 
   int jpos0 = joff, jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
   int ipos0 = ioff, ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   imgpel **mb_pred = currSlice->mb_pred[pl];    
 
-  p_Vid->getNeighbour(currMB, ioff    , joff -1 , p_Vid->mb_size[IS_LUMA], &pix_b);
-  p_Vid->getNeighbour(currMB, ioff +4 , joff -1 , p_Vid->mb_size[IS_LUMA], &pix_c);
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE, PredPel, &avail);
 
-  pix_c.available = pix_c.available && !((ioff==4) && ((joff==4)||(joff==12)));
-  
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-  }
-
-
-  if (!block_available_up)
+  if (!avail.up)
     printf ("warning: Intra_4x4_Vertical_Left prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  P_A = imgY[pix_b.pos_y][pix_b.pos_x + 0];
-  P_B = imgY[pix_b.pos_y][pix_b.pos_x + 1];
-  P_C = imgY[pix_b.pos_y][pix_b.pos_x + 2];
-  P_D = imgY[pix_b.pos_y][pix_b.pos_x + 3];
-
-  if (block_available_up_right)
-  {
-    P_E = imgY[pix_c.pos_y][pix_c.pos_x + 0];
-    P_F = imgY[pix_c.pos_y][pix_c.pos_x + 1];
-    P_G = imgY[pix_c.pos_y][pix_c.pos_x + 2];
-    P_H = imgY[pix_c.pos_y][pix_c.pos_x + 3];
-  }
-  else
-  {
-    P_E = P_F = P_G = P_H = P_D;
-  }
-
   mb_pred[jpos0][ipos0] = (imgpel) ((P_A + P_B + 1) >> 1);
   mb_pred[jpos0][ipos1] =
   mb_pred[jpos2][ipos0] = (imgpel) ((P_B + P_C + 1) >> 1);
@@ -636,42 +401,18 @@ static inline int intra4x4_hor_up_pred(Macroblock *currMB,    //!< current macro
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-  int i;
   imgpel PredPel[13];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-
-  PixelPos pix_a[4];
-
-  int block_available_left;
+  IntraBlockAvail avail;
 
   int jpos0 = joff, jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
   int ipos0 = ioff, ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   imgpel **mb_pred = currSlice->mb_pred[pl];    
 
-  for (i=0;i<4;++i)
-  {
-    p_Vid->getNeighbour(currMB, ioff -1 , joff +i , p_Vid->mb_size[IS_LUMA], &pix_a[i]);
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE, PredPel, &avail);
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<4;++i)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-  }
-
-  if (!block_available_left)
+  if (!avail.left)
     printf ("warning: Intra_4x4_Horizontal_Up prediction mode not allowed at mb %d\n",(int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  P_I = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-  P_J = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-  P_K = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-  P_L = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-
   mb_pred[jpos0][ipos0] = (imgpel) ((P_I + P_J + 1) >> 1);
   mb_pred[jpos0][ipos1] = (imgpel) ((P_I + 2*P_J + P_K + 2) >> 2);
   mb_pred[jpos0][ipos2] =
@@ -710,59 +451,18 @@ static inline int intra4x4_hor_down_pred(Macroblock *currMB,    //!< current mac
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-  int i;
   imgpel PredPel[13];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
-
-  PixelPos pix_a[4];
-  PixelPos pix_b, pix_d;
-
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
+  IntraBlockAvail avail;
 
   int jpos0 = joff, jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
   int ipos0 = ioff, ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   imgpel **mb_pred = currSlice->mb_pred[pl];    
-  
-  for (i=0;i<4;++i)
-  {
-    p_Vid->getNeighbour(currMB, ioff -1 , joff +i , p_Vid->mb_size[IS_LUMA], &pix_a[i]);
-  }
 
-  p_Vid->getNeighbour(currMB, ioff    , joff -1 , p_Vid->mb_size[IS_LUMA], &pix_b);
-  p_Vid->getNeighbour(currMB, ioff -1 , joff -1 , p_Vid->mb_size[IS_LUMA], &pix_d);
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE, PredPel, &avail);
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<4;++i)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_left  = pix_d.available;
-  }
-
-  if ((!block_available_up)||(!block_available_left)||(!block_available_up_left))
+  if ((!avail.up)||(!avail.left)||(!avail.up_left))
     printf ("warning: Intra_4x4_Horizontal_Down prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  P_A = imgY[pix_b.pos_y][pix_b.pos_x + 0];
-  P_B = imgY[pix_b.pos_y][pix_b.pos_x + 1];
-  P_C = imgY[pix_b.pos_y][pix_b.pos_x + 2];
-  P_D = imgY[pix_b.pos_y][pix_b.pos_x + 3];
-
-  P_I = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-  P_J = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-  P_K = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-  P_L = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-
-  P_X = imgY[pix_d.pos_y][pix_d.pos_x];
-
   mb_pred[jpos0][ipos0] =
   mb_pred[jpos1][ipos2] = (imgpel) ((P_X + P_I + 1) >> 1);
   mb_pred[jpos0][ipos1] =
@@ -16,6 +16,7 @@
  */
 #include "global.h"
 #include "intra8x8_pred.h"
+#include "intra_pred_common.h"
 #include "mb_access.h"
 #include "image.h"
 
@@ -69,7 +70,6 @@
  */
 static inline void LowPassForIntra8x8Pred(imgpel *PredPel, int block_up_left, int block_up, int block_left)
 {
-  int i;
   imgpel LoopArray[25];
 
   memcpy(&LoopArray[0], &PredPel[0], 25 * sizeof(imgpel));
@@ -99,10 +99,7 @@ static inline void LowPassForIntra8x8Pred(imgpel *PredPel, int block_up_left, in
       LoopArray[1] = (imgpel) ((PredPel[1] + (PredPel[1]<<1) + PredPel[2] + 2)>>2);
 
 
-    for(i = 2; i <16; i++)
-    {
-      LoopArray[i] = (imgpel) ((PredPel[i-1] + (PredPel[i]<<1) + PredPel[i+1] + 2)>>2);
-    }
+    filter_pels_121(&LoopArray[2], &PredPel[2], 14);
     LoopArray[16] = (imgpel) ((P_P + (P_P<<1) + P_O + 2)>>2);
   }
 
@@ -113,10 +110,7 @@ static inline void LowPassForIntra8x8Pred(imgpel *PredPel, int block_up_left, in
     else
       LoopArray[17] = (imgpel) ((P_Q + (P_Q<<1) + P_R + 2)>>2);
 
-    for(i = 18; i <24; i++)
-    {
-      LoopArray[i] = (imgpel) ((PredPel[i-1] + (PredPel[i]<<1) + PredPel[i+1] + 2)>>2);
-    }
+    filter_pels_121(&LoopArray[18], &PredPel[18], 6);
     LoopArray[24] = (imgpel) ((P_W + (P_X<<1) + P_X + 2) >> 2);
   }
 
@@ -131,7 +125,6 @@ static inline void LowPassForIntra8x8Pred(imgpel *PredPel, int block_up_left, in
  */
 static inline void LowPassForIntra8x8PredHor(imgpel *PredPel, int block_up_left, int block_up, int block_left)
 {
-  int i;
   imgpel LoopArray[25];
 
   memcpy(&LoopArray[0], &PredPel[0], 25 * sizeof(imgpel));
@@ -161,10 +154,7 @@ static inline void LowPassForIntra8x8PredHor(imgpel *PredPel, int block_up_left,
       LoopArray[1] = (imgpel) ((PredPel[1] + (PredPel[1]<<1) + PredPel[2] + 2)>>2);
 
 
-    for(i = 2; i <16; i++)
-    {
-      LoopArray[i] = (imgpel) ((PredPel[i-1] + (PredPel[i]<<1) + PredPel[i+1] + 2)>>2);
-    }
+    filter_pels_121(&LoopArray[2], &PredPel[2], 14);
     LoopArray[16] = (imgpel) ((P_P + (P_P<<1) + P_O + 2)>>2);
   }
 
@@ -182,7 +172,6 @@ static inline void LowPassForIntra8x8PredVer(imgpel *PredPel, int block_up_left,
 {
   // These functions need some cleanup and can be further optimized. 
   // For convenience, let us copy all data for now. It is obvious that the filtering makes things a bit more "complex"
-  int i;
   imgpel LoopArray[25];
 
   memcpy(&LoopArray[0], &PredPel[0], 25 * sizeof(imgpel));
@@ -209,10 +198,7 @@ static inline void LowPassForIntra8x8PredVer(imgpel *PredPel, int block_up_left,
     else
       LoopArray[17] = (imgpel) ((P_Q + (P_Q<<1) + P_R + 2)>>2);
 
-    for(i = 18; i <24; i++)
-    {
-      LoopArray[i] = (imgpel) ((PredPel[i-1] + (PredPel[i]<<1) + PredPel[i+1] + 2)>>2);
-    }
+    filter_pels_121(&LoopArray[18], &PredPel[18], 6);
     LoopArray[24] = (imgpel) ((P_W + (P_X<<1) + P_X + 2) >> 2);
   }
 
@@ -237,130 +223,32 @@ static inline int intra8x8_dc_pred(Macroblock *currMB,    //!< current macrobloc
   int i,j;
   int s0 = 0;
   imgpel PredPel[25];  // array of predictor pels
+  IntraBlockAvail avail;
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
 
-  StorablePicture *dec_picture = p_Vid->dec_picture;
-  imgpel **imgY = (pl) ? dec_picture->imgUV[pl - 1] : dec_picture->imgY; // For MB level frame/field coding tools -- set default to imgY
-
-  PixelPos pix_a[8];
-  PixelPos pix_b, pix_c, pix_d;
-
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-  int block_available_up_right;
-  
-
-  imgpel *pred_pels, **mpr = currSlice->mb_pred[pl];
-  int *mb_size = p_Vid->mb_size[IS_LUMA];
-
-  for (i=0;i<8;i++)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, mb_size, &pix_a[i]);
-  }
-
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, mb_size, &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 8, joff - 1, mb_size, &pix_c);
-  p_Vid->getNeighbour(currMB, ioff - 1, joff - 1, mb_size, &pix_d);
-
-  pix_c.available = pix_c.available &&!(ioff == 8 && joff == 8);
-
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<8;i++)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-    block_available_up_left  = pix_d.available;
-  }
-
-  // form predictor pels
-  if (block_available_up)
-  {
-    pred_pels = &imgY[pix_b.pos_y][pix_b.pos_x];
-    P_A = pred_pels[0];
-    P_B = pred_pels[1];
-    P_C = pred_pels[2];
-    P_D = pred_pels[3];
-    P_E = pred_pels[4];
-    P_F = pred_pels[5];
-    P_G = pred_pels[6];
-    P_H = pred_pels[7];
-  }
-  else
-  {
-    P_A = P_B = P_C = P_D = P_E = P_F = P_G = P_H = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_right)
-  {
-    pred_pels = &imgY[pix_c.pos_y][pix_c.pos_x];
-    P_I = pred_pels[0];
-    P_J = pred_pels[1];
-    P_K = pred_pels[2];
-    P_L = pred_pels[3];
-    P_M = pred_pels[4];
-    P_N = pred_pels[5];
-    P_O = pred_pels[6];
-    P_P = pred_pels[7];
-
-  }
-  else
-  {
-    P_I = P_J = P_K = P_L = P_M = P_N = P_O = P_P = P_H;
-  }
-
-  if (block_available_left)
-  {
-    P_Q = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-    P_R = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-    P_S = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-    P_T = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-    P_U = imgY[pix_a[4].pos_y][pix_a[4].pos_x];
-    P_V = imgY[pix_a[5].pos_y][pix_a[5].pos_x];
-    P_W = imgY[pix_a[6].pos_y][pix_a[6].pos_x];
-    P_X = imgY[pix_a[7].pos_y][pix_a[7].pos_x];
-  }
-  else
-  {
-    P_Q = P_R = P_S = P_T = P_U = P_V = P_W = P_X = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
+  imgpel **mpr = currSlice->mb_pred[pl];
 
-  if (block_available_up_left)
-  {
-    P_Z = imgY[pix_d.pos_y][pix_d.pos_x];
-  }
-  else
-  {
-    P_Z = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE_8x8, PredPel, &avail);
 
-  LowPassForIntra8x8Pred(&(P_Z), block_available_up_left, block_available_up, block_available_left);
+  LowPassForIntra8x8Pred(&(P_Z), avail.up_left, avail.up, avail.left);
   
-  if (block_available_up && block_available_left)
+  if (avail.up && avail.left)
   {
     // no edge
     s0 = (P_A + P_B + P_C + P_D + P_E + P_F + P_G + P_H + P_Q + P_R + P_S + P_T + P_U + P_V + P_W + P_X + 8) >> 4;
   }
-  else if (!block_available_up && block_available_left)
+  else if (!avail.up && avail.left)
   {
     // upper edge
     s0 = (P_Q + P_R + P_S + P_T + P_U + P_V + P_W + P_X + 4) >> 3;
   }
-  else if (block_available_up && !block_available_left)
+  else if (avail.up && !avail.left)
   {
     // left edge
     s0 = (P_A + P_B + P_C + P_D + P_E + P_F + P_G + P_H + 4) >> 3;
   }
-  else //if (!block_available_up && !block_available_left)
+  else //if (!avail.up && !avail.left)
   {
     // top left corner, nothing to predict from
     s0 = p_Vid->dc_pred_value_comp[pl];
@@ -393,95 +281,16 @@ static inline int intra8x8_vert_pred(Macroblock *currMB,    //!< current macrobl
   
   int i;
   imgpel PredPel[25];  // array of predictor pels  
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY; // For MB level frame/field coding tools -- set default to imgY
-
-  PixelPos pix_a[8];
-  PixelPos pix_b, pix_c, pix_d;
-
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-  int block_available_up_right;
-
-  
-  imgpel *pred_pels, **mpr = currSlice->mb_pred[pl];
-  int *mb_size = p_Vid->mb_size[IS_LUMA];
-
-  for (i=0;i<8;i++)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, mb_size, &pix_a[i]);
-  }
+  IntraBlockAvail avail;
 
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, mb_size, &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 8, joff - 1, mb_size, &pix_c);
-  p_Vid->getNeighbour(currMB, ioff - 1, joff - 1, mb_size, &pix_d);
+  imgpel **mpr = currSlice->mb_pred[pl];
 
-  pix_c.available = pix_c.available &&!(ioff == 8 && joff == 8);
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE_8x8, PredPel, &avail);
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<8;i++)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-    block_available_up_left  = pix_d.available;
-  }
-
-  if (!block_available_up)
+  if (!avail.up)
     printf ("warning: Intra_8x8_Vertical prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  if (block_available_up)
-  {
-    pred_pels = &imgY[pix_b.pos_y][pix_b.pos_x];
-    P_A = *(pred_pels ++);
-    P_B = *(pred_pels ++);
-    P_C = *(pred_pels ++);
-    P_D = *(pred_pels ++);
-    P_E = *(pred_pels ++);
-    P_F = *(pred_pels ++);
-    P_G = *(pred_pels ++);
-    P_H = *pred_pels;
-  }
-  else
-  {
-    P_A = P_B = P_C = P_D = P_E = P_F = P_G = P_H = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_right)
-  {
-    pred_pels = &imgY[pix_c.pos_y][pix_c.pos_x];
-    P_I = *(pred_pels ++);
-    P_J = *(pred_pels ++);
-    P_K = *(pred_pels ++);
-    P_L = *(pred_pels ++);
-    P_M = *(pred_pels ++);
-    P_N = *(pred_pels ++);
-    P_O = *(pred_pels ++);
-    P_P = *pred_pels;
-  }
-  else
-  {
-    P_I = P_J = P_K = P_L = P_M = P_N = P_O = P_P = P_H;
-  }
-
-  if (block_available_up_left)
-  {
-    P_Z = imgY[pix_d.pos_y][pix_d.pos_x];
-  }
-  else
-  {
-    P_Z = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  LowPassForIntra8x8PredHor(&(P_Z), block_available_up_left, block_available_up, block_available_left);
+  LowPassForIntra8x8PredHor(&(P_Z), avail.up_left, avail.up, avail.left);
   
   for (i=joff; i < joff + BLOCK_SIZE_8x8; i++)
   {
@@ -509,82 +318,21 @@ static inline int intra8x8_hor_pred(Macroblock *currMB,    //!< current macroblo
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-
-  int i,j;
+  int j;
   imgpel PredPel[25];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY; // For MB level frame/field coding tools -- set default to imgY
-
-  PixelPos pix_a[8];
-  PixelPos pix_b, pix_c, pix_d;
-
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-  int block_available_up_right;
+  IntraBlockAvail avail;
 
   int ipos0 = ioff    , ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   int ipos4 = ioff + 4, ipos5 = ioff + 5, ipos6 = ioff + 6, ipos7 = ioff + 7;
   int jpos;  
   imgpel **mpr = currSlice->mb_pred[pl];
-  int *mb_size = p_Vid->mb_size[IS_LUMA];
-
-  for (i=0;i<8;i++)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, mb_size, &pix_a[i]);
-  }
-
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, mb_size, &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 8, joff - 1, mb_size, &pix_c);
-  p_Vid->getNeighbour(currMB, ioff - 1, joff - 1, mb_size, &pix_d);
-
-  pix_c.available = pix_c.available &&!(ioff == 8 && joff == 8);
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<8;i++)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-    block_available_up_left  = pix_d.available;
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE_8x8, PredPel, &avail);
 
-  if (!block_available_left)
+  if (!avail.left)
     printf ("warning: Intra_8x8_Horizontal prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  if (block_available_left)
-  {
-    P_Q = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-    P_R = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-    P_S = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-    P_T = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-    P_U = imgY[pix_a[4].pos_y][pix_a[4].pos_x];
-    P_V = imgY[pix_a[5].pos_y][pix_a[5].pos_x];
-    P_W = imgY[pix_a[6].pos_y][pix_a[6].pos_x];
-    P_X = imgY[pix_a[7].pos_y][pix_a[7].pos_x];
-  }
-  else
-  {
-    P_Q = P_R = P_S = P_T = P_U = P_V = P_W = P_X = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_left)
-  {
-    P_Z = imgY[pix_d.pos_y][pix_d.pos_x];
-  }
-  else
-  {
-    P_Z = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  LowPassForIntra8x8PredVer(&(P_Z), block_available_up_left, block_available_up, block_available_left);
+  LowPassForIntra8x8PredVer(&(P_Z), avail.up_left, avail.up, avail.left);
 
   for (j=0; j < BLOCK_SIZE_8x8; j++)
   {
@@ -620,186 +368,35 @@ static inline int intra8x8_diag_down_right_pred(Macroblock *currMB,    //!< curr
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-
   int i;
   imgpel PredPel[25];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY; // For MB level frame/field coding tools -- set default to imgY
+  imgpel Edge[17];     // predictor pels X..Q, Z, A..H
+  imgpel PredVal[15];  // filtered pels, one per diagonal
+  IntraBlockAvail avail;
 
-  PixelPos pix_a[8];
-  PixelPos pix_b, pix_c, pix_d;
-
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-  int block_available_up_right;
-
-  int jpos0 = joff    , jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
-  int jpos4 = joff + 4, jpos5 = joff + 5, jpos6 = joff + 6, jpos7 = joff + 7;
-  int ipos0 = ioff    , ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
-  int ipos4 = ioff + 4, ipos5 = ioff + 5, ipos6 = ioff + 6, ipos7 = ioff + 7;  
-
-  imgpel *pred_pels, **mpr = currSlice->mb_pred[pl];
-  int *mb_size = p_Vid->mb_size[IS_LUMA];
-
-  for (i=0;i<8;i++)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, mb_size, &pix_a[i]);
-  }
-
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, mb_size, &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 8, joff - 1, mb_size, &pix_c);
-  p_Vid->getNeighbour(currMB, ioff - 1, joff - 1, mb_size, &pix_d);
+  imgpel **mpr = currSlice->mb_pred[pl];
 
-  pix_c.available = pix_c.available &&!(ioff == 8 && joff == 8);
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE_8x8, PredPel, &avail);
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<8;i++)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-    block_available_up_left  = pix_d.available;
-  }
-
-  if ((!block_available_up)||(!block_available_left)||(!block_available_up_left))
+  if ((!avail.up)||(!avail.left)||(!avail.up_left))
     printf ("warning: Intra_8x8_Diagonal_Down_Right prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  if (block_available_up)
-  {
-    pred_pels = &imgY[pix_b.pos_y][pix_b.pos_x];
-    P_A = pred_pels[0];
-    P_B = pred_pels[1];
-    P_C = pred_pels[2];
-    P_D = pred_pels[3];
-    P_E = pred_pels[4];
-    P_F = pred_pels[5];
-    P_G = pred_pels[6];
-    P_H = pred_pels[7];
-  }
-  else
-  {
-    P_A = P_B = P_C = P_D = P_E = P_F = P_G = P_H = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_right)
-  {
-    pred_pels = &imgY[pix_c.pos_y][pix_c.pos_x];
-    P_I = pred_pels[0];
-    P_J = pred_pels[1];
-    P_K = pred_pels[2];
-    P_L = pred_pels[3];
-    P_M = pred_pels[4];
-    P_N = pred_pels[5];
-    P_O = pred_pels[6];
-    P_P = pred_pels[7];
+  LowPassForIntra8x8Pred(&(P_Z), avail.up_left, avail.up, avail.left);
 
-  }
-  else
-  {
-    P_I = P_J = P_K = P_L = P_M = P_N = P_O = P_P = P_H;
-  }
-
-  if (block_available_left)
-  {
-    P_Q = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-    P_R = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-    P_S = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-    P_T = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-    P_U = imgY[pix_a[4].pos_y][pix_a[4].pos_x];
-    P_V = imgY[pix_a[5].pos_y][pix_a[5].pos_x];
-    P_W = imgY[pix_a[6].pos_y][pix_a[6].pos_x];
-    P_X = imgY[pix_a[7].pos_y][pix_a[7].pos_x];
-  }
-  else
+  // Mode DIAG_DOWN_RIGHT_PRED
+  // every down right diagonal holds one filtered pel of X..Q, Z, A..H
+  for (i = 0; i < BLOCK_SIZE_8x8; i++)
   {
-    P_Q = P_R = P_S = P_T = P_U = P_V = P_W = P_X = (imgpel) p_Vid->dc_pred_value_comp[pl];
+    Edge[i] = PredPel[24 - i];
+    Edge[i + 9] = PredPel[i + 1];
   }
+  Edge[8] = P_Z;
+  filter_pels_121(PredVal, &Edge[1], 15);
 
-  if (block_available_up_left)
-  {
-    P_Z = imgY[pix_d.pos_y][pix_d.pos_x];
-  }
-  else
+  for (i = 0; i < BLOCK_SIZE_8x8; i++)
   {
-    P_Z = (imgpel) p_Vid->dc_pred_value_comp[pl];
+    memcpy(&mpr[joff + i][ioff], &PredVal[7 - i], BLOCK_SIZE_8x8 * sizeof(imgpel));
   }
-
-  LowPassForIntra8x8Pred(&(P_Z), block_available_up_left, block_available_up, block_available_left);
-
-  // Mode DIAG_DOWN_RIGHT_PRED
-  mpr[jpos7][ipos0] = (imgpel) ((P_X + P_V + 2*(P_W) + 2) >> 2);
-  mpr[jpos6][ipos0] =
-    mpr[jpos7][ipos1] = (imgpel) ((P_W + P_U + 2*(P_V) + 2) >> 2);
-  mpr[jpos5][ipos0] =
-    mpr[jpos6][ipos1] =
-    mpr[jpos7][ipos2] = (imgpel) ((P_V + P_T + 2*(P_U) + 2) >> 2);
-  mpr[jpos4][ipos0] =
-    mpr[jpos5][ipos1] =
-    mpr[jpos6][ipos2] =
-    mpr[jpos7][ipos3] = (imgpel) ((P_U + P_S + 2*(P_T) + 2) >> 2);
-  mpr[jpos3][ipos0] =
-    mpr[jpos4][ipos1] =
-    mpr[jpos5][ipos2] =
-    mpr[jpos6][ipos3] =
-    mpr[jpos7][ipos4] = (imgpel) ((P_T + P_R + 2*(P_S) + 2) >> 2);
-  mpr[jpos2][ipos0] =
-    mpr[jpos3][ipos1] =
-    mpr[jpos4][ipos2] =
-    mpr[jpos5][ipos3] =
-    mpr[jpos6][ipos4] =
-    mpr[jpos7][ipos5] = (imgpel) ((P_S + P_Q + 2*(P_R) + 2) >> 2);
-  mpr[jpos1][ipos0] =
-    mpr[jpos2][ipos1] =
-    mpr[jpos3][ipos2] =
-    mpr[jpos4][ipos3] =
-    mpr[jpos5][ipos4] =
-    mpr[jpos6][ipos5] =
-    mpr[jpos7][ipos6] = (imgpel) ((P_R + P_Z + 2*(P_Q) + 2) >> 2);
-  mpr[jpos0][ipos0] =
-    mpr[jpos1][ipos1] =
-    mpr[jpos2][ipos2] =
-    mpr[jpos3][ipos3] =
-    mpr[jpos4][ipos4] =
-    mpr[jpos5][ipos5] =
-    mpr[jpos6][ipos6] =
-    mpr[jpos7][ipos7] = (imgpel) ((P_Q + P_A + 2*(P_Z) + 2) >> 2);
-  mpr[jpos0][ipos1] =
-    mpr[jpos1][ipos2] =
-    mpr[jpos2][ipos3] =
-    mpr[jpos3][ipos4] =
-    mpr[jpos4][ipos5] =
-    mpr[jpos5][ipos6] =
-    mpr[jpos6][ipos7] = (imgpel) ((P_Z + P_B + 2*(P_A) + 2) >> 2);
-  mpr[jpos0][ipos2] =
-    mpr[jpos1][ipos3] =
-    mpr[jpos2][ipos4] =
-    mpr[jpos3][ipos5] =
-    mpr[jpos4][ipos6] =
-    mpr[jpos5][ipos7] = (imgpel) ((P_A + P_C + 2*(P_B) + 2) >> 2);
-  mpr[jpos0][ipos3] =
-    mpr[jpos1][ipos4] =
-    mpr[jpos2][ipos5] =
-    mpr[jpos3][ipos6] =
-    mpr[jpos4][ipos7] = (imgpel) ((P_B + P_D + 2*(P_C) + 2) >> 2);
-  mpr[jpos0][ipos4] =
-    mpr[jpos1][ipos5] =
-    mpr[jpos2][ipos6] =
-    mpr[jpos3][ipos7] = (imgpel) ((P_C + P_E + 2*(P_D) + 2) >> 2);
-  mpr[jpos0][ipos5] =
-    mpr[jpos1][ipos6] =
-    mpr[jpos2][ipos7] = (imgpel) ((P_D + P_F + 2*(P_E) + 2) >> 2);
-  mpr[jpos0][ipos6] =
-    mpr[jpos1][ipos7] = (imgpel) ((P_E + P_G + 2*(P_F) + 2) >> 2);
-  mpr[jpos0][ipos7] = (imgpel) ((P_F + P_H + 2*(P_G) + 2) >> 2);
- 
   return DECODING_OK;
 }
 
@@ -823,183 +420,28 @@ static inline int intra8x8_diag_down_left_pred(Macroblock *currMB,    //!< curre
   
   int i;
   imgpel PredPel[25];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY; // For MB level frame/field coding tools -- set default to imgY
-
-  PixelPos pix_a[8];
-  PixelPos pix_b, pix_c, pix_d;
-
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-  int block_available_up_right;
-
-  int jpos0 = joff    , jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
-  int jpos4 = joff + 4, jpos5 = joff + 5, jpos6 = joff + 6, jpos7 = joff + 7;
-  int ipos0 = ioff    , ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
-  int ipos4 = ioff + 4, ipos5 = ioff + 5, ipos6 = ioff + 6, ipos7 = ioff + 7;
-  
-  imgpel *pred_pels, **mpr = currSlice->mb_pred[pl];
-  int *mb_size = p_Vid->mb_size[IS_LUMA];
-
-  for (i=0;i<8;i++)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, mb_size, &pix_a[i]);
-  }
+  imgpel PredVal[15];  // filtered pels, one per diagonal
+  IntraBlockAvail avail;
 
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, mb_size, &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 8, joff - 1, mb_size, &pix_c);
-  p_Vid->getNeighbour(currMB, ioff - 1, joff - 1, mb_size, &pix_d);
+  imgpel **mpr = currSlice->mb_pred[pl];
 
-  pix_c.available = pix_c.available &&!(ioff == 8 && joff == 8);
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE_8x8, PredPel, &avail);
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<8;i++)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-    block_available_up_left  = pix_d.available;
-  }
-
-  if (!block_available_up)
+  if (!avail.up)
     printf ("warning: Intra_8x8_Diagonal_Down_Left prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  if (block_available_up)
-  {
-    pred_pels = &imgY[pix_b.pos_y][pix_b.pos_x];
-    P_A = pred_pels[0];
-    P_B = pred_pels[1];
-    P_C = pred_pels[2];
-    P_D = pred_pels[3];
-    P_E = pred_pels[4];
-    P_F = pred_pels[5];
-    P_G = pred_pels[6];
-    P_H = pred_pels[7];
-  }
-  else
-  {
-    P_A = P_B = P_C = P_D = P_E = P_F = P_G = P_H = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_right)
-  {
-    pred_pels = &imgY[pix_c.pos_y][pix_c.pos_x];
-    P_I = pred_pels[0];
-    P_J = pred_pels[1];
-    P_K = pred_pels[2];
-    P_L = pred_pels[3];
-    P_M = pred_pels[4];
-    P_N = pred_pels[5];
-    P_O = pred_pels[6];
-    P_P = pred_pels[7];
+  LowPassForIntra8x8Pred(&(P_Z), avail.up_left, avail.up, avail.left);
 
-  }
-  else
-  {
-    P_I = P_J = P_K = P_L = P_M = P_N = P_O = P_P = P_H;
-  }
-
-  if (block_available_left)
-  {
-    P_Q = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-    P_R = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-    P_S = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-    P_T = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-    P_U = imgY[pix_a[4].pos_y][pix_a[4].pos_x];
-    P_V = imgY[pix_a[5].pos_y][pix_a[5].pos_x];
-    P_W = imgY[pix_a[6].pos_y][pix_a[6].pos_x];
-    P_X = imgY[pix_a[7].pos_y][pix_a[7].pos_x];
-  }
-  else
-  {
-    P_Q = P_R = P_S = P_T = P_U = P_V = P_W = P_X = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
+  // Mode DIAG_DOWN_LEFT_PRED
+  // every down left diagonal holds one filtered pel of A..P, the last one
+  // repeats P_P, (P_O + 3*P_P + 2) >> 2
+  P_Q = P_P;
+  filter_pels_121(PredVal, &P_B, 15);
 
-  if (block_available_up_left)
+  for (i = 0; i < BLOCK_SIZE_8x8; i++)
   {
-    P_Z = imgY[pix_d.pos_y][pix_d.pos_x];
+    memcpy(&mpr[joff + i][ioff], &PredVal[i], BLOCK_SIZE_8x8 * sizeof(imgpel));
   }
-  else
-  {
-    P_Z = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  LowPassForIntra8x8Pred(&(P_Z), block_available_up_left, block_available_up, block_available_left);
-
-  // Mode DIAG_DOWN_LEFT_PRED
-  mpr[jpos0][ipos0] = (imgpel) ((P_A + P_C + 2*(P_B) + 2) >> 2);
-  mpr[jpos1][ipos0] =
-    mpr[jpos0][ipos1] = (imgpel) ((P_B + P_D + 2*(P_C) + 2) >> 2);
-  mpr[jpos2][ipos0] =
-    mpr[jpos1][ipos1] =
-    mpr[jpos0][ipos2] = (imgpel) ((P_C + P_E + 2*(P_D) + 2) >> 2);
-  mpr[jpos3][ipos0] =
-    mpr[jpos2][ipos1] =
-    mpr[jpos1][ipos2] =
-    mpr[jpos0][ipos3] = (imgpel) ((P_D + P_F + 2*(P_E) + 2) >> 2);
-  mpr[jpos4][ipos0] =
-    mpr[jpos3][ipos1] =
-    mpr[jpos2][ipos2] =
-    mpr[jpos1][ipos3] =
-    mpr[jpos0][ipos4] = (imgpel) ((P_E + P_G + 2*(P_F) + 2) >> 2);
-  mpr[jpos5][ipos0] =
-    mpr[jpos4][ipos1] =
-    mpr[jpos3][ipos2] =
-    mpr[jpos2][ipos3] =
-    mpr[jpos1][ipos4] =
-    mpr[jpos0][ipos5] = (imgpel) ((P_F + P_H + 2*(P_G) + 2) >> 2);
-  mpr[jpos6][ipos0] =
-    mpr[jpos5][ipos1] =
-    mpr[jpos4][ipos2] =
-    mpr[jpos3][ipos3] =
-    mpr[jpos2][ipos4] =
-    mpr[jpos1][ipos5] =
-    mpr[jpos0][ipos6] = (imgpel) ((P_G + P_I + 2*(P_H) + 2) >> 2);
-  mpr[jpos7][ipos0] =
-    mpr[jpos6][ipos1] =
-    mpr[jpos5][ipos2] =
-    mpr[jpos4][ipos3] =
-    mpr[jpos3][ipos4] =
-    mpr[jpos2][ipos5] =
-    mpr[jpos1][ipos6] =
-    mpr[jpos0][ipos7] = (imgpel) ((P_H + P_J + 2*(P_I) + 2) >> 2);
-  mpr[jpos7][ipos1] =
-    mpr[jpos6][ipos2] =
-    mpr[jpos5][ipos3] =
-    mpr[jpos4][ipos4] =
-    mpr[jpos3][ipos5] =
-    mpr[jpos2][ipos6] =
-    mpr[jpos1][ipos7] = (imgpel) ((P_I + P_K + 2*(P_J) + 2) >> 2);
-  mpr[jpos7][ipos2] =
-    mpr[jpos6][ipos3] =
-    mpr[jpos5][ipos4] =
-    mpr[jpos4][ipos5] =
-    mpr[jpos3][ipos6] =
-    mpr[jpos2][ipos7] = (imgpel) ((P_J + P_L + 2*(P_K) + 2) >> 2);
-  mpr[jpos7][ipos3] =
-    mpr[jpos6][ipos4] =
-    mpr[jpos5][ipos5] =
-    mpr[jpos4][ipos6] =
-    mpr[jpos3][ipos7] = (imgpel) ((P_K + P_M + 2*(P_L) + 2) >> 2);
-  mpr[jpos7][ipos4] =
-    mpr[jpos6][ipos5] =
-    mpr[jpos5][ipos6] =
-    mpr[jpos4][ipos7] = (imgpel) ((P_L + P_N + 2*(P_M) + 2) >> 2);
-  mpr[jpos7][ipos5] =
-    mpr[jpos6][ipos6] =
-    mpr[jpos5][ipos7] = (imgpel) ((P_M + P_O + 2*(P_N) + 2) >> 2);
-  mpr[jpos7][ipos6] =
-    mpr[jpos6][ipos7] = (imgpel) ((P_N + P_P + 2*(P_O) + 2) >> 2);
-  mpr[jpos7][ipos7] = (imgpel) ((P_O + 3*(P_P) + 2) >> 2);
-
   return DECODING_OK;
 }
 
@@ -1021,116 +463,21 @@ static inline int intra8x8_vert_right_pred(Macroblock *currMB,    //!< current m
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-  int i;
   imgpel PredPel[25];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY; // For MB level frame/field coding tools -- set default to imgY
-
-  PixelPos pix_a[8];
-  PixelPos pix_b, pix_c, pix_d;
+  IntraBlockAvail avail;
 
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-  int block_available_up_right;
   int jpos0 = joff    , jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
   int jpos4 = joff + 4, jpos5 = joff + 5, jpos6 = joff + 6, jpos7 = joff + 7;
   int ipos0 = ioff    , ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   int ipos4 = ioff + 4, ipos5 = ioff + 5, ipos6 = ioff + 6, ipos7 = ioff + 7;
-  imgpel *pred_pels, **mpr = currSlice->mb_pred[pl];
-  int *mb_size = p_Vid->mb_size[IS_LUMA];
-
-  for (i=0;i<8;i++)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, mb_size, &pix_a[i]);
-  }
-
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, mb_size, &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 8, joff - 1, mb_size, &pix_c);
-  p_Vid->getNeighbour(currMB, ioff - 1, joff - 1, mb_size, &pix_d);
-
-  pix_c.available = pix_c.available &&!(ioff == 8 && joff == 8);
+  imgpel **mpr = currSlice->mb_pred[pl];
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<8;i++)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-    block_available_up_left  = pix_d.available;
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE_8x8, PredPel, &avail);
 
-  if ((!block_available_up)||(!block_available_left)||(!block_available_up_left))
+  if ((!avail.up)||(!avail.left)||(!avail.up_left))
     printf ("warning: Intra_8x8_Vertical_Right prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  if (block_available_up)
-  {
-    pred_pels = &imgY[pix_b.pos_y][pix_b.pos_x];
-    P_A = pred_pels[0];
-    P_B = pred_pels[1];
-    P_C = pred_pels[2];
-    P_D = pred_pels[3];
-    P_E = pred_pels[4];
-    P_F = pred_pels[5];
-    P_G = pred_pels[6];
-    P_H = pred_pels[7];
-  }
-  else
-  {
-    P_A = P_B = P_C = P_D = P_E = P_F = P_G = P_H = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_right)
-  {
-    pred_pels = &imgY[pix_c.pos_y][pix_c.pos_x];
-    P_I = pred_pels[0];
-    P_J = pred_pels[1];
-    P_K = pred_pels[2];
-    P_L = pred_pels[3];
-    P_M = pred_pels[4];
-    P_N = pred_pels[5];
-    P_O = pred_pels[6];
-    P_P = pred_pels[7];
-
-  }
-  else
-  {
-    P_I = P_J = P_K = P_L = P_M = P_N = P_O = P_P = P_H;
-  }
-
-  if (block_available_left)
-  {
-    P_Q = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-    P_R = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-    P_S = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-    P_T = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-    P_U = imgY[pix_a[4].pos_y][pix_a[4].pos_x];
-    P_V = imgY[pix_a[5].pos_y][pix_a[5].pos_x];
-    P_W = imgY[pix_a[6].pos_y][pix_a[6].pos_x];
-    P_X = imgY[pix_a[7].pos_y][pix_a[7].pos_x];
-  }
-  else
-  {
-    P_Q = P_R = P_S = P_T = P_U = P_V = P_W = P_X = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_left)
-  {
-    P_Z = imgY[pix_d.pos_y][pix_d.pos_x];
-  }
-  else
-  {
-    P_Z = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  LowPassForIntra8x8Pred(&(P_Z), block_available_up_left, block_available_up, block_available_left);
+  LowPassForIntra8x8Pred(&(P_Z), avail.up_left, avail.up, avail.left);
 
   mpr[jpos0][ipos0] =
     mpr[jpos2][ipos1] =
@@ -1219,117 +566,21 @@ static inline int intra8x8_vert_left_pred(Macroblock *currMB,    //!< current ma
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-  int i;
   imgpel PredPel[25];  // array of predictor pels  
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY; // For MB level frame/field coding tools -- set default to imgY
-
-  PixelPos pix_a[8];
-  PixelPos pix_b, pix_c, pix_d;
-
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-  int block_available_up_right;
+  IntraBlockAvail avail;
 
   int jpos0 = joff    , jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
   int jpos4 = joff + 4, jpos5 = joff + 5, jpos6 = joff + 6, jpos7 = joff + 7;
   int ipos0 = ioff    , ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   int ipos4 = ioff + 4, ipos5 = ioff + 5, ipos6 = ioff + 6, ipos7 = ioff + 7;
-  imgpel *pred_pels, **mpr = currSlice->mb_pred[pl];
-  int *mb_size = p_Vid->mb_size[IS_LUMA];
-
-  for (i=0;i<8;i++)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, mb_size, &pix_a[i]);
-  }
-
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, mb_size, &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 8, joff - 1, mb_size, &pix_c);
-  p_Vid->getNeighbour(currMB, ioff - 1, joff - 1, mb_size, &pix_d);
+  imgpel **mpr = currSlice->mb_pred[pl];
 
-  pix_c.available = pix_c.available &&!(ioff == 8 && joff == 8);
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE_8x8, PredPel, &avail);
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<8;i++)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-    block_available_up_left  = pix_d.available;
-  }
-
-  if (!block_available_up)
+  if (!avail.up)
     printf ("warning: Intra_4x4_Vertical_Left prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  if (block_available_up)
-  {
-    pred_pels = &imgY[pix_b.pos_y][pix_b.pos_x];
-    P_A = pred_pels[0];
-    P_B = pred_pels[1];
-    P_C = pred_pels[2];
-    P_D = pred_pels[3];
-    P_E = pred_pels[4];
-    P_F = pred_pels[5];
-    P_G = pred_pels[6];
-    P_H = pred_pels[7];
-  }
-  else
-  {
-    P_A = P_B = P_C = P_D = P_E = P_F = P_G = P_H = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_right)
-  {
-    pred_pels = &imgY[pix_c.pos_y][pix_c.pos_x];
-    P_I = pred_pels[0];
-    P_J = pred_pels[1];
-    P_K = pred_pels[2];
-    P_L = pred_pels[3];
-    P_M = pred_pels[4];
-    P_N = pred_pels[5];
-    P_O = pred_pels[6];
-    P_P = pred_pels[7];
-
-  }
-  else
-  {
-    P_I = P_J = P_K = P_L = P_M = P_N = P_O = P_P = P_H;
-  }
-
-  if (block_available_left)
-  {
-    P_Q = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-    P_R = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-    P_S = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-    P_T = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-    P_U = imgY[pix_a[4].pos_y][pix_a[4].pos_x];
-    P_V = imgY[pix_a[5].pos_y][pix_a[5].pos_x];
-    P_W = imgY[pix_a[6].pos_y][pix_a[6].pos_x];
-    P_X = imgY[pix_a[7].pos_y][pix_a[7].pos_x];
-  }
-  else
-  {
-    P_Q = P_R = P_S = P_T = P_U = P_V = P_W = P_X = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_left)
-  {
-    P_Z = imgY[pix_d.pos_y][pix_d.pos_x];
-  }
-  else
-  {
-    P_Z = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  LowPassForIntra8x8Pred(&(P_Z), block_available_up_left, block_available_up, block_available_left);
+  LowPassForIntra8x8Pred(&(P_Z), avail.up_left, avail.up, avail.left);
 
   mpr[jpos0][ipos0] = (imgpel) ((P_A + P_B + 1) >> 1);
   mpr[jpos0][ipos1] =
@@ -1417,117 +668,22 @@ static inline int intra8x8_hor_up_pred(Macroblock *currMB,    //!< current macro
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
   
-  int i;
   imgpel PredPel[25];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY; // For MB level frame/field coding tools -- set default to imgY
-
-  PixelPos pix_a[8];
-  PixelPos pix_b, pix_c, pix_d;
+  IntraBlockAvail avail;
 
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-  int block_available_up_right;
   int jpos0 = joff    , jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
   int jpos4 = joff + 4, jpos5 = joff + 5, jpos6 = joff + 6, jpos7 = joff + 7;
   int ipos0 = ioff    , ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   int ipos4 = ioff + 4, ipos5 = ioff + 5, ipos6 = ioff + 6, ipos7 = ioff + 7;
   
-  imgpel *pred_pels, **mpr = currSlice->mb_pred[pl];
-  int *mb_size = p_Vid->mb_size[IS_LUMA];
-
-  for (i=0;i<8;i++)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, mb_size, &pix_a[i]);
-  }
-
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, mb_size, &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 8, joff - 1, mb_size, &pix_c);
-  p_Vid->getNeighbour(currMB, ioff - 1, joff - 1, mb_size, &pix_d);
-
-  pix_c.available = pix_c.available &&!(ioff == 8 && joff == 8);
+  imgpel **mpr = currSlice->mb_pred[pl];
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<8;i++)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-    block_available_up_left  = pix_d.available;
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE_8x8, PredPel, &avail);
 
-  if (!block_available_left)
+  if (!avail.left)
     printf ("warning: Intra_8x8_Horizontal_Up prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  if (block_available_up)
-  {
-    pred_pels = &imgY[pix_b.pos_y][pix_b.pos_x];
-    P_A = pred_pels[0];
-    P_B = pred_pels[1];
-    P_C = pred_pels[2];
-    P_D = pred_pels[3];
-    P_E = pred_pels[4];
-    P_F = pred_pels[5];
-    P_G = pred_pels[6];
-    P_H = pred_pels[7];
-  }
-  else
-  {
-    P_A = P_B = P_C = P_D = P_E = P_F = P_G = P_H = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_right)
-  {
-    pred_pels = &imgY[pix_c.pos_y][pix_c.pos_x];
-    P_I = pred_pels[0];
-    P_J = pred_pels[1];
-    P_K = pred_pels[2];
-    P_L = pred_pels[3];
-    P_M = pred_pels[4];
-    P_N = pred_pels[5];
-    P_O = pred_pels[6];
-    P_P = pred_pels[7];
-
-  }
-  else
-  {
-    P_I = P_J = P_K = P_L = P_M = P_N = P_O = P_P = P_H;
-  }
-
-  if (block_available_left)
-  {
-    P_Q = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-    P_R = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-    P_S = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-    P_T = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-    P_U = imgY[pix_a[4].pos_y][pix_a[4].pos_x];
-    P_V = imgY[pix_a[5].pos_y][pix_a[5].pos_x];
-    P_W = imgY[pix_a[6].pos_y][pix_a[6].pos_x];
-    P_X = imgY[pix_a[7].pos_y][pix_a[7].pos_x];
-  }
-  else
-  {
-    P_Q = P_R = P_S = P_T = P_U = P_V = P_W = P_X = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_left)
-  {
-    P_Z = imgY[pix_d.pos_y][pix_d.pos_x];
-  }
-  else
-  {
-    P_Z = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  LowPassForIntra8x8Pred(&(P_Z), block_available_up_left, block_available_up, block_available_left);
+  LowPassForIntra8x8Pred(&(P_Z), avail.up_left, avail.up, avail.left);
 
   mpr[jpos0][ipos0] = (imgpel) ((P_Q + P_R + 1) >> 1);
   mpr[jpos1][ipos0] =
@@ -1615,117 +771,22 @@ static inline int intra8x8_hor_down_pred(Macroblock *currMB,    //!< current mac
   Slice *currSlice = currMB->p_Slice;
   VideoParameters *p_Vid = currMB->p_Vid;
 
-  int i;
   imgpel PredPel[25];  // array of predictor pels
-  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY; // For MB level frame/field coding tools -- set default to imgY
-
-  PixelPos pix_a[8];
-  PixelPos pix_b, pix_c, pix_d;
+  IntraBlockAvail avail;
 
-  int block_available_up;
-  int block_available_left;
-  int block_available_up_left;
-  int block_available_up_right;
   int jpos0 = joff    , jpos1 = joff + 1, jpos2 = joff + 2, jpos3 = joff + 3;
   int jpos4 = joff + 4, jpos5 = joff + 5, jpos6 = joff + 6, jpos7 = joff + 7;
   int ipos0 = ioff    , ipos1 = ioff + 1, ipos2 = ioff + 2, ipos3 = ioff + 3;
   int ipos4 = ioff + 4, ipos5 = ioff + 5, ipos6 = ioff + 6, ipos7 = ioff + 7;
   
-  imgpel *pred_pels, **mpr = currSlice->mb_pred[pl];
-  int *mb_size = p_Vid->mb_size[IS_LUMA];
-
-  for (i=0;i<8;i++)
-  {
-    p_Vid->getNeighbour(currMB, ioff - 1, joff + i, mb_size, &pix_a[i]);
-  }
-
-  p_Vid->getNeighbour(currMB, ioff    , joff - 1, mb_size, &pix_b);
-  p_Vid->getNeighbour(currMB, ioff + 8, joff - 1, mb_size, &pix_c);
-  p_Vid->getNeighbour(currMB, ioff - 1, joff - 1, mb_size, &pix_d);
-
-  pix_c.available = pix_c.available &&!(ioff == 8 && joff == 8);
+  imgpel **mpr = currSlice->mb_pred[pl];
 
-  if (p_Vid->active_pps->constrained_intra_pred_flag)
-  {
-    for (i=0, block_available_left=1; i<8;i++)
-      block_available_left  &= pix_a[i].available ? p_Vid->intra_block[pix_a[i].mb_addr]: 0;
-    block_available_up       = pix_b.available ? p_Vid->intra_block [pix_b.mb_addr] : 0;
-    block_available_up_right = pix_c.available ? p_Vid->intra_block [pix_c.mb_addr] : 0;
-    block_available_up_left  = pix_d.available ? p_Vid->intra_block [pix_d.mb_addr] : 0;
-  }
-  else
-  {
-    block_available_left     = pix_a[0].available;
-    block_available_up       = pix_b.available;
-    block_available_up_right = pix_c.available;
-    block_available_up_left  = pix_d.available;
-  }
+  get_intra_pred_pels(currMB, pl, ioff, joff, BLOCK_SIZE_8x8, PredPel, &avail);
 
-  if ((!block_available_up)||(!block_available_left)||(!block_available_up_left))
+  if ((!avail.up)||(!avail.left)||(!avail.up_left))
     printf ("warning: Intra_8x8_Horizontal_Down prediction mode not allowed at mb %d\n", (int) p_Vid->current_mb_nr);
 
-  // form predictor pels
-  if (block_available_up)
-  {
-    pred_pels = &imgY[pix_b.pos_y][pix_b.pos_x];
-    P_A = pred_pels[0];
-    P_B = pred_pels[1];
-    P_C = pred_pels[2];
-    P_D = pred_pels[3];
-    P_E = pred_pels[4];
-    P_F = pred_pels[5];
-    P_G = pred_pels[6];
-    P_H = pred_pels[7];
-  }
-  else
-  {
-    P_A = P_B = P_C = P_D = P_E = P_F = P_G = P_H = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_right)
-  {
-    pred_pels = &imgY[pix_c.pos_y][pix_c.pos_x];
-    P_I = pred_pels[0];
-    P_J = pred_pels[1];
-    P_K = pred_pels[2];
-    P_L = pred_pels[3];
-    P_M = pred_pels[4];
-    P_N = pred_pels[5];
-    P_O = pred_pels[6];
-    P_P = pred_pels[7];
-
-  }
-  else
-  {
-    P_I = P_J = P_K = P_L = P_M = P_N = P_O = P_P = P_H;
-  }
-
-  if (block_available_left)
-  {
-    P_Q = imgY[pix_a[0].pos_y][pix_a[0].pos_x];
-    P_R = imgY[pix_a[1].pos_y][pix_a[1].pos_x];
-    P_S = imgY[pix_a[2].pos_y][pix_a[2].pos_x];
-    P_T = imgY[pix_a[3].pos_y][pix_a[3].pos_x];
-    P_U = imgY[pix_a[4].pos_y][pix_a[4].pos_x];
-    P_V = imgY[pix_a[5].pos_y][pix_a[5].pos_x];
-    P_W = imgY[pix_a[6].pos_y][pix_a[6].pos_x];
-    P_X = imgY[pix_a[7].pos_y][pix_a[7].pos_x];
-  }
-  else
-  {
-    P_Q = P_R = P_S = P_T = P_U = P_V = P_W = P_X = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  if (block_available_up_left)
-  {
-    P_Z = imgY[pix_d.pos_y][pix_d.pos_x];
-  }
-  else
-  {
-    P_Z = (imgpel) p_Vid->dc_pred_value_comp[pl];
-  }
-
-  LowPassForIntra8x8Pred(&(P_Z), block_available_up_left, block_available_up, block_available_left);
+  LowPassForIntra8x8Pred(&(P_Z), avail.up_left, avail.up, avail.left);
 
   mpr[jpos0][ipos0] =
     mpr[jpos1][ipos2] =
@@ -0,0 +1,228 @@
+/*!
+ *************************************************************************************
+ * \file intra_pred_common.c
+ *
+ * \brief
+ *    Neighbour handling shared by the 4x4, 8x8 and 16x16 intra prediction modes
+ *
+ *    The samples of the neighbouring macroblocks are gathered once per macroblock
+ *    by get_intra_neighbours(). The predictor pels of the individual blocks are
+ *    then formed from this set and the already reconstructed blocks of the
+ *    current macroblock, without further neighbour derivations.
+ *
+ *************************************************************************************
+ */
+#include "global.h"
+#include "intra_pred_common.h"
+#include "mbuffer.h"
+#include "mb_access.h"
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    gathers the samples left of, above and above right of the current
+ *    macroblock and their availability for intra prediction
+ ***********************************************************************
+ */
+void get_intra_neighbours(Macroblock *currMB, ColorPlane pl)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  IntraNeighbours *nb = &currMB->p_Slice->intra_nb;
+  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
+  imgpel dc_value = (imgpel) p_Vid->dc_pred_value_comp[pl];
+  int constrained = p_Vid->active_pps->constrained_intra_pred_flag;
+  int *mb_size = p_Vid->mb_size[IS_LUMA];
+  int i;
+
+  PixelPos left[17];    //!< pixel positions p(-1, -1..15)
+  PixelPos up;          //!< pixel position p(0,-1)
+  PixelPos up_right;    //!< pixel position p(16,-1)
+
+  for (i = 0; i < 17; ++i)
+  {
+    p_Vid->getNeighbour(currMB, -1, i - 1, mb_size, &left[i]);
+  }
+  p_Vid->getNeighbour(currMB,  0, -1, mb_size, &up);
+  p_Vid->getNeighbour(currMB, 16, -1, mb_size, &up_right);
+
+  if (constrained)
+  {
+    for (i = 0; i < 17; ++i)
+      left[i].available = left[i].available ? p_Vid->intra_block[left[i].mb_addr] : 0;
+    up.available        = up.available       ? p_Vid->intra_block[up.mb_addr]       : 0;
+    up_right.available  = up_right.available ? p_Vid->intra_block[up_right.mb_addr] : 0;
+  }
+
+  nb->up_left_avail  = (byte) left[0].available;
+  nb->up_avail       = (byte) up.available;
+  nb->up_right_avail = (byte) up_right.available;
+
+  nb->up[0] = (nb->up_left_avail) ? imgY[left[0].pos_y][left[0].pos_x] : dc_value;
+
+  if (nb->up_avail)
+    memcpy(&nb->up[1], &imgY[up.pos_y][up.pos_x], MB_BLOCK_SIZE * sizeof(imgpel));
+  else
+    for (i = 1; i <= MB_BLOCK_SIZE; ++i)
+      nb->up[i] = dc_value;
+
+  if (nb->up_right_avail)
+    memcpy(&nb->up[MB_BLOCK_SIZE + 1], &imgY[up_right.pos_y][up_right.pos_x], MB_BLOCK_SIZE * sizeof(imgpel));
+  else
+    for (i = MB_BLOCK_SIZE + 1; i <= 2 * MB_BLOCK_SIZE; ++i)
+      nb->up[i] = dc_value;
+
+  for (i = 0; i < MB_BLOCK_SIZE; ++i)
+  {
+    nb->left_avail[i] = (byte) left[i + 1].available;
+    nb->left[i] = (nb->left_avail[i]) ? imgY[left[i + 1].pos_y][left[i + 1].pos_x] : dc_value;
+  }
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    forms the predictor pels of a bsize x bsize intra block
+ *
+ *    PredPel[0] holds the pel above left, PredPel[1..2*bsize] the pels
+ *    above and above right and PredPel[2*bsize+1..3*bsize] the pels to
+ *    the left of the block. Unavailable pels above right repeat the last
+ *    pel above, all other unavailable pels are set to the DC value.
+ ***********************************************************************
+ */
+void get_intra_pred_pels(Macroblock *currMB,    //!< current macroblock
+                         ColorPlane pl,         //!< current image plane
+                         int ioff,              //!< pixel offset X within MB
+                         int joff,              //!< pixel offset Y within MB
+                         int bsize,             //!< block size (4, 8 or 16)
+                         imgpel *PredPel,       //!< returns the predictor pels
+                         IntraBlockAvail *avail)//!< returns the availability of the predictor pels
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  IntraNeighbours *nb = &currMB->p_Slice->intra_nb;
+  imgpel **imgY = (pl) ? p_Vid->dec_picture->imgUV[pl - 1] : p_Vid->dec_picture->imgY;
+  imgpel *up_pels   = &PredPel[1];
+  imgpel *left_pels = &PredPel[2 * bsize + 1];
+  int pos_x = currMB->pix_x + ioff;
+  int pos_y = currMB->pix_y + joff;
+  int i;
+
+  if (joff == 0)
+  {
+    // row above the macroblock
+    avail->up       = nb->up_avail;
+    avail->up_left  = (ioff == 0) ? nb->up_left_avail : nb->up_avail;
+    avail->up_right = (ioff + bsize < MB_BLOCK_SIZE) ? nb->up_avail : nb->up_right_avail;
+
+    PredPel[0] = nb->up[ioff];
+    memcpy(up_pels, &nb->up[ioff + 1], 2 * bsize * sizeof(imgpel));
+  }
+  else
+  {
+    // reconstructed blocks of the current macroblock; the block above right
+    // is not decoded yet for the 4x4 blocks at (4,4) and (4,12)
+    imgpel *line = &imgY[pos_y - 1][pos_x];
+
+    avail->up       = TRUE;
+    avail->up_left  = (ioff == 0) ? nb->left_avail[joff - 1] : TRUE;
+    avail->up_right = (ioff + bsize < MB_BLOCK_SIZE) && !((bsize == BLOCK_SIZE) && (ioff == 4) && ((joff == 4) || (joff == 12)));
+
+    PredPel[0] = (ioff == 0) ? nb->left[joff - 1] : line[-1];
+    memcpy(up_pels, line, (avail->up_right ? 2 : 1) * bsize * sizeof(imgpel));
+  }
+
+  if (!avail->up_right)
+  {
+    for (i = bsize; i < 2 * bsize; ++i)
+      up_pels[i] = up_pels[bsize - 1];
+  }
+
+  if (ioff == 0)
+  {
+    for (i = 0, avail->left = 1; i < bsize; ++i)
+      avail->left &= nb->left_avail[joff + i];
+
+    if (avail->left)
+    {
+      memcpy(left_pels, &nb->left[joff], bsize * sizeof(imgpel));
+    }
+    else
+    {
+      for (i = 0; i < bsize; ++i)
+        left_pels[i] = (imgpel) p_Vid->dc_pred_value_comp[pl];
+    }
+  }
+  else
+  {
+    avail->left = TRUE;
+    for (i = 0; i < bsize; ++i)
+      left_pels[i] = imgY[pos_y + i][pos_x - 1];
+  }
+}
+
+#if defined(__SSE2__) && (IMGTYPE < 2)
+#include <emmintrin.h>
+
+//! loads 8 samples zero extended to 16 bit
+static inline __m128i load_pels8(const imgpel *p)
+{
+#if (IMGTYPE == 0)
+  return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) p), _mm_setzero_si128());
+#else
+  return _mm_loadu_si128((const __m128i *) p);
+#endif
+}
+
+//! stores 8 16 bit values as samples
+static inline void store_pels8(imgpel *p, __m128i v)
+{
+#if (IMGTYPE == 0)
+  _mm_storel_epi64((__m128i *) p, _mm_packus_epi16(v, v));
+#else
+  _mm_storeu_si128((__m128i *) p, v);
+#endif
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    [1 2 1] filter of n pels (SSE2):
+ *    dst[i] = (src[i-1] + 2*src[i] + src[i+1] + 2) >> 2 for i = 0..n-1,
+ *    src[-1] and src[n] must be valid. dst and src must not overlap.
+ ***********************************************************************
+ */
+void filter_pels_121(imgpel *dst, const imgpel *src, int n)
+{
+  __m128i two = _mm_set1_epi16(2);
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8)
+  {
+    __m128i prv = load_pels8(src + i - 1);
+    __m128i cur = load_pels8(src + i);
+    __m128i nxt = load_pels8(src + i + 1);
+    __m128i sum = _mm_add_epi16(_mm_add_epi16(prv, nxt), _mm_add_epi16(_mm_add_epi16(cur, cur), two));
+
+    store_pels8(dst + i, _mm_srli_epi16(sum, 2));
+  }
+
+  for (; i < n; ++i)
+    dst[i] = (imgpel) ((src[i - 1] + (src[i] << 1) + src[i + 1] + 2) >> 2);
+}
+#else
+/*!
+ ***********************************************************************
+ * \brief
+ *    [1 2 1] filter of n pels:
+ *    dst[i] = (src[i-1] + 2*src[i] + src[i+1] + 2) >> 2 for i = 0..n-1,
+ *    src[-1] and src[n] must be valid. dst and src must not overlap.
+ ***********************************************************************
+ */
+void filter_pels_121(imgpel *dst, const imgpel *src, int n)
+{
+  int i;
+
+  for (i = 0; i < n; ++i)
+    dst[i] = (imgpel) ((src[i - 1] + (src[i] << 1) + src[i + 1] + 2) >> 2);
+}
+#endif
+
@@ -49,10 +49,12 @@
 #include "contributors.h"
 
 #include <sys/stat.h>
+#include <ctype.h>
 
 #include "global.h"
 #include "annexb.h"
 #include "image.h"
+#include "img_io.h"
 #include "memalloc.h"
 #include "mc_prediction.h"
 #include "mbuffer.h"
@@ -67,6 +69,8 @@
 #include "block.h"
 #include "nalu.h"
 #include "img_io.h"
+#include "syntax_stats.h"
+#include "dec_profile.h"
 
 #define LOGFILE     "log.dec"
 #define DATADECFILE "dataDec.txt"
@@ -119,12 +123,21 @@ static void JMDecHelpExit (void)
     "   -h        :  prints function usage\n"
     "             :  parse <defdec.cfg> for decoder operation.\n"
     "   -i        :  Input file name. \n"
-    "   -o        :  Output file name. If not specified default output is set as test_dec.yuv\n\n"
+    "   -o        :  Output file name. If not specified default output is set as test_dec.yuv\n"
+    "                *.y4m writes a Y4M file, - writes Y4M to stdout (messages go to stderr)\n\n"
     "   -r        :  Reference file name. If not specified default output is set as test_rec.yuv\n\n"
     "   -p        :  Poc Scale. \n"
     "   -uv       :  write chroma components for monochrome streams(4:2:0)\n"
     "   -lp       :  By default the deblocking filter for High Intra-Only profile is off \n\t  regardless of the flags in the bitstream. In the presence of\n\t  this option, the loop filter usage will then be determined \n\t  by the flags and parameters in the bitstream.\n\n"
-    "   -xmltrace : <tracefile>.xml" 
+    "   -xmltrace : <tracefile>.xml, or <tracefile>.jmbt for the binary trace format\n"
+    "   -inspect  : <directory> to write the inspected residuals and macroblock types to\n"
+    "   -inspect_compact : write macroblock fields as one (H/16, W/16, 5) array and only the non-zero\n	  coefficients as a sparse list, no dense residual planes\n"
+    "   -inspect_none : write no inspector files, e.g. to time the decoding alone\n"
+    "   -parse_only : parse but do not reconstruct, deblock or output non-reference pictures,\n	  -inspect writes no residual planes for them\n"
+    "   -slice_type : <types> only inspect pictures of the given types, e.g. I or PB\n"
+    "   -frames   : <first>[:<last>] only inspect pictures in this display order range\n"
+    "   -syntax_stats : <file> parse only and write per macroblock syntax records to a columnar binary file\n"
+    "   -profile  : <file> write the per-stage decoding times as JSON (decoder built with DEC_PROFILE=1)\n\n"
 
     "## Supported video file formats\n"
     "   Input : .264 -> H.264 bitstream files. \n"
@@ -140,6 +153,37 @@ static void JMDecHelpExit (void)
 }
 
 
+/*!
+ ***********************************************************************
+ * \brief
+ *   parse the picture types of the -slice_type option (I, P, B)
+ *   into the slice type bit mask of the selective decoding filter
+ ***********************************************************************
+ */
+static void parse_slice_type_filter(InputParameters *p_Inp, char *types)
+{
+  p_Inp->select_slice_types = 0;
+
+  for (; *types != '\0'; ++types)
+  {
+    switch (toupper(*types))
+    {
+    case 'I':
+      p_Inp->select_slice_types |= (1 << I_SLICE) | (1 << SI_SLICE);
+      break;
+    case 'P':
+      p_Inp->select_slice_types |= (1 << P_SLICE) | (1 << SP_SLICE);
+      break;
+    case 'B':
+      p_Inp->select_slice_types |= (1 << B_SLICE);
+      break;
+    default:
+      snprintf(errortext, ET_SIZE, "Invalid slice type %c. Use a combination of I, P and B", *types);
+      error(errortext, 300);
+    }
+  }
+}
+
 static void Configure(VideoParameters *p_Vid, InputParameters *p_Inp, int ac, char *av[])
 {
   int CLcount = 1;
@@ -157,6 +201,10 @@ static void Configure(VideoParameters *p_Vid, InputParameters *p_Inp, int ac, ch
   p_Inp->poc_scale=2;
   p_Inp->silent = FALSE;
   p_Inp->intra_profile_deblocking = 0;
+  p_Inp->parse_only = 0;
+  p_Inp->select_slice_types = 0;
+  p_Inp->select_first_frame = 0;
+  p_Inp->select_last_frame = -1;
 
 #ifdef _LEAKYBUCKET_
   p_Inp->R_decoder=500000;          //! Decoder rate
@@ -214,7 +262,7 @@ static void Configure(VideoParameters *p_Vid, InputParameters *p_Inp, int ac, ch
     {
       JMDecHelpExit();
     }
-    if (0 == strncmp (av[1], "-s", 2))
+    if (0 == strcmp (av[1], "-s"))
     {
       p_Inp->silent = TRUE;
     }
@@ -228,6 +276,39 @@ static void Configure(VideoParameters *p_Vid, InputParameters *p_Inp, int ac, ch
     {
       JMDecHelpExit();
     }
+    else if (0 == strncmp (av[CLcount], "-parse_only", 11))  //! Skip reconstruction of non-reference pictures
+    {
+      p_Inp->parse_only = 1;
+      ++CLcount;
+    }
+    else if (0 == strncmp (av[CLcount], "-slice_type", 11))  //! Picture types to decode for inspection
+    {
+      parse_slice_type_filter(p_Inp, av[CLcount+1]);
+      CLcount += 2;
+    }
+    else if (0 == strncmp (av[CLcount], "-frames", 7))  //! Frame range to decode for inspection
+    {
+      if (sscanf (av[CLcount+1], "%d:%d", &p_Inp->select_first_frame, &p_Inp->select_last_frame) < 1)
+      {
+        snprintf(errortext, ET_SIZE, "Invalid frame range %s. Use -frames first[:last]", av[CLcount+1]);
+        error(errortext, 300);
+      }
+      CLcount += 2;
+    }
+    else if (0 == strncmp (av[CLcount], "-syntax_stats", 13))  //! Parse-only syntax statistics file
+    {
+      syntax_stats_set_filename(av[CLcount+1]);
+      CLcount += 2;
+    }
+    else if (0 == strncmp (av[CLcount], "-profile", 8))  //! Per-stage profile summary file
+    {
+#if (DEC_PROFILE)
+      dec_profile_set_filename(av[CLcount+1]);
+#else
+      fprintf(stderr, "Warning: -profile ignored, the decoder was built without DEC_PROFILE\n");
+#endif
+      CLcount += 2;
+    }
     else if (0 == strncmp (av[CLcount], "-s", 2))
     {
       p_Inp->silent = TRUE;
@@ -275,6 +356,14 @@ static void Configure(VideoParameters *p_Vid, InputParameters *p_Inp, int ac, ch
       inspect_set_savedir(av[CLcount+1]);
       CLcount += 2;
     }
+    else if (0 == strncmp (av[CLcount], "-inspect_compact", 16)) {
+      inspect_set_compact(1);
+      ++CLcount;
+    }
+    else if (0 == strncmp (av[CLcount], "-inspect_none", 13)) {
+      inspect_set_export(0);
+      ++CLcount;
+    }
     /***** INSPECT_END *****/
     else
     {
@@ -291,7 +380,7 @@ static void Configure(VideoParameters *p_Vid, InputParameters *p_Inp, int ac, ch
   }
 #endif
 
-  if ((p_Vid->p_out = open(p_Inp->outfile, OPENFLAGS_WRITE, OPEN_PERMISSIONS))==-1)
+  if ((p_Vid->p_out = OpenOutputFile(p_Inp->outfile))==-1)
   {
     snprintf(errortext, ET_SIZE, "Error open file %s ",p_Inp->outfile);
     error(errortext,500);
@@ -422,6 +511,7 @@ static void free_img( VideoParameters *p_Vid)
   if (p_Vid != NULL)
   {
     free_annex_b (p_Vid);
+    FreeNALU(p_Vid->nalu);
 #if (ENABLE_OUTPUT_TONEMAPPING)  
     if (p_Vid->seiToneMapping != NULL)
     {
@@ -498,10 +588,20 @@ int main(int argc, char **argv)
   }
   /****** XML_TRACE_END ******/
 
+  if (syntax_stats_enabled() && syntax_stats_open() != 0)
+  {
+    snprintf(errortext, ET_SIZE, "Error open file %s ", syntax_stats_get_filename());
+    error(errortext, 500);
+  }
+
   init(p_Dec->p_Vid);
  
   init_out_buffer(p_Dec->p_Vid);  
 
+#if (DEC_PROFILE)
+  dec_profile_init();
+#endif
+
   while (decode_one_frame(p_Dec->p_Vid) != EOS)
     ;
 
@@ -523,6 +623,9 @@ int main(int argc, char **argv)
   
   // only show the final report after all buffers have been emptied
   Report(p_Dec->p_Vid);
+#if (DEC_PROFILE)
+  dec_profile_report(p_Dec->p_Vid->snr->frame_ctr);
+#endif
   // YD: end
 
 #if (PAIR_FIELDS_IN_OUTPUT)
@@ -539,7 +642,9 @@ int main(int argc, char **argv)
   }
   /****** XML_TRACE_END ******/
 
-  close(p_Dec->p_Vid->p_out);
+  syntax_stats_close();
+
+  CloseOutputFile(p_Dec->p_Vid->p_out);
 
   if (p_Dec->p_Vid->p_ref != -1)
     close(p_Dec->p_Vid->p_ref);
@@ -553,6 +658,7 @@ int main(int argc, char **argv)
   CleanUpPPS(p_Dec->p_Vid);
   free_dpb(p_Dec->p_Vid);
   uninit_out_buffer(p_Dec->p_Vid);
+  free_pooled_picture(p_Dec->p_Vid);
 
   free (p_Dec->p_Inp);
   free_img (p_Dec->p_Vid);
@@ -608,6 +714,7 @@ static void init(VideoParameters *p_Vid)  //!< video parameters
 
   p_Vid->LastAccessUnitExists  = 0;
   p_Vid->NALUCount = 0;
+  p_Vid->nalu = AllocNALU(MAX_CODED_FRAME_SIZE);
 
 
   p_Vid->out_buffer = NULL;
@@ -1147,10 +1254,11 @@ static void malloc_slice(InputParameters *p_Inp, VideoParameters *p_Vid)
   memory_size += get_mem3Dint(&(currSlice->wp_offset), 6, MAX_REFERENCE_PICTURES, 3);
   memory_size += get_mem4Dint(&(currSlice->wbp_weight), 6, MAX_REFERENCE_PICTURES, MAX_REFERENCE_PICTURES, 3);
 
-  memory_size += get_mem3Dpel(&(currSlice->mb_pred), MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  memory_size += get_mem3Dpel(&(currSlice->mb_rec ), MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  memory_size += get_mem3Dint(&(currSlice->mb_rres), MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  memory_size += get_mem3Dint(&(currSlice->cof    ), MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  // macroblock buffers used by the transform/reconstruction kernels start on a cache line
+  memory_size += get_mem3Dpel_aligned(&(currSlice->mb_pred), MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  memory_size += get_mem3Dpel_aligned(&(currSlice->mb_rec ), MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  memory_size += get_mem3Dint_aligned(&(currSlice->mb_rres), MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  memory_size += get_mem3Dint_aligned(&(currSlice->cof    ), MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
   //  memory_size += get_mem3Dint(&(currSlice->fcf    ), MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
 
   allocate_pred_mem(currSlice);
@@ -1171,10 +1279,10 @@ static void free_slice(Slice *currSlice)
 {
   free_pred_mem(currSlice);
 
-  free_mem3Dint(currSlice->cof    );
-  free_mem3Dint(currSlice->mb_rres);
-  free_mem3Dpel(currSlice->mb_rec );
-  free_mem3Dpel(currSlice->mb_pred);
+  free_mem3Dint_aligned(currSlice->cof    );
+  free_mem3Dint_aligned(currSlice->mb_rres);
+  free_mem3Dpel_aligned(currSlice->mb_rec );
+  free_mem3Dpel_aligned(currSlice->mb_pred);
 
 
   free_mem3Dint(currSlice->wp_weight );
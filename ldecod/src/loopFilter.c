@@ -561,7 +561,7 @@ static void EdgeLoopLumaNormal(ColorPlane pl, imgpel** Img, byte Strength[16], M
       const byte *ClipTab = CLIP_TAB   [indexA];
       PixelPos pixQ = pixMB2;
       int max_imgpel_value = p_Vid->max_pel_value_comp[pl];
-      int width = p->size_x;
+      int width = (pl == PLANE_Y) ? p->planeY.stride : p->planeUV[pl - 1].stride;
       int inc_dim = dir ? width : 1;
       int pel;
 
@@ -657,7 +657,7 @@ static void EdgeLoopLumaNormal(ColorPlane pl, imgpel** Img, byte Strength[16], M
 static void EdgeLoopLumaMBAff(ColorPlane pl, imgpel** Img, byte Strength[16], Macroblock *MbQ, 
               int dir, int edge, StorablePicture *p)
 {
-  int      width = p->size_x;
+  int      width = (pl == PLANE_Y) ? p->planeY.stride : p->planeUV[pl - 1].stride;
   int      pel, ap = 0, aq = 0, Strng ;
   int      incP, incQ;
   int      C0, tc0, dif;
@@ -806,7 +806,7 @@ static void EdgeLoopChromaNormal(imgpel** Img, byte Strength[16], Macroblock *Mb
 
     int AlphaC0Offset = MbQ->DFAlphaC0Offset;
     int BetaOffset = MbQ->DFBetaOffset;
-    int width = p->size_x_cr;
+    int width = p->planeUV[uv].stride;
     int dirM1 = dir - 1;
     PixelPos pixP = pixMB1;
     Macroblock *MbP = &(p_Vid->mb_data[pixP.mb_addr]);
@@ -906,7 +906,7 @@ static void EdgeLoopChromaMBAff(imgpel** Img, byte Strength[16], Macroblock *MbQ
   byte fieldModeFilteringFlag;
   Macroblock *MbP;
   imgpel   *SrcPtrP, *SrcPtrQ;
-  int      width = p->size_x_cr;
+  int      width = p->planeUV[uv].stride;
 
   for( pel = 0 ; pel < PelNum ; ++pel )
   {
@@ -322,7 +322,7 @@ static void readMBMotionVectors (SyntaxElement *currSE, DataPartition *dP, Macro
             }
 
 			/***** XML_TRACE_BEGIN *****/
-			if(xml_gen_trace_file() && xml_get_log_level() >= 3)
+			if(xml_trace_enabled(3))
 			{
 				if(currMB->mb_type != P8x8 && !currMB->skip_flag)
 				{
@@ -331,24 +331,14 @@ static void readMBMotionVectors (SyntaxElement *currSE, DataPartition *dP, Macro
 							xml_write_int_attribute("list", 0);
 						else
 							xml_write_int_attribute("list", 1);
-						xml_write_start_element("RefIdx");
-							xml_write_int(cur_ref_idx);
-						xml_write_end_element();
+						xml_write_int_element("RefIdx", cur_ref_idx);
 						xml_write_start_element("Difference");
-							xml_write_start_element("X");
-								xml_write_int(curr_mvd[0]);
-							xml_write_end_element();
-							xml_write_start_element("Y");
-								xml_write_int(curr_mvd[1]);
-							xml_write_end_element();
+							xml_write_int_element("X", curr_mvd[0]);
+							xml_write_int_element("Y", curr_mvd[1]);
 						xml_write_end_element();
 						xml_write_start_element("Absolute");
-							xml_write_start_element("X");
-								xml_write_int(curr_mv[0]);
-							xml_write_end_element();
-							xml_write_start_element("Y");
-								xml_write_int(curr_mv[1]);
-							xml_write_end_element();
+							xml_write_int_element("X", curr_mv[0]);
+							xml_write_int_element("Y", curr_mv[1]);
 						xml_write_end_element();
 					xml_write_end_element();
 				}
@@ -2252,7 +2242,7 @@ static void read_motion_info_from_NAL_p_slice (Macroblock *currMB)
   readMBMotionVectors (&currSE, dP, currMB, LIST_0, step_h0, step_v0);
 
   /***** XML_TRACE_BEGIN *****/
-  if(xml_gen_trace_file() && xml_get_log_level() >= 2) addMVInfoToTrace(currMB);
+  if(xml_trace_enabled(2)) addMVInfoToTrace(currMB);
   /*****  XML_TRACE_END  *****/
 
   // record reference picture Ids for deblocking decisions
@@ -2520,7 +2510,7 @@ static void read_motion_info_from_NAL_b_slice (Macroblock *currMB)
   readMBMotionVectors (&currSE, dP, currMB, LIST_1, step_h0, step_v0);
 
   /***** XML_TRACE_BEGIN *****/
-  if(xml_gen_trace_file() && xml_get_log_level() >= 2) addMVInfoToTrace(currMB);
+  if(xml_trace_enabled(2)) addMVInfoToTrace(currMB);
   /*****  XML_TRACE_END  *****/
 
   // record reference picture Ids for deblocking decisions
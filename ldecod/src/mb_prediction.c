@@ -32,8 +32,10 @@
 #include "intra4x4_pred.h"
 #include "intra8x8_pred.h"
 #include "intra16x16_pred.h"
+#include "intra_pred_common.h"
 #include "mv_prediction.h"
 #include "mb_prediction.h"
+#include "dec_profile.h"
 
 
 int mb_pred_intra4x4(Macroblock *currMB, ColorPlane curr_plane, imgpel **currImg, StorablePicture *dec_picture)
@@ -46,6 +48,8 @@ int mb_pred_intra4x4(Macroblock *currMB, ColorPlane curr_plane, imgpel **currImg
   int block8x8;   // needed for ABT
   currMB->itrans_4x4 = (currMB->is_lossless == FALSE) ? itrans4x4 : Inv_Residual_trans_4x4;    
 
+  get_intra_neighbours(currMB, curr_plane);
+
   for (block8x8 = 0; block8x8 < 4; block8x8++)
   {
     for (k = block8x8 * 4; k < block8x8 * 4 + 4; k ++)
@@ -62,13 +66,22 @@ int mb_pred_intra4x4(Macroblock *currMB, ColorPlane curr_plane, imgpel **currImg
 
       // PREDICTION
       //===== INTRA PREDICTION =====
+      DEC_PROF_START(PROF_INTRA);
       if (intrapred(currMB, curr_plane, ioff,joff,i4,j4) == SEARCH_SYNC)  /* make 4x4 prediction block mpr from given prediction p_Vid->mb_mode */
+      {
+        DEC_PROF_STOP(PROF_INTRA);
         return SEARCH_SYNC;                   /* bit error */
+      }
+      DEC_PROF_STOP(PROF_INTRA);
       // =============== 4x4 itrans ================
       // -------------------------------------------
-      currMB->itrans_4x4  (currMB, curr_plane, ioff, joff);
+      {
+        DEC_PROF_START(PROF_ITRANS);
+        currMB->itrans_4x4  (currMB, curr_plane, ioff, joff);
 
-      copy_image_data_4x4(&currImg[j_pos], &currSlice->mb_rec[curr_plane][joff], i_pos, ioff);
+        copy_image_data_4x4(&currImg[j_pos], &currSlice->mb_rec[curr_plane][joff], i_pos, ioff);
+        DEC_PROF_STOP(PROF_ITRANS);
+      }
     }
   }
 
@@ -86,11 +99,20 @@ int mb_pred_intra16x16(Macroblock *currMB, ColorPlane curr_plane, imgpel **currI
 {
   int yuv = dec_picture->chroma_format_idc - 1;
 
-  intrapred16x16(currMB, curr_plane, currMB->i16mode);
+  {
+    DEC_PROF_START(PROF_INTRA);
+    get_intra_neighbours(currMB, curr_plane);
+    intrapred16x16(currMB, curr_plane, currMB->i16mode);
+    DEC_PROF_STOP(PROF_INTRA);
+  }
   currMB->ipmode_DPCM = (char) currMB->i16mode; //For residual DPCM
   // =============== 4x4 itrans ================
   // -------------------------------------------
-  iMBtrans4x4(currMB, curr_plane, 0);
+  {
+    DEC_PROF_START(PROF_ITRANS);
+    iMBtrans4x4(currMB, curr_plane, 0);
+    DEC_PROF_STOP(PROF_ITRANS);
+  }
 
   // chroma decoding *******************************************************
   if ((dec_picture->chroma_format_idc != YUV400) && (dec_picture->chroma_format_idc != YUV444)) 
@@ -108,6 +130,8 @@ int mb_pred_intra8x8(Macroblock *currMB, ColorPlane curr_plane, imgpel **currImg
   int block8x8;   // needed for ABT
   currMB->itrans_8x8 = (currMB->is_lossless == FALSE) ? itrans8x8 : Inv_Residual_trans_8x8;
 
+  get_intra_neighbours(currMB, curr_plane);
+
   for (block8x8 = 0; block8x8 < 4; block8x8++)
   {
     //=========== 8x8 BLOCK TYPE ============
@@ -115,10 +139,18 @@ int mb_pred_intra8x8(Macroblock *currMB, ColorPlane curr_plane, imgpel **currImg
     int joff = (block8x8 >> 1  ) << 3;
 
     //PREDICTION
-    intrapred8x8(currMB, curr_plane, ioff, joff);
-    currMB->itrans_8x8  (currMB, curr_plane, ioff,joff);      // use DCT transform and make 8x8 block m7 from prediction block mpr
+    {
+      DEC_PROF_START(PROF_INTRA);
+      intrapred8x8(currMB, curr_plane, ioff, joff);
+      DEC_PROF_STOP(PROF_INTRA);
+    }
+    {
+      DEC_PROF_START(PROF_ITRANS);
+      currMB->itrans_8x8  (currMB, curr_plane, ioff,joff);      // use DCT transform and make 8x8 block m7 from prediction block mpr
 
-    copy_image_data_8x8(&currImg[currMB->pix_y + joff], &currSlice->mb_rec[curr_plane][joff], currMB->pix_x + ioff, ioff);
+      copy_image_data_8x8(&currImg[currMB->pix_y + joff], &currSlice->mb_rec[curr_plane][joff], currMB->pix_x + ioff, ioff);
+      DEC_PROF_STOP(PROF_ITRANS);
+    }
   }
   // chroma decoding *******************************************************
   if ((dec_picture->chroma_format_idc != YUV400) && (dec_picture->chroma_format_idc != YUV444)) 
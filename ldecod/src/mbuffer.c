@@ -39,6 +39,8 @@ static int  remove_unused_frame_from_dpb (VideoParameters *p_Vid, DecodedPicture
 static int  is_used_for_reference    (FrameStore* fs);
 static int  is_short_term_reference  (FrameStore* fs);
 static int  is_long_term_reference   (FrameStore* fs);
+static void init_storable_picture    (VideoParameters *p_Vid, StorablePicture *s, PictureStructure structure, int size_x, int size_y, int size_x_cr, int size_y_cr);
+static void release_storable_picture (VideoParameters *p_Vid, StorablePicture* p);
 
 #define MAX_LIST_SIZE 33
 
@@ -319,6 +321,7 @@ void free_dpb(VideoParameters *p_Vid)
       free_frame_store(p_Vid, p_Vid->last_out_fs);
 
   free_storable_picture(p_Vid, p_Vid->no_reference_picture);
+  free_pooled_picture(p_Vid);
 }
 
 
@@ -378,6 +381,32 @@ void alloc_pic_motion(VideoParameters *p_Vid, PicMotionParams *motion, int size_
   get_mem2D (&(motion->field_frame), size_y, size_x);
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Clear the ref_pic_num tables of a picture up to a slice
+ *
+ * \param p
+ *    picture
+ * \param max_slice_id
+ *    last slice row that is read or written
+ ************************************************************************
+ */
+void clear_ref_pic_num(StorablePicture* p, int max_slice_id)
+{
+  int rows = max_slice_id + 1 - p->ref_pic_num_rows;
+
+  if (rows > 0)
+  {
+    int first = p->ref_pic_num_rows;
+    memset(p->ref_pic_num[first],        0, rows * sizeof(p->ref_pic_num[0]));
+    memset(p->frm_ref_pic_num[first],    0, rows * sizeof(p->frm_ref_pic_num[0]));
+    memset(p->top_ref_pic_num[first],    0, rows * sizeof(p->top_ref_pic_num[0]));
+    memset(p->bottom_ref_pic_num[first], 0, rows * sizeof(p->bottom_ref_pic_num[0]));
+    p->ref_pic_num_rows = (short) (max_slice_id + 1);
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -413,19 +442,35 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
   if (NULL==s)
     no_mem_exit("alloc_storable_picture: s");
 
+  // the four ref_pic_num tables (7.6 MB) share one block that is cleared as slices use it
+  s->ref_pic_num = malloc (4 * MAX_NUM_SLICES * sizeof(*s->ref_pic_num));
+  if (NULL==s->ref_pic_num)
+    no_mem_exit("alloc_storable_picture: s->ref_pic_num");
+  s->frm_ref_pic_num    = s->ref_pic_num     + MAX_NUM_SLICES;
+  s->top_ref_pic_num    = s->frm_ref_pic_num + MAX_NUM_SLICES;
+  s->bottom_ref_pic_num = s->top_ref_pic_num + MAX_NUM_SLICES;
+  clear_ref_pic_num(s, 0);
+
   if (structure!=FRAME)
   {
     size_y    /= 2;
     size_y_cr /= 2;
   }
 
-  s->PicSizeInMbs = (size_x*size_y)/256;
   s->imgUV = NULL;
 
-  get_mem2Dpel (&(s->imgY), size_y, size_x);
+  get_plane (&s->planeY, size_y, size_x);
+  s->imgY = s->planeY.img;
 
   if (active_sps->chroma_format_idc != YUV400)
-    get_mem3Dpel (&(s->imgUV), 2, size_y_cr, size_x_cr);
+  {
+    if ((s->imgUV = (imgpel***) malloc(2 * sizeof(imgpel**))) == NULL)
+      no_mem_exit("alloc_storable_picture: s->imgUV");
+    get_plane (&s->planeUV[0], size_y_cr, size_x_cr);
+    get_plane (&s->planeUV[1], size_y_cr, size_x_cr);
+    s->imgUV[0] = s->planeUV[0].img;
+    s->imgUV[1] = s->planeUV[1].img;
+  }
   
   get_mem2Dshort (&(s->slice_id), size_y / MB_BLOCK_SIZE, size_x / MB_BLOCK_SIZE);
 
@@ -439,6 +484,118 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
     }
   }
 
+  init_storable_picture(p_Vid, s, structure, size_x, size_y, size_x_cr, size_y_cr);
+
+  return s;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Get a frame for a lost frame. With concealment enabled,
+ *    free_storable_picture() keeps one freed frame of the current size,
+ *    which is reused here so that concealing a burst of losses does not
+ *    allocate and page in a new frame per loss.
+ *
+ * \param p_Vid
+ *    image decoding parameters for current picture
+ *
+ * \return
+ *    a frame in the state alloc_storable_picture() returns; the samples
+ *    of a reused frame are left as they are
+ ************************************************************************
+ */
+StorablePicture* alloc_pooled_picture(VideoParameters *p_Vid)
+{
+  StorablePicture *s = p_Vid->picture_pool;
+  StorablePicture keep;
+  int lists = p_Vid->active_sps->frame_mbs_only_flag ? 2 : 6;
+  int size_y, size_x;
+
+  if (s != NULL && (s->size_x != p_Vid->width || s->size_y != p_Vid->height ||
+    s->size_x_cr != p_Vid->width_cr || s->size_y_cr != p_Vid->height_cr))
+  {
+    free_pooled_picture(p_Vid);
+    s = NULL;
+  }
+
+  if (s == NULL)
+  {
+    return alloc_storable_picture(p_Vid, FRAME, p_Vid->width, p_Vid->height, p_Vid->width_cr, p_Vid->height_cr);
+  }
+  p_Vid->picture_pool = NULL;
+
+  // clear everything but the buffers, as calloc does for a new picture
+  keep = *s;
+  memset(s, 0, sizeof(StorablePicture));
+  s->ref_pic_num        = keep.ref_pic_num;
+  s->frm_ref_pic_num    = keep.frm_ref_pic_num;
+  s->top_ref_pic_num    = keep.top_ref_pic_num;
+  s->bottom_ref_pic_num = keep.bottom_ref_pic_num;
+  s->imgY       = keep.imgY;
+  s->imgUV      = keep.imgUV;
+  s->planeY     = keep.planeY;
+  s->planeUV[0] = keep.planeUV[0];
+  s->planeUV[1] = keep.planeUV[1];
+  s->motion     = keep.motion;
+  s->slice_id   = keep.slice_id;
+  if (keep.seiHasTone_mapping)
+    free(keep.tone_mapping_lut);
+
+  clear_ref_pic_num(s, 0);
+  size_y = keep.size_y / BLOCK_SIZE;
+  size_x = keep.size_x / BLOCK_SIZE;
+  // unmark_for_reference() frees the motion of pictures that are no longer referenced
+  if (s->motion.mv == NULL)
+  {
+    alloc_pic_motion(p_Vid, &s->motion, size_y, size_x);
+  }
+  else
+  {
+    memset(s->motion.ref_pic_id[0][0], 0, lists * size_y * size_x * sizeof(int64));
+    memset(s->motion.ref_id[0][0],     0, lists * size_y * size_x * sizeof(int64));
+    memset(s->motion.mv[0][0][0],      0, 2 * size_y * size_x * 2 * sizeof(short));
+    memset(s->motion.ref_idx[0][0],    0, 2 * size_y * size_x * sizeof(char));
+    memset(s->motion.mb_field,         0, size_y * size_x * sizeof(byte));
+    memset(s->motion.field_frame[0],   0, size_y * size_x * sizeof(byte));
+  }
+  memset(s->slice_id[0], 0, (keep.size_y / MB_BLOCK_SIZE) * (keep.size_x / MB_BLOCK_SIZE) * sizeof(short));
+
+  init_storable_picture(p_Vid, s, FRAME, keep.size_x, keep.size_y, keep.size_x_cr, keep.size_y_cr);
+
+  return s;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free the frame kept for the next lost frame.
+ *
+ * \param p_Vid
+ *    image decoding parameters for current picture
+ ************************************************************************
+ */
+void free_pooled_picture(VideoParameters *p_Vid)
+{
+  StorablePicture *p = p_Vid->picture_pool;
+
+  if (p)
+  {
+    p_Vid->picture_pool = NULL;
+    release_storable_picture(p_Vid, p);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Set the parameters of a new picture.
+ ************************************************************************
+ */
+static void init_storable_picture(VideoParameters *p_Vid, StorablePicture *s, PictureStructure structure, int size_x, int size_y, int size_x_cr, int size_y_cr)
+{
+  s->PicSizeInMbs = (size_x*size_y)/256;
+
   s->pic_num=0;
   s->frame_num=0;
   s->long_term_frame_idx=0;
@@ -446,6 +603,7 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
   s->used_for_reference=0;
   s->is_long_term=0;
   s->non_existing=0;
+  s->recon_skipped=0;
   s->is_output = 0;
   s->max_slice_id = 0;
 
@@ -471,8 +629,6 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
 
   s->top_poc = s->bottom_poc = s->poc = 0;
   s->seiHasTone_mapping = 0;
-
-  return s;
 }
 
 /*!
@@ -562,6 +718,31 @@ void free_pic_motion(PicMotionParams *motion)
  ************************************************************************
  */
 void free_storable_picture(VideoParameters *p_Vid, StorablePicture* p)
+{
+  // with concealment enabled, keep one frame of the current size for alloc_pooled_picture()
+  if (p && p_Vid->conceal_mode != 0 && p_Vid->picture_pool == NULL && p->structure == FRAME && !IS_INDEPENDENT(p_Vid) &&
+    p->size_x == p_Vid->width && p->size_y == p_Vid->height && p->size_x_cr == p_Vid->width_cr && p->size_y_cr == p_Vid->height_cr)
+  {
+    p_Vid->picture_pool = p;
+    return;
+  }
+
+  release_storable_picture(p_Vid, p);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free the memory of a picture.
+ *
+ * \param p_Vid
+ *      image decoding parameters for current picture
+ * \param p
+ *    Picture to be freed
+ *
+ ************************************************************************
+ */
+static void release_storable_picture(VideoParameters *p_Vid, StorablePicture* p)
 {
   int nplane;
   if (p)
@@ -578,13 +759,15 @@ void free_storable_picture(VideoParameters *p_Vid, StorablePicture* p)
 
     if (p->imgY)
     {
-      free_mem2Dpel (p->imgY);
+      free_plane (&p->planeY);
       p->imgY=NULL;
     }
 
     if (p->imgUV)
     {
-      free_mem3Dpel (p->imgUV);
+      free_plane (&p->planeUV[0]);
+      free_plane (&p->planeUV[1]);
+      free (p->imgUV);
       p->imgUV=NULL;
     }
 
@@ -597,6 +780,8 @@ void free_storable_picture(VideoParameters *p_Vid, StorablePicture* p)
     if (p->seiHasTone_mapping)
       free(p->tone_mapping_lut);
 
+    free(p->ref_pic_num);
+
     free(p);
     p = NULL;
   }
@@ -2995,6 +3180,8 @@ void dpb_split_field(VideoParameters *p_Vid, FrameStore *fs)
     fs_top->chroma_format_idc = fs_btm->chroma_format_idc = frame->chroma_format_idc;
 
     //store reference picture index
+    clear_ref_pic_num(fs_top, frame->max_slice_id);
+    clear_ref_pic_num(fs_btm, frame->max_slice_id);
     for (j=0; j<=frame->max_slice_id; j++)
     {
       memcpy(&fs_top->ref_pic_num[j][LIST_0][0], &frame->ref_pic_num[j][2 + LIST_0][0], 66 * sizeof(int64));
@@ -3201,6 +3388,7 @@ void dpb_combine_field_yuv(VideoParameters *p_Vid, FrameStore *fs)
   fs->top_field->bottom_poc=fs->frame->bottom_poc=fs->bottom_field->poc;
 
   fs->frame->used_for_reference = (fs->top_field->used_for_reference && fs->bottom_field->used_for_reference );
+  fs->frame->recon_skipped = (fs->top_field->recon_skipped || fs->bottom_field->recon_skipped);
   fs->frame->is_long_term = (fs->top_field->is_long_term && fs->bottom_field->is_long_term );
 
   if (fs->frame->is_long_term)
@@ -3240,6 +3428,10 @@ void dpb_combine_field(VideoParameters *p_Vid, FrameStore *fs)
 
 
   //combine field for frame
+  j = imax(fs->top_field->max_slice_id, fs->bottom_field->max_slice_id);
+  clear_ref_pic_num(fs->frame, j);
+  clear_ref_pic_num(fs->top_field, j);
+  clear_ref_pic_num(fs->bottom_field, j);
   for (j=0; j<=(imax(fs->top_field->max_slice_id, fs->bottom_field->max_slice_id)); j++)
   {
     for (k = LIST_0; k <= LIST_1; k++)
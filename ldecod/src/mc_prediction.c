@@ -20,6 +20,7 @@
 #include "mb_access.h"
 #include "macroblock.h"
 #include "memalloc.h"
+#include "dec_profile.h"
 
 int allocate_pred_mem(Slice *currSlice)
 {
@@ -27,6 +28,10 @@ int allocate_pred_mem(Slice *currSlice)
   alloc_size += get_mem2Dpel(&currSlice->tmp_block_l0, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
   alloc_size += get_mem2Dpel(&currSlice->tmp_block_l1, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
   alloc_size += get_mem2Dint(&currSlice->tmp_res, MB_BLOCK_SIZE + 5, MB_BLOCK_SIZE + 5);
+  alloc_size += get_mem2Dpel(&currSlice->tmp_block_cr[LIST_0][0], MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  alloc_size += get_mem2Dpel(&currSlice->tmp_block_cr[LIST_0][1], MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  alloc_size += get_mem2Dpel(&currSlice->tmp_block_cr[LIST_1][0], MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  alloc_size += get_mem2Dpel(&currSlice->tmp_block_cr[LIST_1][1], MB_BLOCK_SIZE, MB_BLOCK_SIZE);
 
   return (alloc_size);
 }
@@ -36,6 +41,10 @@ void free_pred_mem(Slice *currSlice)
   free_mem2Dint(currSlice->tmp_res);
   free_mem2Dpel(currSlice->tmp_block_l0);
   free_mem2Dpel(currSlice->tmp_block_l1);
+  free_mem2Dpel(currSlice->tmp_block_cr[LIST_0][0]);
+  free_mem2Dpel(currSlice->tmp_block_cr[LIST_0][1]);
+  free_mem2Dpel(currSlice->tmp_block_cr[LIST_1][0]);
+  free_mem2Dpel(currSlice->tmp_block_cr[LIST_1][1]);
 }
 
 static const int COEF[6] = { 1, -5, 20, 20, -5, 1 };
@@ -66,6 +75,223 @@ static inline void mc_prediction(imgpel **mb_pred,
   }
 }
 
+#if defined(__SSE2__) && (IMGTYPE < 2)
+#include <emmintrin.h>
+
+/*
+ * SSE2 prediction kernels
+ *
+ * Samples are processed as 16 bit values, 8 per register. Rows of 2, 4, 8
+ * and 16 samples are supported (all luma and 4:2:0/4:2:2 chroma block widths).
+ * The results are bit-exact to the scalar versions.
+ */
+
+//! loads n (2, 4 or 8) samples zero extended to 16 bit
+static inline __m128i load_pels(const imgpel *p, int n)
+{
+#if (IMGTYPE == 0)
+  if (n == 8)
+  {
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) p), _mm_setzero_si128());
+  }
+  else
+  {
+    int v = 0;
+    memcpy(&v, p, n * sizeof(imgpel));
+    return _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), _mm_setzero_si128());
+  }
+#else
+  if (n == 8)
+  {
+    return _mm_loadu_si128((const __m128i *) p);
+  }
+  else if (n == 4)
+  {
+    return _mm_loadl_epi64((const __m128i *) p);
+  }
+  else
+  {
+    int v;
+    memcpy(&v, p, 2 * sizeof(imgpel));
+    return _mm_cvtsi32_si128(v);
+  }
+#endif
+}
+
+//! stores n (2, 4 or 8) samples from 16 bit values in the imgpel range
+static inline void store_pels(imgpel *p, __m128i v, int n)
+{
+#if (IMGTYPE == 0)
+  v = _mm_packus_epi16(v, v);
+  if (n == 8)
+  {
+    _mm_storel_epi64((__m128i *) p, v);
+  }
+  else
+  {
+    int x = _mm_cvtsi128_si32(v);
+    memcpy(p, &x, n * sizeof(imgpel));
+  }
+#else
+  if (n == 8)
+  {
+    _mm_storeu_si128((__m128i *) p, v);
+  }
+  else if (n == 4)
+  {
+    _mm_storel_epi64((__m128i *) p, v);
+  }
+  else
+  {
+    int x = _mm_cvtsi128_si32(v);
+    memcpy(p, &x, 2 * sizeof(imgpel));
+  }
+#endif
+}
+
+//! (lo, hi) 32 bit sums of w_a * a[i] + w_b * b[i], w holds the (w_a, w_b) pairs
+static inline void madd_pels(__m128i a, __m128i b, __m128i w, __m128i *lo, __m128i *hi)
+{
+  *lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w);
+  *hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w);
+}
+
+//! (x + rnd) >> shift of the 32 bit sums, packed to 16 bit with signed saturation
+static inline __m128i round_pack(__m128i lo, __m128i hi, __m128i rnd, __m128i shift)
+{
+  lo = _mm_sra_epi32(_mm_add_epi32(lo, rnd), shift);
+  hi = _mm_sra_epi32(_mm_add_epi32(hi, rnd), shift);
+  return _mm_packs_epi32(lo, hi);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    block single list weighted prediction
+ ************************************************************************
+ */
+static inline void weighted_mc_prediction(imgpel **mb_pred,
+                            int ver_block_size, 
+                            int hor_block_size,
+                            int ioff,
+                            imgpel **block, 
+                            int wp_scale,
+                            int wp_offset,
+                            int weight_denom,
+                            int color_clip)
+{
+  // rshift_rnd(wp_scale * x, weight_denom) as madd of (x, 1) with (wp_scale, round)
+  short   rnd    = (short) (weight_denom > 0 ? 1 << (weight_denom - 1) : 0);
+  __m128i w      = _mm_setr_epi16((short) wp_scale, rnd, (short) wp_scale, rnd, (short) wp_scale, rnd, (short) wp_scale, rnd);
+  __m128i one    = _mm_set1_epi16(1);
+  __m128i offset = _mm_set1_epi32(wp_offset);
+  __m128i shift  = _mm_cvtsi32_si128(weight_denom);
+  __m128i max    = _mm_set1_epi16((short) color_clip);
+  __m128i zero   = _mm_setzero_si128();
+  int ii, jj;
+
+  for(jj = 0; jj < ver_block_size; jj++)
+  {
+    imgpel *mpr = &mb_pred[jj][ioff];
+    imgpel *b0  = block[jj];
+
+    for(ii = 0; ii < hor_block_size; ii += 8)
+    {
+      int n = imin(hor_block_size - ii, 8);
+      __m128i lo, hi, res;
+
+      madd_pels(load_pels(b0 + ii, n), one, w, &lo, &hi);
+      lo  = _mm_add_epi32(_mm_sra_epi32(lo, shift), offset);
+      hi  = _mm_add_epi32(_mm_sra_epi32(hi, shift), offset);
+      res = _mm_packs_epi32(lo, hi);
+      res = _mm_min_epi16(_mm_max_epi16(res, zero), max);
+      store_pels(mpr + ii, res, n);
+    }
+  }
+}
+
+
+/*!
+ ************************************************************************
+ * \brief
+ *    block biprediction
+ ************************************************************************
+ */
+static inline void bi_prediction(imgpel **mb_pred,  
+                                 imgpel **block_l0, 
+                                 imgpel **block_l1,
+                                 int ver_block_size, 
+                                 int hor_block_size,
+                                 int ioff)
+{
+  int ii, jj;
+
+  for(jj = 0;jj < ver_block_size;jj++)
+  {
+    imgpel *mpr = &mb_pred[jj][ioff];
+    imgpel *b0  = block_l0[jj];
+    imgpel *b1  = block_l1[jj];
+
+    for(ii = 0; ii < hor_block_size; ii += 8)
+    {
+      int n = imin(hor_block_size - ii, 8);
+
+      // (b0 + b1 + 1) >> 1
+      store_pels(mpr + ii, _mm_avg_epu16(load_pels(b0 + ii, n), load_pels(b1 + ii, n)), n);
+    }
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    block weighted biprediction
+ ************************************************************************
+ */
+static inline void weighted_bi_prediction(imgpel **mb_pred, 
+                                          imgpel **block_l0, 
+                                          imgpel **block_l1,
+                                          int ver_block_size, 
+                                          int hor_block_size,
+                                          int ioff,
+                                          int wp_scale_l0,
+                                          int wp_scale_l1,
+                                          int wp_offset,
+                                          int weight_denom,
+                                          int color_clip)
+{
+  __m128i w      = _mm_setr_epi16((short) wp_scale_l0, (short) wp_scale_l1, (short) wp_scale_l0, (short) wp_scale_l1,
+                                  (short) wp_scale_l0, (short) wp_scale_l1, (short) wp_scale_l0, (short) wp_scale_l1);
+  __m128i rnd    = _mm_set1_epi32(weight_denom > 0 ? 1 << (weight_denom - 1) : 0);
+  __m128i offset = _mm_set1_epi32(wp_offset);
+  __m128i shift  = _mm_cvtsi32_si128(weight_denom);
+  __m128i max    = _mm_set1_epi16((short) color_clip);
+  __m128i zero   = _mm_setzero_si128();
+  int ii, jj;
+  
+  for(jj = 0; jj < ver_block_size; jj++)
+  {
+    imgpel *mpr = &mb_pred[jj][ioff];    
+    imgpel *b0  = block_l0[jj];
+    imgpel *b1  = block_l1[jj];
+
+    for(ii = 0; ii < hor_block_size; ii += 8)
+    {
+      int n = imin(hor_block_size - ii, 8);
+      __m128i lo, hi, res;
+
+      madd_pels(load_pels(b0 + ii, n), load_pels(b1 + ii, n), w, &lo, &hi);
+      lo  = _mm_add_epi32(_mm_sra_epi32(_mm_add_epi32(lo, rnd), shift), offset);
+      hi  = _mm_add_epi32(_mm_sra_epi32(_mm_add_epi32(hi, rnd), shift), offset);
+      res = _mm_packs_epi32(lo, hi);
+      res = _mm_min_epi16(_mm_max_epi16(res, zero), max);
+      store_pels(mpr + ii, res, n);
+    }
+  }
+}
+
+#else
+
 /*!
  ************************************************************************
  * \brief
@@ -151,6 +377,8 @@ static inline void weighted_bi_prediction(imgpel **mb_pred,
   }
 }
 
+#endif
+
 /*!
  ************************************************************************
  * \brief
@@ -1840,6 +2068,7 @@ void get_block_luma(Macroblock *currMB, ColorPlane pl, StorablePicture *curr_ref
     imgpel **cur_imgY = curr_ref->imgY;
 
     int dx = (x_pos & 3), dy = (y_pos & 3);
+    int shift_x;
 
     int maxold_x = dec_picture->size_x_m1;
     int maxold_y = (dec_picture->motion.mb_field[currMB->mbAddrX]) ? (dec_picture->size_y >> 1) - 1 : dec_picture->size_y_m1;   
@@ -1868,6 +2097,9 @@ void get_block_luma(Macroblock *currMB, ColorPlane pl, StorablePicture *curr_ref
       cur_imgY = curr_ref->imgUV[pl-1]; 
     }
 
+    // row stride of the reference plane (rounded up for alignment)
+    shift_x = (int) (cur_imgY[1] - cur_imgY[0]);
+
     x_pos >>= 2;
     y_pos >>= 2;
 
@@ -1898,8 +2130,6 @@ void get_block_luma(Macroblock *currMB, ColorPlane pl, StorablePicture *curr_ref
         }
         else if (dx == 0) /* No horizontal interpolation */        
         {         
-          int shift_x  = dec_picture->size_x;
-
           if (dy == 1)
           {
             get_luma_01(block, &cur_imgY[y_pos], ver_block_size, hor_block_size, x_pos, shift_x, max_imgpel_value);
@@ -1932,11 +2162,11 @@ void get_block_luma(Macroblock *currMB, ColorPlane pl, StorablePicture *curr_ref
         {
           if (dx == 1)
           {
-            get_luma_12(block, &cur_imgY[ y_pos], currMB->p_Slice->tmp_res, ver_block_size, hor_block_size, x_pos, dec_picture->size_x, max_imgpel_value);
+            get_luma_12(block, &cur_imgY[ y_pos], currMB->p_Slice->tmp_res, ver_block_size, hor_block_size, x_pos, shift_x, max_imgpel_value);
           }
           else
           {
-            get_luma_32(block, &cur_imgY[ y_pos], currMB->p_Slice->tmp_res, ver_block_size, hor_block_size, x_pos, dec_picture->size_x, max_imgpel_value);
+            get_luma_32(block, &cur_imgY[ y_pos], currMB->p_Slice->tmp_res, ver_block_size, hor_block_size, x_pos, shift_x, max_imgpel_value);
           }        
         }
         else
@@ -1944,16 +2174,16 @@ void get_block_luma(Macroblock *currMB, ColorPlane pl, StorablePicture *curr_ref
           if (dx == 1)
           {
             if (dy == 1)
-              get_luma_11(block, &cur_imgY[ y_pos], ver_block_size, hor_block_size, x_pos, dec_picture->size_x, max_imgpel_value);
+              get_luma_11(block, &cur_imgY[ y_pos], ver_block_size, hor_block_size, x_pos, shift_x, max_imgpel_value);
             else
-              get_luma_13(block, &cur_imgY[ y_pos], ver_block_size, hor_block_size, x_pos, dec_picture->size_x, max_imgpel_value);
+              get_luma_13(block, &cur_imgY[ y_pos], ver_block_size, hor_block_size, x_pos, shift_x, max_imgpel_value);
           }
           else
           {
             if (dy == 1)
-              get_luma_31(block, &cur_imgY[ y_pos], ver_block_size, hor_block_size, x_pos, dec_picture->size_x, max_imgpel_value);
+              get_luma_31(block, &cur_imgY[ y_pos], ver_block_size, hor_block_size, x_pos, shift_x, max_imgpel_value);
             else
-              get_luma_33(block, &cur_imgY[ y_pos], ver_block_size, hor_block_size, x_pos, dec_picture->size_x, max_imgpel_value);
+              get_luma_33(block, &cur_imgY[ y_pos], ver_block_size, hor_block_size, x_pos, shift_x, max_imgpel_value);
           }
         }
       }
@@ -2068,6 +2298,62 @@ static void get_chroma_00(imgpel **block, imgpel **cur_img, int ver_block_size,
 }
 
 
+#if defined(__SSE2__) && (IMGTYPE < 2)
+/*!
+ ************************************************************************
+ * \brief
+ *    Chroma (0,X), (X,0) and (X,X) of the same block in num_planes
+ *    planes (SSE2), block and cur_img hold one entry per plane
+ ************************************************************************
+ */ 
+static void get_chroma_subpel(imgpel ***block, imgpel ***cur_img, int num_planes, int ver_block_size, int hor_block_size, int x_pos, int y_pos,
+                              int dx, int dy, int w00, int w01, int w10, int w11, int total_scale)
+{
+  // (0,X) weighs the current and the next row, (X,0) and (X,X) the current and the next column
+  __m128i w_cur = (dx == 0) ? _mm_setr_epi16((short) w00, (short) w01, (short) w00, (short) w01, (short) w00, (short) w01, (short) w00, (short) w01)
+                            : _mm_setr_epi16((short) w00, (short) w10, (short) w00, (short) w10, (short) w00, (short) w10, (short) w00, (short) w10);
+  __m128i w_nxt = _mm_setr_epi16((short) w01, (short) w11, (short) w01, (short) w11, (short) w01, (short) w11, (short) w01, (short) w11);
+  __m128i rnd   = _mm_set1_epi32(1 << (total_scale - 1));
+  __m128i shift = _mm_cvtsi32_si128(total_scale);
+  int i, j, pl;
+
+  for (j = 0; j < ver_block_size; j++)
+  {
+    for (pl = 0; pl < num_planes; pl++)
+    {
+      imgpel *cur_line = &cur_img[pl][y_pos + j    ][x_pos];
+      imgpel *nxt_line = &cur_img[pl][y_pos + j + 1][x_pos];
+      imgpel *blk_line = block[pl][j];
+
+      for (i = 0; i < hor_block_size; i += 8)
+      {
+        int n = imin(hor_block_size - i, 8);
+        __m128i cur = load_pels(cur_line + i, n);
+        __m128i lo, hi;
+
+        if (dx == 0)
+        {
+          madd_pels(cur, load_pels(nxt_line + i, n), w_cur, &lo, &hi);
+        }
+        else
+        {
+          madd_pels(cur, load_pels(cur_line + i + 1, n), w_cur, &lo, &hi);
+          if (dy != 0)
+          {
+            __m128i lo1, hi1;
+            madd_pels(load_pels(nxt_line + i, n), load_pels(nxt_line + i + 1, n), w_nxt, &lo1, &hi1);
+            lo = _mm_add_epi32(lo, lo1);
+            hi = _mm_add_epi32(hi, hi1);
+          }
+        }
+        store_pels(blk_line + i, round_pack(lo, hi, rnd, shift), n);
+      }
+    }
+  }
+}
+
+#else
+
 /*!
  ************************************************************************
  * \brief
@@ -2159,6 +2445,31 @@ static void get_chroma_XX(imgpel **block, imgpel **cur_img, int ver_block_size,
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Chroma (0,X), (X,0) and (X,X) of the same block in num_planes planes,
+ *    block and cur_img hold one entry per plane
+ ************************************************************************
+ */ 
+static void get_chroma_subpel(imgpel ***block, imgpel ***cur_img, int num_planes, int ver_block_size, int hor_block_size, int x_pos, int y_pos,
+                              int dx, int dy, int w00, int w01, int w10, int w11, int total_scale)
+{
+  int pl;
+
+  for (pl = 0; pl < num_planes; pl++)
+  {
+    if (dx == 0)
+      get_chroma_0X(block[pl], cur_img[pl], ver_block_size, hor_block_size, x_pos, y_pos, w00, w01, total_scale);
+    else if (dy == 0)
+      get_chroma_X0(block[pl], cur_img[pl], ver_block_size, hor_block_size, x_pos, y_pos, w00, w10, total_scale);
+    else
+      get_chroma_XX(block[pl], cur_img[pl], ver_block_size, hor_block_size, x_pos, y_pos, w00, w01, w10, w11, total_scale);
+  }
+}
+
+#endif
+
 void get_block_chroma(Macroblock *currMB, int uv, StorablePicture *curr_ref, int x_pos, int y_pos, int hor_block_size, int ver_block_size, imgpel **block)
 {
   VideoParameters *p_Vid = currMB->p_Vid;
@@ -2188,34 +2499,13 @@ void get_block_chroma(Macroblock *currMB, int uv, StorablePicture *curr_ref, int
         /* fullpel position */
         get_chroma_00(block, &cur_img[y_pos], ver_block_size, hor_block_size, x_pos);
       }
-      else if (dx == 0)
-      {
-        int dxcur = (p_Vid->subpel_x + 1 - dx);
-        int dycur = (p_Vid->subpel_y + 1 - dy);
-
-        int w00 = dxcur * dycur;
-        int w01 = dxcur * dy;
-        get_chroma_0X(block, cur_img, ver_block_size, hor_block_size, x_pos, y_pos, w00, w01, p_Vid->total_scale);
-      }
-      else if (dy == 0)
-      {
-        int dxcur = (p_Vid->subpel_x + 1 - dx);
-        int dycur = (p_Vid->subpel_y + 1 - dy);
-
-        int w00 = dxcur * dycur;
-        int w10 = dx * dycur;
-        get_chroma_X0(block, cur_img, ver_block_size, hor_block_size, x_pos, y_pos, w00, w10, p_Vid->total_scale);
-      }
       else
-      { /* other positions */
+      {
         int dxcur = (p_Vid->subpel_x + 1 - dx);
         int dycur = (p_Vid->subpel_y + 1 - dy);
 
-        int w00 = dxcur * dycur;
-        int w01 = dxcur * dy;
-        int w10 = dx * dycur;
-        int w11 = dx * dy;
-        get_chroma_XX(block, cur_img, ver_block_size, hor_block_size, x_pos, y_pos, w00, w01, w10, w11, p_Vid->total_scale);
+        get_chroma_subpel(&block, &cur_img, 1, ver_block_size, hor_block_size, x_pos, y_pos, dx, dy,
+          dxcur * dycur, dxcur * dy, dx * dycur, dx * dy, p_Vid->total_scale);
       }
     }
     else // unsafe positions
@@ -2329,6 +2619,50 @@ void get_block_chroma(Macroblock *currMB, int uv, StorablePicture *curr_ref, int
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Chroma prediction blocks of both chroma planes. The sub-pel weights
+ *    are set up once and, away from the picture border, both planes are
+ *    interpolated in one pass over the rows.
+ ************************************************************************
+ */
+static void get_block_chroma_uv(Macroblock *currMB, StorablePicture *curr_ref, int x_pos, int y_pos, int hor_block_size, int ver_block_size, imgpel **block[2])
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  StorablePicture *dec_picture = p_Vid->dec_picture;
+  int maxold_x = dec_picture->size_x_cr_m1;
+  int maxold_y = (dec_picture->motion.mb_field[p_Vid->current_mb_nr]) ? (dec_picture->size_y_cr >> 1) - 1 : dec_picture->size_y_cr_m1;
+
+  int dx = (x_pos & p_Vid->subpel_x);
+  int dy = (y_pos & p_Vid->subpel_y);
+  int x_cr = x_pos >> p_Vid->shiftpel_x;
+  int y_cr = y_pos >> p_Vid->shiftpel_y;
+
+  if ((curr_ref == p_Vid->no_reference_picture && p_Vid->framepoc < p_Vid->recovery_poc) ||
+    (y_cr < 0) || (y_cr >= maxold_y - ver_block_size) || (x_cr < 0) || (x_cr >= maxold_x - hor_block_size))
+  {
+    // missing reference or unsafe position
+    get_block_chroma(currMB, 0, curr_ref, x_pos, y_pos, hor_block_size, ver_block_size, block[0]);
+    get_block_chroma(currMB, 1, curr_ref, x_pos, y_pos, hor_block_size, ver_block_size, block[1]);
+  }
+  else if (dx == 0 && dy == 0)
+  {
+    get_chroma_00(block[0], &curr_ref->imgUV[0][y_cr], ver_block_size, hor_block_size, x_cr);
+    get_chroma_00(block[1], &curr_ref->imgUV[1][y_cr], ver_block_size, hor_block_size, x_cr);
+  }
+  else
+  {
+    int dxcur = (p_Vid->subpel_x + 1 - dx);
+    int dycur = (p_Vid->subpel_y + 1 - dy);
+    imgpel **cur_img[2];
+
+    cur_img[0] = curr_ref->imgUV[0];
+    cur_img[1] = curr_ref->imgUV[1];
+    get_chroma_subpel(block, cur_img, 2, ver_block_size, hor_block_size, x_cr, y_cr, dx, dy,
+      dxcur * dycur, dxcur * dy, dx * dycur, dx * dy, p_Vid->total_scale);
+  }
+}
 
 void intra_cr_decoding(Macroblock *currMB, int yuv)
 {
@@ -2345,8 +2679,13 @@ void intra_cr_decoding(Macroblock *currMB, int yuv)
     currMB->itrans_4x4 = (currMB->is_lossless == FALSE) ? itrans4x4 : itrans4x4_ls;
 
     curUV = dec_picture->imgUV[uv];
-    intrapred_chroma(currMB, uv);
-	
+    {
+      DEC_PROF_START(PROF_INTRA);
+      intrapred_chroma(currMB, uv);
+      DEC_PROF_STOP(PROF_INTRA);
+    }
+
+    DEC_PROF_START(PROF_ITRANS);
     if ((!(currMB->mb_type == SI4MB) && (currMB->cbp >> 4)) )
     {
       for (b8 = 0; b8 < (p_Vid->num_uv_blocks); b8++)
@@ -2389,6 +2728,7 @@ void intra_cr_decoding(Macroblock *currMB, int yuv)
         }
       }
     }
+    DEC_PROF_STOP(PROF_ITRANS);
   }
 }
 
@@ -2524,6 +2864,8 @@ void perform_mc(Macroblock *currMB, ColorPlane pl, StorablePicture *dec_picture,
   int ioff = (i << 2);
   int joff = (j << 2);         
   
+  DEC_PROF_START(PROF_MC);
+
   assert (pred_dir<=2);
 
   if (pred_dir != 2)
@@ -2573,20 +2915,20 @@ void perform_mc(Macroblock *currMB, ColorPlane pl, StorablePicture *dec_picture,
 
       int vec1_y_cr = vec1_y + ((active_sps->chroma_format_idc == 1)? list->chroma_vector_adjustment : 0);
 
+      get_block_chroma_uv (currMB, list, vec1_x, vec1_y_cr, block_size_x_cr, block_size_y_cr, currSlice->tmp_block_cr[LIST_0]);
+
       for(uv=0;uv<2;uv++)
       {
-        get_block_chroma (currMB, uv, list, vec1_x, vec1_y_cr, block_size_x_cr, block_size_y_cr, currSlice->tmp_block_l0);
-
         if (currSlice->apply_weights)
         {
           int alpha_l0  = currSlice->wp_weight[pred_dir][ref_idx_wp][uv + 1];
           int wp_offset = currSlice->wp_offset[pred_dir][ref_idx_wp][uv + 1];
 
-          weighted_mc_prediction(&currSlice->mb_pred[uv + 1][joff_cr], block_size_y_cr, block_size_x_cr, ioff_cr, currSlice->tmp_block_l0, alpha_l0, wp_offset, currSlice->chroma_log2_weight_denom, p_Vid->max_pel_value_comp[uv + 1]);
+          weighted_mc_prediction(&currSlice->mb_pred[uv + 1][joff_cr], block_size_y_cr, block_size_x_cr, ioff_cr, currSlice->tmp_block_cr[LIST_0][uv], alpha_l0, wp_offset, currSlice->chroma_log2_weight_denom, p_Vid->max_pel_value_comp[uv + 1]);
         }
         else
         {
-          mc_prediction(&currSlice->mb_pred[uv + 1][joff_cr], block_size_y_cr, block_size_x_cr, ioff_cr, currSlice->tmp_block_l0);
+          mc_prediction(&currSlice->mb_pred[uv + 1][joff_cr], block_size_y_cr, block_size_x_cr, ioff_cr, currSlice->tmp_block_cr[LIST_0][uv]);
         }
       }
     }
@@ -2652,10 +2994,11 @@ void perform_mc(Macroblock *currMB, ColorPlane pl, StorablePicture *dec_picture,
       int vec1_y_cr = vec1_y + ((active_sps->chroma_format_idc == 1)? p_Vid->listX[LIST_0 + list_offset][l0_refframe]->chroma_vector_adjustment : 0);
       int vec2_y_cr = vec2_y + ((active_sps->chroma_format_idc == 1)? p_Vid->listX[LIST_1 + list_offset][l1_refframe]->chroma_vector_adjustment : 0);
 
+      get_block_chroma_uv (currMB, p_Vid->listX[LIST_0 + list_offset][l0_refframe], vec1_x, vec1_y_cr, block_size_x_cr, block_size_y_cr, currSlice->tmp_block_cr[LIST_0]);
+      get_block_chroma_uv (currMB, p_Vid->listX[LIST_1 + list_offset][l1_refframe], vec2_x, vec2_y_cr, block_size_x_cr, block_size_y_cr, currSlice->tmp_block_cr[LIST_1]);
+
       for(uv=0;uv<2;uv++)
       {
-        get_block_chroma (currMB, uv, p_Vid->listX[LIST_0 + list_offset][l0_refframe], vec1_x, vec1_y_cr, block_size_x_cr, block_size_y_cr, currSlice->tmp_block_l0);
-        get_block_chroma (currMB, uv, p_Vid->listX[LIST_1 + list_offset][l1_refframe], vec2_x, vec2_y_cr, block_size_x_cr, block_size_y_cr, currSlice->tmp_block_l1);
 
         if(currSlice->apply_weights)
         {
@@ -2665,14 +3008,16 @@ void perform_mc(Macroblock *currMB, ColorPlane pl, StorablePicture *dec_picture,
           int alpha_l1  =   currSlice->wbp_weight[LIST_1 + wt_list_offset][l0_ref_idx][l1_ref_idx][uv + 1];
           int wp_offset = ((currSlice->wp_offset [LIST_0 + wt_list_offset][l0_ref_idx][uv + 1] + currSlice->wp_offset[LIST_1 + wt_list_offset][l1_ref_idx][uv + 1] + 1) >>1);
 
-          weighted_bi_prediction(&currSlice->mb_pred[uv+1][joff_cr], currSlice->tmp_block_l0, currSlice->tmp_block_l1, block_size_y_cr, block_size_x_cr, ioff_cr, alpha_l0, alpha_l1, wp_offset, (currSlice->chroma_log2_weight_denom + 1), p_Vid->max_pel_value_comp[uv + 1]);
+          weighted_bi_prediction(&currSlice->mb_pred[uv+1][joff_cr], currSlice->tmp_block_cr[LIST_0][uv], currSlice->tmp_block_cr[LIST_1][uv], block_size_y_cr, block_size_x_cr, ioff_cr, alpha_l0, alpha_l1, wp_offset, (currSlice->chroma_log2_weight_denom + 1), p_Vid->max_pel_value_comp[uv + 1]);
         }
         else
         {
-          bi_prediction(&currSlice->mb_pred[uv + 1][joff_cr], currSlice->tmp_block_l0, currSlice->tmp_block_l1, block_size_y_cr, block_size_x_cr, ioff_cr);
+          bi_prediction(&currSlice->mb_pred[uv + 1][joff_cr], currSlice->tmp_block_cr[LIST_0][uv], currSlice->tmp_block_cr[LIST_1][uv], block_size_y_cr, block_size_x_cr, ioff_cr);
         }
       }
     }      
   }
+
+  DEC_PROF_STOP(PROF_MC);
 }
 
@@ -101,7 +101,6 @@ int read_next_nalu(VideoParameters *p_Vid, NALU_t *nalu)
   }
   if (ret == 0)
   {
-    FreeNALU(nalu);
     return 0;
   }
 
@@ -20,7 +20,9 @@
 #include "memalloc.h"
 #include "sei.h"
 #include "input.h"
+#include "img_io.h"
 #include "erc_api.h" // YD: added to conceal lost non reference frames
+#include "dec_profile.h"
 
 /***** XML_TRACE_BEGIN *****/
 #include "xmltracefile.h"
@@ -116,16 +118,24 @@ static void img2buf_normal (imgpel** imgX, unsigned char* buf, int size_x, int s
   }
   else
   {
+    // rows are copied one by one, planes have an aligned stride
     if (sizeof(imgpel) == sizeof(char))
     {
-      memcpy(buf, &(imgX[0][0]), size_y * size_x * sizeof(imgpel));
+      for(i = 0; i < size_y; i++)
+      {
+        memcpy(buf, &(imgX[i][0]), size_x * sizeof(imgpel));
+        buf += size_x;
+      }
     }
     else
     {
-      imgpel *cur_pixel = &(imgX[0][0]);
-      for(i = 0; i < size_y * size_x; i++)
+      for(i = 0; i < size_y; i++)
       {
-        *(buf++)=(char) *(cur_pixel++);
+        imgpel *cur_pixel = &(imgX[i][0]);
+        for(j = 0; j < size_x; j++)
+        {
+          *(buf++)=(char) *(cur_pixel++);
+        }
       }
     }
   }
@@ -298,6 +308,9 @@ void write_picture(VideoParameters *p_Vid, StorablePicture *p, int p_out, int re
 {
    int i, add;
 
+  if (p->recon_skipped)
+    return;
+
   if (real_structure==FRAME)
   {
     flush_pending_output(p_Vid, p_out);
@@ -446,10 +459,12 @@ static void write_out_picture(VideoParameters *p_Vid, StorablePicture *p, int p_
   int symbol_size_in_bytes = (p_Vid->pic_unit_bitsize_on_disk >> 3);
   Boolean rgb_output = (Boolean) (p_Vid->active_sps->vui_seq_parameters.matrix_coefficients==0);
   unsigned char *buf;
+  FrameFormat y4m_format;
+  vui_seq_parameters_t *vui = &p_Vid->active_sps->vui_seq_parameters;
 
   int ret;
 
-  if (p->non_existing)
+  if (p->non_existing || p->recon_skipped)
     return;
 
   // YD: begin error concealment for non-reference frames
@@ -493,6 +508,16 @@ static void write_out_picture(VideoParameters *p_Vid, StorablePicture *p, int p_
   //printf ("write frame size: %dx%d\n", p->size_x-crop_left-crop_right,p->size_y-crop_top-crop_bottom );
   initOutput(p_Vid, symbol_size_in_bytes);
 
+  memset(&y4m_format, 0, sizeof(FrameFormat));
+  y4m_format.width                = p->size_x - crop_left - crop_right;
+  y4m_format.height               = p->size_y - crop_top - crop_bottom;
+  y4m_format.yuv_format           = (p->chroma_format_idc == YUV400 && p_Inp->write_uv) ? YUV420 : (ColorFormat) p->chroma_format_idc;
+  y4m_format.bit_depth[0]         = p_Vid->bitdepth_luma;
+  y4m_format.pic_unit_size_shift3 = symbol_size_in_bytes;
+  if (p_Vid->active_sps->vui_parameters_present_flag && vui->timing_info_present_flag && vui->num_units_in_tick)
+    y4m_format.frame_rate = vui->time_scale / (2.0 * vui->num_units_in_tick);
+  WriteY4MFrameHeader(p_out, &y4m_format);
+
   // KS: this buffer should actually be allocated only once, but this is still much faster than the previous version
   buf = malloc (p->size_x*p->size_y*symbol_size_in_bytes);
   if (NULL==buf)
@@ -591,7 +616,7 @@ static void write_out_picture(VideoParameters *p_Vid, StorablePicture *p, int p_
   free(buf);
 
   /***** XML_TRACE_BEGIN *****/
-  if(xml_gen_trace_file())
+  if(xml_trace_enabled(0))
   {
     if(p->concealed_pic == 1)
     {
@@ -763,6 +788,8 @@ void flush_direct_output(VideoParameters *p_Vid, int p_out)
  */
 void write_stored_frame( VideoParameters *p_Vid, FrameStore *fs,int p_out)
 {
+  DEC_PROF_START(PROF_OUTPUT);
+
   // make sure no direct output field is pending
   flush_direct_output(p_Vid, p_out);
 
@@ -779,6 +806,8 @@ void write_stored_frame( VideoParameters *p_Vid, FrameStore *fs,int p_out)
   }
 
   fs->is_output = 1;
+
+  DEC_PROF_STOP(PROF_OUTPUT);
 }
 
 /*!
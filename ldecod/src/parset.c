@@ -469,7 +469,7 @@ void MakeSPSavailable (VideoParameters *p_Vid, int id, seq_parameter_set_rbsp_t
   memcpy (&p_Vid->SeqParSet[id], sps, sizeof (seq_parameter_set_rbsp_t));
 
     /***** XML_TRACE_BEGIN *****/
-    if(xml_gen_trace_file())
+    if(xml_trace_enabled(0))
     {
         copySPS(sps);
     }
@@ -0,0 +1,89 @@
+#ifndef _BIN_TRACE_H_
+#define _BIN_TRACE_H_
+
+/*
+ * Binary AVCTrace format
+ *
+ * Selected by passing a trace file name ending in BIN_TRACE_EXT to -xmltrace.
+ * The file holds the same element tree as the XML trace, one record per
+ * xml_write_* call:
+ *
+ *   header   : "JMBT", uint8 version
+ *   record   : uint8 type, varint payload length, payload
+ *   trailer  : names table, index, fixed size tail (after a BT_EOF record)
+ *
+ * varint is an unsigned LEB128 number, svarint a zigzag coded varint.
+ * Element and attribute names are sent once as a BT_NAME record and referred
+ * to by id afterwards. Strings are not NUL-terminated, their length follows
+ * from the payload length.
+ *
+ *   BT_NAME        varint id, name
+ *   BT_START       varint id
+ *   BT_END         -
+ *   BT_ATTR_STR    varint id, value
+ *   BT_ATTR_INT    varint id, svarint value
+ *   BT_TEXT        text
+ *   BT_INT         svarint value
+ *   BT_INT_ELEM    varint id, svarint value
+ *   BT_INT_LIST    varint id, svarint values...
+ *   BT_COMMENT     text
+ *   BT_FRAME_ORDER svarint id (the entry of the XML display order file)
+ *
+ * The trailer allows random access without reading the whole trace
+ * (all fields in host byte order):
+ *
+ *   names    : uint32 num_names, num_names x { varint length, name }
+ *   index    : num_index x { int64 offset, uint32 frame id }, one entry per
+ *              picture in decoding order (both fields of a frame share one
+ *              entry). An entry starts at the first child of the root element
+ *              that follows the last Slice of the previous picture, so the
+ *              parameter sets and SEI in front of a picture belong to it, and
+ *              it ends where the next entry starts. The frame id is the one
+ *              written by BT_FRAME_ORDER.
+ *   tail     : int64 names_offset, int64 index_offset, uint32 num_index, "JMBI"
+ */
+
+#define BIN_TRACE_VERSION	2
+#define BIN_TRACE_EXT		".jmbt"
+#define BIN_TRACE_TAIL_SIZE	24
+
+typedef enum
+{
+	BT_EOF = 0,
+	BT_NAME,
+	BT_START,
+	BT_END,
+	BT_ATTR_STR,
+	BT_ATTR_INT,
+	BT_TEXT,
+	BT_INT,
+	BT_INT_ELEM,
+	BT_INT_LIST,
+	BT_COMMENT,
+	BT_FRAME_ORDER
+} BinTraceRecordType;
+
+typedef struct bin_trace_record
+{
+	int type;
+	long long offset;	//File offset of the record
+	char* name;			//Element or attribute name
+	char* text;			//NUL-terminated string value
+	int value;
+	int* values;		//BT_INT_LIST
+	int count;
+} BinTraceRecord;
+
+typedef struct bin_trace_reader BinTraceReader;
+
+BinTraceReader* bintrace_open(const char* filename);
+void bintrace_close(BinTraceReader* reader);
+
+int bintrace_next(BinTraceReader* reader, BinTraceRecord* record);
+
+int bintrace_num_index(BinTraceReader* reader);
+int bintrace_index_frame(BinTraceReader* reader, int entry);
+long long bintrace_index_offset(BinTraceReader* reader, int entry);
+int bintrace_seek_index(BinTraceReader* reader, int entry);
+
+#endif
@@ -5,6 +5,31 @@
 
 #include <stdio.h>
 
+//Set XML_TRACE to 0 to compile all tracing out of the decoder
+#ifndef XML_TRACE
+#define XML_TRACE 1
+#endif
+
+//Write the trace buffers from a separate thread
+#ifndef XML_TRACE_ASYNC
+#if defined(_WIN32)
+#define XML_TRACE_ASYNC 0
+#else
+#define XML_TRACE_ASYNC 1
+#endif
+#endif
+
+#define XML_TRACE_BUFFER_SIZE	(4 << 20)
+
+extern int xml_active_level;
+
+//True if a trace file is open and its log level is at least level
+#if XML_TRACE
+#define xml_trace_enabled(level)	(xml_active_level >= (level))
+#else
+#define xml_trace_enabled(level)	0
+#endif
+
 void xml_set_trace_filename(char* filename);
 char* xml_get_trace_filename();
 
@@ -24,10 +49,18 @@ void xml_write_text(char* value);
 void xml_write_int(int value);
 void xml_write_comment(char* comment);
 
+//Same output as start element, int and end element
+void xml_write_int_element(char* name, int value);
+//<name>v0,v1,...</name>, count must be between 1 and 64
+void xml_write_int_list_element(char* name, int* values, int count);
+
 int xml_check_and_write_end_element(char* name);
 
 int xml_gen_trace_file();
 
+//Marks the start of a new picture (indexed in the binary trace)
+void xml_start_picture(int id);
+
 int xml_output_frame_order(int);
 
 #endif
@@ -0,0 +1,347 @@
+#include "bintrace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct bin_trace_reader
+{
+	unsigned char* data;
+	size_t size;
+	int mapped;
+
+	size_t pos;
+	size_t end;			//End of the record stream
+
+	char** names;
+	int num_names;
+	int names_size;
+
+	long long* index_offset;
+	unsigned int* index_frame;
+	int num_index;
+
+	char* text;
+	size_t text_size;
+	int* values;
+	int values_size;
+};
+
+static int read_varint(BinTraceReader* r, size_t end, unsigned int* value)
+{
+	unsigned int v = 0;
+	int shift = 0;
+
+	while(r->pos < end && shift < 35)
+	{
+		unsigned char b = r->data[r->pos++];
+		v |= (unsigned int)(b & 0x7f) << shift;
+		if(!(b & 0x80))
+		{
+			*value = v;
+			return 0;
+		}
+		shift += 7;
+	}
+	return -1;
+}
+
+static int read_svarint(BinTraceReader* r, size_t end, int* value)
+{
+	unsigned int v;
+
+	if(read_varint(r, end, &v) != 0) return -1;
+	*value = (int)(v >> 1) ^ -(int)(v & 1);
+	return 0;
+}
+
+static int set_name(BinTraceReader* r, unsigned int id, const unsigned char* name, size_t len)
+{
+	if(id >= 0x100000) return -1;
+
+	if((int)id >= r->names_size)
+	{
+		int size = r->names_size ? r->names_size : 256;
+		char** names;
+
+		while(size <= (int)id) size *= 2;
+		names = (char**) realloc(r->names, size * sizeof(char*));
+		if(names == NULL) return -1;
+		memset(names + r->names_size, 0, (size - r->names_size) * sizeof(char*));
+		r->names = names;
+		r->names_size = size;
+	}
+	if(r->names[id] == NULL)
+	{
+		if((r->names[id] = (char*) malloc(len + 1)) == NULL) return -1;
+		memcpy(r->names[id], name, len);
+		r->names[id][len] = '\0';
+	}
+	if((int)id >= r->num_names) r->num_names = id + 1;
+	return 0;
+}
+
+static char* get_name(BinTraceReader* r, unsigned int id)
+{
+	if((int)id >= r->num_names) return NULL;
+	return r->names[id];
+}
+
+//Loads the names table and the index if the trace has a valid trailer
+static void read_trailer(BinTraceReader* r)
+{
+	long long names_offset, index_offset;
+	unsigned int num_index, num_names, i, len;
+	const unsigned char* tail;
+
+	if(r->size < 5 + BIN_TRACE_TAIL_SIZE) return;
+	tail = r->data + r->size - BIN_TRACE_TAIL_SIZE;
+	if(memcmp(tail + 20, "JMBI", 4) != 0) return;
+
+	memcpy(&names_offset, tail, sizeof(long long));
+	memcpy(&index_offset, tail + 8, sizeof(long long));
+	memcpy(&num_index, tail + 16, sizeof(unsigned int));
+	if(names_offset < 5 || names_offset + 4 > index_offset ||
+		(size_t)index_offset + (size_t)num_index * 12 != r->size - BIN_TRACE_TAIL_SIZE)
+		return;
+
+	r->pos = (size_t)names_offset;
+	memcpy(&num_names, r->data + r->pos, sizeof(unsigned int));
+	r->pos += 4;
+	for(i = 0; i < num_names; i++)
+	{
+		if(read_varint(r, (size_t)index_offset, &len) != 0 || r->pos + len > (size_t)index_offset) return;
+		if(set_name(r, i, r->data + r->pos, len) != 0) return;
+		r->pos += len;
+	}
+
+	r->index_offset = (long long*) malloc(num_index * sizeof(long long) + 1);
+	r->index_frame = (unsigned int*) malloc(num_index * sizeof(unsigned int) + 1);
+	if(r->index_offset == NULL || r->index_frame == NULL) return;
+	for(i = 0; i < num_index; i++)
+	{
+		memcpy(&r->index_offset[i], r->data + index_offset + 12 * i, sizeof(long long));
+		memcpy(&r->index_frame[i], r->data + index_offset + 12 * i + 8, sizeof(unsigned int));
+	}
+	r->num_index = num_index;
+	r->end = (size_t)names_offset;
+}
+
+static int load_file(BinTraceReader* r, const char* filename)
+{
+	FILE* f;
+	long size;
+
+#if !defined(_WIN32)
+	struct stat st;
+	int fd = open(filename, O_RDONLY);
+
+	if(fd < 0) return -1;
+	if(fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(p != MAP_FAILED)
+		{
+			close(fd);
+			r->data = (unsigned char*) p;
+			r->size = (size_t)st.st_size;
+			r->mapped = 1;
+			return 0;
+		}
+	}
+	close(fd);
+#endif
+
+	if((f = fopen(filename, "rb")) == NULL) return -1;
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if(size <= 0 || (r->data = (unsigned char*) malloc(size)) == NULL ||
+		fread(r->data, 1, size, f) != (size_t)size)
+	{
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+	r->size = (size_t)size;
+	return 0;
+}
+
+/*
+ * Opens a binary trace. Traces without a trailer (e.g. from an aborted
+ * decoder run) can still be read sequentially.
+ * Returns NULL if the file cannot be read or is not a binary trace.
+ */
+BinTraceReader* bintrace_open(const char* filename)
+{
+	BinTraceReader* r = (BinTraceReader*) calloc(1, sizeof(BinTraceReader));
+
+	if(r == NULL) return NULL;
+
+	if(load_file(r, filename) != 0 || r->size < 5 ||
+		memcmp(r->data, "JMBT", 4) != 0 || r->data[4] != BIN_TRACE_VERSION)
+	{
+		bintrace_close(r);
+		return NULL;
+	}
+
+	r->end = r->size;
+	read_trailer(r);
+	r->pos = 5;
+	return r;
+}
+
+void bintrace_close(BinTraceReader* r)
+{
+	int i;
+
+	if(r == NULL) return;
+
+#if !defined(_WIN32)
+	if(r->mapped)
+		munmap(r->data, r->size);
+	else
+#endif
+		free(r->data);
+
+	for(i = 0; i < r->num_names; i++) free(r->names[i]);
+	free(r->names);
+	free(r->index_offset);
+	free(r->index_frame);
+	free(r->text);
+	free(r->values);
+	free(r);
+}
+
+static int copy_text(BinTraceReader* r, size_t end, BinTraceRecord* record)
+{
+	size_t len = end - r->pos;
+
+	if(len + 1 > r->text_size)
+	{
+		char* text = (char*) realloc(r->text, len + 256);
+		if(text == NULL) return -1;
+		r->text = text;
+		r->text_size = len + 256;
+	}
+	memcpy(r->text, r->data + r->pos, len);
+	r->text[len] = '\0';
+	r->pos = end;
+	record->text = r->text;
+	return 0;
+}
+
+/*
+ * Reads the next record. The strings and values of the record stay valid
+ * until the next call, names until the reader is closed.
+ * Returns 1 for a record, 0 at the end of the trace and -1 if the trace is corrupt.
+ */
+int bintrace_next(BinTraceReader* r, BinTraceRecord* record)
+{
+	unsigned int len, id;
+	size_t end;
+
+	memset(record, 0, sizeof(BinTraceRecord));
+
+	if(r->pos >= r->end) return 0;
+
+	record->offset = (long long)r->pos;
+	record->type = r->data[r->pos++];
+	if(record->type == BT_EOF) return 0;
+
+	if(read_varint(r, r->end, &len) != 0 || r->pos + len > r->end) return -1;
+	end = r->pos + len;
+
+	switch(record->type)
+	{
+		case BT_NAME:
+			if(read_varint(r, end, &id) != 0 || set_name(r, id, r->data + r->pos, end - r->pos) != 0) return -1;
+			record->name = get_name(r, id);
+			r->pos = end;
+			break;
+		case BT_START:
+		case BT_ATTR_STR:
+		case BT_ATTR_INT:
+		case BT_INT_ELEM:
+		case BT_INT_LIST:
+			if(read_varint(r, end, &id) != 0 || (record->name = get_name(r, id)) == NULL) return -1;
+			if(record->type == BT_ATTR_STR)
+			{
+				if(copy_text(r, end, record) != 0) return -1;
+			}
+			else if(record->type == BT_ATTR_INT || record->type == BT_INT_ELEM)
+			{
+				if(read_svarint(r, end, &record->value) != 0) return -1;
+			}
+			else if(record->type == BT_INT_LIST)
+			{
+				while(r->pos < end)
+				{
+					if(record->count == r->values_size)
+					{
+						int* values = (int*) realloc(r->values, (r->values_size + 64) * sizeof(int));
+						if(values == NULL) return -1;
+						r->values = values;
+						r->values_size += 64;
+					}
+					if(read_svarint(r, end, &r->values[record->count]) != 0) return -1;
+					record->count++;
+				}
+				record->values = r->values;
+			}
+			break;
+		case BT_END:
+			break;
+		case BT_TEXT:
+		case BT_COMMENT:
+			if(copy_text(r, end, record) != 0) return -1;
+			break;
+		case BT_INT:
+		case BT_FRAME_ORDER:
+			if(read_svarint(r, end, &record->value) != 0) return -1;
+			break;
+		default:
+			return -1;
+	}
+
+	if(r->pos != end) return -1;
+	return 1;
+}
+
+//Number of pictures listed in the index
+int bintrace_num_index(BinTraceReader* r)
+{
+	return r->num_index;
+}
+
+//Frame id of an indexed picture, -1 for an invalid entry
+int bintrace_index_frame(BinTraceReader* r, int entry)
+{
+	if(entry < 0 || entry >= r->num_index) return -1;
+	return (int)r->index_frame[entry];
+}
+
+//File offset where an indexed picture starts, -1 for an invalid entry
+long long bintrace_index_offset(BinTraceReader* r, int entry)
+{
+	if(entry < 0 || entry >= r->num_index) return -1;
+	return r->index_offset[entry];
+}
+
+/*
+ * Positions the reader at the first record of an indexed picture.
+ * Returns 0 on success, -1 for an invalid entry.
+ */
+int bintrace_seek_index(BinTraceReader* r, int entry)
+{
+	if(entry < 0 || entry >= r->num_index || (size_t)r->index_offset[entry] >= r->end) return -1;
+	r->pos = (size_t)r->index_offset[entry];
+	return 0;
+}
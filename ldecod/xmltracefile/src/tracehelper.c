@@ -44,7 +44,7 @@ void incrementNAL()
 void setNAL(NALU_t *nal)
 {
 	incrementNAL();
-	curr_NAL = AllocNALU(MAX_CODED_FRAME_SIZE);
+	curr_NAL = AllocNALU(1); // only the type and the length are traced
 	curr_NAL->nal_unit_type = nal->nal_unit_type;
 	curr_NAL->len = nal->len;
 }
@@ -52,7 +52,7 @@ void setNAL(NALU_t *nal)
 void setDPBNAL(NALU_t *nal)
 {
 	incrementNAL();
-	dpb_NAL = AllocNALU(MAX_CODED_FRAME_SIZE);
+	dpb_NAL = AllocNALU(1); // only the type and the length are traced
 	dpb_NAL->nal_unit_type = nal->nal_unit_type;
 	dpb_NAL->len = nal->len;
 }
@@ -60,7 +60,7 @@ void setDPBNAL(NALU_t *nal)
 void setDPCNAL(NALU_t *nal)
 {
 	incrementNAL();
-	dpc_NAL = AllocNALU(MAX_CODED_FRAME_SIZE);
+	dpc_NAL = AllocNALU(1); // only the type and the length are traced
 	dpc_NAL->nal_unit_type = nal->nal_unit_type;
 	dpc_NAL->len = nal->len;
 }
@@ -241,9 +241,7 @@ void addMVInfoToTrace(Macroblock *currMB)
 				kk = 2 * (j0 >> 1) + (i0 >> 1);
 				xml_write_start_element("SubMacroBlock");
 					xml_write_int_attribute("num", kk);
-					xml_write_start_element("Type");
-						xml_write_int(currMB->b8submbtype[kk]);
-					xml_write_end_element();
+					xml_write_int_element("Type", currMB->b8submbtype[kk]);
 					xml_write_start_element("TypeString");
 						if(currMB->p_Slice->slice_type == B_SLICE)
 							getSubMbTypeName_B_Slice(currMB->b8submbtype[kk], typestring);
@@ -252,7 +250,7 @@ void addMVInfoToTrace(Macroblock *currMB)
 						xml_write_text(typestring);
 					xml_write_end_element();
 
-					if(xml_get_log_level() >= 3)
+					if(xml_trace_enabled(3))
 					{
 						//Loop through every block inside the submacroblock to get the motion vectors
 						step_h = BLOCK_STEP [currMB->b8mode[kk]][0];
@@ -271,24 +269,14 @@ void addMVInfoToTrace(Macroblock *currMB)
 											printf("j0=%d, i0=%d, j=%d, i=%d \n", j0, i0, j, i);
 											xml_write_start_element("MotionVector");
 												xml_write_int_attribute("list", list);
-												xml_write_start_element("RefIdx");
-													xml_write_int(currMB->p_Vid->dec_picture->motion.ref_id[list][currMB->block_y+j0][currMB->block_x+i0]);
-												xml_write_end_element();
+												xml_write_int_element("RefIdx", currMB->p_Vid->dec_picture->motion.ref_id[list][currMB->block_y+j0][currMB->block_x+i0]);
 												xml_write_start_element("Difference");
-													xml_write_start_element("X");
-														xml_write_int(currMB->mvd[list][j][i][0]);
-													xml_write_end_element();
-													xml_write_start_element("Y");
-														xml_write_int(currMB->mvd[list][j][i][1]);
-													xml_write_end_element();
+													xml_write_int_element("X", currMB->mvd[list][j][i][0]);
+													xml_write_int_element("Y", currMB->mvd[list][j][i][1]);
 												xml_write_end_element();
 												xml_write_start_element("Absolute");
-													xml_write_start_element("X");
-														xml_write_int(currMB->p_Vid->dec_picture->motion.mv[list][currMB->block_y + j][currMB->block_x + i][0]);
-													xml_write_end_element();
-													xml_write_start_element("Y");
-														xml_write_int(currMB->p_Vid->dec_picture->motion.mv[list][currMB->block_y + j][currMB->block_x + i][1]);
-													xml_write_end_element();
+													xml_write_int_element("X", currMB->p_Vid->dec_picture->motion.mv[list][currMB->block_y + j][currMB->block_x + i][0]);
+													xml_write_int_element("Y", currMB->p_Vid->dec_picture->motion.mv[list][currMB->block_y + j][currMB->block_x + i][1]);
 												xml_write_end_element();
 											xml_write_end_element();
 										}
@@ -306,7 +294,7 @@ void addMVInfoToTrace(Macroblock *currMB)
 
 void addCoeffsToTrace(Macroblock* currMB, Slice* currSlice)
 {
-	int pl, i, j;
+	int pl, i;
 	xml_write_start_element("Coeffs");
 		if(currMB->luma_transform_size_8x8_flag)
 		{
@@ -315,13 +303,7 @@ void addCoeffsToTrace(Macroblock* currMB, Slice* currSlice)
 			xml_write_int_attribute("type", 0);
 				for(i = 0; i < 16; i++)
 				{
-					xml_write_start_element("Row");
-					for(j = 0; j < 16; j++)
-					{
-						if(j > 0) xml_write_text(",");
-						xml_write_int((&currSlice->mb_rres[0][0])[i][j]);
-					}
-					xml_write_end_element();
+					xml_write_int_list_element("Row", currSlice->mb_rres[0][i], 16);
 				}
 			xml_write_end_element();
 			//Chroma
@@ -331,13 +313,7 @@ void addCoeffsToTrace(Macroblock* currMB, Slice* currSlice)
 				xml_write_int_attribute("type", pl);
 					for( i = 0; i < 8; i++)
 					{
-						xml_write_start_element("Row");
-						for(j = 0; j < 8; j++)
-						{
-							if(j > 0) xml_write_text(",");
-							xml_write_int(currSlice->cof[pl][i][j]);
-						}
-						xml_write_end_element();
+						xml_write_int_list_element("Row", currSlice->cof[pl][i], 8);
 					}
 				xml_write_end_element();
 			}
@@ -349,13 +325,7 @@ void addCoeffsToTrace(Macroblock* currMB, Slice* currSlice)
 			xml_write_int_attribute("type", 0);
 				for(i = 0; i < 16; i++)
 				{
-					xml_write_start_element("Row");
-					for(j = 0; j < 16; j++)
-					{
-						if(j > 0) xml_write_text(",");
-						xml_write_int(currSlice->cof[0][i][j]);
-					}
-					xml_write_end_element();
+					xml_write_int_list_element("Row", currSlice->cof[0][i], 16);
 				}
 			xml_write_end_element();
 			//Chroma
@@ -365,13 +335,7 @@ void addCoeffsToTrace(Macroblock* currMB, Slice* currSlice)
 				xml_write_int_attribute("type", pl);
 					for( i = 0; i < 8; i++)
 					{
-						xml_write_start_element("Row");
-						for(j = 0; j < 8; j++)
-						{
-							if(j > 0) xml_write_text(",");
-							xml_write_int(currSlice->cof[pl][i][j]);
-						}
-						xml_write_end_element();
+						xml_write_int_list_element("Row", currSlice->cof[pl][i], 8);
 					}
 				xml_write_end_element();
 			}
@@ -468,16 +432,12 @@ void writeNALInfo(Slice* currSlice)
 					xml_write_int(iCurr_NAL_number);
 			}
 		xml_write_end_element();
-		xml_write_start_element("Type");
-			xml_write_int(curr_NAL->nal_unit_type);
-		xml_write_end_element();
+		xml_write_int_element("Type", curr_NAL->nal_unit_type);
 		xml_write_start_element("TypeString");
 			getNALTypeName(curr_NAL->nal_unit_type, typestring);
 			xml_write_text(typestring);
 		xml_write_end_element();
-		xml_write_start_element("Length");
-			xml_write_int(curr_NAL->len);
-		xml_write_end_element();
+		xml_write_int_element("Length", curr_NAL->len);
 	xml_write_end_element();
     
     //Output SPS info
@@ -490,31 +450,17 @@ void writeNALInfo(Slice* currSlice)
             //width = ((pic_width_in_mbs_minus1 +1)*16) - frame_crop_left_offset*2 - frame_crop_right_offset*2;
             //height= ((2 - frame_mbs_only_flag)* (pic_height_in_map_units_minus1 +1) * 16) - (frame_crop_top_offset * 2) - (frame_crop_bottom_offset * 2);
             
-            xml_write_start_element("pic_width_in_mbs_minus1");
-                xml_write_int(sps->pic_width_in_mbs_minus1);
-            xml_write_end_element();
-            xml_write_start_element("pic_height_in_map_units_minus1");
-                xml_write_int(sps->pic_height_in_map_units_minus1);
-            xml_write_end_element();
-            xml_write_start_element("frame_mbs_only_flag");
-                xml_write_int(sps->frame_mbs_only_flag);
-            xml_write_end_element();
+            xml_write_int_element("pic_width_in_mbs_minus1", sps->pic_width_in_mbs_minus1);
+            xml_write_int_element("pic_height_in_map_units_minus1", sps->pic_height_in_map_units_minus1);
+            xml_write_int_element("frame_mbs_only_flag", sps->frame_mbs_only_flag);
             //if(sps->frame_cropping_flag)
             //{
                 xml_write_start_element("frame_cropping");
                 
-                    xml_write_start_element("frame_crop_left_offset");
-                        xml_write_int(sps->frame_cropping_rect_left_offset);
-                    xml_write_end_element();
-                    xml_write_start_element("frame_crop_right_offset");
-                        xml_write_int(sps->frame_cropping_rect_right_offset);
-                    xml_write_end_element();
-                    xml_write_start_element("frame_crop_top_offset");
-                        xml_write_int(sps->frame_cropping_rect_top_offset);
-                    xml_write_end_element();
-                    xml_write_start_element("frame_crop_bottom_offset");
-                        xml_write_int(sps->frame_cropping_rect_bottom_offset);
-                    xml_write_end_element();
+                    xml_write_int_element("frame_crop_left_offset", sps->frame_cropping_rect_left_offset);
+                    xml_write_int_element("frame_crop_right_offset", sps->frame_cropping_rect_right_offset);
+                    xml_write_int_element("frame_crop_top_offset", sps->frame_cropping_rect_top_offset);
+                    xml_write_int_element("frame_crop_bottom_offset", sps->frame_cropping_rect_bottom_offset);
                 
                 xml_write_end_element();
             //}
@@ -525,15 +471,9 @@ void writeNALInfo(Slice* currSlice)
                 xml_write_start_element("vui_parameters");
                 
                     xml_write_start_element("timing_info");
-                        xml_write_start_element("num_units_in_tick");
-                            xml_write_int(sps->vui_seq_parameters.num_units_in_tick);
-                        xml_write_end_element();
-                        xml_write_start_element("time_scale");
-                            xml_write_int(sps->vui_seq_parameters.time_scale);
-                        xml_write_end_element();
-                        xml_write_start_element("fixed_frame_rate_flag");
-                            xml_write_int(sps->vui_seq_parameters.fixed_frame_rate_flag);
-                        xml_write_end_element();
+                        xml_write_int_element("num_units_in_tick", sps->vui_seq_parameters.num_units_in_tick);
+                        xml_write_int_element("time_scale", sps->vui_seq_parameters.time_scale);
+                        xml_write_int_element("fixed_frame_rate_flag", sps->vui_seq_parameters.fixed_frame_rate_flag);
                     xml_write_end_element();
                 
                 xml_write_end_element();
@@ -554,16 +494,12 @@ void writeNALInfo(Slice* currSlice)
 				else
 					xml_write_int(iCurr_NAL_number);
 			xml_write_end_element();
-			xml_write_start_element("Type");
-				xml_write_int(dpb_NAL->nal_unit_type);
-			xml_write_end_element();
+			xml_write_int_element("Type", dpb_NAL->nal_unit_type);
 			xml_write_start_element("TypeString");
 				getNALTypeName(dpb_NAL->nal_unit_type, typestring);
 				xml_write_text(typestring);
 			xml_write_end_element();
-			xml_write_start_element("Length");
-				xml_write_int(dpb_NAL->len);
-			xml_write_end_element();
+			xml_write_int_element("Length", dpb_NAL->len);
 		xml_write_end_element();
 	}
 
@@ -571,19 +507,13 @@ void writeNALInfo(Slice* currSlice)
 	if(currSlice->dpC_NotPresent == 0 && dpc_NAL != NULL)
 	{
 		xml_write_start_element("NAL");
-			xml_write_start_element("Num");
-				xml_write_int(iCurr_NAL_number);
-			xml_write_end_element();
-			xml_write_start_element("Type");
-				xml_write_int(dpc_NAL->nal_unit_type);
-			xml_write_end_element();
+			xml_write_int_element("Num", iCurr_NAL_number);
+			xml_write_int_element("Type", dpc_NAL->nal_unit_type);
 			xml_write_start_element("TypeString");
 				getNALTypeName(dpc_NAL->nal_unit_type, typestring);
 				xml_write_text(typestring);
 			xml_write_end_element();
-			xml_write_start_element("Length");
-				xml_write_int(dpc_NAL->len);
-			xml_write_end_element();
+			xml_write_int_element("Length", dpc_NAL->len);
 		xml_write_end_element();
 	}
 
@@ -1,6 +1,12 @@
 #include "xmltracefile.h"
+#include "bintrace.h"
 
 #include <string.h>
+#include <stdlib.h>
+
+#if XML_TRACE_ASYNC
+#include <pthread.h>
+#endif
 
 #define STACK_SIZE 1024
 
@@ -10,13 +16,351 @@ char file_frameorder[255];
 FILE* fh = NULL;
 FILE* fo = NULL;
 
-char tags[STACK_SIZE];
+//Element stack, the names are not copied (all callers pass string literals)
+static char* tags[STACK_SIZE];
 int stackcount = 0;
 char bPrevIsElement = '0';
 int displaynr = -1;
 int loglevel = 4;
 
-int write_to_file(char* text);
+//Level checked by xml_trace_enabled(), -1 while no trace file is open
+int xml_active_level = -1;
+
+#define INDENT_MAX 64
+
+//Indentation is written as a prefix of this string
+static const char indent[INDENT_MAX + 1] =
+	"\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+	"\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+
+//Write buffers: the trace is collected in userspace and handed to the
+//flush thread (or written directly) in chunks of XML_TRACE_BUFFER_SIZE
+static char* buf[2] = {NULL, NULL};
+static int cur = 0;
+static size_t buf_len = 0;
+static long long written = 0;
+
+//Binary trace state (see bintrace.h)
+static int binary = 0;
+static char** bt_names = NULL;
+static int bt_num_names = 0;
+static int bt_names_size = 0;
+#define BT_HASH_SIZE 4096
+static struct { const char* ptr; int id; } bt_hash[BT_HASH_SIZE];
+static int bt_hash_count = 0;
+static long long* bt_index_offset = NULL;
+static int* bt_index_frame = NULL;
+static int bt_num_index = 0;
+static int bt_index_size = 0;
+//Offset of the first root child written after the last Slice element
+static long long bt_pending = -1;
+
+#if XML_TRACE_ASYNC
+static pthread_t flush_thread;
+static pthread_mutex_t flush_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER;
+static char* flush_buf = NULL;
+static size_t flush_len = 0;
+static int flush_exit = 0;
+static int thread_running = 0;
+#endif
+
+static void flush_buffer();
+
+static void write_to_file_len(const char* text, size_t len)
+{
+	if(fh == NULL) return;
+
+	written += len;
+	if(buf_len + len > XML_TRACE_BUFFER_SIZE)
+	{
+		flush_buffer();
+		if(len > XML_TRACE_BUFFER_SIZE)
+		{
+			//Larger than the buffer itself, flush_buffer() has waited for the thread
+			fwrite(text, 1, len, fh);
+			return;
+		}
+	}
+	memcpy(buf[cur] + buf_len, text, len);
+	buf_len += len;
+}
+
+int write_to_file(char* text)
+{
+	if(fh == NULL) return -1;
+
+	write_to_file_len(text, strlen(text));
+	return 1;
+}
+
+static void write_indent(int depth)
+{
+	if(depth <= 0) return;
+	while(depth > INDENT_MAX)
+	{
+		write_to_file_len(indent, INDENT_MAX);
+		depth -= INDENT_MAX;
+	}
+	write_to_file_len(indent, depth);
+}
+
+//Formats value into str (at least 12 chars) and returns the length
+static int format_int(char* str, int value)
+{
+	char tmp[12];
+	unsigned int v = (value < 0) ? 0u - (unsigned int)value : (unsigned int)value;
+	int n = 0, len = 0;
+
+	do
+	{
+		tmp[n++] = (char)('0' + v % 10);
+		v /= 10;
+	} while(v != 0);
+
+	if(value < 0) str[len++] = '-';
+	while(n > 0) str[len++] = tmp[--n];
+	str[len] = '\0';
+	return len;
+}
+
+//Binary trace encoding
+
+static int bt_put_varint(unsigned char* p, unsigned int value)
+{
+	int len = 0;
+
+	while(value >= 0x80)
+	{
+		p[len++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	p[len++] = (unsigned char)value;
+	return len;
+}
+
+static int bt_put_svarint(unsigned char* p, int value)
+{
+	return bt_put_varint(p, ((unsigned int)value << 1) ^ (unsigned int)(value >> 31));
+}
+
+//Writes type, payload length, head and data
+static void bt_write_record(int type, const unsigned char* head, int head_len, const char* data, size_t data_len)
+{
+	unsigned char hdr[8];
+	int len = 0;
+
+	hdr[len++] = (unsigned char)type;
+	len += bt_put_varint(hdr + len, (unsigned int)(head_len + data_len));
+	write_to_file_len((const char*)hdr, len);
+	if(head_len > 0) write_to_file_len((const char*)head, head_len);
+	if(data_len > 0) write_to_file_len(data, data_len);
+}
+
+//Returns the id of name, new names are sent as BT_NAME record first
+static int bt_name_id(const char* name)
+{
+	unsigned int h = (unsigned int)(((size_t)name) >> 2) & (BT_HASH_SIZE - 1);
+	unsigned char head[8];
+	int id;
+
+	//Names are string literals, so they are looked up by pointer first
+	while(bt_hash[h].ptr != NULL)
+	{
+		if(bt_hash[h].ptr == name) return bt_hash[h].id;
+		h = (h + 1) & (BT_HASH_SIZE - 1);
+	}
+
+	for(id = 0; id < bt_num_names; id++)
+		if(strcmp(bt_names[id], name) == 0) break;
+
+	if(id == bt_num_names)
+	{
+		if(bt_num_names == bt_names_size)
+		{
+			bt_names_size = bt_names_size ? 2 * bt_names_size : 256;
+			bt_names = (char**) realloc(bt_names, bt_names_size * sizeof(char*));
+		}
+		if(bt_names == NULL || (bt_names[bt_num_names] = (char*) malloc(strlen(name) + 1)) == NULL)
+		{
+			fprintf(stderr, "bt_name_id: out of memory\n");
+			exit(-100);
+		}
+		strcpy(bt_names[bt_num_names], name);
+		bt_num_names++;
+
+		bt_write_record(BT_NAME, head, bt_put_varint(head, id), name, strlen(name));
+	}
+
+	if(bt_hash_count < BT_HASH_SIZE / 2)
+	{
+		bt_hash[h].ptr = name;
+		bt_hash[h].id = id;
+		bt_hash_count++;
+	}
+	return id;
+}
+
+static void bt_write_name_record(int type, const char* name)
+{
+	unsigned char head[8];
+	int id = bt_name_id(name);
+
+	bt_write_record(type, head, bt_put_varint(head, id), NULL, 0);
+}
+
+static void bt_write_name_int_record(int type, const char* name, int value)
+{
+	unsigned char head[16];
+	int id = bt_name_id(name);
+	int len = bt_put_varint(head, id);
+
+	len += bt_put_svarint(head + len, value);
+	bt_write_record(type, head, len, NULL, 0);
+}
+
+static void bt_write_int_record(int type, int value)
+{
+	unsigned char head[8];
+
+	bt_write_record(type, head, bt_put_svarint(head, value), NULL, 0);
+}
+
+//Root children other than slices (parameter sets, SEI) belong to the next picture
+static void bt_root_child(const char* name)
+{
+	if(strcmp(name, "Slice") == 0)
+		bt_pending = -1;
+	else if(bt_pending < 0)
+		bt_pending = written;
+}
+
+static void bt_add_index(int id)
+{
+	if(bt_num_index == bt_index_size)
+	{
+		bt_index_size = bt_index_size ? 2 * bt_index_size : 1024;
+		bt_index_offset = (long long*) realloc(bt_index_offset, bt_index_size * sizeof(long long));
+		bt_index_frame = (int*) realloc(bt_index_frame, bt_index_size * sizeof(int));
+		if(bt_index_offset == NULL || bt_index_frame == NULL)
+		{
+			fprintf(stderr, "bt_add_index: out of memory\n");
+			exit(-100);
+		}
+	}
+	bt_index_frame[bt_num_index] = id;
+	bt_index_offset[bt_num_index] = bt_pending >= 0 ? bt_pending : written;
+	bt_num_index++;
+	bt_pending = -1;
+}
+
+//Writes the end of stream record and the trailer described in bintrace.h
+static void bt_write_trailer()
+{
+	unsigned char head[8];
+	long long names_offset, index_offset;
+	unsigned int count;
+	int i, len;
+
+	bt_write_record(BT_EOF, NULL, 0, NULL, 0);
+
+	names_offset = written;
+	count = bt_num_names;
+	write_to_file_len((const char*)&count, sizeof(count));
+	for(i = 0; i < bt_num_names; i++)
+	{
+		len = bt_put_varint(head, (unsigned int)strlen(bt_names[i]));
+		write_to_file_len((const char*)head, len);
+		write_to_file_len(bt_names[i], strlen(bt_names[i]));
+	}
+
+	index_offset = written;
+	for(i = 0; i < bt_num_index; i++)
+	{
+		count = bt_index_frame[i];
+		write_to_file_len((const char*)&bt_index_offset[i], sizeof(long long));
+		write_to_file_len((const char*)&count, sizeof(count));
+	}
+
+	count = bt_num_index;
+	write_to_file_len((const char*)&names_offset, sizeof(long long));
+	write_to_file_len((const char*)&index_offset, sizeof(long long));
+	write_to_file_len((const char*)&count, sizeof(count));
+	write_to_file_len("JMBI", 4);
+}
+
+static void bt_reset()
+{
+	int i;
+
+	for(i = 0; i < bt_num_names; i++) free(bt_names[i]);
+	free(bt_names);
+	free(bt_index_offset);
+	free(bt_index_frame);
+	bt_names = NULL;
+	bt_index_offset = NULL;
+	bt_index_frame = NULL;
+	bt_num_names = bt_names_size = 0;
+	bt_num_index = bt_index_size = 0;
+	bt_pending = -1;
+	memset(bt_hash, 0, sizeof(bt_hash));
+	bt_hash_count = 0;
+}
+
+#if XML_TRACE_ASYNC
+static void* flush_thread_main(void* arg)
+{
+	pthread_mutex_lock(&flush_mutex);
+	for(;;)
+	{
+		while(flush_buf == NULL && !flush_exit)
+			pthread_cond_wait(&flush_cond, &flush_mutex);
+		if(flush_buf == NULL) break;
+
+		pthread_mutex_unlock(&flush_mutex);
+		fwrite(flush_buf, 1, flush_len, fh);
+		pthread_mutex_lock(&flush_mutex);
+
+		flush_buf = NULL;
+		pthread_cond_broadcast(&flush_cond);
+	}
+	pthread_mutex_unlock(&flush_mutex);
+	return arg;
+}
+
+//Blocks until the flush thread has written the previous buffer
+static void wait_flush_idle()
+{
+	pthread_mutex_lock(&flush_mutex);
+	while(flush_buf != NULL)
+		pthread_cond_wait(&flush_cond, &flush_mutex);
+	pthread_mutex_unlock(&flush_mutex);
+}
+#endif
+
+//Hands the filled buffer over for writing and continues in the other one
+static void flush_buffer()
+{
+#if XML_TRACE_ASYNC
+	if(thread_running)
+	{
+		wait_flush_idle();
+		if(buf_len == 0) return;
+
+		pthread_mutex_lock(&flush_mutex);
+		flush_buf = buf[cur];
+		flush_len = buf_len;
+		pthread_cond_broadcast(&flush_cond);
+		pthread_mutex_unlock(&flush_mutex);
+
+		cur ^= 1;
+		buf_len = 0;
+		return;
+	}
+#endif
+	if(buf_len > 0) fwrite(buf[cur], 1, buf_len, fh);
+	buf_len = 0;
+}
 
 void xml_set_trace_filename(char* location)
 {
@@ -25,6 +369,14 @@ void xml_set_trace_filename(char* location)
 		strcpy(filename, location);
 		strncpy(file_frameorder, location, strlen(location)-4);
 		strcat(file_frameorder, "_displayorder.xml");
+		binary = 0;
+	}
+	else if(strlen(location) > strlen(BIN_TRACE_EXT) && strcmp(location + strlen(location) - strlen(BIN_TRACE_EXT), BIN_TRACE_EXT) == 0)
+	{
+		//The display order is stored in the binary trace itself
+		strcpy(filename, location);
+		strcpy(file_frameorder, "\0");
+		binary = 1;
 	}
 	else
 	{
@@ -41,6 +393,7 @@ char* xml_get_trace_filename()
 void xml_set_log_level(int level)
 {
 	loglevel = level;
+	if(fh != NULL) xml_active_level = level;
 }
 
 int xml_get_log_level()
@@ -55,11 +408,44 @@ int xml_open_trace_file()
 
 	if(fh != NULL) xml_close_trace_file();
 
-	fh = fopen(filename, "w");
+	fh = fopen(filename, binary ? "wb" : "w");
 
 	if(fh == NULL) return -1;
+
+	buf[0] = (char*) malloc(XML_TRACE_BUFFER_SIZE);
+	buf[1] = (char*) malloc(XML_TRACE_BUFFER_SIZE);
+	if(buf[0] == NULL || buf[1] == NULL)
+	{
+		fclose(fh);
+		fh = NULL;
+		return -1;
+	}
+	cur = 0;
+	buf_len = 0;
+	written = 0;
+	stackcount = 0;
+
+#if XML_TRACE_ASYNC
+	flush_exit = 0;
+	flush_buf = NULL;
+	//Without the thread the buffers are written synchronously
+	thread_running = (pthread_create(&flush_thread, NULL, flush_thread_main, NULL) == 0);
+#endif
+
+	xml_active_level = loglevel;
+
+	if(binary)
+	{
+		char version = BIN_TRACE_VERSION;
+
+		bt_reset();
+		write_to_file_len("JMBT", 4);
+		write_to_file_len(&version, 1);
+		return 0;
+	}
+
 	//Write the XML declaration
-	fputs("<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n", fh);
+	write_to_file("<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n");
 
 	bClosed = '1';
 
@@ -79,12 +465,37 @@ int xml_open_trace_file()
 
 void xml_close_trace_file()
 {
-	if(fh != NULL) fclose(fh);
+	xml_active_level = -1;
+
+	if(fh != NULL)
+	{
+		if(binary) bt_write_trailer();
+		flush_buffer();
+#if XML_TRACE_ASYNC
+		if(thread_running)
+		{
+			pthread_mutex_lock(&flush_mutex);
+			flush_exit = 1;
+			pthread_cond_broadcast(&flush_cond);
+			pthread_mutex_unlock(&flush_mutex);
+			pthread_join(flush_thread, NULL);
+			thread_running = 0;
+		}
+#endif
+		fclose(fh);
+		fh = NULL;
+	}
+	free(buf[0]);
+	free(buf[1]);
+	buf[0] = buf[1] = NULL;
+	bt_reset();
+
 	if(fo != NULL)
 	{
 		//Write closing tag
 		fputs("</AVCTraceDisplayOrder>\n", fo);
 		fclose(fo);
+		fo = NULL;
 	}
 }
 
@@ -95,36 +506,38 @@ int xml_gen_trace_file()
 	return 0;
 }
 
-void xml_close_tag()
+static void xml_close_tag()
 {
 	if(bClosed == '0')
 	{
-		write_to_file(">");
+		write_to_file_len(">", 1);
 		bClosed = '1';
 	}
 }
 
 void xml_write_start_element(char* name)
 {
-	char str[STACK_SIZE];
-	int i;
+	if(binary)
+	{
+		if(stackcount == 1) bt_root_child(name);
+		bt_write_name_record(BT_START, name);
+		if(stackcount < STACK_SIZE) tags[stackcount] = name;
+		stackcount++;
+		return;
+	}
 
 	xml_close_tag();
 
-	if(bPrevIsElement == '1') write_to_file("\n");
+	if(bPrevIsElement == '1') write_to_file_len("\n", 1);
 
-	for(i = 0; i < stackcount; i++)
-		write_to_file("\t");
+	write_indent(stackcount);
 
-	write_to_file("<");
+	write_to_file_len("<", 1);
 	write_to_file(name);
 	bClosed = '0';
 
 	//Add element to stack
-	strcpy(str, tags);
-	strcpy(tags, name);
-	strcat(tags, ";");
-	strcat(tags, str);
+	if(stackcount < STACK_SIZE) tags[stackcount] = name;
 	stackcount++;
 
 	bPrevIsElement = '1';
@@ -132,64 +545,72 @@ void xml_write_start_element(char* name)
 
 void xml_write_end_element()
 {
-	char* pch;
-	char first = '0';
-	char str[STACK_SIZE];
-	int i;
+	if(binary)
+	{
+		bt_write_record(BT_END, NULL, 0, NULL, 0);
+		if(stackcount > 0) stackcount--;
+		return;
+	}
 
 	xml_close_tag();
 
 	if(bPrevIsElement == '1')
 	{
-		write_to_file("\n");
-		for(i = 1; i < stackcount; i++)
-			write_to_file("\t");
+		write_to_file_len("\n", 1);
+		write_indent(stackcount - 1);
 	}
-	write_to_file("</");
+	write_to_file_len("</", 2);
 	//Get the last tag from the stack
-	pch = strtok(tags, ";");
-	if(pch != NULL) write_to_file(pch);
-	//Write rest of the stack content
-	first = '1';
-	pch = strtok(NULL, ";");
-	while(pch != NULL)
-	{
-		if(first == '1')
-		{
-			strcpy(str, pch);
-			first = '0';
-		}
-		else
-			strcat(str, pch);
-		strcat(str, ";");
-		pch = strtok(NULL, ";");
-	}
-	strcpy(tags, str);
-	stackcount--;
-	write_to_file(">");
+	if(stackcount > 0)
+	{
+		stackcount--;
+		if(stackcount < STACK_SIZE) write_to_file(tags[stackcount]);
+	}
+	write_to_file_len(">", 1);
 	bPrevIsElement = '1';
 }
 
 void xml_write_string_attribute(char* name, char* value)
 {
-	write_to_file(" ");
+	if(binary)
+	{
+		unsigned char head[8];
+		int id = bt_name_id(name);
+
+		bt_write_record(BT_ATTR_STR, head, bt_put_varint(head, id), value, strlen(value));
+		return;
+	}
+
+	write_to_file_len(" ", 1);
 	write_to_file(name);
-	write_to_file("=\"");
+	write_to_file_len("=\"", 2);
 	write_to_file(value);
-	write_to_file("\"");
+	write_to_file_len("\"", 1);
 }
 
 void xml_write_int_attribute(char* name, int value)
 {
-	char buffer[255];
+	char buffer[16];
+
+	if(binary)
+	{
+		bt_write_name_int_record(BT_ATTR_INT, name, value);
+		return;
+	}
 
-	sprintf(buffer, "%i", value);
+	format_int(buffer, value);
 
 	xml_write_string_attribute(name, buffer);
 }
 
 void xml_write_text(char* value)
 {
+	if(binary)
+	{
+		bt_write_record(BT_TEXT, NULL, 0, value, strlen(value));
+		return;
+	}
+
 	xml_close_tag();
 	write_to_file(value);
 
@@ -198,17 +619,112 @@ void xml_write_text(char* value)
 
 void xml_write_int(int value)
 {
-	char buffer[255];
+	char buffer[16];
+	int len;
+
+	if(binary)
+	{
+		bt_write_int_record(BT_INT, value);
+		return;
+	}
 
 	xml_close_tag();
-	sprintf(buffer, "%i", value);
-	write_to_file(buffer);
+	len = format_int(buffer, value);
+	write_to_file_len(buffer, len);
 
 	bPrevIsElement = '0';
 }
 
+void xml_write_int_element(char* name, int value)
+{
+	char buffer[16];
+	size_t name_len;
+	int len;
+
+	if(binary)
+	{
+		bt_write_name_int_record(BT_INT_ELEM, name, value);
+		return;
+	}
+
+	name_len = strlen(name);
+	xml_close_tag();
+
+	if(bPrevIsElement == '1') write_to_file_len("\n", 1);
+	write_indent(stackcount);
+
+	//<name>value</name>
+	write_to_file_len("<", 1);
+	write_to_file_len(name, name_len);
+	write_to_file_len(">", 1);
+	len = format_int(buffer, value);
+	write_to_file_len(buffer, len);
+	write_to_file_len("</", 2);
+	write_to_file_len(name, name_len);
+	write_to_file_len(">", 1);
+
+	bPrevIsElement = '1';
+}
+
+void xml_write_int_list_element(char* name, int* values, int count)
+{
+	//Each value needs at most 11 characters plus the separator
+	char buffer[64 * 12];
+	size_t name_len;
+	int i, len = 0;
+
+	if(binary)
+	{
+		unsigned char head[8];
+		int id = bt_name_id(name);
+		int head_len = bt_put_varint(head, id);
+
+		for(i = 0; i < count; i++)
+		{
+			len += bt_put_svarint((unsigned char*)buffer + len, values[i]);
+			if(len > (int) sizeof(buffer) - 5)
+				break;
+		}
+		bt_write_record(BT_INT_LIST, head, head_len, buffer, len);
+		return;
+	}
+
+	name_len = strlen(name);
+	xml_close_tag();
+
+	if(bPrevIsElement == '1') write_to_file_len("\n", 1);
+	write_indent(stackcount);
+
+	//<name>v0,v1,...</name>
+	write_to_file_len("<", 1);
+	write_to_file_len(name, name_len);
+	write_to_file_len(">", 1);
+	for(i = 0; i < count; i++)
+	{
+		if(i > 0) buffer[len++] = ',';
+		len += format_int(buffer + len, values[i]);
+		if(len > (int) sizeof(buffer) - 13)
+		{
+			write_to_file_len(buffer, len);
+			len = 0;
+		}
+	}
+	write_to_file_len(buffer, len);
+	write_to_file_len("</", 2);
+	write_to_file_len(name, name_len);
+	write_to_file_len(">", 1);
+
+	bPrevIsElement = '1';
+}
+
 void xml_write_comment(char* comment)
 {
+	if(binary)
+	{
+		bt_write_record(BT_COMMENT, NULL, 0, comment, strlen(comment));
+		return;
+	}
+
 	xml_close_tag();
 	xml_write_text("<!-- ");
 	xml_write_text(comment);
@@ -218,7 +734,7 @@ void xml_write_comment(char* comment)
 int xml_check_and_write_end_element(char* name)
 {
 	int len = strlen(name);
-	if (strncmp(tags, name, len) == 0)
+	if (stackcount > 0 && stackcount <= STACK_SIZE && strncmp(tags[stackcount - 1], name, len) == 0)
 	{
 		xml_write_end_element();	//Close the tag
 		return 1;
@@ -226,25 +742,31 @@ int xml_check_and_write_end_element(char* name)
 	return 0;
 }
 
+//Starts an index entry of the binary trace for the picture with the given frame id
+void xml_start_picture(int id)
+{
+	if(binary && fh != NULL) bt_add_index(id);
+}
+
 int xml_output_frame_order(int id)
 {
 	int concealed = 0;
 	char buffer[255];
 
 	if(id == -1) concealed = 1;
-	
+
 	displaynr = displaynr + 1;
-	
-	sprintf(buffer, "\t<Picture displaynr=\"%i\" id=\"%i\" concealed=\"%i\"/>\n", displaynr, id, concealed);
 
-	if(fo != NULL) return fputs(buffer, fo);
+	if(binary)
+	{
+		if(fh == NULL) return -1;
+		bt_write_int_record(BT_FRAME_ORDER, id);
+		return 0;
+	}
 
-	return -1;
-}
+	sprintf(buffer, "\t<Picture displaynr=\"%i\" id=\"%i\" concealed=\"%i\"/>\n", displaynr, id, concealed);
 
-int write_to_file(char* text)
-{
-  if(fh != NULL) return fputs(text, fh);
+	if(fo != NULL) return fputs(buffer, fo);
 
 	return -1;
 }
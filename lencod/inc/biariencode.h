@@ -42,6 +42,8 @@
 #define MIN_BITS_TO_GO 0
 #define B_LOAD_MASK    0xFFFF      // ((1<<BITS_TO_LOAD) - 1)
 
+extern const int entropyBits[128];
+
 extern int get_pic_bin_count(VideoParameters *p_Vid);
 extern void reset_pic_bin_count(VideoParameters *p_Vid);
 extern void set_pic_bin_count  (VideoParameters *p_Vid, EncodingEnvironmentPtr eep);
@@ -52,17 +54,20 @@ extern void arienco_done_encoding (Macroblock *currMB, EncodingEnvironmentPtr ee
 extern void biari_init_context    (int qp, BiContextTypePtr ctx, const char* ini);
 extern void biari_encode_symbol   (EncodingEnvironmentPtr eep, signed short symbol, BiContextTypePtr bi_ct );
 extern void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, signed short symbol);
+extern void biari_encode_symbols_eq_prob(EncodingEnvironmentPtr eep, unsigned int symbols, int num_bins);
 extern void biari_encode_symbol_final(EncodingEnvironmentPtr eep, signed short symbol);
 
 /*!
 ************************************************************************
 * \brief
 *    Returns the number of currently written bits
+*    (including the estimated rate of symbols that were not coded)
 ************************************************************************
 */
 static inline int arienco_bits_written(EncodingEnvironmentPtr eep)
 {
-  return (((*eep->Ecodestrm_len) + eep->Epbuf + 1) << 3) + (eep->Echunks_outstanding * BITS_TO_LOAD) + BITS_TO_LOAD - eep->Ebits_to_go;
+  return (((*eep->Ecodestrm_len) + eep->Epbuf + 1) << 3) + (eep->Echunks_outstanding * BITS_TO_LOAD) + BITS_TO_LOAD - eep->Ebits_to_go
+    + (int) (eep->Erate_est >> 15);
 }
 
 #endif  // BIARIENCOD_H
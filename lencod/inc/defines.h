@@ -131,6 +131,8 @@ enum {
 #define BLOCK_MULTIPLE         4 // (MB_BLOCK_SIZE/BLOCK_SIZE)
 #define MB_BLOCK_PARTITIONS   16 // (BLOCK_MULTIPLE * BLOCK_MULTIPLE)
 #define BLOCK_CONTEXT         64 // (4 * MB_BLOCK_PARTITIONS)
+// all_mv[list][ref][type][y][x][c] is all_mv_data[((list * max_num_references + ref) * 9 + type) * 32 + (y * 4 + x) * 2 + c]
+#define MV_REF_SIZE          288 // (9 * MB_BLOCK_PARTITIONS * 2) shorts per list and reference
 // These variables relate to the subpel accuracy supported by the software (1/4)
 #define BLOCK_SIZE_SP      16  // BLOCK_SIZE << 2
 #define BLOCK_SIZE_8x8_SP  32  // BLOCK_SIZE8x8 << 2
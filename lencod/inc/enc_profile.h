@@ -0,0 +1,86 @@
+/*!
+ ************************************************************************
+ * \file
+ *    enc_profile.h
+ *
+ * \brief
+ *    Per-module encoder profiling timers and counters
+ *
+ *    Build with ENC_PROFILE=1 (make PROF=1) to enable. When disabled all
+ *    ENC_PROF_* macros expand to empty statements. Modules may nest, the
+ *    time of a nested module is not counted again in the enclosing one.
+ ************************************************************************
+ */
+
+#ifndef _ENC_PROFILE_H_
+#define _ENC_PROFILE_H_
+
+#ifndef ENC_PROFILE
+#define ENC_PROFILE 0
+#endif
+
+//! encoder modules with their own timers
+typedef enum
+{
+  PROF_INPUT = 0,     //!< ReadOneFrame() and source preprocessing
+  PROF_PRED_STRUCT,   //!< populate_frm_struct(): prediction structure lookahead
+  PROF_INT_ME,        //!< integer pel motion search (IntPelME, BiPredME)
+  PROF_SUBPEL_ME,     //!< sub pel motion search (SubPelME, SubPelBiPredME)
+  PROF_INTRA,         //!< intra mode decisions, trans_quant of the candidates is nested in it
+  PROF_TRANS_QUANT,   //!< forward transform, quantization and reconstruction, rdoq is nested in it
+  PROF_RDOQ,          //!< trellis quantization
+  PROF_ENTROPY,       //!< write_macroblock(): entropy coding of the chosen modes
+  PROF_DEBLOCK,       //!< DeblockFrame()
+  PROF_METRICS,       //!< frame distortion metrics (only the submission with DistortionThread)
+  PROF_NUM_STAGES
+} EncProfileStage;
+
+//! encoder event counters
+typedef enum
+{
+  PROF_CNT_MB = 0,    //!< macroblocks written to the bitstream
+  PROF_CNT_ME_DIST,   //!< block distortions (SAD, SATD, SSE) evaluated by the motion search
+  PROF_CNT_RDO,       //!< RDO mode candidates (RDCost_for_macroblocks)
+  PROF_NUM_COUNTERS
+} EncProfileCounter;
+
+#if (ENC_PROFILE)
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define enc_prof_ticks() ((unsigned long long) __rdtsc())
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#define enc_prof_ticks() ((unsigned long long) __rdtsc())
+#else
+extern unsigned long long enc_prof_ticks(void);
+#endif
+
+#define PROF_NUM_SLICE_TYPES 5
+
+extern int enc_prof_slice_type;
+extern unsigned long long enc_prof_counts[PROF_NUM_SLICE_TYPES][PROF_NUM_COUNTERS];
+
+extern void enc_profile_init        (char *filename);
+extern void enc_profile_set_slice_type(int slice_type);
+extern void enc_profile_start       (int stage);
+extern void enc_profile_stop        (int stage);
+extern void enc_profile_report_frame(int frame_no, int slice_type);
+extern void enc_profile_report      (int num_frames);
+
+#define ENC_PROF_START(stage)            enc_profile_start(stage)
+#define ENC_PROF_STOP(stage)             enc_profile_stop(stage)
+#define ENC_PROF_COUNT(counter)          (enc_prof_counts[enc_prof_slice_type][counter]++)
+#define ENC_PROF_SET_SLICE_TYPE(type)    enc_profile_set_slice_type(type)
+
+#else
+
+#define ENC_PROF_START(stage)            ((void) 0)
+#define ENC_PROF_STOP(stage)             ((void) 0)
+#define ENC_PROF_COUNT(counter)          ((void) 0)
+#define ENC_PROF_SET_SLICE_TYPE(type)    ((void) 0)
+
+#endif
+
+#endif
+
@@ -41,6 +41,8 @@ typedef struct inp_par_enc InputParameters;
 // structures that will be declared somewhere else
 struct storable_picture;
 struct coding_state;
+struct ctx_journal;
+struct dist_worker;
 
 
 typedef struct image_structure
@@ -85,7 +87,7 @@ typedef struct
 {
   struct video_par *p_Vid;
   unsigned int  Elow, Erange;
-  unsigned int  Ebuffer;
+  uint64        Ebuffer;     //!< up to eight bytes of code not yet written to Ecodestrm
   unsigned int  Ebits_to_go;
   unsigned int  Echunks_outstanding;
   int           Epbuf;
@@ -93,6 +95,7 @@ typedef struct
   int           *Ecodestrm_len;
   int           C;
   int           E;
+  int64         Erate_est;   //!< estimated rate of the symbols not coded in rate estimation mode (1/32768 bits)
 } EncodingEnvironment;
 
 typedef EncodingEnvironment *EncodingEnvironmentPtr;
@@ -465,6 +468,7 @@ typedef struct rd_data
   
   // These need to be changed to MotionVector parameters
   short   ******all_mv;               //!< all modes motion vectors
+  short   *all_mv_data;               //!< flat view of all_mv, see MV_REF_SIZE
   short *******bipred_mv;             //!<Biprediction MVs  
 
   char    intra_pred_modes[16];
@@ -554,6 +558,7 @@ typedef struct slice
   // Motion vectors for a macroblock
   // These need to be changed to MotionVector parameters
   short ******all_mv;         //!< replaces local all_mv
+  short *all_mv_data;         //!< flat view of all_mv, see MV_REF_SIZE
   short *******bipred_mv;     //!< Biprediction MVs  
   //Weighted prediction
   short ***wp_weight;         //!< weight in [list][index][component] order
@@ -576,6 +581,8 @@ typedef struct slice
   int **tblk4x4;     //!< Transform related array
   int ****i16blk4x4;
 
+  struct slice_arena *arena;   //!< scratch memory of the slice (mv, rd data and prediction buffers)
+
   RD_DATA *rddata;
   // RD_DATA data. Moved here to enable parallelization at the slice level
   // of RDOQ
@@ -716,8 +723,51 @@ typedef struct distortion_params
 {
   int        frame_ctr;                     //!< number of coded frames
   DistMetric metric[TOTAL_DIST_TYPES];      //!< Distortion metrics
+  float     *ssim_values;                   //!< per window SSIM terms
+  int        ssim_values_size;              //!< size of ssim_values
+  struct dist_worker *worker;               //!< background metrics thread (DistortionThread)
 } DistortionParams;
 
+//! values of the report line of a coded frame, printed once its metrics are known
+typedef struct frame_report
+{
+  int  nvb_line;                  //!< print the non-VCL bits line first
+  int  frame_no;                  //!< frame number of the non-VCL bits line
+  int  nvb_bits;                  //!< non-VCL bits
+  int  cur_bits;                  //!< bits of the frame including filler data
+  int  fdn_bits;                  //!< filler data bits
+  int  frm_no_in_file;
+  char pic_type[4];
+  int  wp_method;
+  int  qp;                        //!< average frame QP
+  int  lambda;
+  int  tmp_time;                  //!< coding time of the frame
+  int  me_time;                   //!< motion estimation time of the frame
+  int  fld_flag;
+  int  intras;
+  int  direct_mode;
+  int  num_ref_idx_l0_active;
+  int  num_ref_idx_l1_active;
+  int  rd_pass;
+  int  nal_reference_idc;
+} FrameReport;
+
+#define WP_ORG_PLANES  9          //!< cached original planes (Y, U, V of the frame and both fields)
+
+//! sample statistics of a picture plane, used by the weighted prediction estimators
+typedef struct plane_stats
+{
+  imgpel **img;                   //!< plane the statistics belong to (NULL if not computed)
+  int      height;
+  int      width;
+  double   dsum;                  //!< sum of the samples
+  double   dsum2;                 //!< sum of the squared samples
+  double   ddc;                   //!< DC (mean sample value)
+  int      norm_valid;            //!< dnorm is computed
+  double   norm_mean;             //!< mean value dnorm refers to
+  double   dnorm;                 //!< sum of the absolute differences to norm_mean
+} PlaneStats;
+
 typedef struct picture
 {
   int   no_slices;
@@ -903,6 +953,7 @@ typedef struct video_par
 
   Picture       *currentPicture;         //!< The coded picture currently in the works (typically p_frame_pic, p_Vid->field_pic[0], or p_Vid->field_pic[1])
   struct slice  *currentSlice;           //!< pointer to current Slice data struct
+  struct slice_arena *slice_arenas;      //!< pool of idle slice arenas
   Macroblock    *mb_data;                //!< array containing all MBs of a whole frame
   Block8x8Info  *b8x8info;               //!< block 8x8 information for RDopt
 
@@ -1084,6 +1135,8 @@ typedef struct video_par
   int frame_statistic_start;
   int initial_Bframes;
   int cabac_encoding;
+  int cabac_rate_estimation;   //!< CABAC symbols are only rated, not coded (RD mode decision)
+  struct ctx_journal *ctx_journal; //!< CABAC context changes since the oldest stored coding state
 
   unsigned int primary_pic_type;
 
@@ -1091,6 +1144,8 @@ typedef struct video_par
   int frameOffsetCount[2][MAX_REFERENCE_PICTURES]; 
   short frameOffset[2][MAX_REFERENCE_PICTURES];
   int frameOffsetAvail; 
+  PlaneStats wp_org_stats[WP_ORG_PLANES]; //!< statistics of the original planes of the current frame
+  int wp_org_next;                        //!< next wp_org_stats entry to be replaced
 
   double *mb16x16_cost_frame;
   double mb16x16_cost;
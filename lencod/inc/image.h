@@ -28,6 +28,7 @@ extern void    UnifiedOneForthPix_JV ( VideoParameters *p_Vid, int nplane, Stora
 extern void    frame_picture         ( VideoParameters *p_Vid, Picture *frame, ImageData *imgData, int rd_pass);
 extern byte    get_idr_flag          ( VideoParameters *p_Vid );
 extern void    write_non_vcl_nalu    ( VideoParameters *p_Vid, InputParameters *p_Inp );
+extern void    report_frame_line     ( InputParameters *p_Inp, FrameReport *r, DistMetric *mPSNR, DistMetric *mSSIM );
 
 #endif
 
@@ -20,7 +20,16 @@
 #define _IMG_DIST_SSIM_H_
 #include "img_distortion.h"
 
-extern void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric metricSSIM[3]);
+//! SSIM terms averaged by compute_ssim_windows()
+typedef enum
+{
+  SSIM_FULL      = 0,  //!< luminance, contrast and structure
+  SSIM_STRUCTURE = 1,  //!< contrast and structure
+  SSIM_LUMINANCE = 2   //!< luminance
+} SSIMTerm;
+
+extern float compute_ssim_windows (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int comp, SSIMTerm term, int unbiased);
+extern void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricSSIM);
 
 #endif
 
@@ -22,6 +22,10 @@ extern void accumulate_average(DistMetric metric[3], int frames);
 extern void find_distortion   (VideoParameters *p_Vid, ImageData *imgData);
 extern void select_img        (VideoParameters *p_Vid, ImageStructure *imgSRC, ImageStructure *imgREF, ImageData *imgData);
 extern void compute_distortion(VideoParameters *p_Vid, ImageData *imgData);
+extern void report_distortion (VideoParameters *p_Vid, FrameReport *report);
+extern void init_distortion   (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void flush_distortion  (VideoParameters *p_Vid);
+extern void free_distortion   (VideoParameters *p_Vid);
 
 #endif
 
@@ -21,10 +21,10 @@
 
 #define MAX_LIST_SIZE 33
 
+//! sample statistics of the planes of a picture, computed when it enters the DPB
 typedef struct picture_stats
 {
-  double dsum[3];
-  double dvar[3];
+  PlaneStats plane[MAX_PLANE];    //!< statistics of imgY, imgUV[0] and imgUV[1]
 } PictureStats;
 
 //! definition a picture (field or frame)
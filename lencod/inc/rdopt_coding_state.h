@@ -19,6 +19,30 @@
 #ifndef _RD_OPT_CS_H_
 #define _RD_OPT_CS_H_
 
+//! context and a value of it (the value before a modification in the undo journal)
+typedef struct ctx_journal_entry {
+  BiContextTypePtr     ctx;
+  BiContextType        value;
+} CtxJournalEntry;
+
+//! list of context values (undo journal or values to restore a coding state)
+typedef struct ctx_entry_list {
+  CtxJournalEntry      *entry;
+  int                  size;
+  int                  max_size;
+} CtxEntryList;
+
+//! journal of the context modifications since the oldest stored coding state
+struct ctx_journal {
+  CtxEntryList         undo;
+  struct coding_state  **state;                        //!< coding states stored in the current epoch
+  int                  no_states;
+  int                  max_states;
+  int                  epoch;                          //!< incremented whenever the journal is reset
+};
+
+typedef struct ctx_journal CtxJournal;
+
 struct coding_state {
 
   // important variables of data partition array
@@ -26,9 +50,11 @@ struct coding_state {
   Bitstream            *bitstream;
   EncodingEnvironment  *encenv;
 
-  // contexts for binary arithmetic coding
-  MotionInfoContexts   *mot_ctx;
-  TextureInfoContexts  *tex_ctx;
+  // contexts for binary arithmetic coding: the contexts of the stored state
+  // are those at journal position base, followed by the values in redo
+  int                  epoch;
+  int                  base;
+  CtxEntryList         redo;
 
   // bit counter
   BitCounter            bits;
@@ -46,6 +72,28 @@ extern CSobj *create_coding_state  (InputParameters *p_Inp);       //!< create s
 
 extern void init_coding_state_methods(Slice *currSlice);  //!< Init methods given entropy coding
 
+extern CtxJournal *create_ctx_journal (void);
+extern void delete_ctx_journal (CtxJournal *journal);
+extern void reset_ctx_journal  (CtxJournal *journal);
+extern void grow_ctx_entry_list(CtxEntryList *list);
+
+/*!
+ ************************************************************************
+ * \brief
+ *    records the value of a context before it is modified
+ ************************************************************************
+ */
+static inline void journal_context(CtxJournal *journal, BiContextTypePtr ctx)
+{
+  CtxEntryList *undo = &journal->undo;
+
+  if (undo->size == undo->max_size)
+    grow_ctx_entry_list(undo);
+
+  undo->entry[undo->size].ctx     = ctx;
+  undo->entry[undo->size++].value = *ctx;
+}
+
 
 #endif
 
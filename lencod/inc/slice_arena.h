@@ -0,0 +1,54 @@
+/*!
+ ************************************************************************
+ * \file
+ *    slice_arena.h
+ *
+ * \brief
+ *    Arena allocator for the per-slice scratch memory of the encoder
+ *
+ *    Each slice takes an arena from the pool in VideoParameters when it is
+ *    created and returns it when it is freed. Allocations are bump-pointer
+ *    allocations that are never freed individually; returning the arena
+ *    resets it in O(1).
+ *
+ *    arena_array() keeps the pointer tables so the [a][b]... accesses of
+ *    the encoder stay as they are; the elements are contiguous, so whole
+ *    buffers (e.g. all_mv via all_mv_data) are copied through flat views.
+ *    This is only a partial move to flat views: the element accesses of
+ *    the motion search and mode decision (about 190 to all_mv and 50 to
+ *    bipred_mv) still go through the pointer tables, and several of them
+ *    pass sub-tables such as all_mv[list] to functions.
+ ************************************************************************
+ */
+
+#ifndef _SLICE_ARENA_H_
+#define _SLICE_ARENA_H_
+
+#include "global.h"
+
+#define ARENA_BLOCK_SIZE  (1 << 20)   //!< size of the first block of an arena
+#define ARENA_MAX_DIMS    7           //!< maximum number of dimensions of arena_array()
+
+//! block of arena memory, the data follows the (MEM_ALIGNMENT sized) header
+typedef struct arena_block
+{
+  struct arena_block *next;
+  size_t              size;           //!< usable bytes of the block
+} ArenaBlock;
+
+//! slice scratch memory arena
+typedef struct slice_arena
+{
+  ArenaBlock         *block;          //!< block list, the current block first
+  size_t              used;           //!< bytes used in the current block
+  struct slice_arena *next;           //!< next idle arena of the pool
+} SliceArena;
+
+extern SliceArena *get_slice_arena    (VideoParameters *p_Vid);
+extern void        release_slice_arena(VideoParameters *p_Vid, SliceArena *arena);
+extern void        free_slice_arenas  (VideoParameters *p_Vid);
+
+extern void *arena_alloc(SliceArena *arena, size_t size);
+extern void *arena_array(SliceArena *arena, size_t elem_size, int num_dims, ...);
+
+#endif
@@ -30,7 +30,11 @@ extern void EstimateWPPSliceAlg0(Slice *currSlice, int offset);
 extern int  TestWPPSliceAlg0    (VideoParameters *p_Vid, int offset);
 extern int  TestWPBSliceAlg0    (VideoParameters *p_Vid, int method);
 
-extern double ComputeImgSum     (imgpel **CurrentImage, int height, int width);
+extern void        ComputePicStats  (struct storable_picture *p);
+extern PlaneStats *GetRefPlaneStats (struct storable_picture *p, imgpel **img);
+extern PlaneStats *GetOrgPlaneStats (VideoParameters *p_Vid, imgpel **img, int height, int width);
+extern void        ResetOrgStats    (VideoParameters *p_Vid);
+extern double      GetPlaneNorm     (PlaneStats *s, double mean_value);
 
 #endif
 
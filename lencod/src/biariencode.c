@@ -19,6 +19,7 @@
 
 #include "global.h"
 #include "biariencode.h"
+#include "rdopt_coding_state.h"
 
 // Range table for LPS
 static const byte rLPS_table_64x4[64][4]=
@@ -113,6 +114,27 @@ static const byte AC_next_state_LPS_64[64] =
 
 static const byte renorm_table_32[32]={6,5,4,4,3,3,3,3,2,2,2,2,2,2,2,2,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};
 
+//! bits (in 1/32768 units) of a symbol, indexed by 63 - state for the MPS and 64 + state for the LPS
+const int entropyBits[128]= 
+{
+     895,    943,    994,   1048,   1105,   1165,   1228,   1294, 
+    1364,   1439,   1517,   1599,   1686,   1778,   1875,   1978, 
+    2086,   2200,   2321,   2448,   2583,   2725,   2876,   3034, 
+    3202,   3380,   3568,   3767,   3977,   4199,   4435,   4684, 
+    4948,   5228,   5525,   5840,   6173,   6527,   6903,   7303, 
+    7727,   8178,   8658,   9169,   9714,  10294,  10914,  11575, 
+   12282,  13038,  13849,  14717,  15650,  16653,  17734,  18899, 
+   20159,  21523,  23005,  24617,  26378,  28306,  30426,  32768, 
+   32768,  35232,  37696,  40159,  42623,  45087,  47551,  50015, 
+   52479,  54942,  57406,  59870,  62334,  64798,  67262,  69725, 
+   72189,  74653,  77117,  79581,  82044,  84508,  86972,  89436, 
+   91900,  94363,  96827,  99291, 101755, 104219, 106683, 109146, 
+  111610, 114074, 116538, 119002, 121465, 123929, 126393, 128857, 
+  131321, 133785, 136248, 138712, 141176, 143640, 146104, 148568, 
+  151031, 153495, 155959, 158423, 160887, 163351, 165814, 168278, 
+  170742, 173207, 175669, 178134, 180598, 183061, 185525, 187989
+};
+
 
 void reset_pic_bin_count(VideoParameters *p_Vid)
 {
@@ -170,21 +192,21 @@ static inline void put_one_byte_final(EncodingEnvironmentPtr eep, unsigned int b
 
 static forceinline void put_buffer(EncodingEnvironmentPtr eep)
 {
+  byte *out = eep->Ecodestrm + *eep->Ecodestrm_len;
+
+  *eep->Ecodestrm_len += eep->Epbuf + 1;
   while(eep->Epbuf>=0)
   {
-    eep->Ecodestrm[(*eep->Ecodestrm_len)++] =  (byte) ((eep->Ebuffer>>((eep->Epbuf--)<<3))&0xFF); 
-  }
-  while(eep->C > 7)
-  {
-    eep->C-=8;
-    ++(eep->E);
+    *out++ = (byte) (eep->Ebuffer>>((eep->Epbuf--)<<3)); 
   }
+  eep->E += eep->C >> 3;
+  eep->C &= 7;
   eep->Ebuffer = 0; 
 }
 
 static inline void put_one_byte(EncodingEnvironmentPtr eep, int b) 
 { 
-  if(eep->Epbuf == 3)
+  if(eep->Epbuf >= 7)  // Ebuffer holds eight bytes
   { 
     put_buffer(eep);
   } 
@@ -196,7 +218,7 @@ static inline void put_one_byte(EncodingEnvironmentPtr eep, int b)
 
 static inline void put_one_word(EncodingEnvironmentPtr eep, int b) 
 {
-  if (eep->Epbuf >= 3)
+  if (eep->Epbuf >= 6)
   { 
     put_buffer(eep);
   }
@@ -268,6 +290,7 @@ void arienco_start_encoding(EncodingEnvironmentPtr eep,
   eep->Ecodestrm_len = code_len;
 
   eep->Erange = HALF;
+  eep->Erate_est = 0;
 }
 
 /*!
@@ -352,14 +375,30 @@ void arienco_done_encoding(Macroblock *currMB, EncodingEnvironmentPtr eep)
  * \brief
  *    Actually arithmetic encoding of one binary symbol by using
  *    the probability estimate of its associated context model
+ *
+ *    In rate estimation mode the symbol is not coded; its rate is taken
+ *    from the context state, which is left unchanged
  ************************************************************************
  */
 void biari_encode_symbol(EncodingEnvironmentPtr eep, signed short symbol, BiContextTypePtr bi_ct )
 {
-  unsigned int low = eep->Elow;
-  unsigned int range = eep->Erange;  
-  int bl = eep->Ebits_to_go;
-  unsigned int rLPS = rLPS_table_64x4[bi_ct->state][(range>>6) & 3]; 
+  unsigned int low, range, rLPS;
+  int bl;
+
+  if (eep->p_Vid->cabac_rate_estimation)
+  {
+    eep->Erate_est += entropyBits[((symbol != 0) == bi_ct->MPS) ? 63 - bi_ct->state : 64 + bi_ct->state];
+    return;
+  }
+
+  // trial encodings journal the context so that stored coding states can be restored
+  if (eep->p_Vid->ctx_journal != NULL && !eep->p_Vid->cabac_encoding)
+    journal_context(eep->p_Vid->ctx_journal, bi_ct);
+
+  low   = eep->Elow;
+  range = eep->Erange;
+  bl    = eep->Ebits_to_go;
+  rLPS  = rLPS_table_64x4[bi_ct->state][(range>>6) & 3]; 
  
   range -= rLPS;
 
@@ -444,7 +483,15 @@ void biari_encode_symbol(EncodingEnvironmentPtr eep, signed short symbol, BiCont
  */
 void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, signed short symbol)
 {
-  unsigned int low = eep->Elow;
+  unsigned int low;
+
+  if (eep->p_Vid->cabac_rate_estimation)
+  {
+    eep->Erate_est += 32768; // one bit
+    return;
+  }
+
+  low = eep->Elow;
   --(eep->Ebits_to_go);  
   ++(eep->C);
 
@@ -479,6 +526,68 @@ void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, signed short symbol
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Arithmetic encoding of the num_bins least significant bits of
+ *    symbols (most significant first), each with p(symbol) = 0.5.
+ *    Gives the same code as num_bins calls of
+ *    biari_encode_symbol_eq_prob(), but adds all bins up to the next
+ *    renormalization to low at once
+ ************************************************************************
+ */
+void biari_encode_symbols_eq_prob(EncodingEnvironmentPtr eep, unsigned int symbols, int num_bins)
+{
+  if (eep->p_Vid->cabac_rate_estimation)
+  {
+    eep->Erate_est += (int64) num_bins * 32768; // one bit per bin
+    return;
+  }
+
+  eep->C += num_bins;
+
+  while (num_bins > 0)
+  {
+    unsigned int low = eep->Elow;
+    int n = imin(num_bins, (int) eep->Ebits_to_go);
+    unsigned int bins;
+
+    num_bins -= n;
+    bins = (symbols >> num_bins) & ((1u << n) - 1);
+    eep->Ebits_to_go -= n;
+
+    if (bins != 0)
+    {
+      // the bins add less than Erange << (Ebits_to_go + n), at most one carry
+      low += (eep->Erange * bins) << eep->Ebits_to_go;
+      if (low >= ONE) // output of carry needed
+      {
+        low -= ONE;
+        propagate_carry(eep);
+      }
+    }
+
+    if(eep->Ebits_to_go == MIN_BITS_TO_GO)  // renorm needed
+    {
+      eep->Elow = (low << BITS_TO_LOAD )& (ONE_M1);
+      low = (low >> B_BITS) & B_LOAD_MASK; // mask out the 8/16 MSBs for output
+      if (low < B_LOAD_MASK)      // no carry possible, output now
+      {
+        put_last_chunk_plus_outstanding(eep, low);
+      }
+      else          // low == "FF"; keep it, may affect future carry
+      {
+        ++(eep->Echunks_outstanding);
+      }
+      eep->Ebits_to_go = BITS_TO_LOAD;
+    }
+    else
+    {
+      eep->Elow = low;
+    }
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -487,9 +596,19 @@ void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, signed short symbol
  */
 void biari_encode_symbol_final(EncodingEnvironmentPtr eep, signed short symbol)
 {
-  unsigned int range = eep->Erange - 2;
-  unsigned int low = eep->Elow;
-  int bl = eep->Ebits_to_go; 
+  unsigned int range, low;
+  int bl;
+
+  if (eep->p_Vid->cabac_rate_estimation)
+  {
+    if (symbol != 0)
+      eep->Erate_est += 7 * 32768; // 7 renormalizations for the terminating LPS
+    return;
+  }
+
+  range = eep->Erange - 2;
+  low   = eep->Elow;
+  bl    = eep->Ebits_to_go; 
 
   ++(eep->C);
 
@@ -40,6 +40,7 @@
 #include "quantChroma.h"
 #include "md_common.h"
 #include "transform8x8.h"
+#include "enc_profile.h"
 
 
 // Notation for comments regarding prediction and predictors.
@@ -350,6 +351,7 @@ void intrapred_16x16(Macroblock *currMB, ColorPlane pl)
  */
 int dct_16x16(Macroblock *currMB, ColorPlane pl)
 {
+  ENC_PROF_START(PROF_TRANS_QUANT);
   int i,j;
   int ii,jj;
 
@@ -490,6 +492,7 @@ int dct_16x16(Macroblock *currMB, ColorPlane pl)
         p_Vid->lrec[j][i]=-16; //signals an I16 block in the SP frame
   }
 
+  ENC_PROF_STOP(PROF_TRANS_QUANT);
   return ac_coef;
 }
 
@@ -686,6 +689,7 @@ static inline int check_zero(int **mb_ores, int block_x)
 */
 int dct_4x4(Macroblock *currMB, ColorPlane pl, int block_x,int block_y, int *coeff_cost, int intra)
 {
+  ENC_PROF_START(PROF_TRANS_QUANT);
   int nonzero = FALSE;
 
   int   pos_x   = block_x >> BLOCK_SHIFT;
@@ -749,6 +753,7 @@ int dct_4x4(Macroblock *currMB, ColorPlane pl, int block_x,int block_y, int *coe
     copy_image_data_4x4(&img_enc[currMB->pix_y + block_y], &mb_pred[block_y], currMB->pix_x + block_x, block_x);
   }
 
+  ENC_PROF_STOP(PROF_TRANS_QUANT);
   return nonzero;
 }
 
@@ -1063,6 +1068,7 @@ static int Inv_Residual_DPCM_4x4_for_Intra16x16(int **m7, int ipmode)
  */
 int dct_chroma(Macroblock *currMB, int uv, int cr_cbp)
 {
+  ENC_PROF_START(PROF_TRANS_QUANT);
   int i, j, n2, n1, coeff_ctr;
   int *m1;
   int coeff_cost = 0;
@@ -1297,6 +1303,7 @@ int dct_chroma(Macroblock *currMB, int uv, int cr_cbp)
     copy_image_data(&p_Vid->enc_picture->imgUV[uv][currMB->pix_c_y], mb_pred, currMB->pix_c_x, 0, p_Vid->mb_cr_size_x, p_Vid->mb_cr_size_y);
   }
 
+  ENC_PROF_STOP(PROF_TRANS_QUANT);
   return cr_cbp;
 }
 
@@ -142,29 +142,25 @@ const byte* pos2ctx_last    [] = {
 /*!
  ************************************************************************
  * \brief
- *    Exp Golomb binarization and encoding
+ *    Exp Golomb binarization and encoding; the unary prefix and the
+ *    binary suffix are each coded as one batch of bypass bins
  ************************************************************************
  */
 static void exp_golomb_encode_eq_prob( EncodingEnvironmentPtr eep_dp,
                                 unsigned int symbol,
                                 int k)
 {
-  for(;;)
+  int prefix_len = 0;
+
+  while (symbol >= (unsigned int)(1<<k))
   {
-    if (symbol >= (unsigned int)(1<<k))
-    {
-      biari_encode_symbol_eq_prob(eep_dp, 1);   //first unary part
-      symbol = symbol - (1<<k);
-      k++;
-    }
-    else
-    {
-      biari_encode_symbol_eq_prob(eep_dp, 0);   //now terminated zero of unary part
-      while (k--)                               //next binary part
-        biari_encode_symbol_eq_prob(eep_dp, (signed short)((symbol>>k)&1));
-      break;
-    }
+    symbol = symbol - (1<<k);
+    k++;
+    prefix_len++;
   }
+  // prefix_len ones terminated by a zero, then the k bit suffix
+  biari_encode_symbols_eq_prob(eep_dp, ((1u << prefix_len) - 1) << 1, prefix_len + 1);
+  biari_encode_symbols_eq_prob(eep_dp, symbol, k);
 }
 
 /*!
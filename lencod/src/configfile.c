@@ -68,6 +68,7 @@
 #include "mv_search.h"
 #include "img_io.h"
 #include "ratectl.h"
+#include "enc_profile.h"
 
 char *GetConfigFileContent (char *Filename);
 static void ParseContent            (InputParameters *p_Inp, Mapping *Map, char *buf, int bufsize);
@@ -145,12 +146,23 @@ int64 getVideoFileSize(int video_file)
  */
 void getNumberOfFrames (InputParameters *p_Inp, VideoDataFile *input_file)
 {
-  int64 fsize = getVideoFileSize(input_file->f_num);
+  int64 fsize;
   int64 isize = (int64) p_Inp->source.size;
   int maxBitDepth = imax(p_Inp->source.bit_depth[0], p_Inp->source.bit_depth[1]);
 
+  // only the frames read so far are known for a pipe
+  if (input_file->is_pipe)
+  {
+    p_Inp->no_frames = input_file->pipe_frame - p_Inp->start_frame;
+    return;
+  }
+
+  fsize = getVideoFileSize(input_file->f_num);
   isize <<= (maxBitDepth > 8)? 1: 0;
-  p_Inp->no_frames   = (int) (((fsize - p_Inp->infile_header)/ isize) - p_Inp->start_frame);
+  if (input_file->vdtype == VIDEO_Y4M)
+    p_Inp->no_frames = (int) (((fsize - input_file->y4m_header) / (isize + input_file->y4m_frame_header)) - p_Inp->start_frame);
+  else
+    p_Inp->no_frames = (int) (((fsize - p_Inp->infile_header)/ isize) - p_Inp->start_frame);
 }
 
 /*!
@@ -925,6 +937,18 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
   int storedBplus1;
   int bitdepth_qp_scale[3];
 
+  // a Y4M input describes its own size, frame rate, color format and bit depth
+  ParseVideoType(&p_Inp->input_file1);
+  if (p_Inp->input_file1.vdtype == VIDEO_Y4M)
+  {
+    if (ParseY4MHeader(&p_Inp->input_file1, &p_Inp->source) == 0)
+    {
+      snprintf(errortext, ET_SIZE, "Input file %s is not a valid Y4M stream.", p_Inp->input_file1.fname);
+      error (errortext, 500);
+    }
+    p_Inp->yuv_format = p_Inp->source.yuv_format;
+  }
+
   if (p_Inp->src_BitDepthRescale)
   {
     bitdepth_qp_scale [0] = 6*(p_Inp->output.bit_depth[0] - 8);
@@ -943,7 +967,6 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
   if (p_Inp->source.frame_rate == 0.0)
     p_Inp->source.frame_rate = (double) INIT_FRAME_RATE;
 
-  ParseVideoType(&p_Inp->input_file1);
   ParseFrameNoFormatFromString (&p_Inp->input_file1);
 
   // Read resolution from file name
@@ -994,6 +1017,11 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
 
   if (p_Inp->no_frames == -1)
   {
+    if (p_Inp->input_file1.is_pipe)
+    {
+      snprintf(errortext, ET_SIZE, "FramesToBeEncoded must be given when the input is read from a pipe.");
+      error (errortext, 500);
+    }
     OpenFiles(&p_Inp->input_file1);
     getNumberOfFrames(p_Inp, &p_Inp->input_file1);
     CloseFiles(&p_Inp->input_file1);
@@ -1266,12 +1294,23 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     error (errortext, 500);
   }
 
+#if !(ENC_PROFILE)
+  if (p_Inp->ProfileFile[0] != '\0')
+    fprintf(stderr, "Warning: ProfileFile ignored, the encoder was built without ENC_PROFILE\n");
+#endif
+
   if ( p_Inp->ChromaMEEnable && p_Inp->yuv_format ==  YUV400) 
   {
     fprintf(stderr, "Warning: ChromaMEEnable cannot be used with monochrome color format, disabling ChromaMEEnable.\n");
     p_Inp->ChromaMEEnable = 0;
   }
 
+  if ( p_Inp->ChromaWeightSupport && p_Inp->yuv_format ==  YUV400) 
+  {
+    fprintf(stderr, "Warning: ChromaWeightSupport cannot be used with monochrome color format, disabling ChromaWeightSupport.\n");
+    p_Inp->ChromaWeightSupport = 0;
+  }
+
   if ( (p_Inp->ChromaMCBuffer == 0) && (( p_Inp->yuv_format ==  YUV444) && (!p_Inp->separate_colour_plane_flag)) )
   {
     fprintf(stderr, "Warning: Enabling ChromaMCBuffer for 4:4:4 combined color coding.\n");
@@ -0,0 +1,357 @@
+/*!
+ ************************************************************************
+ * \file
+ *    enc_profile.c
+ *
+ * \brief
+ *    Per-module encoder profiling timers and counters.
+ *
+ *    The time of each module is accumulated in CPU ticks per slice type,
+ *    the tick rate is calibrated against gettime() since the start of
+ *    the encoder. Started modules are kept on a stack, so that the time
+ *    of a nested module (e.g. rdoq inside trans_quant) is only counted
+ *    as the self time of the nested one. Only the main thread is timed
+ *    and counted; the metrics, SSIM and WP offset threads are not.
+ *
+ *    With ReportFrameStats one line per coded frame is written to
+ *    stat_profile.csv, which is recreated by every run. The summary is
+ *    printed after encoding and, with ProfileFile, written as JSON.
+ ************************************************************************
+ */
+
+#include "global.h"
+#include "enc_profile.h"
+
+#if (ENC_PROFILE)
+
+#if !defined(_WIN32) && !(defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)))
+#include <time.h>
+
+unsigned long long enc_prof_ticks(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+#define PROF_FRAME_FILE "stat_profile.csv"
+#define PROF_MAX_DEPTH  16
+
+static const char *stage_names[PROF_NUM_STAGES] =
+{
+  "input", "pred_struct", "int_me", "subpel_me", "intra", "trans_quant", "rdoq", "entropy", "deblock", "metrics"
+};
+
+static const char *counter_names[PROF_NUM_COUNTERS] = { "mbs", "me_dist", "rdo_cand" };
+
+static const char *slice_type_names[PROF_NUM_SLICE_TYPES] = { "P", "B", "I", "SP", "SI" };
+
+int enc_prof_slice_type = P_SLICE;
+unsigned long long enc_prof_counts[PROF_NUM_SLICE_TYPES][PROF_NUM_COUNTERS];
+
+//! a started module
+typedef struct
+{
+  int stage;
+  unsigned long long start;
+  unsigned long long nested;  //!< ticks of the modules started inside this one
+} ProfileFrame;
+
+static unsigned long long prof_ticks[PROF_NUM_SLICE_TYPES][PROF_NUM_STAGES];  //!< self time
+static unsigned long long prof_total[PROF_NUM_SLICE_TYPES][PROF_NUM_STAGES];  //!< including nested modules
+static unsigned long long prof_calls[PROF_NUM_SLICE_TYPES][PROF_NUM_STAGES];
+
+static ProfileFrame prof_stack[PROF_MAX_DEPTH];
+static int prof_depth = 0;
+static int frame_file_open = 0;   //!< stat_profile.csv was created by this run
+
+//! totals at the last frame report
+static unsigned long long last_ticks[PROF_NUM_STAGES];
+static unsigned long long last_counts[PROF_NUM_COUNTERS];
+
+static TIME_T prof_start_time;
+static unsigned long long prof_start_ticks;
+static char prof_filename[FILE_NAME_SIZE] = "";
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Resets the counters, starts the tick calibration and sets the file
+ *    the JSON summary is written to (none if empty)
+ ************************************************************************
+ */
+void enc_profile_init(char *filename)
+{
+  memset(prof_ticks, 0, sizeof(prof_ticks));
+  memset(prof_total, 0, sizeof(prof_total));
+  memset(prof_calls, 0, sizeof(prof_calls));
+  memset(enc_prof_counts, 0, sizeof(enc_prof_counts));
+  prof_depth = 0;
+  frame_file_open = 0;
+  memset(last_ticks, 0, sizeof(last_ticks));
+  memset(last_counts, 0, sizeof(last_counts));
+
+  strncpy(prof_filename, filename, FILE_NAME_SIZE - 1);
+  prof_filename[FILE_NAME_SIZE - 1] = '\0';
+
+  gettime(&prof_start_time);
+  prof_start_ticks = enc_prof_ticks();
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sets the slice type the following modules are counted for
+ ************************************************************************
+ */
+void enc_profile_set_slice_type(int slice_type)
+{
+  enc_prof_slice_type = (slice_type >= 0 && slice_type < PROF_NUM_SLICE_TYPES) ? slice_type : P_SLICE;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Starts a module, nested in the module that is running
+ ************************************************************************
+ */
+void enc_profile_start(int stage)
+{
+  ProfileFrame *frame;
+
+  if (prof_depth == PROF_MAX_DEPTH)
+    error("enc_profile_start: modules nested too deep", 500);
+  frame = &prof_stack[prof_depth++];
+  frame->stage  = stage;
+  frame->nested = 0;
+  frame->start  = enc_prof_ticks();
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stops the module started last and adds its time to the module that
+ *    encloses it
+ ************************************************************************
+ */
+void enc_profile_stop(int stage)
+{
+  unsigned long long ticks = enc_prof_ticks();
+  ProfileFrame *frame;
+
+  if (prof_depth == 0 || prof_stack[prof_depth - 1].stage != stage)
+    error("enc_profile_stop: module was not started last", 500);
+  frame = &prof_stack[--prof_depth];
+  ticks -= frame->start;
+
+  prof_ticks[enc_prof_slice_type][stage] += ticks - frame->nested;
+  prof_total[enc_prof_slice_type][stage] += ticks;
+  prof_calls[enc_prof_slice_type][stage]++;
+  if (prof_depth > 0)
+    prof_stack[prof_depth - 1].nested += ticks;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns the milliseconds per tick measured since enc_profile_init()
+ *    and the elapsed time in *total_ms
+ ************************************************************************
+ */
+static double calibrate(double *total_ms)
+{
+  TIME_T now;
+  unsigned long long total_ticks = enc_prof_ticks() - prof_start_ticks;
+
+  gettime(&now);
+  *total_ms = (double) timenorm(timediff(&prof_start_time, &now) * 1000) * 0.001;
+
+  return total_ticks ? *total_ms / (double) total_ticks : 0.0;
+}
+
+//! sums the ticks or calls of one stage over all slice types
+static unsigned long long sum_stage(unsigned long long values[PROF_NUM_SLICE_TYPES][PROF_NUM_STAGES], int stage)
+{
+  unsigned long long sum = 0;
+  int type;
+
+  for (type = 0; type < PROF_NUM_SLICE_TYPES; type++)
+    sum += values[type][stage];
+  return sum;
+}
+
+//! sums one counter over all slice types
+static unsigned long long sum_counter(int counter)
+{
+  unsigned long long sum = 0;
+  int type;
+
+  for (type = 0; type < PROF_NUM_SLICE_TYPES; type++)
+    sum += enc_prof_counts[type][counter];
+  return sum;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Appends the module self times and counters since the last call to
+ *    stat_profile.csv, which the first call of a run recreates. Called
+ *    from report_frame_statistic().
+ ************************************************************************
+ */
+void enc_profile_report_frame(int frame_no, int slice_type)
+{
+  double total_ms, ms_per_tick = calibrate(&total_ms);
+  unsigned long long counts[PROF_NUM_COUNTERS];
+  int stage, counter;
+  FILE *f;
+
+  if ((f = fopen(PROF_FRAME_FILE, frame_file_open ? "a" : "w")) == NULL)
+  {
+    fprintf(stderr, "Error open file %s\n", PROF_FRAME_FILE);
+    return;
+  }
+
+  if (!frame_file_open)
+  {
+    frame_file_open = 1;
+    fprintf(f, "frame,type");
+    for (stage = 0; stage < PROF_NUM_STAGES; stage++)
+      fprintf(f, ",%s_ms", stage_names[stage]);
+    for (counter = 0; counter < PROF_NUM_COUNTERS; counter++)
+      fprintf(f, ",%s", counter_names[counter]);
+    fprintf(f, ",me_dist_per_mb,rdo_cand_per_mb\n");
+  }
+
+  fprintf(f, "%d,%s", frame_no, slice_type_names[(slice_type >= 0 && slice_type < PROF_NUM_SLICE_TYPES) ? slice_type : P_SLICE]);
+  for (stage = 0; stage < PROF_NUM_STAGES; stage++)
+  {
+    unsigned long long ticks = sum_stage(prof_ticks, stage);
+
+    fprintf(f, ",%.3f", (ticks - last_ticks[stage]) * ms_per_tick);
+    last_ticks[stage] = ticks;
+  }
+  for (counter = 0; counter < PROF_NUM_COUNTERS; counter++)
+  {
+    unsigned long long count = sum_counter(counter);
+
+    counts[counter] = count - last_counts[counter];
+    last_counts[counter] = count;
+    fprintf(f, ",%llu", counts[counter]);
+  }
+  fprintf(f, ",%.1f,%.2f\n",
+    counts[PROF_CNT_MB] ? (double) counts[PROF_CNT_ME_DIST] / counts[PROF_CNT_MB] : 0.0,
+    counts[PROF_CNT_MB] ? (double) counts[PROF_CNT_RDO] / counts[PROF_CNT_MB] : 0.0);
+  fclose(f);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Writes the timers and counters of one slice type (or all of them if
+ *    slice_type is negative) as JSON object members
+ ************************************************************************
+ */
+static void write_json_stages(FILE *f, int slice_type, double ms_per_tick, const char *indent)
+{
+  unsigned long long counts[PROF_NUM_COUNTERS];
+  int stage, counter, type;
+
+  fprintf(f, "%s\"modules\": {\n", indent);
+  for (stage = 0; stage < PROF_NUM_STAGES; stage++)
+  {
+    unsigned long long ticks = 0, total = 0, calls = 0;
+
+    for (type = 0; type < PROF_NUM_SLICE_TYPES; type++)
+    {
+      if (slice_type < 0 || slice_type == type)
+      {
+        ticks += prof_ticks[type][stage];
+        total += prof_total[type][stage];
+        calls += prof_calls[type][stage];
+      }
+    }
+    fprintf(f, "%s  \"%s\": {\"ms\": %.3f, \"total_ms\": %.3f, \"calls\": %llu}%s\n", indent, stage_names[stage],
+      ticks * ms_per_tick, total * ms_per_tick, calls, stage < PROF_NUM_STAGES - 1 ? "," : "");
+  }
+  fprintf(f, "%s},\n", indent);
+
+  for (counter = 0; counter < PROF_NUM_COUNTERS; counter++)
+  {
+    counts[counter] = 0;
+    for (type = 0; type < PROF_NUM_SLICE_TYPES; type++)
+    {
+      if (slice_type < 0 || slice_type == type)
+        counts[counter] += enc_prof_counts[type][counter];
+    }
+  }
+  fprintf(f, "%s\"counters\": {\"mbs\": %llu, \"me_dist\": %llu, \"rdo_cand\": %llu, \"me_dist_per_mb\": %.1f, \"rdo_cand_per_mb\": %.2f}",
+    indent, counts[PROF_CNT_MB], counts[PROF_CNT_ME_DIST], counts[PROF_CNT_RDO],
+    counts[PROF_CNT_MB] ? (double) counts[PROF_CNT_ME_DIST] / counts[PROF_CNT_MB] : 0.0,
+    counts[PROF_CNT_MB] ? (double) counts[PROF_CNT_RDO] / counts[PROF_CNT_MB] : 0.0);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Prints the per-module times and counters and writes the JSON summary
+ ************************************************************************
+ */
+void enc_profile_report(int num_frames)
+{
+  double total_ms, ms_per_tick = calibrate(&total_ms);
+  unsigned long long mbs = sum_counter(PROF_CNT_MB);
+  int stage, counter, type, first = 1;
+  FILE *f;
+
+  fprintf(stdout,"-------------------- Encoder module profile -----------------------------------\n");
+  fprintf(stdout," Module       Self time(ms)   Share  Incl. nested(ms)       Calls\n");
+  for (stage = 0; stage < PROF_NUM_STAGES; stage++)
+  {
+    double ms = sum_stage(prof_ticks, stage) * ms_per_tick;
+
+    fprintf(stdout," %-12s %13.3f %6.1f%% %17.3f %11llu\n", stage_names[stage], ms,
+      total_ms > 0.0 ? 100.0 * ms / total_ms : 0.0, sum_stage(prof_total, stage) * ms_per_tick, sum_stage(prof_calls, stage));
+  }
+  fprintf(stdout," %-12s %13.3f\n", "total", total_ms);
+  fprintf(stdout," Counter                Count      Per MB\n");
+  for (counter = 0; counter < PROF_NUM_COUNTERS; counter++)
+  {
+    unsigned long long count = sum_counter(counter);
+
+    fprintf(stdout," %-12s %14llu %11.2f\n", counter_names[counter], count, mbs ? (double) count / mbs : 0.0);
+  }
+
+  if (prof_filename[0] == '\0')
+    return;
+
+  if ((f = fopen(prof_filename, "w")) == NULL)
+  {
+    fprintf(stderr, "Error open file %s\n", prof_filename);
+    return;
+  }
+
+  fprintf(f, "{\n");
+  fprintf(f, "  \"frames\": %d,\n", num_frames);
+  fprintf(f, "  \"total_ms\": %.3f,\n", total_ms);
+  write_json_stages(f, -1, ms_per_tick, "  ");
+  fprintf(f, ",\n");
+  fprintf(f, "  \"slice_types\": {");
+  for (type = 0; type < PROF_NUM_SLICE_TYPES; type++)
+  {
+    for (stage = 0; stage < PROF_NUM_STAGES && prof_calls[type][stage] == 0; stage++)
+      ;
+    if (stage == PROF_NUM_STAGES && enc_prof_counts[type][PROF_CNT_MB] == 0)
+      continue;
+    fprintf(f, "%s\n    \"%s\": {\n", first ? "" : ",", slice_type_names[type]);
+    write_json_stages(f, type, ms_per_tick, "      ");
+    fprintf(f, "\n    }");
+    first = 0;
+  }
+  fprintf(f, "\n  }\n}\n");
+  fclose(f);
+}
+
+#endif
@@ -61,6 +61,7 @@
 #include "rdopt.h"
 #include "sei.h"
 #include "configfile.h"
+#include "enc_profile.h"
 
 
 extern void DeblockFrame              (VideoParameters *p_Vid, imgpel **, imgpel ***);
@@ -85,7 +86,6 @@ static void ReportFirstframe   (VideoParameters *p_Vid, InputParameters *p_Inp,
 static void ReportI            (VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_Stats, int64 tmp_time);
 static void ReportP            (VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_Stats, int64 tmp_time);
 static void ReportB            (VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_Stats, int64 tmp_time);
-static void ReportNALNonVLCBits(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_Stats, int64 tmp_time);
 
 extern void rd_picture_coding(VideoParameters *p_Vid, InputParameters *p_Inp);
 
@@ -209,7 +209,11 @@ static void code_a_plane(VideoParameters *p_Vid, InputParameters *p_Inp)
   FmoEndPicture ();
 
   if ((p_Inp->SkipDeBlockNonRef == 0) || (p_Vid->nal_reference_idc != 0))
+  {
+    ENC_PROF_START(PROF_DEBLOCK);
     DeblockFrame (p_Vid, p_Vid->enc_picture->imgY, p_Vid->enc_picture->imgUV); //comment out to disable deblocking filter
+    ENC_PROF_STOP(PROF_DEBLOCK);
+  }
 }
 /*!
  ************************************************************************
@@ -434,9 +438,11 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
                                // (and not to one of the field structures)
   init_frame (p_Vid, p_Inp);
 
+  ENC_PROF_START(PROF_INPUT);
   file_read = ReadOneFrame (p_Vid, &p_Inp->input_file1, p_Vid->frm_no_in_file, p_Inp->infile_header, &p_Inp->source, &p_Inp->output, p_Vid->imgData0.frm_data);
   if ( !file_read )
   {
+    ENC_PROF_STOP(PROF_INPUT);
     // end of file or stream found: trigger error handling
     getNumberOfFrames(p_Inp, &p_Inp->input_file1);
     fprintf(stdout, "\nIncorrect FramesToBeEncoded: actual number is %6d frames!\n", p_Inp->no_frames );
@@ -447,6 +453,8 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
 
   ProcessImage(p_Vid, p_Inp);
   PaddAutoCropBorders (p_Inp->output, p_Vid->width, p_Vid->height, p_Vid->width_cr, p_Vid->height_cr, p_Vid->imgData.frm_data);
+  ResetOrgStats(p_Vid);
+  ENC_PROF_STOP(PROF_INPUT);
 
 
 
@@ -654,7 +662,9 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
       UpdatePixelMap (p_Vid, p_Inp);
   }
 
+  ENC_PROF_START(PROF_METRICS);
   compute_distortion(p_Vid, &p_Vid->imgData);
+  ENC_PROF_STOP(PROF_METRICS);
 
   // redundant pictures: save reconstruction to calculate SNR and replace reference picture
   if(p_Inp->redundant_pic_flag)
@@ -755,9 +765,6 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   tmp_time  = timenorm(tmp_time);
   p_Vid->me_time   = timenorm(p_Vid->me_time);
 
-  if (p_Vid->p_Stats->bit_ctr_parametersets_n!=0 && p_Inp->Verbose != 3)
-    ReportNALNonVLCBits(p_Vid, p_Inp, p_Vid->p_Stats, tmp_time);
-
   if (p_Vid->curr_frm_idx == 0)
     ReportFirstframe(p_Vid, p_Inp, p_Vid->p_Stats, tmp_time);
   else
@@ -1012,7 +1019,9 @@ void frame_picture (VideoParameters *p_Vid, Picture *frame, ImageData *imgData,
 
   if (p_Vid->structure==FRAME)
   {
+    ENC_PROF_START(PROF_METRICS);
     find_distortion (p_Vid, imgData);
+    ENC_PROF_STOP(PROF_METRICS);
     frame->distortion = p_Vid->p_Dist->metric[SSE];
   }
 }
@@ -1171,7 +1180,9 @@ static void distortion_fld (VideoParameters *p_Vid, InputParameters *p_Inp, Pict
     p_Vid->pImgOrg[2] = imgData->frm_data[2];
   }
 
+  ENC_PROF_START(PROF_METRICS);
   find_distortion (p_Vid, imgData);   // find snr from original frame picture
+  ENC_PROF_STOP(PROF_METRICS);
   field_pic->distortion = p_Vid->p_Dist->metric[SSE];
 }
 
@@ -1629,127 +1640,165 @@ Boolean dummy_slice_too_big (int bits_slice)
   return FALSE;
 }
 
-static void ReportSimple(VideoParameters *p_Vid, char *pic_type, int cur_bits, DistMetric *metric, int tmp_time)
+static void ReportSimple(FrameReport *r, DistMetric *metric)
 {
   printf ("%05d(%3s)%8d   %2d %7.3f %7.3f %7.3f %9d %7d    %3s    %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, 
-    p_Vid->AverageFrameQP,
+    r->frm_no_in_file, r->pic_type, r->cur_bits, 
+    r->qp,
     metric->value[0], metric->value[1], metric->value[2], 
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", 
-    p_Vid->nal_reference_idc);
+    r->tmp_time, r->me_time,
+    r->fld_flag ? "FLD" : "FRM", 
+    r->nal_reference_idc);
 }
 
-static void ReportVerbose(VideoParameters *p_Vid, char *pic_type, int cur_bits, int wp_method, int lambda, DistMetric *mPSNR, int tmp_time, int direct_mode)
+static void ReportVerbose(FrameReport *r, DistMetric *mPSNR)
 {
   printf ("%05d(%3s)%8d %1d %2d %2d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, r->pic_type, r->cur_bits, r->wp_method,
+    r->qp, r->lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    r->tmp_time, r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, r->direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
 }
 
-static void ReportVerboseNVB(VideoParameters *p_Vid, char *pic_type, int cur_bits, int nvb_bits, int wp_method, int lambda, DistMetric *mPSNR, int tmp_time, int direct_mode)
+static void ReportVerboseNVB(FrameReport *r, DistMetric *mPSNR)
 {
   printf ("%05d(%3s)%8d %3d  %1d %2d %2d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, nvb_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, r->pic_type, r->cur_bits + r->nvb_bits, r->nvb_bits, r->wp_method,
+    r->qp, r->lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    r->tmp_time, r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, r->direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
 }
 
-static void ReportVerboseFDN(VideoParameters *p_Vid, char *pic_type, int cur_bits, int fdn_bits, int nvb_bits, int wp_method, int lambda, DistMetric *mPSNR, int tmp_time, int direct_mode)
+static void ReportVerboseFDN(FrameReport *r, DistMetric *mPSNR)
 {
   printf ("%05d(%3s)%8d %8d %3d  %1d %2d %2d %7.3f %7.3f %7.3f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, fdn_bits, nvb_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, r->pic_type, r->cur_bits + r->nvb_bits, r->fdn_bits, r->nvb_bits, r->wp_method,
+    r->qp, r->lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2],     
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    r->tmp_time, r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, r->direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
 }
 
-static void ReportVerboseSSIM(VideoParameters *p_Vid, char *pic_type, int cur_bits, int wp_method, int lambda, DistMetric *mPSNR, DistMetric *mSSIM,int tmp_time, int direct_mode)
+static void ReportVerboseSSIM(FrameReport *r, DistMetric *mPSNR, DistMetric *mSSIM)
 {
   printf ("%05d(%3s)%8d %1d %2d %2d %7.3f %7.3f %7.3f %7.4f %7.4f %7.4f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, r->pic_type, r->cur_bits, r->wp_method,
+    r->qp, r->lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2], 
     mSSIM->value[0], mSSIM->value[1], mSSIM->value[2], 
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active,p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    r->tmp_time, r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, r->direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active,r->rd_pass, r->nal_reference_idc);
 }
 
-static void ReportVerboseNVBSSIM(VideoParameters *p_Vid, char *pic_type, int cur_bits, int nvb_bits, int wp_method, int lambda, DistMetric *mPSNR, DistMetric *mSSIM,int tmp_time, int direct_mode)
+static void ReportVerboseNVBSSIM(FrameReport *r, DistMetric *mPSNR, DistMetric *mSSIM)
 {
   printf ("%05d(%3s)%8d %3d  %1d %2d %2d %7.3f %7.3f %7.3f %7.4f %7.4f %7.4f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, nvb_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, r->pic_type, r->cur_bits + r->nvb_bits, r->nvb_bits, r->wp_method,
+    r->qp, r->lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2], 
     mSSIM->value[0], mSSIM->value[1], mSSIM->value[2], 
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    r->tmp_time, r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, r->direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
 }
 
-static void ReportVerboseFDNSSIM(VideoParameters *p_Vid, char *pic_type, int cur_bits, int fdn_bits, int nvb_bits, int wp_method, int lambda, DistMetric *mPSNR, DistMetric *mSSIM,int tmp_time, int direct_mode)
+static void ReportVerboseFDNSSIM(FrameReport *r, DistMetric *mPSNR, DistMetric *mSSIM)
 {
   printf ("%05d(%3s)%8d %8d %3d  %1d %2d %2d %7.3f %7.3f %7.3f %7.4f %7.4f %7.4f %9d %7d    %3s %5d %1d %2d %2d  %d   %d\n",
-    p_Vid->frm_no_in_file, pic_type, cur_bits, fdn_bits, nvb_bits, wp_method,
-    p_Vid->AverageFrameQP, lambda, 
+    r->frm_no_in_file, r->pic_type, r->cur_bits + r->nvb_bits, r->fdn_bits, r->nvb_bits, r->wp_method,
+    r->qp, r->lambda, 
     mPSNR->value[0], mPSNR->value[1], mPSNR->value[2], 
     mSSIM->value[0], mSSIM->value[1], mSSIM->value[2], 
-    tmp_time, (int) p_Vid->me_time,
-    p_Vid->fld_flag ? "FLD" : "FRM", p_Vid->intras, direct_mode,
-    p_Vid->num_ref_idx_l0_active, p_Vid->num_ref_idx_l1_active, p_Vid->rd_pass, p_Vid->nal_reference_idc);
+    r->tmp_time, r->me_time,
+    r->fld_flag ? "FLD" : "FRM", r->intras, r->direct_mode,
+    r->num_ref_idx_l0_active, r->num_ref_idx_l1_active, r->rd_pass, r->nal_reference_idc);
 }
 
-
-static void ReportNALNonVLCBits(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_Stats, int64 tmp_time)
+/*!
+ ************************************************************************
+ * \brief
+ *    prints the report line of a coded frame, preceded by the non-VCL
+ *    bits line if needed
+ ************************************************************************
+ */
+void report_frame_line(InputParameters *p_Inp, FrameReport *r, DistMetric *mPSNR, DistMetric *mSSIM)
 {
   //! Need to add type (i.e. SPS, PPS, SEI etc).
-  if (p_Inp->Verbose != 0)
-    printf ("%05d(NVB)%8d \n", p_Vid->frame_no, p_Stats->bit_ctr_parametersets_n);
-}
-
-static void ReportFirstframe(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *stats, int64 tmp_time)
-{
-  int cur_bits = (int)(stats->bit_ctr - stats->bit_ctr_n)
-    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
+  if (r->nvb_line)
+    printf ("%05d(NVB)%8d \n", r->frame_no, r->nvb_bits);
 
   if (p_Inp->Verbose == 1)
   {
-    ReportSimple(p_Vid, "IDR", cur_bits, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time);
+    ReportSimple(r, mPSNR);
   }
   else if (p_Inp->Verbose == 2)
   {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->AverageFrameQP][0];
     if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseSSIM(p_Vid, "IDR", cur_bits, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
+      ReportVerboseSSIM(r, mPSNR, mSSIM);
     else
-      ReportVerbose(p_Vid, "IDR", cur_bits, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
+      ReportVerbose(r, mPSNR);
   }
   else if (p_Inp->Verbose == 3)
   {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->AverageFrameQP][0];
     if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseNVBSSIM(p_Vid, "IDR", cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
+      ReportVerboseNVBSSIM(r, mPSNR, mSSIM);
     else
-      ReportVerboseNVB(p_Vid, "IDR", cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
+      ReportVerboseNVB(r, mPSNR);
   }
   else if (p_Inp->Verbose == 4)
   {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->AverageFrameQP][0];
     if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseFDNSSIM(p_Vid, "IDR", cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
+      ReportVerboseFDNSSIM(r, mPSNR, mSSIM);
     else
-      ReportVerboseFDN(p_Vid, "IDR", cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
+      ReportVerboseFDN(r, mPSNR);
   }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    collects the report line values of the coded frame and hands them
+ *    to the distortion module, which prints them with the frame metrics
+ ************************************************************************
+ */
+static void ReportFrame(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *stats, int64 tmp_time, char *pic_type, int wp_method, int lambda_type, int direct_mode)
+{
+  FrameReport r;
+
+  r.nvb_line  = (stats->bit_ctr_parametersets_n != 0) && (p_Inp->Verbose != 0) && (p_Inp->Verbose != 3);
+  r.frame_no  = p_Vid->frame_no;
+  r.nvb_bits  = stats->bit_ctr_parametersets_n;
+  r.cur_bits  = (int)(stats->bit_ctr - stats->bit_ctr_n)
+    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
+  r.fdn_bits  = (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
+  r.frm_no_in_file = p_Vid->frm_no_in_file;
+  strncpy(r.pic_type, pic_type, 4);
+  r.pic_type[3] = '\0';
+  r.wp_method = wp_method;
+  r.qp        = p_Vid->AverageFrameQP;
+  r.lambda    = (p_Inp->Verbose >= 2) ? (int) p_Vid->lambda_me[lambda_type][p_Vid->AverageFrameQP][0] : 0;
+  r.tmp_time  = (int) tmp_time;
+  r.me_time   = (int) p_Vid->me_time;
+  r.fld_flag  = p_Vid->fld_flag;
+  r.intras    = p_Vid->intras;
+  r.direct_mode = direct_mode;
+  r.num_ref_idx_l0_active = p_Vid->num_ref_idx_l0_active;
+  r.num_ref_idx_l1_active = p_Vid->num_ref_idx_l1_active;
+  r.rd_pass   = p_Vid->rd_pass;
+  r.nal_reference_idc = p_Vid->nal_reference_idc;
+
+  report_distortion(p_Vid, &r);
+}
+
+static void ReportFirstframe(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *stats, int64 tmp_time)
+{
+  ReportFrame(p_Vid, p_Inp, stats, tmp_time, "IDR", 0, I_SLICE, 0);
 
   stats->bit_counter[I_SLICE] = stats->bit_ctr;
   stats->bit_ctr = 0;
@@ -1758,8 +1807,6 @@ static void ReportFirstframe(VideoParameters *p_Vid, InputParameters *p_Inp, Sta
 static void ReportI(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *stats, int64 tmp_time)
 {
   char pic_type[4];
-  int  cur_bits = (int)(stats->bit_ctr - stats->bit_ctr_n)
-    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
 
   if ((p_Inp->redundant_pic_flag == 0) || !p_Vid->redundant_coding )
   {
@@ -1773,88 +1820,18 @@ static void ReportI(VideoParameters *p_Vid, InputParameters *p_Inp, StatParamete
   else
     strcpy(pic_type,"R");
 
-  if (p_Inp->Verbose == 1)
-  {
-    ReportSimple(p_Vid, pic_type, cur_bits, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time);
-  }
-  else if (p_Inp->Verbose == 2)
-  {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->AverageFrameQP][0];
-    if (p_Inp->Distortion[SSIM] == 1)
-    {
-      ReportVerboseSSIM(p_Vid, pic_type, cur_bits, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    }
-    else
-    {
-      ReportVerbose(p_Vid, pic_type, cur_bits, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-    }
-  }
-  else if (p_Inp->Verbose == 3)
-  {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->AverageFrameQP][0];
-    if (p_Inp->Distortion[SSIM] == 1)
-    {
-      ReportVerboseNVBSSIM(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    }
-    else
-    {
-      ReportVerboseNVB(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-    }
-  }
-  else if (p_Inp->Verbose == 4)
-  {
-    int lambda = (int) p_Vid->lambda_me[I_SLICE][p_Vid->AverageFrameQP][0];
-    if (p_Inp->Distortion[SSIM] == 1)
-    {
-      ReportVerboseFDNSSIM(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    }
-    else
-    {
-      ReportVerboseFDN(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, 0, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-    }
-  }
+  ReportFrame(p_Vid, p_Inp, stats, tmp_time, pic_type, 0, I_SLICE, 0);
 }
 
 static void ReportB(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *stats, int64 tmp_time)
 {
-  int cur_bits = (int)(stats->bit_ctr - stats->bit_ctr_n)
-    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
-
-  if (p_Inp->Verbose == 1)
-  {
-    ReportSimple(p_Vid, " B ", cur_bits, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time);
-  }
-  else if (p_Inp->Verbose == 2)
-  {
-    int lambda = (int) p_Vid->lambda_me[p_Vid->nal_reference_idc ? 5 : B_SLICE][p_Vid->AverageFrameQP][0];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseSSIM(p_Vid, " B ", cur_bits, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-    else
-      ReportVerbose(p_Vid, " B ", cur_bits, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-  }
-  else if (p_Inp->Verbose == 3)
-  {
-    int lambda = (int) p_Vid->lambda_me[p_Vid->nal_reference_idc ? 5 : B_SLICE][p_Vid->AverageFrameQP][0];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseNVBSSIM(p_Vid, " B ", cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-    else
-      ReportVerboseNVB(p_Vid, " B ", cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-  }
-  else if (p_Inp->Verbose == 4)
-  {
-    int lambda = (int) p_Vid->lambda_me[p_Vid->nal_reference_idc ? 5 : B_SLICE][p_Vid->AverageFrameQP][0];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseFDNSSIM(p_Vid, " B ", cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-    else
-      ReportVerboseFDN(p_Vid, " B ", cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_bipred_idc, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, p_Vid->direct_spatial_mv_pred_flag);
-  }
+  ReportFrame(p_Vid, p_Inp, stats, tmp_time, " B ", p_Vid->active_pps->weighted_bipred_idc,
+    p_Vid->nal_reference_idc ? 5 : B_SLICE, p_Vid->direct_spatial_mv_pred_flag);
 }
 
 static void ReportP(VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *stats, int64 tmp_time)
 {
   char pic_type[4];
-  int  cur_bits = (int)(stats->bit_ctr - stats->bit_ctr_n)
-    + (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n);
 
   if (p_Vid->type == SP_SLICE)
     strcpy(pic_type,"SP ");
@@ -1863,34 +1840,7 @@ static void ReportP(VideoParameters *p_Vid, InputParameters *p_Inp, StatParamete
   else
     strcpy(pic_type," R ");
 
-  if (p_Inp->Verbose == 1)
-  {
-    ReportSimple(p_Vid, pic_type, cur_bits, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time);
-  }
-  else if (p_Inp->Verbose == 2)
-  {
-    int lambda = (int) p_Vid->lambda_me[P_SLICE][p_Vid->AverageFrameQP][0];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseSSIM(p_Vid, pic_type, cur_bits, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    else
-      ReportVerbose(p_Vid, pic_type, cur_bits, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-  }
-  else if (p_Inp->Verbose == 3)
-  {
-    int lambda = (int) p_Vid->lambda_me[P_SLICE][p_Vid->AverageFrameQP][0];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseNVBSSIM(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    else
-      ReportVerboseNVB(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-  }
-  else if (p_Inp->Verbose == 4)
-  {
-    int lambda = (int) p_Vid->lambda_me[P_SLICE][p_Vid->AverageFrameQP][0];    
-    if (p_Inp->Distortion[SSIM] == 1)
-      ReportVerboseFDNSSIM(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], &p_Vid->p_Dist->metric[SSIM], (int) tmp_time, 0);
-    else
-      ReportVerboseFDN(p_Vid, pic_type, cur_bits + stats->bit_ctr_parametersets_n, (int)(stats->bit_ctr_filler_data - stats->bit_ctr_filler_data_n), stats->bit_ctr_parametersets_n, p_Vid->active_pps->weighted_pred_flag, lambda, &p_Vid->p_Dist->metric[PSNR], (int) tmp_time, 0);
-  }
+  ReportFrame(p_Vid, p_Inp, stats, tmp_time, pic_type, p_Vid->active_pps->weighted_pred_flag, P_SLICE, 0);
 }
 
 /*!
@@ -29,7 +29,6 @@
  */
 void find_snr(VideoParameters *p_Vid, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metricSSE, DistMetric *metricPSNR)
 {
-  DistortionParams *p_Dist = p_Vid->p_Dist;
   FrameFormat *format = &imgREF->format;
   // Luma.
   metricSSE ->value[0] = (float) compute_SSE(imgREF->data[0], imgSRC->data[0], 0, 0, format->height, format->width);
@@ -43,12 +42,4 @@ void find_snr(VideoParameters *p_Vid, ImageStructure *imgREF, ImageStructure *im
     metricSSE ->value[2] = (float) compute_SSE(imgREF->data[2], imgSRC->data[2], 0, 0, format->height_cr, format->width_cr);
     metricPSNR->value[2] = psnr(format->max_value_sq[2], format->size_cmp[2], metricSSE->value[2]);
   }
-   
-  {
-    accumulate_average(metricSSE,  p_Dist->frame_ctr);
-    accumulate_average(metricPSNR, p_Dist->frame_ctr);
-
-    accumulate_avslice(metricSSE,  p_Vid->type, p_Vid->p_Stats->frame_ctr[p_Vid->type]);
-    accumulate_avslice(metricPSNR, p_Vid->type, p_Vid->p_Stats->frame_ctr[p_Vid->type]);
-  }
 }
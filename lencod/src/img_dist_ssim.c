@@ -1,4 +1,3 @@
-
 /*!
  *************************************************************************************
  * \file img_dist_ssim.c
@@ -6,79 +5,442 @@
  * \brief
  *    Compute structural similarity (SSIM) index using the encoded image and the reference image
  *
+ *    The window sums are formed with separable running sums: the column sums over
+ *    the window height are updated by the rows entering and leaving the window and
+ *    the window sums slide along these column sums. The pictures are split into
+ *    bands of window rows that are processed in parallel (SSIMThreads). The per window
+ *    terms are kept and summed in raster order, so the results do not depend on the
+ *    number of bands.
+ *
  * \author
  *    Main contributors (see contributors.h for copyright, address and affiliation details)
  *     - Woo-Shik Kim                    <wooshik.kim@usc.edu>
- *     - Zhen Li                         <zli@dolby.com> 
+ *     - Zhen Li                         <zli@dolby.com>
  *     - Alexis Michael Tourapis         <alexismt@ieee.org>
  *************************************************************************************
  */
 #include "contributors.h"
 #include "global.h"
 #include "img_distortion.h"
+#include "img_dist_ssim.h"
 #include "enc_statistics.h"
+#include "memalloc.h"
+
+#if !defined(WIN32)
+#include <pthread.h>
+#endif
 
 //#define UNBIASED_VARIANCE // unbiased estimation of the variance
 
-float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int comp)
+#define SSIM_MAX_THREADS    64  //!< maximum number of bands
+#define SSIM_MIN_BAND_ROWS  32  //!< minimum number of window rows per band
+
+//! window sums
+enum {
+  SUM_ORG = 0,
+  SUM_ENC,
+  SQR_ORG,
+  SQR_ENC,
+  SUM_CROSS,
+  SSIM_SUMS
+};
+
+//! one band of window rows
+typedef struct ssim_band
 {
+  imgpel **refImg;
+  imgpel **encImg;
+  int    width;
+  int    win_height;
+  int    win_width;
+  int    step;              //!< window distance (SSIMOverlapSize)
+  int    nwin_x;            //!< windows per window row
+  int    first_row;         //!< first window row of the band
+  int    last_row;          //!< first window row after the band
+  int    term;              //!< SSIMTerm
+  float  C1;
+  float  C2;
+  float  win_pixels;
+  float  win_pixels_bias;
+  float *values;            //!< per window terms of the band
+} SSIMBand;
 
-  static const float K1 = 0.01f, K2 = 0.03f;
-  float max_pix_value_sqd;
-  float C1, C2;
-  float win_pixels = (float) (win_width * win_height);
-#ifdef UNBIASED_VARIANCE
-  float win_pixels_bias = win_pixels - 1;
-#else
-  float win_pixels_bias = win_pixels;
-#endif
+/*!
+ ************************************************************************
+ * \brief
+ *    SSIM term of one window
+ ************************************************************************
+ */
+static inline float ssim_window(SSIMBand *b, int imeanOrg, int imeanEnc, int ivarOrg, int ivarEnc, int icovOrgEnc)
+{
   float mb_ssim, meanOrg, meanEnc;
   float varOrg, varEnc, covOrgEnc;
-  int imeanOrg, imeanEnc, ivarOrg, ivarEnc, icovOrgEnc;
-  float cur_distortion = 0.0;
-  int i, j, n, m, win_cnt = 0;
-  int overlapSize = p_Inp->SSIMOverlapSize;
 
-  max_pix_value_sqd = (float) (p_Vid->max_pel_value_comp[comp] * p_Vid->max_pel_value_comp[comp]);
-  C1 = K1 * K1 * max_pix_value_sqd;
-  C2 = K2 * K2 * max_pix_value_sqd;
+  meanOrg = (float) imeanOrg / b->win_pixels;
+  meanEnc = (float) imeanEnc / b->win_pixels;
+
+  if (b->term == SSIM_LUMINANCE)
+  {
+    mb_ssim  = (float) (2.0 * meanOrg * meanEnc + b->C1);
+    mb_ssim /= (float) (meanOrg * meanOrg + meanEnc * meanEnc + b->C1);
+    return mb_ssim;
+  }
+
+  varOrg    = ((float) ivarOrg - ((float) imeanOrg) * meanOrg) / b->win_pixels_bias;
+  varEnc    = ((float) ivarEnc - ((float) imeanEnc) * meanEnc) / b->win_pixels_bias;
+  covOrgEnc = ((float) icovOrgEnc - ((float) imeanOrg) * meanEnc) / b->win_pixels_bias;
+
+  if (b->term == SSIM_STRUCTURE)
+  {
+    mb_ssim  = (float) (2.0 * covOrgEnc + b->C2);
+    mb_ssim /= (float) (varOrg + varEnc + b->C2);
+  }
+  else
+  {
+    mb_ssim  = (float) ((2.0 * meanOrg * meanEnc + b->C1) * (2.0 * covOrgEnc + b->C2));
+    mb_ssim /= (float) (meanOrg * meanOrg + meanEnc * meanEnc + b->C1) * (varOrg + varEnc + b->C2);
+  }
+  return mb_ssim;
+}
+
+#if defined(__SSE2__) && (IMGTYPE < 2)
+#include <emmintrin.h>
+
+//! loads 8 samples zero extended to 16 bit
+static inline __m128i load_pels8(const imgpel *p)
+{
+#if (IMGTYPE == 0)
+  return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) p), _mm_setzero_si128());
+#else
+  return _mm_loadu_si128((const __m128i *) p);
+#endif
+}
+
+//! adds (sub = 0) or subtracts (sub = 1) the sums of 4 pel pairs held in 32 bit lanes
+static inline void update_cols4(unsigned int **cols, int i, __m128i r, __m128i e, int sub)
+{
+  __m128i v[SSIM_SUMS];
+  int k;
+
+  v[SUM_ORG]   = r;
+  v[SUM_ENC]   = e;
+  v[SQR_ORG]   = _mm_madd_epi16(r, r);
+  v[SQR_ENC]   = _mm_madd_epi16(e, e);
+  v[SUM_CROSS] = _mm_madd_epi16(r, e);
+
+  for (k = 0; k < SSIM_SUMS; ++k)
+  {
+    __m128i *c = (__m128i *) &cols[k][i];
+    __m128i  s = _mm_loadu_si128(c);
+    _mm_storeu_si128(c, sub ? _mm_sub_epi32(s, v[k]) : _mm_add_epi32(s, v[k]));
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    adds (sub = 0) or subtracts (sub = 1) one row of pels to the
+ *    column sums (SSE2)
+ ************************************************************************
+ */
+static inline void update_cols(unsigned int **cols, const imgpel *ref, const imgpel *enc, int width, int sub)
+{
+  __m128i zero = _mm_setzero_si128();
+  int i, k;
+
+  for (i = 0; i + 8 <= width; i += 8)
+  {
+    __m128i r = load_pels8(ref + i);
+    __m128i e = load_pels8(enc + i);
+
+    update_cols4(cols, i,     _mm_unpacklo_epi16(r, zero), _mm_unpacklo_epi16(e, zero), sub);
+    update_cols4(cols, i + 4, _mm_unpackhi_epi16(r, zero), _mm_unpackhi_epi16(e, zero), sub);
+  }
+
+  for (; i < width; ++i)
+  {
+    unsigned int v[SSIM_SUMS];
+
+    v[SUM_ORG]   = ref[i];
+    v[SUM_ENC]   = enc[i];
+    v[SQR_ORG]   = ref[i] * ref[i];
+    v[SQR_ENC]   = enc[i] * enc[i];
+    v[SUM_CROSS] = ref[i] * enc[i];
+    for (k = 0; k < SSIM_SUMS; ++k)
+      cols[k][i] = sub ? cols[k][i] - v[k] : cols[k][i] + v[k];
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    SSIM terms of a row of windows (SSE2), four windows at a time with
+ *    the same single and double precision operations as ssim_window()
+ ************************************************************************
+ */
+static void ssim_window_row(SSIMBand *b, int **win, float *values)
+{
+  __m128  wp   = _mm_set1_ps(b->win_pixels);
+  __m128  bias = _mm_set1_ps(b->win_pixels_bias);
+  __m128  C1   = _mm_set1_ps(b->C1);
+  __m128  C2   = _mm_set1_ps(b->C2);
+  __m128d dC1  = _mm_set1_pd(b->C1);
+  __m128d dC2  = _mm_set1_pd(b->C2);
+  __m128d two  = _mm_set1_pd(2.0);
+  int i;
+
+  for (i = 0; i + 4 <= b->nwin_x; i += 4)
+  {
+    __m128 fo = _mm_cvtepi32_ps(_mm_loadu_si128((__m128i *) &win[SUM_ORG][i]));
+    __m128 fe = _mm_cvtepi32_ps(_mm_loadu_si128((__m128i *) &win[SUM_ENC][i]));
+    __m128 mo = _mm_div_ps(fo, wp);
+    __m128 me = _mm_div_ps(fe, wp);
+    __m128 num, den;
+
+    if (b->term == SSIM_LUMINANCE)
+    {
+      __m128d lo = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(two, _mm_cvtps_pd(mo)), _mm_cvtps_pd(me)), dC1);
+      __m128d hi = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(two, _mm_cvtps_pd(_mm_movehl_ps(mo, mo))), _mm_cvtps_pd(_mm_movehl_ps(me, me))), dC1);
+
+      num = _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+      den = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mo, mo), _mm_mul_ps(me, me)), C1);
+    }
+    else
+    {
+      __m128 vo = _mm_div_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_loadu_si128((__m128i *) &win[SQR_ORG][i])),   _mm_mul_ps(fo, mo)), bias);
+      __m128 ve = _mm_div_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_loadu_si128((__m128i *) &win[SQR_ENC][i])),   _mm_mul_ps(fe, me)), bias);
+      __m128 cv = _mm_div_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_loadu_si128((__m128i *) &win[SUM_CROSS][i])), _mm_mul_ps(fo, me)), bias);
+      __m128d cv_lo = _mm_add_pd(_mm_mul_pd(two, _mm_cvtps_pd(cv)), dC2);
+      __m128d cv_hi = _mm_add_pd(_mm_mul_pd(two, _mm_cvtps_pd(_mm_movehl_ps(cv, cv))), dC2);
+
+      den = _mm_add_ps(_mm_add_ps(vo, ve), C2);
+      if (b->term == SSIM_STRUCTURE)
+      {
+        num = _mm_movelh_ps(_mm_cvtpd_ps(cv_lo), _mm_cvtpd_ps(cv_hi));
+      }
+      else
+      {
+        __m128d lo = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(two, _mm_cvtps_pd(mo)), _mm_cvtps_pd(me)), dC1);
+        __m128d hi = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(two, _mm_cvtps_pd(_mm_movehl_ps(mo, mo))), _mm_cvtps_pd(_mm_movehl_ps(me, me))), dC1);
+
+        num = _mm_movelh_ps(_mm_cvtpd_ps(_mm_mul_pd(lo, cv_lo)), _mm_cvtpd_ps(_mm_mul_pd(hi, cv_hi)));
+        den = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mo, mo), _mm_mul_ps(me, me)), C1), den);
+      }
+    }
+    _mm_storeu_ps(&values[i], _mm_div_ps(num, den));
+  }
+
+  for (; i < b->nwin_x; ++i)
+    values[i] = ssim_window(b, win[SUM_ORG][i], win[SUM_ENC][i], win[SQR_ORG][i], win[SQR_ENC][i], win[SUM_CROSS][i]);
+}
+#else
+/*!
+ ************************************************************************
+ * \brief
+ *    adds (sub = 0) or subtracts (sub = 1) one row of pels to the
+ *    column sums
+ ************************************************************************
+ */
+static inline void update_cols(unsigned int **cols, const imgpel *ref, const imgpel *enc, int width, int sub)
+{
+  int i, k;
 
-  for (j = 0; j <= height - win_height; j += overlapSize)
+  for (i = 0; i < width; ++i)
   {
-    for (i = 0; i <= width - win_width; i += overlapSize)
+    unsigned int v[SSIM_SUMS];
+
+    v[SUM_ORG]   = ref[i];
+    v[SUM_ENC]   = enc[i];
+    v[SQR_ORG]   = ref[i] * ref[i];
+    v[SQR_ENC]   = enc[i] * enc[i];
+    v[SUM_CROSS] = ref[i] * enc[i];
+    for (k = 0; k < SSIM_SUMS; ++k)
+      cols[k][i] = sub ? cols[k][i] - v[k] : cols[k][i] + v[k];
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    SSIM terms of a row of windows
+ ************************************************************************
+ */
+static void ssim_window_row(SSIMBand *b, int **win, float *values)
+{
+  int i;
+
+  for (i = 0; i < b->nwin_x; ++i)
+    values[i] = ssim_window(b, win[SUM_ORG][i], win[SUM_ENC][i], win[SQR_ORG][i], win[SQR_ENC][i], win[SUM_CROSS][i]);
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    computes the SSIM terms of all windows of one band
+ ************************************************************************
+ */
+static void ssim_band(SSIMBand *b)
+{
+  unsigned int *cols[SSIM_SUMS];
+  int *win[SSIM_SUMS];
+  unsigned int *mem;
+  int width = b->width, step = b->step, nwin_x = b->nwin_x;
+  int win_width = b->win_width, win_height = b->win_height;
+  int row, i, j, k, m, n;
+
+  if (b->first_row >= b->last_row || nwin_x == 0)
+    return;
+
+  if ((mem = (unsigned int *) calloc(SSIM_SUMS * (width + nwin_x), sizeof(unsigned int))) == NULL)
+    no_mem_exit("ssim_band: mem");
+  for (k = 0; k < SSIM_SUMS; ++k)
+  {
+    cols[k] = mem + k * width;
+    win[k]  = (int *) mem + SSIM_SUMS * width + k * nwin_x;
+  }
+
+  for (row = b->first_row; row < b->last_row; ++row)
+  {
+    j = row * step;
+
+    // column sums over the rows j .. j + win_height - 1
+    if (row == b->first_row || step >= win_height)
+    {
+      memset(mem, 0, SSIM_SUMS * width * sizeof(unsigned int));
+      for (n = j; n < j + win_height; ++n)
+        update_cols(cols, b->refImg[n], b->encImg[n], width, 0);
+    }
+    else
     {
-      imeanOrg = 0;
-      imeanEnc = 0; 
-      ivarOrg  = 0;
-      ivarEnc  = 0;
-      icovOrgEnc = 0;
+      for (n = j - step; n < j; ++n)
+      {
+        update_cols(cols, b->refImg[n], b->encImg[n], width, 1);
+        update_cols(cols, b->refImg[n + win_height], b->encImg[n + win_height], width, 0);
+      }
+    }
+
+    // window sums
+    for (k = 0; k < SSIM_SUMS; ++k)
+    {
+      unsigned int *col = cols[k];
+      unsigned int sum = 0;
 
-      for ( n = j;n < j + win_height;n ++)
+      if (step == 1)
       {
-        for (m = i;m < i + win_width;m ++)
+        for (m = 0; m < win_width; ++m)
+          sum += col[m];
+        win[k][0] = (int) sum;
+        for (i = 1; i < nwin_x; ++i)
         {
-          imeanOrg   += refImg[n][m];
-          imeanEnc   += encImg[n][m];
-          ivarOrg    += refImg[n][m] * refImg[n][m];
-          ivarEnc    += encImg[n][m] * encImg[n][m];
-          icovOrgEnc += refImg[n][m] * encImg[n][m];
+          sum += col[i + win_width - 1] - col[i - 1];
+          win[k][i] = (int) sum;
         }
       }
+      else
+      {
+        for (i = 0; i < nwin_x; ++i)
+        {
+          for (m = i * step, sum = 0; m < i * step + win_width; ++m)
+            sum += col[m];
+          win[k][i] = (int) sum;
+        }
+      }
+    }
 
-      meanOrg = (float) imeanOrg / win_pixels;
-      meanEnc = (float) imeanEnc / win_pixels;
+    ssim_window_row(b, win, &b->values[(row - b->first_row) * nwin_x]);
+  }
+
+  free(mem);
+}
+
+#if !defined(WIN32)
+static void *ssim_band_thread(void *arg)
+{
+  ssim_band((SSIMBand *) arg);
+  return NULL;
+}
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Mean SSIM term (full index, contrast-structure or luminance) over
+ *    all windows of a plane
+ ************************************************************************
+ */
+float compute_ssim_windows (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int comp, SSIMTerm term, int unbiased)
+{
+  static const float K1 = 0.01f, K2 = 0.03f;
+  DistortionParams *p_Dist = p_Vid->p_Dist;
+  SSIMBand band[SSIM_MAX_THREADS];
+  float max_pix_value_sqd;
+  float cur_distortion = 0.0;
+  int step = p_Inp->SSIMOverlapSize;
+  int nwin_x = (width  >= win_width ) ? (width  - win_width ) / step + 1 : 0;
+  int nwin_y = (height >= win_height) ? (height - win_height) / step + 1 : 0;
+  int win_cnt = nwin_x * nwin_y;
+  int bands = imax(1, imin(imin(p_Inp->SSIMThreads, SSIM_MAX_THREADS), nwin_y / SSIM_MIN_BAND_ROWS));
+  int k;
 
-      varOrg    = ((float) ivarOrg - ((float) imeanOrg) * meanOrg) / win_pixels_bias;
-      varEnc    = ((float) ivarEnc - ((float) imeanEnc) * meanEnc) / win_pixels_bias;
-      covOrgEnc = ((float) icovOrgEnc - ((float) imeanOrg) * meanEnc) / win_pixels_bias;
+  if (win_cnt > p_Dist->ssim_values_size)
+  {
+    free(p_Dist->ssim_values);
+    if ((p_Dist->ssim_values = (float *) malloc(win_cnt * sizeof(float))) == NULL)
+      no_mem_exit("compute_ssim_windows: ssim_values");
+    p_Dist->ssim_values_size = win_cnt;
+  }
 
-      mb_ssim  = (float) ((2.0 * meanOrg * meanEnc + C1) * (2.0 * covOrgEnc + C2));
-      mb_ssim /= (float) (meanOrg * meanOrg + meanEnc * meanEnc + C1) * (varOrg + varEnc + C2);
+  max_pix_value_sqd = (float) (p_Vid->max_pel_value_comp[comp] * p_Vid->max_pel_value_comp[comp]);
 
-      cur_distortion += mb_ssim;
-      win_cnt++;
+  for (k = 0; k < bands; ++k)
+  {
+    SSIMBand *b = &band[k];
+
+    b->refImg     = refImg;
+    b->encImg     = encImg;
+    b->width      = width;
+    b->win_height = win_height;
+    b->win_width  = win_width;
+    b->step       = step;
+    b->nwin_x     = nwin_x;
+    b->first_row  = (k * nwin_y) / bands;
+    b->last_row   = ((k + 1) * nwin_y) / bands;
+    b->term       = term;
+    b->C1         = K1 * K1 * max_pix_value_sqd;
+    b->C2         = K2 * K2 * max_pix_value_sqd;
+    b->win_pixels = (float) (win_width * win_height);
+    b->win_pixels_bias = unbiased ? b->win_pixels - 1 : b->win_pixels;
+    b->values     = p_Dist->ssim_values + b->first_row * nwin_x;
+  }
+
+#if !defined(WIN32)
+  if (bands > 1)
+  {
+    pthread_t thread[SSIM_MAX_THREADS];
+    int started[SSIM_MAX_THREADS];
+
+    for (k = 1; k < bands; ++k)
+      started[k] = (pthread_create(&thread[k], NULL, ssim_band_thread, &band[k]) == 0);
+    ssim_band(&band[0]);
+    for (k = 1; k < bands; ++k)
+    {
+      if (started[k])
+        pthread_join(thread[k], NULL);
+      else
+        ssim_band(&band[k]);
     }
   }
+  else
+#endif
+  {
+    for (k = 0; k < bands; ++k)
+      ssim_band(&band[k]);
+  }
+
+  // accumulate in raster order
+  for (k = 0; k < win_cnt; ++k)
+    cur_distortion += p_Dist->ssim_values[k];
 
   cur_distortion /= (float) win_cnt;
 
@@ -88,6 +450,15 @@ float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **ref
   return cur_distortion;
 }
 
+float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int comp)
+{
+#ifdef UNBIASED_VARIANCE
+  return compute_ssim_windows(p_Vid, p_Inp, refImg, encImg, height, width, win_height, win_width, comp, SSIM_FULL, 1);
+#else
+  return compute_ssim_windows(p_Vid, p_Inp, refImg, encImg, height, width, win_height, win_width, comp, SSIM_FULL, 0);
+#endif
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -96,7 +467,6 @@ float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **ref
  */
 void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metricSSIM)
 {
-  DistortionParams *p_Dist = p_Vid->p_Dist;
   FrameFormat *format = &ref->format;
 
   metricSSIM->value[0] = compute_ssim (p_Vid, p_Inp, ref->data[0], src->data[0], format->height, format->width, BLOCK_SIZE_8x8, BLOCK_SIZE_8x8, 0);
@@ -106,10 +476,5 @@ void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *
     metricSSIM->value[1]  = compute_ssim (p_Vid, p_Inp, ref->data[1], src->data[1], format->height_cr, format->width_cr, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 1);
     metricSSIM->value[2]  = compute_ssim (p_Vid, p_Inp, ref->data[2], src->data[2], format->height_cr, format->width_cr, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 2);
   }
-
-  {
-    accumulate_average(metricSSIM,  p_Dist->frame_ctr);
-    accumulate_avslice(metricSSIM,  p_Vid->type, p_Vid->p_Stats->frame_ctr[p_Vid->type]);
-  }
 }
 
@@ -48,6 +48,10 @@
 #include "img_dist_ms_ssim.h"
 #include "cconv_yuv2rgb.h"
 
+#if !defined(WIN32)
+#include <pthread.h>
+#endif
+
 
 /*!
  ************************************************************************
@@ -183,6 +187,281 @@ void select_img(VideoParameters *p_Vid, ImageStructure *imgSRC, ImageStructure *
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Checks whether a distortion metric is computed
+ ************************************************************************
+ */
+static int metric_enabled(InputParameters *p_Inp, int type)
+{
+  switch (type)
+  {
+  case SSE:
+  case PSNR:
+    return TRUE;
+  case SSIM:
+  case MS_SSIM:
+    return (p_Inp->Distortion[type] == 1);
+  case SSE_RGB:
+  case PSNR_RGB:
+    return (p_Inp->DistortionYUVtoRGB == 1);
+  case SSIM_RGB:
+  case MS_SSIM_RGB:
+    return (p_Inp->DistortionYUVtoRGB == 1) && (p_Inp->Distortion[type - 1] == 1);
+  default:
+    return FALSE;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Computes the enabled metrics of a frame
+ ************************************************************************
+ */
+static void compute_metrics(VideoParameters *p_Vid, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric *metric)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+
+  find_snr (p_Vid, imgREF, imgSRC, &metric[SSE], &metric[PSNR]);
+  if (p_Inp->Distortion[SSIM] == 1)
+    find_ssim (p_Vid, p_Inp, imgREF, imgSRC, &metric[SSIM]);
+  if (p_Inp->Distortion[MS_SSIM] == 1)
+    find_ms_ssim(p_Vid, p_Inp, imgREF, imgSRC, &metric[MS_SSIM]);
+  // RGB Distortion
+  if(p_Inp->DistortionYUVtoRGB == 1)
+  {
+    YUVtoRGB(p_Vid, imgREF, &p_Vid->imgRGB_ref);
+    YUVtoRGB(p_Vid, imgSRC, &p_Vid->imgRGB_src);
+    find_snr (p_Vid, &p_Vid->imgRGB_ref, &p_Vid->imgRGB_src, &metric[SSE_RGB], &metric[PSNR_RGB]);
+    if (p_Inp->Distortion[SSIM] == 1)
+      find_ssim (p_Vid, p_Inp, &p_Vid->imgRGB_ref, &p_Vid->imgRGB_src, &metric[SSIM_RGB]);
+    if (p_Inp->Distortion[MS_SSIM] == 1)
+      find_ms_ssim(p_Vid, p_Inp, &p_Vid->imgRGB_ref, &p_Vid->imgRGB_src, &metric[MS_SSIM_RGB]);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stores the metrics of a frame as current values and adds them to
+ *    the sequence and slice type averages
+ ************************************************************************
+ */
+static void accumulate_metrics(VideoParameters *p_Vid, DistMetric *metric, int frame_ctr, int slice_type, int type_ctr)
+{
+  DistortionParams *p_Dist = p_Vid->p_Dist;
+  int k;
+
+  for (k = 0; k < TOTAL_DIST_TYPES; ++k)
+  {
+    if (metric_enabled(p_Vid->p_Inp, k))
+    {
+      if (metric != p_Dist->metric)
+        memcpy(p_Dist->metric[k].value, metric[k].value, 3 * sizeof(float));
+      accumulate_average(&p_Dist->metric[k], frame_ctr);
+      accumulate_avslice(&p_Dist->metric[k], slice_type, type_ctr);
+    }
+  }
+}
+
+#if !defined(WIN32)
+#define DIST_JOBS 4   //!< frames queued for the metrics thread
+
+//! report line state of a queued frame
+enum {
+  REPORT_PENDING  = 0,  //!< report line not known yet
+  REPORT_ATTACHED = 1,  //!< report line printed with the metrics
+  REPORT_NONE     = 2   //!< frame without report line
+};
+
+//! frame queued for the metrics thread
+typedef struct dist_job
+{
+  ImageStructure imgREF;                    //!< copy of the source frame
+  ImageStructure imgSRC;                    //!< copy of the reconstructed frame
+  DistMetric     metric[TOTAL_DIST_TYPES];  //!< metrics computed by the thread
+  int            frame_ctr;                 //!< number of coded frames
+  int            slice_type;                //!< picture type of the frame
+  int            type_ctr;                  //!< number of coded frames of slice_type
+  int            report_state;
+  FrameReport    report;                    //!< report line of the frame
+} DistJob;
+
+//! metrics thread and its queue; jobs are used round robin
+typedef struct dist_worker
+{
+  DistJob         job[DIST_JOBS];
+  int             submitted;                //!< number of queued frames
+  int             computed;                 //!< number of frames computed by the thread
+  int             delivered;                //!< number of frames reported
+  int             pending;                  //!< frame waiting for its report line, -1 if none
+  int             quit;
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+} DistWorker;
+
+//! frees the frame buffers and the thread objects
+static void free_worker(DistWorker *w)
+{
+  int i, k;
+
+  for (i = 0; i < DIST_JOBS; ++i)
+  {
+    for (k = 0; k < 3; ++k)
+    {
+      if (w->job[i].imgREF.data[k])
+        free_mem2Dpel(w->job[i].imgREF.data[k]);
+      if (w->job[i].imgSRC.data[k])
+        free_mem2Dpel(w->job[i].imgSRC.data[k]);
+    }
+  }
+  pthread_mutex_destroy(&w->mutex);
+  pthread_cond_destroy(&w->cond);
+  free(w);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Metrics thread: computes the queued frames in order
+ ************************************************************************
+ */
+static void *distortion_worker(void *arg)
+{
+  VideoParameters *p_Vid = (VideoParameters *) arg;
+  DistWorker *w = p_Vid->p_Dist->worker;
+
+  pthread_mutex_lock(&w->mutex);
+  for (;;)
+  {
+    DistJob *job;
+
+    while (w->computed == w->submitted && !w->quit)
+      pthread_cond_wait(&w->cond, &w->mutex);
+    if (w->computed == w->submitted)
+      break;
+
+    job = &w->job[w->computed % DIST_JOBS];
+    pthread_mutex_unlock(&w->mutex);
+
+    compute_metrics(p_Vid, &job->imgREF, &job->imgSRC, job->metric);
+
+    pthread_mutex_lock(&w->mutex);
+    w->computed++;
+    pthread_cond_broadcast(&w->cond);
+  }
+  pthread_mutex_unlock(&w->mutex);
+
+  return NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Hands the computed frames to the averages and the frame report in
+ *    coding order. Stops at the first frame that is not computed yet
+ *    unless wait is set, and at a frame still waiting for its report.
+ ************************************************************************
+ */
+static void deliver_metrics(VideoParameters *p_Vid, DistWorker *w, int wait)
+{
+  DistortionParams *p_Dist = p_Vid->p_Dist;
+
+  while (w->delivered < w->submitted)
+  {
+    DistJob *job = &w->job[w->delivered % DIST_JOBS];
+    int done;
+
+    if (job->report_state == REPORT_PENDING)
+      break;
+
+    pthread_mutex_lock(&w->mutex);
+    while (wait && w->computed <= w->delivered)
+      pthread_cond_wait(&w->cond, &w->mutex);
+    done = (w->computed > w->delivered);
+    pthread_mutex_unlock(&w->mutex);
+
+    if (!done)
+      break;
+
+    accumulate_metrics(p_Vid, job->metric, job->frame_ctr, job->slice_type, job->type_ctr);
+    if (job->report_state == REPORT_ATTACHED)
+      report_frame_line(p_Vid->p_Inp, &job->report, &p_Dist->metric[PSNR], &p_Dist->metric[SSIM]);
+    w->delivered++;
+  }
+}
+
+//! copies a plane into the buffer of a job
+static void copy_plane(imgpel **dst, imgpel **src, int height, int width)
+{
+  int j;
+
+  for (j = 0; j < height; ++j)
+    memcpy(dst[j], src[j], width * sizeof(imgpel));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Queues the source and reconstructed frame selected by select_img()
+ *    for the metrics thread
+ ************************************************************************
+ */
+static void submit_metrics(VideoParameters *p_Vid, DistWorker *w)
+{
+  DistJob *job;
+  FrameFormat *format = &p_Vid->imgREF.format;
+  int k;
+
+  // a frame without report line (e.g. not reported) is delivered without one
+  if (w->pending >= 0)
+  {
+    w->job[w->pending % DIST_JOBS].report_state = REPORT_NONE;
+    w->pending = -1;
+  }
+
+  deliver_metrics(p_Vid, w, FALSE);
+  if (w->submitted - w->delivered == DIST_JOBS)
+  {
+    // all buffers in use: wait for the oldest frame
+    pthread_mutex_lock(&w->mutex);
+    while (w->computed <= w->delivered)
+      pthread_cond_wait(&w->cond, &w->mutex);
+    pthread_mutex_unlock(&w->mutex);
+    deliver_metrics(p_Vid, w, FALSE);
+  }
+
+  job = &w->job[w->submitted % DIST_JOBS];
+  job->imgREF.format = p_Vid->imgREF.format;
+  job->imgSRC.format = p_Vid->imgSRC.format;
+  copy_plane(job->imgREF.data[0], p_Vid->imgREF.data[0], format->height, format->width);
+  copy_plane(job->imgSRC.data[0], p_Vid->imgSRC.data[0], format->height, format->width);
+  if (format->yuv_format != YUV400)
+  {
+    for (k = 1; k < 3; ++k)
+    {
+      copy_plane(job->imgREF.data[k], p_Vid->imgREF.data[k], format->height_cr, format->width_cr);
+      copy_plane(job->imgSRC.data[k], p_Vid->imgSRC.data[k], format->height_cr, format->width_cr);
+    }
+  }
+
+  memset(job->metric, 0, TOTAL_DIST_TYPES * sizeof(DistMetric));
+  job->frame_ctr    = p_Vid->p_Dist->frame_ctr;
+  job->slice_type   = p_Vid->type;
+  job->type_ctr     = p_Vid->p_Stats->frame_ctr[p_Vid->type];
+  job->report_state = REPORT_PENDING;
+  w->pending = w->submitted;
+
+  pthread_mutex_lock(&w->mutex);
+  w->submitted++;
+  pthread_cond_broadcast(&w->cond);
+  pthread_mutex_unlock(&w->mutex);
+}
+#endif
+
 void compute_distortion(VideoParameters *p_Vid, ImageData *imgData)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
@@ -191,21 +470,143 @@ void compute_distortion(VideoParameters *p_Vid, ImageData *imgData)
   {
     select_img(p_Vid, &p_Vid->imgSRC, &p_Vid->imgREF, imgData);
 
-    find_snr (p_Vid, &p_Vid->imgREF, &p_Vid->imgSRC, &p_Dist->metric[SSE], &p_Dist->metric[PSNR]);
-    if (p_Inp->Distortion[SSIM] == 1)
-      find_ssim (p_Vid, p_Inp, &p_Vid->imgREF, &p_Vid->imgSRC, &p_Dist->metric[SSIM]);
-    if (p_Inp->Distortion[MS_SSIM] == 1)
-      find_ms_ssim(p_Vid, p_Inp, &p_Vid->imgREF, &p_Vid->imgSRC, &p_Dist->metric[MS_SSIM]);
-    // RGB Distortion
-    if(p_Inp->DistortionYUVtoRGB == 1)
+#if !defined(WIN32)
+    if (p_Dist->worker)
     {
-      YUVtoRGB(p_Vid, &p_Vid->imgREF, &p_Vid->imgRGB_ref);
-      YUVtoRGB(p_Vid, &p_Vid->imgSRC, &p_Vid->imgRGB_src);
-      find_snr (p_Vid, &p_Vid->imgRGB_ref, &p_Vid->imgRGB_src, &p_Dist->metric[SSE_RGB], &p_Dist->metric[PSNR_RGB]);
-      if (p_Inp->Distortion[SSIM] == 1)
-        find_ssim (p_Vid, p_Inp, &p_Vid->imgRGB_ref, &p_Vid->imgRGB_src, &p_Dist->metric[SSIM_RGB]);
-      if (p_Inp->Distortion[MS_SSIM] == 1)
-        find_ms_ssim(p_Vid, p_Inp, &p_Vid->imgRGB_ref, &p_Vid->imgRGB_src, &p_Dist->metric[MS_SSIM_RGB]);
+      submit_metrics(p_Vid, p_Dist->worker);
+      return;
     }
+#endif
+
+    compute_metrics(p_Vid, &p_Vid->imgREF, &p_Vid->imgSRC, p_Dist->metric);
+    accumulate_metrics(p_Vid, p_Dist->metric, p_Dist->frame_ctr, p_Vid->type, p_Vid->p_Stats->frame_ctr[p_Vid->type]);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Prints the report line of the coded frame. With the metrics
+ *    thread the line is kept until the metrics of the frame are done.
+ ************************************************************************
+ */
+void report_distortion(VideoParameters *p_Vid, FrameReport *report)
+{
+  DistortionParams *p_Dist = p_Vid->p_Dist;
+
+#if !defined(WIN32)
+  DistWorker *w = p_Dist->worker;
+
+  if (w && w->pending >= 0)
+  {
+    DistJob *job = &w->job[w->pending % DIST_JOBS];
+
+    job->report = *report;
+    job->report_state = REPORT_ATTACHED;
+    w->pending = -1;
+    deliver_metrics(p_Vid, w, FALSE);
+    return;
+  }
+#endif
+
+  report_frame_line(p_Vid->p_Inp, report, &p_Dist->metric[PSNR], &p_Dist->metric[SSIM]);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Starts the metrics thread (DistortionThread)
+ ************************************************************************
+ */
+void init_distortion(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+#if !defined(WIN32)
+  FrameFormat *output = &p_Inp->output;
+  DistWorker *w;
+  int i, k;
+
+  if (!p_Inp->DistortionThread || p_Inp->Verbose == 0)
+    return;
+
+  if ((w = (DistWorker *) calloc(1, sizeof(DistWorker))) == NULL)
+    no_mem_exit("init_distortion: worker");
+
+  for (i = 0; i < DIST_JOBS; ++i)
+  {
+    DistJob *job = &w->job[i];
+
+    get_mem2Dpel(&job->imgREF.data[0], output->height, output->width);
+    get_mem2Dpel(&job->imgSRC.data[0], output->height, output->width);
+    if (output->yuv_format != YUV400)
+    {
+      for (k = 1; k < 3; ++k)
+      {
+        get_mem2Dpel(&job->imgREF.data[k], output->height_cr, output->width_cr);
+        get_mem2Dpel(&job->imgSRC.data[k], output->height_cr, output->width_cr);
+      }
+    }
+  }
+  w->pending = -1;
+
+  pthread_mutex_init(&w->mutex, NULL);
+  pthread_cond_init(&w->cond, NULL);
+  p_Vid->p_Dist->worker = w;
+
+  if (pthread_create(&w->thread, NULL, distortion_worker, p_Vid))
+  {
+    // compute the metrics after each frame instead
+    p_Vid->p_Dist->worker = NULL;
+    free_worker(w);
+  }
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Waits for the metrics thread and reports all queued frames
+ ************************************************************************
+ */
+void flush_distortion(VideoParameters *p_Vid)
+{
+#if !defined(WIN32)
+  DistWorker *w = p_Vid->p_Dist->worker;
+
+  if (w)
+  {
+    if (w->pending >= 0)
+    {
+      w->job[w->pending % DIST_JOBS].report_state = REPORT_NONE;
+      w->pending = -1;
+    }
+    deliver_metrics(p_Vid, w, TRUE);
+  }
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stops the metrics thread
+ ************************************************************************
+ */
+void free_distortion(VideoParameters *p_Vid)
+{
+#if !defined(WIN32)
+  DistWorker *w = p_Vid->p_Dist->worker;
+
+  if (w)
+  {
+    flush_distortion(p_Vid);
+
+    pthread_mutex_lock(&w->mutex);
+    w->quit = TRUE;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->mutex);
+    pthread_join(w->thread, NULL);
+
+    p_Vid->p_Dist->worker = NULL;
+    free_worker(w);
   }
+#endif
 }
@@ -59,7 +59,9 @@
 #include "image.h"
 #include "input.h"
 #include "img_io.h"
+#include "img_distortion.h"
 #include "slice.h"
+#include "slice_arena.h"
 #include "intrarefresh.h"
 #include "leaky_bucket.h"
 #include "mc_prediction.h"
@@ -82,6 +84,7 @@
 #include "img_process.h"
 #include "q_offsets.h"
 #include "pred_struct.h"
+#include "enc_profile.h"
 
 static const int mb_width_cr[4] = {0, 8, 8,16};
 static const int mb_height_cr[4]= {0, 8,16,16};
@@ -218,6 +221,10 @@ int main(int argc, char **argv)
 
   Configure (p_Enc->p_Vid, p_Enc->p_Inp, argc, argv);
 
+#if (ENC_PROFILE)
+  enc_profile_init(p_Enc->p_Inp->ProfileFile);
+#endif
+
   // init encoder
   init_encoder(p_Enc->p_Vid, p_Enc->p_Inp);
 
@@ -291,7 +298,7 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp)
   if (((1<<(p_Vid->log2_max_pic_order_cnt_lsb_minus4 + 3)) < p_Inp->jumpd * 4) && p_Inp->Log2MaxPOCLsbMinus4 != -1)
     error("log2_max_pic_order_cnt_lsb_minus4 might not be sufficient for encoding. Increase value.",400);
 
-  if (strlen (p_Inp->ReconFile) > 0 && (p_Vid->p_dec = open(p_Inp->ReconFile, OPENFLAGS_WRITE, OPEN_PERMISSIONS))==-1)
+  if (strlen (p_Inp->ReconFile) > 0 && (p_Vid->p_dec = OpenOutputFile(p_Inp->ReconFile))==-1)
   {
     snprintf(errortext, ET_SIZE, "Error open file %s", p_Inp->ReconFile);
     error (errortext, 500);
@@ -419,6 +426,8 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp)
   if(p_Inp->DistortionYUVtoRGB)
     init_YUVtoRGB(p_Vid, p_Inp);
 
+  init_distortion(p_Vid, p_Inp);
+
   //Rate control
   if (p_Inp->RCEnable)
     rc_init_sequence(p_Vid, p_Inp);
@@ -546,6 +555,7 @@ static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
     }
 
     prepare_frame_params(p_Vid, p_Inp, curr_frame_to_code);
+    ENC_PROF_SET_SLICE_TYPE(p_Vid->type);
 
     // redundant frame initialization and allocation
     if (p_Inp->redundant_pic_flag)
@@ -573,9 +583,14 @@ static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
       p_Vid->last_valid_reference = p_Vid->ThisPOC;
 
     if (p_Inp->ReportFrameStats)
+    {
+      flush_distortion(p_Vid);
       report_frame_statistic(p_Vid, p_Inp);
-
+    }
   }
+
+  // report the frames still on the metrics thread
+  flush_distortion(p_Vid);
 }
 
 
@@ -592,10 +607,11 @@ void free_encoder_memory(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   flush_dpb(p_Vid, &p_Inp->output);
 
+  CloseFramePrefetch(&p_Inp->input_file1);
   CloseFiles(&p_Inp->input_file1);
 
   if (-1 != p_Vid->p_dec)
-    close(p_Vid->p_dec);
+    CloseOutputFile(p_Vid->p_dec);
   
   if (p_Enc->p_trace)
     fclose(p_Enc->p_trace);
@@ -614,8 +630,13 @@ void free_encoder_memory(VideoParameters *p_Vid, InputParameters *p_Inp)
   calc_buffer(p_Vid, p_Inp);
 #endif
 
+  free_distortion(p_Vid);
+
   // report everything
   report(p_Vid, p_Inp, p_Vid->p_Stats);
+#if (ENC_PROFILE)
+  enc_profile_report(p_Vid->p_Stats->frame_counter);
+#endif
 
 #ifdef _LEAKYBUCKET_
   if (p_Vid->Bit_Buffer != NULL)
@@ -630,6 +651,7 @@ void free_encoder_memory(VideoParameters *p_Vid, InputParameters *p_Inp)
   uninit_out_buffer(p_Vid);
 
   free_global_buffers(p_Vid, p_Inp);
+  free_slice_arenas(p_Vid);
 
   FreeParameterSets(p_Vid);
 
@@ -858,6 +880,8 @@ static void init_img( VideoParameters *p_Vid)
 
   // Allocate I/O Frame memory
   AllocateFrameMemory(p_Vid, p_Inp, &p_Inp->source);
+  OpenFramePrefetch(p_Inp, &p_Inp->input_file1, p_Inp->infile_header, &p_Inp->source,
+    1 + p_Inp->frame_skip, p_Inp->no_frames, p_Inp->input_prefetch);
 
   // Initialize filtering parameters. If sending parameters, the offsets are
   // multiplied by 2 since inputs are taken in "div 2" format.
@@ -922,6 +946,7 @@ static void free_img (VideoParameters *p_Vid, InputParameters *p_Inp)
   CloseSEIMessages(p_Vid, p_Inp); 
 
   free_context_memory (p_Vid);
+  delete_ctx_journal (p_Vid->ctx_journal);
 
   if (p_Inp->AdaptiveRounding)
   {
@@ -935,6 +960,7 @@ static void free_img (VideoParameters *p_Vid, InputParameters *p_Inp)
   free (p_Vid->p_Quant);
   free (p_Vid->p_Dpb);
   free (p_Vid->p_Stats);
+  free (p_Vid->p_Dist->ssim_values);
   free (p_Vid->p_Dist);
   free (p_Vid);
 }
@@ -47,6 +47,8 @@
 #include "mv_prediction.h"
 #include "rdopt.h"
 #include "transform.h"
+#include "rdopt_coding_state.h"
+#include "enc_profile.h"
 
 
 #if TRACE
@@ -2611,8 +2613,16 @@ void write_macroblock (Macroblock* currMB, int eos_bit)
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   BitCounter *mbBits = &currMB->bits;
+  int rate_estimation = p_Vid->cabac_rate_estimation;
   int i;
 
+  ENC_PROF_START(PROF_ENTROPY);
+
+  // the final symbols are always coded; coding states stored during
+  // the mode decision of this macroblock are no longer needed
+  p_Vid->cabac_rate_estimation = FALSE;
+  reset_ctx_journal(p_Vid->ctx_journal);
+
   // enable writing of trace file
 #if TRACE
   if ( currMB->prev_recode_mb == FALSE )
@@ -2677,10 +2687,13 @@ void write_macroblock (Macroblock* currMB, int eos_bit)
 
   /*record the total number of MBs*/
   ++(p_Vid->NumberofCodedMacroBlocks);
+  ENC_PROF_COUNT(PROF_CNT_MB);
 
   p_Vid->p_Stats->bit_slice += mbBits->mb_total;
 
   p_Vid->cabac_encoding = 0;
+  p_Vid->cabac_rate_estimation = rate_estimation;
+  ENC_PROF_STOP(PROF_ENTROPY);
 }
 
 
@@ -24,6 +24,7 @@
 #include "nalucommon.h"
 #include "img_luma.h"
 #include "img_chroma.h"
+#include "wp.h"
 
 extern void init_stats                   (InputParameters *p_Inp, StatParameters *stats);
 static void insert_picture_in_dpb        (VideoParameters *p_Vid, FrameStore* fs, StorablePicture* p);
@@ -34,6 +35,7 @@ static int  is_used_for_reference        (FrameStore* fs);
 static int  remove_unused_frame_from_dpb (DecodedPictureBuffer *p_Dpb);
 static int  is_short_term_reference      (FrameStore* fs);
 static int  is_long_term_reference       (FrameStore* fs);
+static void compute_fs_stats             (VideoParameters *p_Vid, FrameStore *fs);
 
 
 #define MAX_LIST_SIZE 33
@@ -2621,6 +2623,8 @@ void replace_top_pic_with_frame(VideoParameters *p_Vid, StorablePicture* p, Fram
     }
     // generate field views
     dpb_split_field(p_Vid, fs);
+    if (p->used_for_reference)
+      compute_fs_stats(p_Vid, fs);
     update_ref_list(p_Dpb);
     update_ltref_list(p_Dpb);
   }
@@ -2733,6 +2737,30 @@ static void insert_picture_in_dpb(VideoParameters *p_Vid, FrameStore* fs, Storab
   fs->frame_num = p->pic_num;
   fs->is_output = p->is_output;
 
+  if (p->used_for_reference)
+    compute_fs_stats(p_Vid, fs);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Computes the sample statistics of the pictures of a frame store
+ *    for the weighted prediction estimators
+ ************************************************************************
+ */
+static void compute_fs_stats(VideoParameters *p_Vid, FrameStore *fs)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+
+  if (p_Inp->WeightedPrediction || p_Inp->WeightedBiprediction || p_Inp->GenerateMultiplePPS)
+  {
+    if (fs->frame)
+      ComputePicStats(fs->frame);
+    if (fs->top_field)
+      ComputePicStats(fs->top_field);
+    if (fs->bottom_field)
+      ComputePicStats(fs->bottom_field);
+  }
 }
 
 /*!
@@ -17,6 +17,7 @@
 #include "image.h"
 #include "macroblock.h"
 #include "mc_prediction.h"
+#include "enc_profile.h"
 
 /*!
  *************************************************************************************
@@ -127,7 +128,7 @@ void SetMotionVectorsMBPSlice (Macroblock* currMB, PicMotionParams *motion)
 
   if (currSlice->mb_aff_frame_flag || (currSlice->UseRDOQuant && currSlice->RDOQ_QP_Num > 1))
   {
-    memcpy(&rdopt->all_mv[LIST_0][0][0][0][0][0], &all_mv[0][0][0][0][0], p_Vid->max_num_references * 9 * MB_BLOCK_PARTITIONS * 2 * sizeof(short));
+    memcpy(rdopt->all_mv_data, currSlice->all_mv_data, p_Vid->max_num_references * MV_REF_SIZE * sizeof(short));
   }
 
   if (currMB->mb_type == PSKIP) // Skip mode
@@ -348,7 +349,7 @@ void SetMotionVectorsMBBSlice (Macroblock* currMB, PicMotionParams *motion)
 
   if (currSlice->mb_aff_frame_flag || (currSlice->UseRDOQuant && currSlice->RDOQ_QP_Num > 1))
   {
-    memcpy(&currSlice->rddata->all_mv[LIST_0][0][0][0][0][0], &currSlice->all_mv[LIST_0][0][0][0][0][0], 2 * p_Vid->max_num_references * 9 * MB_BLOCK_PARTITIONS * 2 * sizeof(short));
+    memcpy(currSlice->rddata->all_mv_data, currSlice->all_mv_data, 2 * p_Vid->max_num_references * MV_REF_SIZE * sizeof(short));
   }
 
   if (currMB->mb_type == P16x16) // 16x16
@@ -511,7 +512,9 @@ void SetChromaPredMode(Macroblock *currMB, RD_PARAMS enc_mb, int *mb_available,
 
     if (p_Inp->FastCrIntraDecision) 
     {           
+      ENC_PROF_START(PROF_INTRA);
       intra_chroma_RD_decision(currMB, enc_mb);
+      ENC_PROF_STOP(PROF_INTRA);
 
       chroma_pred_mode_range[0] = currMB->c_ipred_mode;
       chroma_pred_mode_range[1] = currMB->c_ipred_mode;
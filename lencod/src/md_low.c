@@ -31,6 +31,7 @@
 #include "rdopt.h"
 #include "memalloc.h"
 #include "mc_prediction.h"
+#include "enc_profile.h"
 
 
 /*!
@@ -376,7 +377,9 @@ void encode_one_macroblock_low (Macroblock *currMB)
     currMB->luma_transform_size_8x8_flag = TRUE; // at this point cost will ALWAYS be less than min_cost
 
     currMB->mb_type = currMB->ar_mode = I8MB;
+    ENC_PROF_START(PROF_INTRA);
     temp_cpb = Mode_Decision_for_Intra8x8Macroblock (currMB, enc_mb.lambda_mdfp, &rd_cost);
+    ENC_PROF_STOP(PROF_INTRA);
 
     if (rd_cost <= currMB->min_rdcost) //HYU_NOTE. bug fix. 08/15/07
     {
@@ -431,7 +434,9 @@ void encode_one_macroblock_low (Macroblock *currMB)
   {
     currMB->luma_transform_size_8x8_flag = FALSE;
     currMB->mb_type = currMB->ar_mode = I4MB;
+    ENC_PROF_START(PROF_INTRA);
     temp_cpb = Mode_Decision_for_Intra4x4Macroblock (currMB, enc_mb.lambda_mdfp, &rd_cost);
+    ENC_PROF_STOP(PROF_INTRA);
     if (rd_cost <= currMB->min_rdcost) 
     {
       currMB->cbp = temp_cpb;
@@ -462,6 +467,7 @@ void encode_one_macroblock_low (Macroblock *currMB)
   }
   if (enc_mb.valid[I16MB]) // check INTRA16x16
   {
+    ENC_PROF_START(PROF_INTRA);
     currMB->luma_transform_size_8x8_flag = FALSE;
     intrapred_16x16 (currMB, PLANE_Y);
     if (p_Vid->P444_joined)
@@ -474,6 +480,7 @@ void encode_one_macroblock_low (Macroblock *currMB)
     }
 
     rd_cost = currSlice->find_sad_16x16 (currMB);
+    ENC_PROF_STOP(PROF_INTRA);
 
     if (rd_cost < currMB->min_rdcost)
     {
@@ -24,6 +24,7 @@
 #include "refbuf.h"
 #include "mv_search.h"
 #include "me_distortion.h"
+#include "enc_profile.h"
 
 
 //#define CHECKOVERFLOW(mcost) assert(mcost>=0)
@@ -363,6 +364,9 @@ distblk computeSAD(StorablePicture *ref1,
 #endif
 
   imgpel *src_line, *ref_line;
+
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   src_line = mv_block->orig_pic[0];
   ref_line = UMVLine4X (ref1, cand->mv_y, cand->mv_x);
   for (y=0; y<blocksize_y; y++)
@@ -457,6 +461,8 @@ distblk computeSADWP(StorablePicture *ref1,
   imgpel *src_line = mv_block->orig_pic[0];
   imgpel *ref_line = UMVLine4X (ref1, cand->mv_y, cand->mv_x);
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   for (y=0; y<blocksize_y; y++)
   {
     for (x = 0; x < blocksize_x; x+=4)
@@ -545,6 +551,8 @@ distblk computeBiPredSAD1(StorablePicture *ref1,
   imgpel *ref2_line  = UMVLine4X(ref2, cand2->mv_y, cand2->mv_x);
   imgpel *ref1_line  = UMVLine4X(ref1, cand1->mv_y, cand1->mv_x);
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   for (y = 0; y < blocksize_y; y++)
   {
     for (x = 0; x < blocksize_x; x+=4)
@@ -650,6 +658,8 @@ distblk computeBiPredSAD2(StorablePicture *ref1,
   imgpel *ref2_line  = UMVLine4X(ref2, cand2->mv_y, cand2->mv_x);
   imgpel *ref1_line  = UMVLine4X(ref1, cand1->mv_y, cand1->mv_x);
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   for (y=0; y<blocksize_y; y++)
   {
     for (x = 0; x < blocksize_x; x+=4)
@@ -759,6 +769,8 @@ distblk computeSATD(StorablePicture *ref1,
   int diff[MB_PIXELS];
   imgpel *src_line, *ref_line;
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   if ( !mv_block->test8x8 )
   { // 4x4 TRANSFORM
     src_size_x = blocksize_x - BLOCK_SIZE;
@@ -856,6 +868,8 @@ distblk computeSATDWP(StorablePicture *ref1,
   int diff[MB_PIXELS];
   imgpel *src_line, *ref_line;
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   if ( !mv_block->test8x8 )
   { // 4x4 TRANSFORM
     src_size_x = (blocksize_x - BLOCK_SIZE);
@@ -958,6 +972,8 @@ distblk computeBiPredSATD1(StorablePicture *ref1,
   short blocksize_y = mv_block->blocksize_y;
   VideoParameters *p_Vid = mv_block->p_Vid;
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   if ( !mv_block->test8x8 )
   { // 4x4 TRANSFORM
     src_size_x = (blocksize_x - BLOCK_SIZE);
@@ -1063,6 +1079,8 @@ distblk computeBiPredSATD2(StorablePicture *ref1,
   short blocksize_x = mv_block->blocksize_x;
   short blocksize_y = mv_block->blocksize_y;
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   if ( !mv_block->test8x8 )
   { // 4x4 TRANSFORM
     src_size_x = (blocksize_x - BLOCK_SIZE);
@@ -1204,6 +1222,8 @@ distblk computeSSE(StorablePicture *ref1,
   imgpel *src_line = mv_block->orig_pic[0];
   imgpel *ref_line = UMVLine4X (ref1, cand->mv_y, cand->mv_x);
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   for (y=0; y<blocksize_y; y++)
   {
     for (x = 0; x < blocksize_x; x+=4)
@@ -1283,6 +1303,8 @@ distblk computeSSEWP(StorablePicture *ref1,
   imgpel *src_line = mv_block->orig_pic[0];
   imgpel *ref_line = UMVLine4X (ref1, cand->mv_y, cand->mv_x);
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   for (y=0; y<blocksize_y; y++)
   {
     for (x = 0; x < blocksize_x; x+=4)
@@ -1370,6 +1392,8 @@ distblk computeBiPredSSE1(StorablePicture *ref1,
   imgpel *ref2_line  = UMVLine4X(ref2, cand2->mv_y, cand2->mv_x);
   imgpel *ref1_line  = UMVLine4X(ref1, cand1->mv_y, cand1->mv_x);
 
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   for (y = 0; y < blocksize_y; y++)
   {
     for (x = 0; x < blocksize_x; x+=4)
@@ -1463,6 +1487,9 @@ distblk computeBiPredSSE2(StorablePicture *ref1,
   imgpel *src_line   = mv_block->orig_pic[0];
   imgpel *ref2_line  = UMVLine4X(ref2, cand2->mv_y, cand2->mv_x);
   imgpel *ref1_line  = UMVLine4X(ref1, cand1->mv_y, cand1->mv_x);
+
+  ENC_PROF_COUNT(PROF_CNT_ME_DIST);
+
   for (y=0; y<blocksize_y; y++)
   {
     for (x = 0; x < blocksize_x; x+=4)
@@ -50,6 +50,7 @@
 #include "me_umhex.h"
 #include "me_umhexsmp.h"
 #include "rdoq.h"
+#include "enc_profile.h"
 
 
 static const short bx0[5][4] = {{0,0,0,0}, {0,0,0,0}, {0,0,0,0}, {0,2,0,0}, {0,2,0,2}};
@@ -978,7 +979,9 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
   clip_mv_range(p_Vid, 0, mv, Q_PEL);
 
   //--- perform motion search ---
+  ENC_PROF_START(PROF_INT_ME);
   min_mcost = currMB->IntPelME (currMB, &pred, mv_block, min_mcost, lambda_factor[F_PEL]);
+  ENC_PROF_STOP(PROF_INT_ME);
 
   //==============================
   //=====   SUB-PEL SEARCH   =====
@@ -989,11 +992,13 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
   {
     if (p_Inp->SearchMode != EPZS || (ref == 0 || currSlice->structure != FRAME || (ref > 0 && min_mcost < 3.5 * prevSad[pic_pix_x >> 2])))
     {
+      ENC_PROF_START(PROF_SUBPEL_ME);
       if ( !p_Vid->start_me_refinement_hp )
       {
         min_mcost = max_value;
       }
       min_mcost =  currMB->SubPelME (currMB, &pred, mv_block, min_mcost, lambda_factor);
+      ENC_PROF_STOP(PROF_SUBPEL_ME);
     }
   }
 
@@ -1131,9 +1136,11 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
 
     PrepareBiPredMEParams(currSlice, mv_block, mv_block->ChromaMEEnable, iterlist, currMB->list_offset, mv_block->ref_idx);
     // Get bipred mvs for list iterlist given previously computed mvs from other list
+    ENC_PROF_START(PROF_INT_ME);
     min_mcostbi = currMB->BiPredME (currMB, iterlist, 
       &pred_mv1, &pred_mv2, &bi_mv1, &bi_mv2, mv_block, 
       (p_Inp->BiPredMESearchRange <<2)>>mv_block->iteration_no, min_mcostbi, lambda_factor[F_PEL]);
+    ENC_PROF_STOP(PROF_INT_ME);
 
     if (mv_block->iteration_no > 0 && (tempmv.mv_x == bi_mv1.mv_x) && (tempmv.mv_y == bi_mv1.mv_y))
     {
@@ -1143,6 +1150,7 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
 
   if (!p_Inp->DisableSubpelME)
   {
+    ENC_PROF_START(PROF_SUBPEL_ME);
     if (p_Inp->BiPredMESubPel)
     {
       min_mcostbi = DISTBLK_MAX;
@@ -1158,6 +1166,7 @@ static distblk BiPredBlockMotionSearch(Macroblock *currMB,      //!< Current Mac
 
       min_mcostbi =  currMB->SubPelBiPredME (currMB, mv_block, iterlist ^ 1, &pred_mv2, &pred_mv1, &bi_mv2, &bi_mv1, min_mcostbi, lambda_factor);
     }
+    ENC_PROF_STOP(PROF_SUBPEL_ME);
   }
 
   clip_mv_range(p_Vid, 0, &bi_mv1, Q_PEL);
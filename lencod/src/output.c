@@ -16,6 +16,7 @@
 #include "global.h"
 #include "image.h"
 #include "input.h"
+#include "img_io.h"
 #include "output.h"
 
 /*!
@@ -181,6 +182,7 @@ void write_out_picture(StorablePicture *p, FrameFormat *output, int p_out)
   int symbol_size_in_bytes = output->pic_unit_size_shift3;
   Boolean rgb_output = (Boolean) (output->color_model != CM_YUV && output->yuv_format == YUV444);
   unsigned char *buf;
+  FrameFormat y4m_format = *output;
 
   if (p->non_existing)
     return;
@@ -202,6 +204,11 @@ void write_out_picture(StorablePicture *p, FrameFormat *output, int p_out)
 
   //printf ("write frame size: %dx%d\n", p->size_x-crop_left-crop_right,p->size_y-crop_top-crop_bottom );
 
+  y4m_format.width      = p->size_x - crop_left - crop_right;
+  y4m_format.height     = p->size_y - crop_top - crop_bottom;
+  y4m_format.yuv_format = (ColorFormat) p->chroma_format_idc;
+  WriteY4MFrameHeader(p_out, &y4m_format);
+
   // KS: this buffer should actually be allocated only once, but this is still much faster than the previous version
   buf = malloc (p->size_x * p->size_y * symbol_size_in_bytes);
   if (NULL==buf)
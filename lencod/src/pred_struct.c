@@ -16,6 +16,7 @@
 
 #include "pred_struct.h"
 #include "explicit_seq.h"
+#include "enc_profile.h"
 
 
 #define DEBUG_PRED_STRUCT 0
@@ -1338,6 +1339,7 @@ void populate_frm_struct( VideoParameters *p_Vid, InputParameters *p_Inp, SeqStr
   int is_sp;
   int terminate_pop = 0;
 
+  ENC_PROF_START(PROF_PRED_STRUCT);
   p_seq_struct->curr_num_to_populate = imin( num_to_populate, init_frames_to_code - p_seq_struct->pop_start_frame );
   curr_frame  = p_seq_struct->pop_start_frame;
   proc_frames = 0;
@@ -1414,6 +1416,7 @@ void populate_frm_struct( VideoParameters *p_Vid, InputParameters *p_Inp, SeqStr
   } // proc_frames loop
   // update pop_start_frame for subsequent run of this function ;)
   p_seq_struct->pop_start_frame = curr_frame;
+  ENC_PROF_STOP(PROF_PRED_STRUCT);
 }
 
 /*!
@@ -30,6 +30,7 @@
 #include "q_matrix.h"
 #include "quant4x4.h"
 #include "rdoq.h"
+#include "enc_profile.h"
 
 /*!
  ************************************************************************
@@ -40,6 +41,7 @@
  */
 int quant_4x4_trellis(Macroblock *currMB, int **tblock, struct quant_methods *q_method)
 {
+  ENC_PROF_START(PROF_RDOQ);
   int   block_x = q_method->block_x;
 
   int*  ACLevel = q_method->ACLevel;
@@ -113,6 +115,7 @@ int quant_4x4_trellis(Macroblock *currMB, int **tblock, struct quant_methods *q_
 
   *ACL = 0;
 
+  ENC_PROF_STOP(PROF_RDOQ);
   return nonzero;
 }
 
@@ -207,6 +210,7 @@ void rdoq_4x4_CABAC(Macroblock *currMB, int **tblock, struct quant_methods *q_me
  */
 int quant_ac4x4_trellis(Macroblock *currMB, int **tblock, struct quant_methods *q_method)
 {
+  ENC_PROF_START(PROF_RDOQ);
   int   block_x = q_method->block_x;
 
   int*  ACLevel = q_method->ACLevel;
@@ -281,6 +285,7 @@ int quant_ac4x4_trellis(Macroblock *currMB, int **tblock, struct quant_methods *
 
   *ACL = 0;
 
+  ENC_PROF_STOP(PROF_RDOQ);
   return nonzero;
 }
 
@@ -376,6 +381,7 @@ void rdoq_ac4x4_CABAC(Macroblock *currMB, int **tblock, struct quant_methods *q_
 int quant_dc4x4_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel, int* DCRun, 
                        LevelQuantParams *q_params_4x4, const byte (*pos_scan)[2])
 {
+  ENC_PROF_START(PROF_RDOQ);
   Slice *currSlice = currMB->p_slice;
   QuantParameters *p_Quant = currMB->p_Vid->p_Quant;
   Boolean is_cavlc = (currSlice->symbol_mode == CAVLC);
@@ -434,6 +440,7 @@ int quant_dc4x4_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel,
 
   *DCL = 0;
 
+  ENC_PROF_STOP(PROF_RDOQ);
   return nonzero;
 }
 
@@ -27,6 +27,7 @@
 #include "q_matrix.h"
 #include "quant8x8.h"
 #include "rdoq.h"
+#include "enc_profile.h"
 
 /*!
 ************************************************************************
@@ -104,6 +105,7 @@ static void rdoq_8x8_CAVLC(Macroblock *currMB, int **tblock, int block_y, int bl
  */
 int quant_8x8_trellis(Macroblock *currMB, int **tblock, struct quant_methods *q_method)
 {
+  ENC_PROF_START(PROF_RDOQ);
   QuantParameters *p_Quant = currMB->p_Vid->p_Quant;
   int block_x = q_method->block_x;
   int  qp = q_method->qp;
@@ -166,6 +168,7 @@ int quant_8x8_trellis(Macroblock *currMB, int **tblock, struct quant_methods *q_
 
   *ACL = 0;
 
+  ENC_PROF_STOP(PROF_RDOQ);
   return nonzero;
 }
 
@@ -183,6 +186,7 @@ int quant_8x8_trellis(Macroblock *currMB, int **tblock, struct quant_methods *q_
  */
 int quant_8x8cavlc_trellis(Macroblock *currMB, int **tblock, struct quant_methods *q_method, int***  cofAC)
 {
+  ENC_PROF_START(PROF_RDOQ);
   QuantParameters *p_Quant = currMB->p_Vid->p_Quant;
   int block_x = q_method->block_x;
   int block_y = q_method->block_y;
@@ -257,6 +261,7 @@ int quant_8x8cavlc_trellis(Macroblock *currMB, int **tblock, struct quant_method
   for(k = 0; k < 4; k++)
     *(ACL[k]) = 0;
 
+  ENC_PROF_STOP(PROF_RDOQ);
   return nonzero;
 }
 
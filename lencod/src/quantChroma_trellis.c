@@ -22,6 +22,7 @@
 #include "quant4x4.h"
 #include "quantChroma.h"
 #include "rdoq.h"
+#include "enc_profile.h"
 
 /*!
  ************************************************************************
@@ -37,6 +38,7 @@
 int quant_dc2x2_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel, int* DCRun, 
                        LevelQuantParams *q_params_4x4, int **fadjust, const byte (*pos_scan)[2])
 {
+  ENC_PROF_START(PROF_RDOQ);
   Slice *currSlice = currMB->p_slice;
   QuantParameters *p_Quant = currMB->p_Vid->p_Quant;
   Boolean is_cavlc = (currMB->p_slice->symbol_mode == CAVLC);
@@ -97,6 +99,7 @@ int quant_dc2x2_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel,
 
   *DCL = 0;
 
+  ENC_PROF_STOP(PROF_RDOQ);
   return nonzero;
 }
 
@@ -114,6 +117,7 @@ int quant_dc2x2_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel,
 int quant_dc4x2_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel, int* DCRun, 
                        LevelQuantParams *q_params_4x4, int **fadjust, const byte (*pos_scan)[2])
 {
+  ENC_PROF_START(PROF_RDOQ);
   Slice *currSlice = currMB->p_slice;
   QuantParameters *p_Quant = currMB->p_Vid->p_Quant;
   Boolean is_cavlc = (currMB->p_slice->symbol_mode == CAVLC);
@@ -172,6 +176,7 @@ int quant_dc4x2_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel,
 
   *DCL = 0;
 
+  ENC_PROF_STOP(PROF_RDOQ);
   return nonzero;
 }
 
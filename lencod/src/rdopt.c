@@ -46,6 +46,7 @@
 #include "mv_search.h"
 #include "md_common.h"
 #include "md_distortion.h"
+#include "enc_profile.h"
 
 #define FASTMODE 1
 void compute_sad4x4_cost (VideoParameters *p_Vid, imgpel **cur_img, imgpel **prd_img, int pic_opix_x, distblk *cost, distblk min_cost);
@@ -61,7 +62,7 @@ static void set_ref_and_motion_vectors_B_slice    (Macroblock *currMB, PicMotion
 
 static inline void copy_motion_vectors_MB (Slice *currSlice, RD_DATA *rdopt)
 {
-  memcpy(&currSlice->all_mv [LIST_0][0][0][0][0][0], &rdopt->all_mv [LIST_0][0][0][0][0][0], 576 * currSlice->max_num_references * sizeof(short));  
+  memcpy(currSlice->all_mv_data, rdopt->all_mv_data, 2 * MV_REF_SIZE * currSlice->max_num_references * sizeof(short));
 }
 
 void alloc_rd8x8data (RD_8x8DATA *rd_data)
@@ -1480,6 +1481,8 @@ int RDCost_for_macroblocks (Macroblock  *currMB,   // <-- Current Macroblock to
   imgpel     **mb_pred = currSlice->mb_pred[0];
   imgpel     ***curr_mpr_16x16 = currSlice->mpr_16x16[0];
 
+  ENC_PROF_COUNT(PROF_CNT_RDO);
+
   // Test MV limits for Skip Mode. This could be necessary for MBAFF case Frame MBs.
   if ((currSlice->mb_aff_frame_flag) && (!currMB->mb_field) && (currSlice->slice_type == P_SLICE) && (mode==0) )
   {
@@ -1512,20 +1515,26 @@ int RDCost_for_macroblocks (Macroblock  *currMB,   // <-- Current Macroblock to
   }
   else if (mode==I4MB)
   {
+    ENC_PROF_START(PROF_INTRA);
     currMB->cbp = Mode_Decision_for_Intra4x4Macroblock (currMB, lambda, &dummy_d);
+    ENC_PROF_STOP(PROF_INTRA);
   }
   else if (mode==I16MB)
   {
+    ENC_PROF_START(PROF_INTRA);
     if (active_sps->chroma_format_idc == YUV444)
       Intra16x16_Mode_Decision444 (currMB);
     else if(p_Inp->I16rdo)
       Intra16x16_Mode_Decision_RDopt    (currMB, lambda);
     else
       Intra16x16_Mode_Decision_SAD      (currMB);
+    ENC_PROF_STOP(PROF_INTRA);
   }
   else if(mode==I8MB)
   {
+    ENC_PROF_START(PROF_INTRA);
     currMB->cbp = Mode_Decision_for_Intra8x8Macroblock(currMB, lambda, &dummy_d);
+    ENC_PROF_STOP(PROF_INTRA);
   }
   else if(mode==IPCM)
   {
@@ -15,6 +15,7 @@
  **************************************************************************/
 
 #include "global.h"
+#include "enc_statistics.h"
 
 #include "rdopt_coding_state.h"
 #include "cabac.h"
@@ -35,8 +36,7 @@ void delete_coding_state (CSobj *cs)
     if (cs->bitstream != NULL)   free (cs->bitstream);
 
     //=== contexts for binary arithmetic coding ===
-    delete_contexts_MotionInfo  (cs->mot_ctx);
-    delete_contexts_TextureInfo (cs->tex_ctx);
+    if (cs->redo.entry != NULL)  free (cs->redo.entry);
 
     //=== coding state structure ===
     free (cs);
@@ -73,19 +73,207 @@ CSobj *create_coding_state (InputParameters *p_Inp)
   if ((cs->bitstream = (Bitstream*) calloc (cs->no_part, sizeof(Bitstream))) == NULL)
     no_mem_exit("init_coding_state: cs->bitstream");
 
-  //=== context for binary arithmetic coding ===
-  if (p_Inp->symbol_mode == CABAC)
+  //=== contexts for binary arithmetic coding are kept in the context journal ===
+
+  return cs;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    create the journal of context modifications
+ ************************************************************************
+ */
+CtxJournal *create_ctx_journal (void)
+{
+  CtxJournal *journal;
+
+  if ((journal = (CtxJournal *) calloc (1, sizeof(CtxJournal))) == NULL)
+    no_mem_exit("create_ctx_journal: journal");
+
+  journal->epoch = 1;
+
+  return journal;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    delete the journal of context modifications
+ ************************************************************************
+ */
+void delete_ctx_journal (CtxJournal *journal)
+{
+  if (journal != NULL)
   {
-    cs->mot_ctx = create_contexts_MotionInfo ();
-    cs->tex_ctx = create_contexts_TextureInfo();
+    if (journal->undo.entry != NULL)
+      free (journal->undo.entry);
+    if (journal->state != NULL)
+      free (journal->state);
+    free (journal);
   }
-  else
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    empty the journal of context modifications. All coding states
+ *    stored before can no longer be restored.
+ ************************************************************************
+ */
+void reset_ctx_journal (CtxJournal *journal)
+{
+  if (journal != NULL)
   {
-    cs->mot_ctx = NULL;
-    cs->tex_ctx = NULL;
+    journal->undo.size = 0;
+    journal->no_states = 0;
+    ++journal->epoch;
   }
+}
 
-  return cs;
+/*!
+ ************************************************************************
+ * \brief
+ *    enlarge a list of context values
+ ************************************************************************
+ */
+void grow_ctx_entry_list(CtxEntryList *list)
+{
+  list->max_size = imax(2 * list->max_size, 1024);
+  if ((list->entry = (CtxJournalEntry *) realloc (list->entry, list->max_size * sizeof(CtxJournalEntry))) == NULL)
+    no_mem_exit("grow_ctx_entry_list: list->entry");
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    undo the context modifications journaled after position pos
+ ************************************************************************
+ */
+static int undo_ctx_journal (CtxJournal *journal, int pos)
+{
+  CtxEntryList *undo = &journal->undo;
+  int n = imax(undo->size - pos, 0);
+
+  while (undo->size > pos)
+  {
+    --undo->size;
+    *undo->entry[undo->size].ctx = undo->entry[undo->size].value;
+  }
+  return n;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    moves the base of a stored coding state back to journal position
+ *    pos. The values of the contexts modified between pos and the old
+ *    base are kept in the redo list of the coding state.
+ ************************************************************************
+ */
+static int rebase_coding_state (CtxJournal *journal, CSobj *cs, int pos)
+{
+  CtxJournalEntry *undo_entry = &journal->undo.entry[pos];
+  CtxEntryList *redo = &cs->redo;
+  int n = cs->base - pos;
+  int i, copied = undo_ctx_journal(journal, cs->base);
+
+  while (redo->size + n > redo->max_size)
+    grow_ctx_entry_list(redo);
+
+  memmove(&redo->entry[n], &redo->entry[0], redo->size * sizeof(CtxJournalEntry));
+  for (i = 0; i < n; ++i)
+  {
+    redo->entry[i].ctx   = undo_entry[i].ctx;
+    redo->entry[i].value = *undo_entry[i].ctx;
+  }
+  redo->size += n;
+  cs->base    = pos;
+
+  return copied + n;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    store the contexts of a coding state by its journal position
+ ************************************************************************
+ */
+static void store_contexts (CtxJournal *journal, CSobj *cs)
+{
+  if (cs->epoch != journal->epoch)
+  {
+    if (journal->no_states == journal->max_states)
+    {
+      journal->max_states = imax(2 * journal->max_states, 8);
+      if ((journal->state = (CSobj **) realloc (journal->state, journal->max_states * sizeof(CSobj *))) == NULL)
+        no_mem_exit("store_contexts: journal->state");
+    }
+    journal->state[journal->no_states++] = cs;
+    cs->epoch = journal->epoch;
+  }
+
+  cs->base = journal->undo.size;
+  cs->redo.size = 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    restore the contexts of a stored coding state. Coding states stored
+ *    later are rebased first so that they remain restorable.
+ * \return
+ *    number of context values copied
+ ************************************************************************
+ */
+static int reset_contexts (CtxJournal *journal, CSobj *cs)
+{
+  int i, copied = 0;
+
+  if (cs->epoch != journal->epoch)
+    error ("reset_contexts: coding state has not been stored", 500);
+
+  for (;;)
+  {
+    CSobj *newest = NULL;
+
+    for (i = 0; i < journal->no_states; ++i)
+    {
+      if (journal->state[i]->base > cs->base && (newest == NULL || journal->state[i]->base > newest->base))
+        newest = journal->state[i];
+    }
+    if (newest == NULL)
+      break;
+    copied += rebase_coding_state(journal, newest, cs->base);
+  }
+
+  copied += undo_ctx_journal(journal, cs->base);
+
+  for (i = 0; i < cs->redo.size; ++i)
+  {
+    journal_context(journal, cs->redo.entry[i].ctx);
+    *cs->redo.entry[i].ctx = cs->redo.entry[i].value;
+  }
+
+  return copied + cs->redo.size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    bytes copied for the elements of the current macroblock
+ ************************************************************************
+ */
+static int mb_coding_state_bytes (Macroblock *currMB)
+{
+  int bytes = sizeof(BitCounter) + 3 * sizeof(int64);
+
+  if (currMB->mb_type <= P8x8)
+    bytes += BLOCK_CONTEXT * sizeof(short);
+  if (currMB->p_slice->P444_joined)
+    bytes += 3 * sizeof(int64);
+
+  return bytes;
 }
 
 /*!
@@ -116,6 +304,7 @@ static void store_coding_state_cavlc (Macroblock *currMB, CSobj *cs)
   {
     cs->bitstream[i] = *currSlice->partArr[i].bitstream;
   }
+  currMB->p_Vid->p_Stats->cs_bytes_copied += i_last * sizeof(Bitstream) + mb_coding_state_bytes(currMB);
 
   //=== syntax element number and bitcounters ===
   cs->bits = currMB->bits;
@@ -132,10 +321,12 @@ static void store_coding_state_cavlc (Macroblock *currMB, CSobj *cs)
 /*!
  ************************************************************************
  * \brief
- *    store cabac coding state (for rd-optimized mode decision)
+ *    store cabac coding state for rd-optimized mode decision with
+ *    table based rate estimation. The contexts are not changed by the
+ *    rate estimation and therefore not stored.
  ************************************************************************
  */
-static void store_coding_state_cabac (Macroblock *currMB, CSobj *cs)
+static void store_coding_state_cabac_est (Macroblock *currMB, CSobj *cs)
 {
   int  i;
   Slice *currSlice = currMB->p_slice;
@@ -143,16 +334,12 @@ static void store_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   DataPartition *partArr = &currSlice->partArr[0];
 
   //=== important variables of data partition array ===
-  //only one partition for an IDR picture
   for (i = 0; i < i_last; i++)
   {
     cs->bitstream[i] = *partArr->bitstream;
     cs->encenv[i]    = (partArr++)->ee_cabac;    
   }
-
-  //=== contexts for binary arithmetic coding ===
-  *cs->mot_ctx = *currSlice->mot_ctx;
-  *cs->tex_ctx = *currSlice->tex_ctx;
+  currMB->p_Vid->p_Stats->cs_bytes_copied += i_last * (sizeof(Bitstream) + sizeof(EncodingEnvironment)) + mb_coding_state_bytes(currMB);
 
   //=== syntax element number and bitcounters ===
   cs->bits = currMB->bits;
@@ -166,6 +353,22 @@ static void store_coding_state_cabac (Macroblock *currMB, CSobj *cs)
     memcpy (cs->cbp_bits_8x8, currMB->cbp_bits_8x8, 3 * sizeof(int64));
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    store cabac coding state (for rd-optimized mode decision).
+ *    The contexts are not copied; their modifications after this point
+ *    are journaled by the arithmetic coder.
+ ************************************************************************
+ */
+static void store_coding_state_cabac (Macroblock *currMB, CSobj *cs)
+{
+  store_coding_state_cabac_est(currMB, cs);
+
+  //=== contexts for binary arithmetic coding ===
+  store_contexts(currMB->p_Vid->ctx_journal, cs);
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -195,6 +398,7 @@ static void reset_coding_state_cavlc (Macroblock *currMB, CSobj *cs)
     //--- parameters of encoding environments ---
     *currSlice->partArr[i].bitstream = cs->bitstream[i];
   }
+  currMB->p_Vid->p_Stats->cs_bytes_copied += i_last * sizeof(Bitstream) + mb_coding_state_bytes(currMB);
 
   //=== syntax element number and bit counters ===
   currMB->bits = cs->bits;
@@ -211,10 +415,11 @@ static void reset_coding_state_cavlc (Macroblock *currMB, CSobj *cs)
 /*!
  ************************************************************************
  * \brief
- *    restore coding state (for rd-optimized mode decision)
+ *    restore cabac coding state for rd-optimized mode decision with
+ *    table based rate estimation (contexts are left untouched)
  ************************************************************************
  */
-static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
+static void reset_coding_state_cabac_est (Macroblock *currMB, CSobj *cs)
 {
   int  i;
   Slice *currSlice = currMB->p_slice;
@@ -222,17 +427,12 @@ static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   DataPartition *partArr = &currSlice->partArr[0];
 
   //=== important variables of data partition array ===
-  //only one partition for an IDR picture
   for (i = 0; i < i_last; i++)
   {
-    //--- parameters of encoding environments ---
     *partArr->bitstream   = cs->bitstream[i];
     (partArr++)->ee_cabac = cs->encenv[i];
   }
-
-  //=== contexts for binary arithmetic coding ===
-  *currSlice->mot_ctx = *cs->mot_ctx;
-  *currSlice->tex_ctx = *cs->tex_ctx;
+  currMB->p_Vid->p_Stats->cs_bytes_copied += i_last * (sizeof(Bitstream) + sizeof(EncodingEnvironment)) + mb_coding_state_bytes(currMB);
 
   //=== syntax element number and bit counters ===
   currMB->bits = cs->bits;
@@ -247,7 +447,19 @@ static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
     memcpy (currMB->cbp_bits_8x8, cs->cbp_bits_8x8, 3 * sizeof(int64));
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    restore coding state (for rd-optimized mode decision)
+ ************************************************************************
+ */
+static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
+{
+  reset_coding_state_cabac_est(currMB, cs);
 
+  //=== contexts for binary arithmetic coding ===
+  currMB->p_Vid->p_Stats->cs_bytes_copied += reset_contexts(currMB->p_Vid->ctx_journal, cs) * sizeof(BiContextType);
+}
 
 
 /*!
@@ -258,6 +470,8 @@ static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
  */
 void init_coding_state_methods(Slice *currSlice)
 {
+  currSlice->p_Vid->cabac_rate_estimation = FALSE;
+
   if (currSlice->p_Inp->rdopt == 0)
   {
     currSlice->reset_coding_state = reset_coding_state_nordo;
@@ -265,8 +479,22 @@ void init_coding_state_methods(Slice *currSlice)
   }
   else
   {
-    if (currSlice->symbol_mode == CABAC)
+    if (currSlice->symbol_mode == CABAC && currSlice->p_Inp->CABACRateEstimation)
     {
+      // symbols are only rated during mode decision, see write_macroblock()
+      currSlice->p_Vid->cabac_rate_estimation = TRUE;
+      currSlice->reset_coding_state = reset_coding_state_cabac_est;
+      currSlice->store_coding_state = store_coding_state_cabac_est;
+    }
+    else if (currSlice->symbol_mode == CABAC)
+    {
+      VideoParameters *p_Vid = currSlice->p_Vid;
+
+      // the contexts of stored coding states are restored from the journal
+      if (p_Vid->ctx_journal == NULL)
+        p_Vid->ctx_journal = create_ctx_journal();
+      reset_ctx_journal(p_Vid->ctx_journal);
+
       currSlice->reset_coding_state = reset_coding_state_cabac;
       currSlice->store_coding_state = store_coding_state_cabac;
     }
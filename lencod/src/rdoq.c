@@ -434,7 +434,7 @@ void copy_rddata_trellis (Macroblock *currMB, RD_DATA *dest, RD_DATA *src)
   if (p_Vid->type != I_SLICE && p_Vid->type != SI_SLICE)
   {
     // note that this is not copying the bipred mvs!!!
-    memcpy(&dest->all_mv [0][0][0][0][0][0], &src->all_mv [0][0][0][0][0][0], p_Vid->max_num_references * 576 * sizeof(short)); // 2 * ref * 9 * 4 * 4 * 2
+    memcpy(dest->all_mv_data, src->all_mv_data, 2 * p_Vid->max_num_references * MV_REF_SIZE * sizeof(short));
   }
 
   memcpy(dest->intra_pred_modes,src->intra_pred_modes, MB_BLOCK_PARTITIONS * sizeof(char));
@@ -28,6 +28,7 @@
 #include "output.h"
 #include "parset.h"
 #include "report.h"
+#include "enc_profile.h"
 
 static const char DistortionType[3][20] = {"SAD", "SSE", "Hadamard SAD"};
 
@@ -202,6 +203,10 @@ void report_frame_statistic(VideoParameters *p_Vid, InputParameters *p_Inp)
   //save the last results
   p_Vid->frame_statistic_start = 0;
   fclose(p_stat_frm);
+
+#if (ENC_PROFILE)
+  enc_profile_report_frame(p_Vid->frame_no, p_Vid->type);
+#endif
 }
 
 
@@ -725,6 +730,13 @@ void report( VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_S
     float csnr_v = psnr(p_Vid->max_imgpel_value_comp_sq[2], impix_cr, sse->average[2]);
 
     fprintf(stdout,  " Total encoding time for the seq.  : %7.3f sec (%3.2f fps)\n", (float) p_Vid->tot_time * 0.001, 1000.0 * (float) (p_Stats->frame_counter) / (float)p_Vid->tot_time);
+    if (p_Inp->rdopt != 0)
+    {
+      int64 num_mbs = 0;
+      for (i = 0; i < NUM_SLICE_TYPES; i++)
+        num_mbs += p_Stats->num_macroblocks[i];
+      fprintf(stdout,  " Coding state bytes copied per MB  : %9.1f\n", (double) p_Stats->cs_bytes_copied / (double) i64max(num_mbs, 1));
+    }
     fprintf(stdout,  " Total ME time for sequence        : %7.3f sec \n\n", (float)p_Vid->me_tot_time * 0.001);
 
     fprintf(stdout," Y { PSNR (dB), cSNR (dB), MSE }   : { %7.3f, %7.3f, %9.5f }\n", 
@@ -53,6 +53,7 @@
 #include "quantChroma.h"
 #include "rdopt.h"
 #include "rdopt_coding_state.h"
+#include "slice_arena.h"
 
 // Local declarations
 static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp);
@@ -61,22 +62,13 @@ static void  set_ref_pic_num(Slice *currSlice);
 
 //! convert from H.263 QP to H.264 quant given by: quant=pow(2,QP/6)
 
-int allocate_block_mem(Slice *currSlice)
+static void allocate_block_mem(Slice *currSlice)
 {
-  int alloc_size = 0;
-  alloc_size += get_mem2Dint(&currSlice->tblk4x4, BLOCK_SIZE, BLOCK_SIZE);
-  alloc_size += get_mem2Dint(&currSlice->tblk16x16, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  alloc_size += get_mem4Dint(&currSlice->i16blk4x4, BLOCK_SIZE, BLOCK_SIZE, BLOCK_SIZE, BLOCK_SIZE);
-  
-  return (alloc_size);
-}
+  SliceArena *arena = currSlice->arena;
 
-
-void free_block_mem(Slice *currSlice)
-{
-  free_mem4Dint(currSlice->i16blk4x4);
-  free_mem2Dint(currSlice->tblk16x16);
-  free_mem2Dint(currSlice->tblk4x4);
+  currSlice->tblk4x4   = (int **)   arena_array(arena, sizeof(int), 2, BLOCK_SIZE, BLOCK_SIZE);
+  currSlice->tblk16x16 = (int **)   arena_array(arena, sizeof(int), 2, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  currSlice->i16blk4x4 = (int ****) arena_array(arena, sizeof(int), 4, BLOCK_SIZE, BLOCK_SIZE, BLOCK_SIZE, BLOCK_SIZE);
 }
 
 /*!
@@ -103,15 +95,17 @@ static void CAVLC_init(Slice *currSlice)
  * \par Input:
  *    Image Parameters VideoParameters *p_Vid                             \n
  *    int****** mv
+ *    short *data receives the flat view of the motion vectors
  * \return memory size in bytes
  ************************************************************************
  */
-static int get_mem_mv (Slice *currSlice, short ******* mv)
+static int get_mem_mv (Slice *currSlice, short ******* mv, short **data)
 {
   // LIST, reference, block_type, block_y, block_x, component
-  get_mem6Dshort(mv, 2, currSlice->max_num_references, 9, 4, 4, 2);
+  *mv = (short ******) arena_array(currSlice->arena, sizeof(short), 6, 2, currSlice->max_num_references, 9, 4, 4, 2);
+  *data = &(*mv)[LIST_0][0][0][0][0][0];
 
-  return 576 * currSlice->max_num_references * sizeof(short); // 2 * ref * 9 * 4 * 4 * 2
+  return 2 * MV_REF_SIZE * currSlice->max_num_references * sizeof(short);
 }
 
 /*!
@@ -126,7 +120,7 @@ static int get_mem_mv (Slice *currSlice, short ******* mv)
  */
 static int get_mem_bipred_mv (Slice *currSlice, short******** bipred_mv) 
 {
-  get_mem7Dshort(bipred_mv, 2, 2, currSlice->max_num_references, 9, 4, 4, 2);
+  *bipred_mv = (short *******) arena_array(currSlice->arena, sizeof(short), 7, 2, 2, currSlice->max_num_references, 9, 4, 4, 2);
   
   return 1152 * currSlice->max_num_references * sizeof(short);
 }
@@ -134,66 +128,27 @@ static int get_mem_bipred_mv (Slice *currSlice, short******** bipred_mv)
 /*!
  ************************************************************************
  * \brief
- *    Free memory from mv
- * \par Input:
- *    int****** mv
+ *    Allocate the buffers of a RD_DATA structure from the slice arena
  ************************************************************************
  */
-static void free_mem_mv (short****** mv)
+static void alloc_rddata(Slice *currSlice, RD_DATA *rd_data)
 {
-  free_mem6Dshort(mv);
-}
+  SliceArena *arena = currSlice->arena;
 
+  rd_data->rec_mb = (imgpel ***) arena_array(arena, sizeof(imgpel), 3, 3, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
 
-/*!
- ************************************************************************
- * \brief
- *    Free memory from mv
- * \par Input:
- *    int****** mv
- ************************************************************************
- */
-static void free_mem_bipred_mv (short******* bipred_mv) 
-{
-  free_mem7Dshort(bipred_mv);
-}
-
-
-static int alloc_rddata(Slice *currSlice, RD_DATA *rd_data)
-{
-  int alloc_size = 0;
-
-  alloc_size += get_mem3Dpel(&(rd_data->rec_mb), 3, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-
-  alloc_size += get_mem_ACcoeff (currSlice->p_Vid, &(rd_data->cofAC));
-  alloc_size += get_mem_DCcoeff (&(rd_data->cofDC));  
+  // same layout as get_mem_ACcoeff() / get_mem_DCcoeff()
+  rd_data->cofAC = (int ****) arena_array(arena, sizeof(int), 4, 4 + currSlice->p_Vid->num_blk8x8_uv, BLOCK_SIZE, 2, 65);
+  rd_data->cofDC = (int ***)  arena_array(arena, sizeof(int), 3, 3, 2, 18);
 
   if ((currSlice->slice_type != I_SLICE) && currSlice->slice_type != SI_SLICE)
   {          
-    alloc_size += get_mem_mv (currSlice, &(rd_data->all_mv));
+    get_mem_mv (currSlice, &(rd_data->all_mv), &(rd_data->all_mv_data));
   }
   
   // Why is this stored as height_blk * width_blk?
-  alloc_size += get_mem2D((byte***)&(rd_data->ipredmode), currSlice->height_blk, currSlice->width_blk);
-  alloc_size += get_mem3D((byte****)&(rd_data->refar), 2, 4, 4);
-
-  return alloc_size;
-}
-
-static void free_rddata(Slice *currSlice, RD_DATA *rd_data)
-{
-  free_mem3D((byte***) rd_data->refar);
-  free_mem2D((byte**)  rd_data->ipredmode);
-
-  if ((currSlice->slice_type != I_SLICE) && currSlice->slice_type != SI_SLICE)
-  {  
-    free_mem_mv (rd_data->all_mv);
-  }
-
-  free_mem_DCcoeff (rd_data->cofDC);
-  free_mem_ACcoeff (rd_data->cofAC);  
-
-  free_mem3Dpel(rd_data->rec_mb);
+  rd_data->ipredmode = (char **)  arena_array(arena, sizeof(char), 2, currSlice->height_blk, currSlice->width_blk);
+  rd_data->refar     = (char ***) arena_array(arena, sizeof(char), 3, 2, 4, 4);
 }
 
 
@@ -346,6 +301,7 @@ static int terminate_slice(Macroblock *currMB, int lastslice, StatParameters *cu
   int part;
   int tmp_stuffingbits = currMB->bits.mb_stuffing;
 
+  p_Vid->cabac_rate_estimation = FALSE;
   if (currSlice->symbol_mode == CABAC)
     write_terminating_bit (currSlice, 1);      // only once, not for all partitions
 
@@ -1173,8 +1129,8 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
     {
       (*currSlice)->num_ref_idx_active[LIST_1] = (char) imin((*currSlice)->num_ref_idx_active[LIST_1], p_Inp->B_List1_refs * ((p_Vid->structure !=0) + 1));
     }
-    get_mem3D((byte ****)(void*)&(*currSlice)->direct_ref_idx, (*currSlice)->height_blk, (*currSlice)->width_blk, 2);
-    get_mem2D((byte ***) (void*)&(*currSlice)->direct_pdir,    (*currSlice)->height_blk, (*currSlice)->width_blk);
+    (*currSlice)->direct_ref_idx = (char ***) arena_array((*currSlice)->arena, sizeof(char), 3, (*currSlice)->height_blk, (*currSlice)->width_blk, 2);
+    (*currSlice)->direct_pdir    = (char **)  arena_array((*currSlice)->arena, sizeof(char), 2, (*currSlice)->height_blk, (*currSlice)->width_blk);
   }
 
   // generate reference picture lists
@@ -1246,7 +1202,7 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
 
   if (((*currSlice)->slice_type != I_SLICE) && (*currSlice)->slice_type != SI_SLICE)
   {
-    get_mem_mv(*currSlice, &(*currSlice)->all_mv);  
+    get_mem_mv(*currSlice, &(*currSlice)->all_mv, &(*currSlice)->all_mv_data);  
 
     if (p_Inp->BiPredMotionEstimation && ((*currSlice)->slice_type == B_SLICE))
     {
@@ -1257,10 +1213,13 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
     {
       if (p_Inp->Transform8x8Mode && p_Inp->RDOQ_CP_MV)
       {
-        get_mem4Dmv (&(*currSlice)->tmp_mv8, 2, (*currSlice)->max_num_references, 4, 4);
-        get_mem3Ddistblk(&(*currSlice)->motion_cost8, 2, (*currSlice)->max_num_references, 4);
-        get_mem4Dmv (&(*currSlice)->tmp_mv4, 2, (*currSlice)->max_num_references, 4, 4);
-        get_mem3Ddistblk(&(*currSlice)->motion_cost4, 2, (*currSlice)->max_num_references, 4);
+        SliceArena *arena = (*currSlice)->arena;
+        int num_ref = (*currSlice)->max_num_references;
+
+        (*currSlice)->tmp_mv8      = (MotionVector ****) arena_array(arena, sizeof(MotionVector), 4, 2, num_ref, 4, 4);
+        (*currSlice)->motion_cost8 = (distblk ***)       arena_array(arena, sizeof(distblk), 3, 2, num_ref, 4);
+        (*currSlice)->tmp_mv4      = (MotionVector ****) arena_array(arena, sizeof(MotionVector), 4, 2, num_ref, 4, 4);
+        (*currSlice)->motion_cost4 = (distblk ***)       arena_array(arena, sizeof(distblk), 3, 2, num_ref, 4);
       }
     }
   }
@@ -1394,13 +1353,14 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
       (*currSlice)->Get_Direct_Motion_Vectors = Get_Direct_MV_Temporal;
   }
 
-  get_mem3Dpel(&((*currSlice)->mb_pred),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem3Dint(&((*currSlice)->mb_rres),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem3Dint(&((*currSlice)->mb_ores),   MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem4Dpel(&((*currSlice)->mpr_4x4),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem4Dpel(&((*currSlice)->mpr_8x8),   MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
-  get_mem4Dpel(&((*currSlice)->mpr_16x16), MAX_PLANE, 5, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  (*currSlice)->mb_pred   = (imgpel ***)  arena_array((*currSlice)->arena, sizeof(imgpel), 3, MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  (*currSlice)->mb_rres   = (int ***)     arena_array((*currSlice)->arena, sizeof(int),    3, MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  (*currSlice)->mb_ores   = (int ***)     arena_array((*currSlice)->arena, sizeof(int),    3, MAX_PLANE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  (*currSlice)->mpr_4x4   = (imgpel ****) arena_array((*currSlice)->arena, sizeof(imgpel), 4, MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  (*currSlice)->mpr_8x8   = (imgpel ****) arena_array((*currSlice)->arena, sizeof(imgpel), 4, MAX_PLANE, 9, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  (*currSlice)->mpr_16x16 = (imgpel ****) arena_array((*currSlice)->arena, sizeof(imgpel), 4, MAX_PLANE, 5, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
 
+  // cofAC/cofDC are swapped with the p_RDO buffers during mode decision, so they stay on the heap
   get_mem_ACcoeff (p_Vid, &((*currSlice)->cofAC));
   get_mem_DCcoeff (&((*currSlice)->cofDC));
 
@@ -1447,6 +1407,7 @@ static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   currSlice->p_Vid             = p_Vid;
   currSlice->p_Inp             = p_Inp;
+  currSlice->arena             = get_slice_arena(p_Vid);
 
   if (((currSlice->p_RDO)  = (RDOPTStructure *) calloc(1, sizeof(RDOPTStructure)))==NULL) 
     no_mem_exit("malloc_slice: p_RDO");
@@ -1612,13 +1573,6 @@ static void free_slice(Slice *currSlice)
     free_mem_ACcoeff (currSlice->cofAC);
     free_mem_DCcoeff (currSlice->cofDC);
 
-    free_mem3Dint(currSlice->mb_rres  );
-    free_mem3Dint(currSlice->mb_ores  );
-    free_mem3Dpel(currSlice->mb_pred  );
-    free_mem4Dpel(currSlice->mpr_16x16);
-    free_mem4Dpel(currSlice->mpr_8x8  );
-    free_mem4Dpel(currSlice->mpr_4x4  );
-
     if (currSlice->slice_type == B_SLICE)
     {
       free_colocated(currSlice->p_colocated);
@@ -1647,51 +1601,11 @@ static void free_slice(Slice *currSlice)
     if (currSlice->UseRDOQuant)
     {
       free(currSlice->estBitsCabac);
-
-      free_rddata(currSlice, &currSlice->rddata_trellis_curr);
-      if(currSlice->RDOQ_QP_Num > 1)
-      {
-        free_rddata(currSlice, &currSlice->rddata_trellis_best);
-      }
-    }
-
-    if(p_Vid->mb_aff_frame_flag)
-    {
-      free_rddata(currSlice, &currSlice->rddata_top_frame_mb);
-      free_rddata(currSlice, &currSlice->rddata_bot_frame_mb);
-
-      if ( p_Inp->MbInterlace != FRAME_MB_PAIR_CODING )
-      {
-        free_rddata(currSlice, &currSlice->rddata_top_field_mb);
-        free_rddata(currSlice, &currSlice->rddata_bot_field_mb);
-      }
     }
 
-    if ((currSlice->slice_type == P_SLICE) || (currSlice->slice_type == SP_SLICE) || (currSlice->slice_type == B_SLICE))
-    {
-      free_mem_mv (currSlice->all_mv);
-      if (p_Inp->BiPredMotionEstimation && (currSlice->slice_type == B_SLICE))
-        free_mem_bipred_mv(currSlice->bipred_mv);
-
-      if (currSlice->UseRDOQuant && currSlice->RDOQ_QP_Num > 1)
-      {
-        if (p_Inp->Transform8x8Mode && p_Inp->RDOQ_CP_MV)
-        {
-          free_mem4Dmv (currSlice->tmp_mv8);
-          free_mem3Ddistblk(currSlice->motion_cost8);
-          free_mem4Dmv (currSlice->tmp_mv4);
-          free_mem3Ddistblk(currSlice->motion_cost4);
-        }
-      }
-    }
-
-    if (currSlice->slice_type == B_SLICE)
-    {
-      free_mem3D((byte ***)currSlice->direct_ref_idx);
-      free_mem2D((byte **) currSlice->direct_pdir);
-    }
+    // mv, rd data, prediction and block buffers
+    release_slice_arena(p_Vid, currSlice->arena);
 
-    free_block_mem(currSlice);
     free(currSlice);
   }
 }
@@ -0,0 +1,222 @@
+/*!
+ ************************************************************************
+ * \file
+ *    slice_arena.c
+ *
+ * \brief
+ *    Arena allocator for the per-slice scratch memory of the encoder.
+ *
+ *    An arena starts with one block of ARENA_BLOCK_SIZE bytes and chains
+ *    further blocks when it runs out of space. When such an arena is
+ *    released its blocks are merged into one, so that after the first
+ *    slices every slice is served from a single block and the reset is
+ *    just clearing the fill level.
+ ************************************************************************
+ */
+
+#include <stdarg.h>
+
+#include "global.h"
+#include "memalloc.h"
+#include "slice_arena.h"
+
+#define ARENA_HEADER_SIZE  ((sizeof(ArenaBlock) + MEM_ALIGNMENT - 1) & ~((size_t) MEM_ALIGNMENT - 1))
+
+static inline byte *block_data(ArenaBlock *block)
+{
+  return (byte *) block + ARENA_HEADER_SIZE;
+}
+
+static ArenaBlock *new_block(size_t size)
+{
+  ArenaBlock *block = (ArenaBlock *) mem_calloc_aligned(ARENA_HEADER_SIZE + size);
+
+  if (block == NULL)
+    no_mem_exit("new_block: arena block");
+  block->size = size;
+
+  return block;
+}
+
+static void free_blocks(ArenaBlock *block)
+{
+  while (block != NULL)
+  {
+    ArenaBlock *next = block->next;
+    mem_free_aligned(block);
+    block = next;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates size bytes aligned to align (a power of two, at most
+ *    MEM_ALIGNMENT) from the arena
+ ************************************************************************
+ */
+static void *arena_alloc_aligned(SliceArena *arena, size_t size, size_t align)
+{
+  ArenaBlock *block = arena->block;
+  size_t offset = (arena->used + align - 1) & ~(align - 1);
+  void *ptr;
+
+  if (block == NULL || offset + size > block->size)
+  {
+    block = new_block((size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE);
+    block->next  = arena->block;
+    arena->block = block;
+    offset = 0;
+  }
+
+  ptr = block_data(block) + offset;
+  arena->used = offset + size;
+
+  memset(ptr, 0, size);
+  return ptr;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Takes an arena from the pool of idle arenas or creates a new one
+ ************************************************************************
+ */
+SliceArena *get_slice_arena(VideoParameters *p_Vid)
+{
+  SliceArena *arena = p_Vid->slice_arenas;
+
+  if (arena != NULL)
+  {
+    p_Vid->slice_arenas = arena->next;
+  }
+  else
+  {
+    if ((arena = (SliceArena *) calloc(1, sizeof(SliceArena))) == NULL)
+      no_mem_exit("get_slice_arena: arena");
+    arena->block = new_block(ARENA_BLOCK_SIZE);
+  }
+  arena->next = NULL;
+  arena->used = 0;
+
+  return arena;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Resets an arena and returns it to the pool. All memory allocated
+ *    from it becomes invalid.
+ ************************************************************************
+ */
+void release_slice_arena(VideoParameters *p_Vid, SliceArena *arena)
+{
+  if (arena == NULL)
+    return;
+
+  if (arena->block->next != NULL)
+  {
+    size_t size = 0;
+    ArenaBlock *block;
+
+    for (block = arena->block; block != NULL; block = block->next)
+      size += block->size;
+
+    free_blocks(arena->block);
+    arena->block = new_block(size);
+  }
+
+  arena->used = 0;
+  arena->next = p_Vid->slice_arenas;
+  p_Vid->slice_arenas = arena;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Frees the arenas of the pool
+ ************************************************************************
+ */
+void free_slice_arenas(VideoParameters *p_Vid)
+{
+  while (p_Vid->slice_arenas != NULL)
+  {
+    SliceArena *arena = p_Vid->slice_arenas;
+    p_Vid->slice_arenas = arena->next;
+    free_blocks(arena->block);
+    free(arena);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates size zeroed bytes from the arena
+ ************************************************************************
+ */
+void *arena_alloc(SliceArena *arena, size_t size)
+{
+  return arena_alloc_aligned(arena, size, 16);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocates a zeroed num_dims dimensional array from the arena
+ *
+ *    The elements are stored contiguously (the same layout as the
+ *    get_memXD() functions) starting at a MEM_ALIGNMENT boundary. For
+ *    more than one dimension the pointer tables are allocated from the
+ *    arena as well and the top level table is returned.
+ *
+ * \param arena
+ *    arena to allocate from
+ * \param elem_size
+ *    size of one element in bytes
+ * \param num_dims
+ *    number of dimensions (1 to ARENA_MAX_DIMS), followed by the
+ *    dimensions as int, outermost first
+ ************************************************************************
+ */
+void *arena_array(SliceArena *arena, size_t elem_size, int num_dims, ...)
+{
+  int     dims[ARENA_MAX_DIMS];
+  void  **table[ARENA_MAX_DIMS];
+  size_t  count = 1, i;
+  byte   *data;
+  int     k;
+  va_list ap;
+
+  if (num_dims < 1 || num_dims > ARENA_MAX_DIMS)
+    error("arena_array: invalid number of dimensions", 100);
+
+  va_start(ap, num_dims);
+  for (k = 0; k < num_dims; ++k)
+    dims[k] = va_arg(ap, int);
+  va_end(ap);
+
+  for (k = 0; k < num_dims - 1; ++k)
+  {
+    count *= dims[k];
+    table[k] = (void **) arena_alloc_aligned(arena, count * sizeof(void *), sizeof(void *));
+  }
+  data = (byte *) arena_alloc_aligned(arena, count * dims[num_dims - 1] * elem_size, MEM_ALIGNMENT);
+
+  count = 1;
+  for (k = 0; k < num_dims - 1; ++k)
+  {
+    count *= dims[k];
+    if (k < num_dims - 2)
+    {
+      for (i = 0; i < count; ++i)
+        table[k][i] = table[k + 1] + i * dims[k + 1];
+    }
+    else
+    {
+      for (i = 0; i < count; ++i)
+        table[k][i] = data + i * dims[k + 1] * elem_size;
+    }
+  }
+
+  return (num_dims > 1) ? (void *) table[0] : (void *) data;
+}
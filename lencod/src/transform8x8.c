@@ -39,6 +39,7 @@
 #include "md_common.h"
 #include "intra8x8.h"
 #include "rdopt_coding_state.h"
+#include "enc_profile.h"
 
 //! single scan pattern
 static const byte SNGL_SCAN8x8[64][2] = {
@@ -509,6 +510,7 @@ static inline int check_zero(int **mb_ores, int block_x)
  */
 int dct_8x8(Macroblock *currMB, ColorPlane pl, int b8, int *coeff_cost, int intra)
 {
+  ENC_PROF_START(PROF_TRANS_QUANT);
   VideoParameters *p_Vid = currMB->p_Vid;
   int nonzero = FALSE; 
 
@@ -571,6 +573,7 @@ int dct_8x8(Macroblock *currMB, ColorPlane pl, int b8, int *coeff_cost, int intr
   }  
 
   //  Decoded block moved to frame memory
+  ENC_PROF_STOP(PROF_TRANS_QUANT);
   return nonzero;
 }
 
@@ -591,6 +594,7 @@ int dct_8x8(Macroblock *currMB, ColorPlane pl, int b8, int *coeff_cost, int intr
  */
 int dct_8x8_cavlc(Macroblock *currMB, ColorPlane pl, int b8, int *coeff_cost, int intra)
 {
+  ENC_PROF_START(PROF_TRANS_QUANT);
   VideoParameters *p_Vid = currMB->p_Vid;
   int nonzero = FALSE; 
 
@@ -644,6 +648,7 @@ int dct_8x8_cavlc(Macroblock *currMB, ColorPlane pl, int b8, int *coeff_cost, in
   }  
 
   //  Decoded block moved to frame memory
+  ENC_PROF_STOP(PROF_TRANS_QUANT);
   return nonzero;
 }
 
@@ -595,70 +595,46 @@ int writeSyntaxElement2Buf_UVLC(SyntaxElement *se, Bitstream* this_streamBuffer
 /*!
  ************************************************************************
  * \brief
- *    writes UVLC code to the appropriate buffer
+ *    writes the len (at most 32) least significant bits of value to the
+ *    buffer. The bits pending in byte_buf and the new bits are collected
+ *    in a 64 bit accumulator and written out as whole bytes.
  ************************************************************************
  */
-void  writeUVLC2buffer(SyntaxElement *se, Bitstream *currStream)
+static inline void write_bits(Bitstream *currStream, unsigned int value, int len)
 {
-  unsigned int mask = 1 << (se->len - 1);
-  byte *byte_buf  = &currStream->byte_buf;
-  int *bits_to_go = &currStream->bits_to_go;
-  int i;
+  int pending = 8 - currStream->bits_to_go;
+  uint64 acc = ((uint64) (currStream->byte_buf & ((1 << pending) - 1)) << len) | (value & (((uint64) 1 << len) - 1));
+  byte *out = currStream->streamBuffer + currStream->byte_pos;
 
-  // Add the new bits to the bitstream.
-  // Write out a byte if it is full
-  if ( se->len < 33 )
+  pending += len;
+  while (pending >= 8)
   {
-    for (i = 0; i < se->len; i++)
-    {
-      *byte_buf <<= 1;
-
-      if (se->bitpattern & mask)
-        *byte_buf |= 1;
-
-      mask >>= 1;
-
-      if ((--(*bits_to_go)) == 0)
-      {
-        *bits_to_go = 8;      
-        currStream->streamBuffer[currStream->byte_pos++] = *byte_buf;
-        *byte_buf = 0;      
-      }
-    }
+    pending -= 8;
+    *out++ = (byte) (acc >> pending);
   }
-  else
-  {
-    // zeros
-    for (i = 0; i < (se->len - 32); i++)
-    {
-      *byte_buf <<= 1;
 
-      if ((--(*bits_to_go)) == 0)
-      {
-        *bits_to_go = 8;      
-        currStream->streamBuffer[currStream->byte_pos++] = *byte_buf;
-        *byte_buf = 0;      
-      }
-    }
-    // actual info
-    mask = (unsigned int) 1 << 31;
-    for (i = 0; i < 32; i++)
-    {
-      *byte_buf <<= 1;
-
-      if (se->bitpattern & mask)
-        *byte_buf |= 1;
+  currStream->byte_pos   = (int) (out - currStream->streamBuffer);
+  currStream->byte_buf   = (byte) (acc & ((1 << pending) - 1));
+  currStream->bits_to_go = 8 - pending;
+}
 
-      mask >>= 1;
+/*!
+ ************************************************************************
+ * \brief
+ *    writes UVLC code to the appropriate buffer
+ ************************************************************************
+ */
+void  writeUVLC2buffer(SyntaxElement *se, Bitstream *currStream)
+{
+  int zeros = se->len - 32;
 
-      if ((--(*bits_to_go)) == 0)
-      {
-        *bits_to_go = 8;      
-        currStream->streamBuffer[currStream->byte_pos++] = *byte_buf;
-        *byte_buf = 0;      
-      }
-    }
+  // codewords longer than 32 bits start with zeros
+  while (zeros > 0)
+  {
+    write_bits(currStream, 0, imin(zeros, 32));
+    zeros -= 32;
   }
+  write_bits(currStream, (unsigned int) se->bitpattern, imin(se->len, 32));
 }
 
 
@@ -54,25 +54,210 @@ void InitWP(VideoParameters *p_Vid, InputParameters *p_Inp)
   }
 }
 
+#if defined(__SSE2__) && (IMGTYPE < 2)
+#include <emmintrin.h>
+
 /*!
 ************************************************************************
 * \brief
-*    Compute sum of samples in a picture
+*    Computes the sum and the sum of squares of the samples of a plane (SSE2)
 ************************************************************************
 */
-double ComputeImgSum(imgpel **CurrentImage, int height, int width)
+static void sum_plane(imgpel **img, int height, int width, int64 *sum, int64 *sum2)
 {
+  __m128i zero = _mm_setzero_si128();
+  __m128i one  = _mm_set1_epi16(1);
+  __m128i vsum  = zero;
+  __m128i vsum2 = zero;
+  int64 s = 0, s2 = 0;
+  int64 lanes[2];
   int i, j;
-  double sum_value = 0.0;
 
-  for (i = 0; i < height; i++)
+  for (i = 0; i < height; ++i)
+  {
+    imgpel *line = img[i];
+    __m128i rsum = zero;
+
+    for (j = 0; j + 8 <= width; j += 8)
+    {
+#if (IMGTYPE == 0)
+      __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) &line[j]), zero);
+#else
+      __m128i v = _mm_loadu_si128((const __m128i *) &line[j]);
+#endif
+      __m128i sq = _mm_madd_epi16(v, v);
+
+      rsum  = _mm_add_epi32(rsum, _mm_madd_epi16(v, one));
+      vsum2 = _mm_add_epi64(vsum2, _mm_add_epi64(_mm_unpacklo_epi32(sq, zero), _mm_unpackhi_epi32(sq, zero)));
+    }
+    vsum = _mm_add_epi64(vsum, _mm_add_epi64(_mm_unpacklo_epi32(rsum, zero), _mm_unpackhi_epi32(rsum, zero)));
+
+    for (; j < width; ++j)
+    {
+      s  += line[j];
+      s2 += line[j] * line[j];
+    }
+  }
+
+  _mm_storeu_si128((__m128i *) lanes, vsum);
+  *sum  = s + lanes[0] + lanes[1];
+  _mm_storeu_si128((__m128i *) lanes, vsum2);
+  *sum2 = s2 + lanes[0] + lanes[1];
+}
+#else
+/*!
+************************************************************************
+* \brief
+*    Computes the sum and the sum of squares of the samples of a plane
+************************************************************************
+*/
+static void sum_plane(imgpel **img, int height, int width, int64 *sum, int64 *sum2)
+{
+  int64 s = 0, s2 = 0;
+  int i, j;
+
+  for (i = 0; i < height; ++i)
+  {
+    imgpel *line = img[i];
+    for (j = 0; j < width; ++j)
+    {
+      s  += line[j];
+      s2 += line[j] * line[j];
+    }
+  }
+  *sum  = s;
+  *sum2 = s2;
+}
+#endif
+
+/*!
+************************************************************************
+* \brief
+*    Computes the sample statistics of a plane
+************************************************************************
+*/
+static void compute_plane_stats(PlaneStats *s, imgpel **img, int height, int width)
+{
+  int64 sum, sum2;
+
+  sum_plane(img, height, width, &sum, &sum2);
+
+  s->img        = img;
+  s->height     = height;
+  s->width      = width;
+  s->dsum       = (double) sum;
+  s->dsum2      = (double) sum2;
+  s->ddc        = s->dsum / (double) (height * width);
+  s->norm_valid = FALSE;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Computes the statistics of all planes of a reference picture.
+*    Called when the picture enters the DPB.
+************************************************************************
+*/
+void ComputePicStats(StorablePicture *p)
+{
+  int k;
+
+  if (p->p_stats.plane[0].img != p->imgY)
+    compute_plane_stats(&p->p_stats.plane[0], p->imgY, p->size_y, p->size_x);
+
+  if (p->imgUV != NULL)
   {
-    for (j = 0; j < width; j++)
+    for (k = 0; k < 2; k++)
+    {
+      if (p->p_stats.plane[k + 1].img != p->imgUV[k])
+        compute_plane_stats(&p->p_stats.plane[k + 1], p->imgUV[k], p->size_y_cr, p->size_x_cr);
+    }
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Returns the statistics of a plane (imgY, imgUV[0] or imgUV[1]) of a
+*    reference picture. Monochrome pictures only have the luma plane.
+************************************************************************
+*/
+PlaneStats *GetRefPlaneStats(StorablePicture *p, imgpel **img)
+{
+  PlaneStats *s = &p->p_stats.plane[0];
+
+  if (img != p->imgY && p->chroma_format_idc != YUV400)
+    s = &p->p_stats.plane[(img == p->imgUV[0]) ? 1 : 2];
+
+  if (s->img != img)
+    ComputePicStats(p);
+  return s;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Returns the statistics of a plane of the original picture. They are
+*    kept until ResetOrgStats() is called for the next input frame.
+************************************************************************
+*/
+PlaneStats *GetOrgPlaneStats(VideoParameters *p_Vid, imgpel **img, int height, int width)
+{
+  PlaneStats *s;
+  int k;
+
+  for (k = 0; k < WP_ORG_PLANES; k++)
+  {
+    s = &p_Vid->wp_org_stats[k];
+    if (s->img == img && s->height == height && s->width == width)
+      return s;
+  }
+
+  s = &p_Vid->wp_org_stats[p_Vid->wp_org_next];
+  p_Vid->wp_org_next = (p_Vid->wp_org_next + 1) % WP_ORG_PLANES;
+  compute_plane_stats(s, img, height, width);
+  return s;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Invalidates the statistics of the original planes
+************************************************************************
+*/
+void ResetOrgStats(VideoParameters *p_Vid)
+{
+  memset(p_Vid->wp_org_stats, 0, WP_ORG_PLANES * sizeof(PlaneStats));
+  p_Vid->wp_org_next = 0;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Returns the sum of the absolute differences of the samples of a
+*    plane to mean_value. The sum is kept for repeated requests with the
+*    same mean value.
+************************************************************************
+*/
+double GetPlaneNorm(PlaneStats *s, double mean_value)
+{
+  if (!s->norm_valid || s->norm_mean != mean_value)
+  {
+    int i, j;
+    double sum_value = 0.0;
+
+    for (i = 0; i < s->height; i++)
     {
-      sum_value += (double) CurrentImage[i][j];
+      for (j = 0; j < s->width; j++)
+      {
+        sum_value += dabs((double) s->img[i][j] - mean_value);
+      }
     }
+    s->dnorm      = sum_value;
+    s->norm_mean  = mean_value;
+    s->norm_valid = TRUE;
   }
-  return sum_value;
+  return s->dnorm;
 }
 
 /*!
@@ -108,13 +293,13 @@ void EstimateWPPSliceAlg0(Slice *currSlice, int select_offset)
   default_weight[0]       = 1 << currSlice->luma_log_weight_denom;
   default_weight[1]       = default_weight[2] = 1 << currSlice->chroma_log_weight_denom;
   
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
     } 
   }
 
@@ -135,7 +320,7 @@ void EstimateWPPSliceAlg0(Slice *currSlice, int select_offset)
 
         // Y
         tmpPtr = p_Vid->listX[clist][n]->p_curr_img;      
-        dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
         if (p_Inp->ChromaWeightSupport == 1)
         {
@@ -143,7 +328,7 @@ void EstimateWPPSliceAlg0(Slice *currSlice, int select_offset)
           {
             // UV
             tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-            dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
           }        
         }
 
@@ -319,13 +504,13 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
   }
   else
   {
-    dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
       } 
     }
 
@@ -347,7 +532,7 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
           // stored in the reference buffer and attach them to the storedimage structure!!!
           // Y
           tmpPtr = p_Vid->listX[clist][n]->p_curr_img;
-          dc_ref[clist][n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+          dc_ref[clist][n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
           if (dc_ref[clist][n] != 0.0)
             wf_weight = (short) (default_weight[0] * dc_org / dc_ref[clist][n] + 0.5);
@@ -367,7 +552,7 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
             for (k = 0; k < 2; k++)
             {        	
               tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-              dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+              dc_ref_UV[clist][n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
               if (dc_ref_UV[clist][n][k] != 0.0)
                 wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -484,13 +669,13 @@ int TestWPPSliceAlg0(VideoParameters *p_Vid, int select_offset)
     }
   }
 
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
     } 
   }
 
@@ -499,14 +684,14 @@ int TestWPPSliceAlg0(VideoParameters *p_Vid, int select_offset)
     for (n = 0; n < p_Vid->listXsize[clist]; n++)
     {
       tmpPtr = p_Vid->listX[clist][n]->p_curr_img;
-      dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+      dc_ref[n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
       if (p_Inp->ChromaWeightSupport == 1)
       {
         for (k = 0; k < 2; k++)
         {
           tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-          dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+          dc_ref_UV[n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
         }        
       }
 
@@ -699,13 +884,13 @@ int TestWPBSliceAlg0(VideoParameters *p_Vid, int select_method)
   }
   else
   {
-    dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
       } 
     }
 
@@ -717,7 +902,7 @@ int TestWPBSliceAlg0(VideoParameters *p_Vid, int select_method)
         // stored in the reference buffer and attach them to the storedimage structure!!!
         // Y
         tmpPtr = p_Vid->listX[clist][n]->p_curr_img;
-        dc_ref[clist][n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[clist][n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
         if (dc_ref[clist][n] != 0.0)
           wf_weight = (short) (default_weight[0] * dc_org / dc_ref[clist][n] + 0.5);
@@ -735,7 +920,7 @@ int TestWPBSliceAlg0(VideoParameters *p_Vid, int select_method)
           for (k = 0; k < 2; k++)
           {
             tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-            dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[clist][n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
             if (dc_ref_UV[clist][n][k] != 0.0)
               wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -18,21 +18,6 @@
 #include "image.h"
 #include "wp.h"
 
-static inline double ComputeNormMean(imgpel **CurrentImage, double mean_value, int height, int width)
-{
-  int i, j;
-  double sum_value = 0.0;
-
-  for (i = 0; i < height; i++)
-  {
-    for (j = 0; j < width; j++)
-    {
-      sum_value += dabs((double) CurrentImage[i][j] - mean_value);
-    }
-  }
-  return sum_value;
-}
-
 /*!
 ************************************************************************
 * \brief
@@ -70,16 +55,16 @@ void EstimateWPPSliceAlg1(Slice *currSlice, int select_offset)
   default_weight[0]       = 1 << currSlice->luma_log_weight_denom;
   default_weight[1]       = default_weight[2] = 1 << currSlice->chroma_log_weight_denom;
   
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
   norm_org = dc_org / ((double) p_Vid->size);
-  numer = ComputeNormMean(p_Vid->pCurImg, norm_org, p_Vid->height, p_Vid->width);
+  numer = GetPlaneNorm(GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width), norm_org);
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
     } 
   }
 
@@ -100,10 +85,10 @@ void EstimateWPPSliceAlg1(Slice *currSlice, int select_offset)
 
         // Y
         tmpPtr = p_Vid->listX[clist][n]->p_curr_img;      
-        dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
         norm_ref[n] = dc_ref[n] / ((double) p_Vid->size);
-        denom[n] = ComputeNormMean(tmpPtr, norm_ref[n], p_Vid->height, p_Vid->width);
+        denom[n] = GetPlaneNorm(GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr), norm_ref[n]);
 
         if (p_Inp->ChromaWeightSupport == 1)
         {
@@ -111,7 +96,7 @@ void EstimateWPPSliceAlg1(Slice *currSlice, int select_offset)
           {
             // UV
             tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-            dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
           }        
         }
 
@@ -296,19 +281,19 @@ void EstimateWPBSliceAlg1(Slice *currSlice)
   }
   else // explicit WP mode (or no WP at all)
   {
-    dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
     if (p_Inp->EnhancedBWeightSupport)
     {
       norm_org = dc_org / ((double) p_Vid->size);
-      numer = ComputeNormMean(p_Vid->pCurImg, norm_org, p_Vid->height, p_Vid->width);
+      numer = GetPlaneNorm(GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width), norm_org);
     }
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
       } 
     }
 
@@ -330,12 +315,12 @@ void EstimateWPBSliceAlg1(Slice *currSlice)
           // stored in the reference buffer and attach them to the storedimage structure!!!
           // Y
           tmpPtr = p_Vid->listX[clist][n]->p_curr_img;
-          dc_ref[clist][n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+          dc_ref[clist][n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
           if (p_Inp->EnhancedBWeightSupport)
           {
             norm_ref[n] = dc_ref[clist][n] / ((double) p_Vid->size);
-            denom[n] = ComputeNormMean(tmpPtr, norm_ref[n], p_Vid->height, p_Vid->width);
+            denom[n] = GetPlaneNorm(GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr), norm_ref[n]);
           }
           if (p_Inp->EnhancedBWeightSupport)
           {
@@ -371,7 +356,7 @@ void EstimateWPBSliceAlg1(Slice *currSlice)
             for (k = 0; k < 2; k++)
             {        	
               tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-              dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+              dc_ref_UV[clist][n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
               if (dc_ref_UV[clist][n][k] != 0.0)
                 wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -492,16 +477,16 @@ int TestWPPSliceAlg1(VideoParameters *p_Vid, int select_offset)
     }
   }
 
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
   norm_org = dc_org / ((double) p_Vid->size);
-  numer = ComputeNormMean(p_Vid->pCurImg, norm_org, p_Vid->height, p_Vid->width);
+  numer = GetPlaneNorm(GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width), norm_org);
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
     } 
   }
 
@@ -510,17 +495,17 @@ int TestWPPSliceAlg1(VideoParameters *p_Vid, int select_offset)
     for (n = 0; n < p_Vid->listXsize[clist]; n++)
     {
       tmpPtr = p_Vid->listX[clist][n]->p_curr_img;
-      dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+      dc_ref[n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
       norm_ref[n] = dc_ref[n] / ((double) p_Vid->size);
-      denom[n] = ComputeNormMean(tmpPtr, norm_ref[n], p_Vid->height, p_Vid->width);
+      denom[n] = GetPlaneNorm(GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr), norm_ref[n]);
 
       if (p_Inp->ChromaWeightSupport == 1)
       {
         for (k = 0; k < 2; k++)
         {
           tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-          dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+          dc_ref_UV[n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
         }        
       }
 
@@ -722,19 +707,19 @@ int TestWPBSliceAlg1(VideoParameters *p_Vid, int select_method)
   }
   else
   {
-    dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
     if (p_Inp->EnhancedBWeightSupport)
     {
       norm_org = dc_org / ((double) p_Vid->size);
-      numer = ComputeNormMean(p_Vid->pCurImg, norm_org, p_Vid->height, p_Vid->width);
+      numer = GetPlaneNorm(GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width), norm_org);
     }
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
       } 
     }
 
@@ -746,12 +731,12 @@ int TestWPBSliceAlg1(VideoParameters *p_Vid, int select_method)
         // stored in the reference buffer and attach them to the storedimage structure!!!
         // Y
         tmpPtr = p_Vid->listX[clist][n]->p_curr_img;
-        dc_ref[clist][n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[clist][n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
         if (p_Inp->EnhancedBWeightSupport)
         {
           norm_ref[n] = dc_ref[clist][n] / ((double) p_Vid->size);
-          denom[n] = ComputeNormMean(tmpPtr, norm_ref[n], p_Vid->height, p_Vid->width);
+          denom[n] = GetPlaneNorm(GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr), norm_ref[n]);
 
           if (denom[n] != 0)
             wf_weight = (short) (default_weight[0] * numer / denom[n] + 0.5);
@@ -783,7 +768,7 @@ int TestWPBSliceAlg1(VideoParameters *p_Vid, int select_method)
           for (k = 0; k < 2; k++)
           {
             tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-            dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[clist][n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
             if (dc_ref_UV[clist][n][k] != 0.0)
               wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
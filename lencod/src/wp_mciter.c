@@ -18,6 +18,12 @@
 #include "image.h"
 #include "wp.h"
 
+#if !defined(WIN32)
+#include <pthread.h>
+#endif
+
+#define WP_MAX_THREADS  16  //!< maximum number of compute_offset() jobs
+
 /*!
 ************************************************************************
 * \brief
@@ -51,13 +57,13 @@ void EstimateWPPSliceAlg2(Slice *currSlice, int select_offset)
   default_weight[0]       = 1 << currSlice->luma_log_weight_denom;
   default_weight[1]       = default_weight[2] = 1 << currSlice->chroma_log_weight_denom;
   
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
     } 
   }
 
@@ -78,7 +84,7 @@ void EstimateWPPSliceAlg2(Slice *currSlice, int select_offset)
 
         // Y
         tmpPtr = p_Vid->listX[clist][n]->p_curr_img;      
-        dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
         if (p_Inp->ChromaWeightSupport == 1)
         {
@@ -86,7 +92,7 @@ void EstimateWPPSliceAlg2(Slice *currSlice, int select_offset)
           {
             // UV
             tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-            dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
           }        
         }
 
@@ -260,13 +266,13 @@ void EstimateWPBSliceAlg2(Slice *currSlice)
   }
   else
   {
-    dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
       } 
     }
 
@@ -295,7 +301,7 @@ void EstimateWPBSliceAlg2(Slice *currSlice)
             for (k = 0; k < 2; k++)
             {        	
               tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-              dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+              dc_ref_UV[clist][n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
               if (dc_ref_UV[clist][n][k] != 0.0)
                 wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -412,13 +418,13 @@ int TestWPPSliceAlg2(VideoParameters *p_Vid, int select_offset)
     }
   }
 
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
     } 
   }
 
@@ -427,14 +433,14 @@ int TestWPPSliceAlg2(VideoParameters *p_Vid, int select_offset)
     for (n = 0; n < p_Vid->listXsize[clist]; n++)
     {
       tmpPtr = p_Vid->listX[clist][n]->p_curr_img;
-      dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+      dc_ref[n] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
       if (p_Inp->ChromaWeightSupport == 1)
       {
         for (k = 0; k < 2; k++)
         {
           tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-          dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+          dc_ref_UV[n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
         }        
       }
 
@@ -626,13 +632,13 @@ int TestWPBSliceAlg2(VideoParameters *p_Vid, int select_method)
   }
   else
   {
-    dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    dc_org = GetOrgPlaneStats(p_Vid, p_Vid->pCurImg, p_Vid->height, p_Vid->width)->dsum;
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = GetOrgPlaneStats(p_Vid, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr)->dsum;
       } 
     }
 
@@ -649,7 +655,7 @@ int TestWPBSliceAlg2(VideoParameters *p_Vid, int select_method)
           for (k = 0; k < 2; k++)
           {
             tmpPtr = p_Vid->listX[clist][n]->imgUV[k];
-            dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[clist][n][k] = GetRefPlaneStats(p_Vid->listX[clist][n], tmpPtr)->dsum;
 
             if (dc_ref_UV[clist][n][k] != 0.0)
               wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -740,122 +746,174 @@ int TestWPBSliceAlg2(VideoParameters *p_Vid, int select_method)
   return perform_wp;
 }
 
-void compute_offset(VideoParameters *p_Vid)
+//! accumulation of the MC offsets of the reference indices ref_idx with ref_idx % num_jobs == job
+typedef struct wp_offset_job
 {
-  PicMotionParams *motion = &p_Vid->enc_picture->motion;
-  Macroblock *currMB;
-  int i, j, x, y, xj, yi, temp, valOrg;
-  int mvx=0,  mvy=0;
-  int ref_frame=0;
-  int subblock=0;
-  int x_orig, y_orig;       
-  int x_pos, y_pos;
-  int out4Y_width  = (p_Vid->width  + 2 * IMG_PAD_SIZE) * 4 - 1;  
+  VideoParameters *p_Vid;
+  int job;
+  int num_jobs;
+  int total[2][MAX_REFERENCE_PICTURES];
+  int count[2][MAX_REFERENCE_PICTURES];
+} WPOffsetJob;
+
+/*!
+************************************************************************
+* \brief
+*    Accumulates the differences between the original and the motion
+*    compensated samples of a 4x4 block
+************************************************************************
+*/
+static void accumulate_block_offset(VideoParameters *p_Vid, StorablePicture *ref, int x, int y, int mvx, int mvy, int *total, int *count)
+{
+  int out4Y_width  = (p_Vid->width  + 2 * IMG_PAD_SIZE) * 4 - 1;
   int out4Y_height = (p_Vid->height + 2 * IMG_PAD_SIZE) * 4 - 1;
+  int xj, yi, x_pos, y_pos;
 
-  int frame, list, offset; 
-  double dtemp;
-  int numlists  = (p_Vid->type == B_SLICE) ? 2 : 1;
+  for(yi = 0; yi < 4; yi++)
+  {    //y
+    for(xj = 0; xj < 4; xj++)
+    {  //x
+      int valOrg = p_Vid->pCurImg[y+yi][x+xj];
 
+      y_pos = imax(0,imin(out4Y_height,4*(y+yi)+4*IMG_PAD_SIZE+mvy));
+      x_pos = imax(0,imin(out4Y_width, 4*(x+xj)+4*IMG_PAD_SIZE+mvx));
 
-  for(list = 0; list < 2; list++)
-  {
-    for(frame = 0; frame < MAX_REFERENCE_PICTURES; frame++)
-    {
-      p_Vid->frameOffsetTotal[list][frame] = 0;
-      p_Vid->frameOffsetCount[list][frame] = 0;
+      *total += valOrg - ref->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
+      (*count)++;
     }
   }
+}
 
+/*!
+************************************************************************
+* \brief
+*    Accumulates the MC offsets of the reference indices of one job
+************************************************************************
+*/
+static void accumulate_offsets(WPOffsetJob *job)
+{
+  VideoParameters *p_Vid = job->p_Vid;
+  PicMotionParams *motion = &p_Vid->enc_picture->motion;
+  Macroblock *currMB;
+  int i, j, x, y, list;
+  int ref_frame;
+  int subblock;
+
+  memset(job->total, 0, sizeof(job->total));
+  memset(job->count, 0, sizeof(job->count));
 
   for(i=0; i<p_Vid->height >> 4; i++) //y
   {
     for(j=0; j<p_Vid->width >> 4; j++)  //x
     {
-      { 
-        currMB = &p_Vid->mb_data[((i*p_Vid->width) >> 4)+j];
-        if(IS_INTRA(currMB)) //intra macroblocks are not used for calculation of the filter coeffs.
-          continue;
+      currMB = &p_Vid->mb_data[((i*p_Vid->width) >> 4)+j];
+      if(IS_INTRA(currMB)) //intra macroblocks are not used for calculation of the filter coeffs.
+        continue;
 
-        x_orig = MB_BLOCK_SIZE*j;
-        y_orig = MB_BLOCK_SIZE*i;
+      for(subblock = 0; subblock < 16; subblock++)
+      {
+        x = MB_BLOCK_SIZE*j+4*(subblock & 0x03);
+        y = MB_BLOCK_SIZE*i+4*(subblock >> 2);
 
-        for(subblock = 0; subblock < 16; subblock++)
+        for (list = LIST_0; list <= LIST_1; list++)
         {
-          //List 0
-          x = x_orig+4*(subblock & 0x03);
-          y = y_orig+4*(subblock >> 2);
-          mvx = motion->mv[LIST_0][y >> 2][x >> 2][0];
-          mvy = motion->mv[LIST_0][y >> 2][x >> 2][1];
-          ref_frame = motion->ref_idx[LIST_0][y >> 2][x >> 2];
-
-          if(ref_frame != -1)
-          {
-            for(yi = 0; yi < 4; yi++)
-            {    //y
-              for(xj = 0; xj < 4; xj++)
-              {  //x
-                valOrg   = p_Vid->pCurImg[y+yi][x+xj];
-
-                y_pos = imax(0,imin(out4Y_height,4*(y+yi)+4*IMG_PAD_SIZE+mvy));
-                x_pos = imax(0,imin(out4Y_width, 4*(x+xj)+4*IMG_PAD_SIZE+mvx));
-
-                temp=p_Vid->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
-                p_Vid->frameOffsetTotal[LIST_0][ref_frame]+=(valOrg-temp);
-                p_Vid->frameOffsetCount[LIST_0][ref_frame]++;          
-              }
-            }
-          } 
-
-
-          //List 1
-          mvx = motion->mv[LIST_1][y >> 2][x >> 2][0];
-          mvy = motion->mv[LIST_1][y >> 2][x >> 2][1];
-          ref_frame = motion->ref_idx[LIST_1][y >> 2][x >> 2];
-          if(ref_frame != -1)
+          ref_frame = motion->ref_idx[list][y >> 2][x >> 2];
+          // both lists are compensated from the list 0 reference with the same index
+          if(ref_frame != -1 && (ref_frame % job->num_jobs) == job->job)
           {
-            for(yi = 0; yi < 4; yi++)
-            {    //y
-              for(xj = 0; xj < 4; xj++)
-              {  //x
-                valOrg   = p_Vid->pCurImg[y+yi][x+xj];
-
-                y_pos = imax(0,imin(out4Y_height,4*(y+yi)+4*IMG_PAD_SIZE+mvy));
-                x_pos = imax(0,imin(out4Y_width, 4*(x+xj)+4*IMG_PAD_SIZE+mvx));
-
-                temp=p_Vid->listX[LIST_0][ref_frame]->p_curr_img_sub[(y_pos & 0x03)][(x_pos & 0x03)][y_pos >> 2][x_pos >> 2];
-                p_Vid->frameOffsetTotal[LIST_1][ref_frame]+=(valOrg-temp);
-                p_Vid->frameOffsetCount[LIST_1][ref_frame]++;          
-              }
-            }
+            accumulate_block_offset(p_Vid, p_Vid->listX[LIST_0][ref_frame], x, y,
+              motion->mv[list][y >> 2][x >> 2][0], motion->mv[list][y >> 2][x >> 2][1],
+              &job->total[list][ref_frame], &job->count[list][ref_frame]);
           }
-        }//  for(subblock = 0; subblock < 16; subblock++)
+        }
       }
     }
+  }
+}
+
+#if !defined(WIN32)
+static void *offset_job_thread(void *arg)
+{
+  accumulate_offsets((WPOffsetJob *) arg);
+  return NULL;
+}
+#endif
+
+/*!
+************************************************************************
+* \brief
+*    Computes the average MC offset of each reference picture for the
+*    iterative WP method. The reference indices are distributed over
+*    WPThreads jobs that are processed in parallel.
+************************************************************************
+*/
+void compute_offset(VideoParameters *p_Vid)
+{
+  WPOffsetJob job[WP_MAX_THREADS];
+  int num_jobs = imax(1, imin(imin(p_Vid->p_Inp->WPThreads, WP_MAX_THREADS), imax(p_Vid->listXsize[LIST_0], p_Vid->listXsize[LIST_1])));
+  int numlists = (p_Vid->type == B_SLICE) ? 2 : 1;
+  int frame, list, offset, k;
+  double dtemp;
+
+  for (k = 0; k < num_jobs; k++)
+  {
+    job[k].p_Vid    = p_Vid;
+    job[k].job      = k;
+    job[k].num_jobs = num_jobs;
+  }
+
+#if !defined(WIN32)
+  if (num_jobs > 1)
+  {
+    pthread_t thread[WP_MAX_THREADS];
+    int started[WP_MAX_THREADS];
+
+    for (k = 1; k < num_jobs; k++)
+      started[k] = (pthread_create(&thread[k], NULL, offset_job_thread, &job[k]) == 0);
+    accumulate_offsets(&job[0]);
+    for (k = 1; k < num_jobs; k++)
+    {
+      if (started[k])
+        pthread_join(thread[k], NULL);
+      else
+        accumulate_offsets(&job[k]);
+    }
+  }
+  else
+#endif
+  {
+    for (k = 0; k < num_jobs; k++)
+      accumulate_offsets(&job[k]);
+  }
 
-    for(list = 0; list < numlists; list++)
+  // each reference index is accumulated by exactly one job
+  for(list = 0; list < 2; list++)
+  {
+    for(frame = 0; frame < MAX_REFERENCE_PICTURES; frame++)
     {
-      for(frame = 0; frame < p_Vid->listXsize[list]; frame++)
-      {
-        dtemp=(double)p_Vid->frameOffsetTotal[list][frame];
+      k = frame % num_jobs;
+      p_Vid->frameOffsetTotal[list][frame] = job[k].total[list][frame];
+      p_Vid->frameOffsetCount[list][frame] = job[k].count[list][frame];
+    }
+  }
+
+  for(list = 0; list < numlists; list++)
+  {
+    for(frame = 0; frame < p_Vid->listXsize[list]; frame++)
+    {
+      dtemp=(double)p_Vid->frameOffsetTotal[list][frame];
 
-        if (p_Vid->frameOffsetCount[list][frame]>0)
+      if (p_Vid->frameOffsetCount[list][frame]>0)
+      {
+        offset=(int)(fabs(dtemp)/(double)p_Vid->frameOffsetCount[list][frame]+0.5);
+        if (p_Vid->frameOffsetTotal[list][frame]>=0)
         {
-          offset=(int)(fabs(dtemp)/(double)p_Vid->frameOffsetCount[list][frame]+0.5);
-          if (p_Vid->frameOffsetTotal[list][frame]>=0)
-          {
-            p_Vid->frameOffset[list][frame] = (short) offset;
-          }
-          else
-          {
-            p_Vid->frameOffset[list][frame] = (short) -offset;
-          }
-          //printf("list %d frame %d offset %d frameOffsetCount %d, frameOffsetTotal %d\n", list, frame, p_Vid->frameOffset[list][frame], p_Vid->frameOffsetCount[list][frame], p_Vid->frameOffsetTotal[list][frame]);
+          p_Vid->frameOffset[list][frame] = (short) offset;
+        }
+        else
+        {
+          p_Vid->frameOffset[list][frame] = (short) -offset;
         }
-        //else
-        //{
-        //printf("list %d frame %d, frameOffsetCount=0\n", list, frame);
-        //}
       }
     }
   }
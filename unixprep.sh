@@ -23,6 +23,11 @@ do
    sed -e "s///" < $f >$f.tmp && mv $f.tmp $f
 done
 
+for f in bench/*.c bench/Makefile
+do
+   sed -e "s///" < $f >$f.tmp && mv $f.tmp $f
+done
+
 
 echo "Done."
 